@@ -0,0 +1,68 @@
+#include <spark_dsg/bounding_box_extraction.h>
+
+#include <chrono>
+#include <iostream>
+#include <random>
+
+namespace {
+
+// reads points through the virtual interface (like any user-provided adaptor)
+struct ListAdaptor : spark_dsg::BoundingBox::PointAdaptor {
+  explicit ListAdaptor(const std::vector<Eigen::Vector3f>& points) : points(points) {}
+  size_t size() const override { return points.size(); }
+  Eigen::Vector3f get(size_t index) const override { return points[index]; }
+  const std::vector<Eigen::Vector3f>& points;
+};
+
+template <typename Func>
+double timeMs(size_t num_trials, const Func& func) {
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < num_trials; ++i) {
+    func();
+  }
+  const std::chrono::duration<double, std::milli> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count() / num_trials;
+}
+
+}  // namespace
+
+auto main(int argc, char* argv[]) -> int {
+  if (argc > 2) {
+    std::cerr << "Invalid arguments! Usage: bounding_box_benchmark [NUM_POINTS]"
+              << std::endl;
+    return 1;
+  }
+
+  const size_t num_points = argc >= 2 ? std::strtoul(argv[1], nullptr, 10) : 4000000;
+  if (!num_points) {
+    std::cerr << "Invalid benchmark parameters!" << std::endl;
+    return 1;
+  }
+
+  std::mt19937 gen(0);
+  std::uniform_real_distribution<float> dist(-10.0f, 10.0f);
+  std::vector<Eigen::Vector3f> points;
+  points.reserve(num_points);
+  for (size_t i = 0; i < num_points; ++i) {
+    points.emplace_back(dist(gen), dist(gen), dist(gen));
+  }
+
+  constexpr size_t num_trials = 10;
+  const ListAdaptor adaptor(points);
+  spark_dsg::BoundingBox expected;
+  const double adaptor_ms = timeMs(num_trials, [&]() {
+    expected = spark_dsg::bounding_box::extract(adaptor);
+  });
+
+  spark_dsg::BoundingBox result;
+  const double contiguous_ms = timeMs(num_trials, [&]() {
+    result = spark_dsg::bounding_box::extract(points.data(), points.size());
+  });
+
+  std::cout << "points: " << num_points << std::endl;
+  std::cout << "AABB through PointAdaptor: " << adaptor_ms << " ms" << std::endl;
+  std::cout << "AABB from contiguous points: " << contiguous_ms << " ms" << std::endl;
+  std::cout << "boxes match: " << std::boolalpha << (result == expected) << std::endl;
+  return 0;
+}
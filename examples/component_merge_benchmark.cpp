@@ -0,0 +1,114 @@
+#include <spark_dsg/graph_utilities.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <unordered_set>
+
+namespace {
+
+using NodeSet = std::unordered_set<spark_dsg::NodeId>;
+using spark_dsg::graph_utilities::Components;
+
+// groups of sets where each set shares one node with the next set in its group
+std::vector<NodeSet> createSets(size_t num_sets, size_t set_size, size_t group_size) {
+  std::mt19937 gen(1234);
+  std::vector<NodeSet> sets(num_sets);
+  spark_dsg::NodeId next_node = 0;
+  for (size_t i = 0; i < num_sets; ++i) {
+    if (i % group_size != 0) {
+      sets[i].insert(*sets[i - 1].begin());
+    }
+
+    while (sets[i].size() < set_size) {
+      sets[i].insert(next_node++);
+    }
+  }
+
+  // process sets out of order so that merges chain across the input
+  std::shuffle(sets.begin(), sets.end(), gen);
+  return sets;
+}
+
+// previous single-pass implementation (chained overlaps may not be merged)
+Components pairwiseMerge(const std::vector<NodeSet>& unmerged) {
+  Components components;
+  std::unordered_set<size_t> added_components;
+  for (size_t i = 0; i < unmerged.size(); ++i) {
+    if (added_components.count(i)) {
+      continue;
+    }
+
+    NodeSet curr_component = unmerged.at(i);
+    for (size_t j = i + 1; j < unmerged.size(); ++j) {
+      if (added_components.count(j)) {
+        continue;
+      }
+
+      for (const auto node : unmerged[j]) {
+        if (curr_component.count(node)) {
+          added_components.insert(j);
+          curr_component.insert(unmerged.at(j).begin(), unmerged.at(j).end());
+          break;
+        }
+      }
+    }
+
+    added_components.insert(i);
+    components.emplace_back(curr_component.begin(), curr_component.end());
+  }
+
+  return components;
+}
+
+template <typename Func>
+double timeMs(size_t num_trials, const Func& func) {
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < num_trials; ++i) {
+    func();
+  }
+  const std::chrono::duration<double, std::milli> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count() / num_trials;
+}
+
+}  // namespace
+
+auto main(int argc, char* argv[]) -> int {
+  if (argc > 4) {
+    std::cerr << "Invalid arguments! Usage: component_merge_benchmark [NUM_SETS] "
+                 "[SET_SIZE] [GROUP_SIZE]"
+              << std::endl;
+    return 1;
+  }
+
+  const size_t num_sets = argc >= 2 ? std::strtoul(argv[1], nullptr, 10) : 5000;
+  const size_t set_size = argc >= 3 ? std::strtoul(argv[2], nullptr, 10) : 20;
+  const size_t group_size = argc >= 4 ? std::strtoul(argv[3], nullptr, 10) : 50;
+  if (!num_sets || set_size < 2 || !group_size) {
+    std::cerr << "Invalid benchmark parameters!" << std::endl;
+    return 1;
+  }
+
+  const auto sets = createSets(num_sets, set_size, group_size);
+  constexpr size_t num_trials = 5;
+
+  Components merged;
+  const double merge_ms = timeMs(num_trials, [&]() {
+    merged = spark_dsg::graph_utilities::getMergedComponents(sets);
+  });
+
+  Components pairwise;
+  const double pairwise_ms =
+      timeMs(num_trials, [&]() { pairwise = pairwiseMerge(sets); });
+
+  std::cout << "sets: " << num_sets << " x " << set_size << " nodes, "
+            << (num_sets + group_size - 1) / group_size << " expected components"
+            << std::endl;
+  std::cout << "disjoint-set: " << merged.size() << " components in " << merge_ms
+            << " ms" << std::endl;
+  std::cout << "pairwise: " << pairwise.size() << " components in " << pairwise_ms
+            << " ms (" << pairwise_ms / merge_ms << "x slower)" << std::endl;
+  return 0;
+}
@@ -0,0 +1,69 @@
+#include <spark_dsg/stream_recording.h>
+#include <spark_dsg/zmq_interface.h>
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+auto main(int argc, char* argv[]) -> int {
+  if (argc < 2) {
+    std::cerr << "Invalid arguments! Usage: dsg_player RECORDING_PATH [SPEED] [ADDRESS]"
+              << std::endl;
+    return 1;
+  }
+
+  const std::string recording_path(argv[1]);
+
+  // speed of 0 plays back messages as fast as possible
+  double speed = 1.0;
+  if (argc >= 3) {
+    speed = std::strtod(argv[2], nullptr);
+  }
+
+  if (speed < 0) {
+    std::cerr << "Invalid speed: " << speed << "!" << std::endl;
+    return 1;
+  }
+
+  std::string address = "tcp://127.0.0.1:8001";
+  if (argc >= 4) {
+    address = std::string(argv[3]);
+  }
+
+  spark_dsg::StreamReader reader(recording_path);
+  if (reader.empty()) {
+    std::cerr << "No messages in '" << recording_path << "'" << std::endl;
+    return 1;
+  }
+
+  std::cout << "playing " << reader.size() << " messages from '" << recording_path
+            << "' @ '" << address << "'" << std::endl;
+  spark_dsg::ZmqSender sender(address, 2);
+  sender.enableStats();
+
+  // give subscribers a chance to connect before playback starts
+  std::this_thread::sleep_for(std::chrono::seconds(1));
+
+  // schedule against the start time to avoid accumulating drift
+  const auto start = std::chrono::steady_clock::now();
+  const auto first_stamp = reader.stamp(0);
+  for (size_t i = 0; i < reader.size(); ++i) {
+    if (speed > 0) {
+      // recordings are not guaranteed to be monotonic, so clamp to the start
+      const uint64_t stamp = std::max(reader.stamp(i), first_stamp);
+      const std::chrono::duration<double, std::nano> offset((stamp - first_stamp) /
+                                                            speed);
+      std::this_thread::sleep_until(
+          start + std::chrono::duration_cast<std::chrono::nanoseconds>(offset));
+    }
+
+    sender.sendRaw(reader.read(i));
+  }
+
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  std::cout << "played back " << reader.size() << " messages in " << elapsed.count()
+            << " [s]" << std::endl
+            << sender.stats() << std::endl;
+  return 0;
+}
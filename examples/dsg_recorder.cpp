@@ -0,0 +1,62 @@
+#include <spark_dsg/stream_recording.h>
+#include <spark_dsg/zmq_interface.h>
+
+#include <atomic>
+#include <csignal>
+
+namespace {
+std::atomic<bool> should_shutdown(false);
+}
+
+void handleSignal(int) { should_shutdown = true; }
+
+auto main(int argc, char* argv[]) -> int {
+  if (argc < 2) {
+    std::cerr << "Invalid arguments! Usage: dsg_recorder OUTPUT_PATH [ADDRESS] "
+                 "[LAYER_IDS...]"
+              << std::endl;
+    return 1;
+  }
+
+  const std::string output_path(argv[1]);
+
+  std::string address = "tcp://127.0.0.1:8001";
+  if (argc >= 3) {
+    address = std::string(argv[2]);
+  }
+
+  // senders using layer topics require the layers to record
+  std::vector<spark_dsg::LayerId> layers;
+  for (int i = 3; i < argc; ++i) {
+    layers.push_back(std::strtoul(argv[i], nullptr, 10));
+  }
+
+  std::unique_ptr<spark_dsg::ZmqReceiver> receiver;
+  if (layers.empty()) {
+    receiver.reset(new spark_dsg::ZmqReceiver(address, 2, false));
+  } else {
+    receiver.reset(new spark_dsg::ZmqReceiver(address, 2, layers, true, false));
+  }
+
+  std::signal(SIGINT, handleSignal);
+  std::signal(SIGTERM, handleSignal);
+
+  std::cout << "recording graph stream @ '" << address << "' to '" << output_path
+            << "'" << std::endl;
+  spark_dsg::StreamWriter writer(output_path);
+  spark_dsg::StreamMessage message;
+  size_t num_bytes = 0;
+  while (!should_shutdown) {
+    if (!receiver->recvRaw(100, message)) {
+      continue;
+    }
+
+    writer.write(message);
+    num_bytes += message.payload.size();
+  }
+
+  writer.close();
+  std::cout << "recorded " << writer.numMessages() << " messages (" << num_bytes
+            << " bytes)" << std::endl;
+  return 0;
+}
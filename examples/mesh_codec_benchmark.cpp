@@ -0,0 +1,101 @@
+#include <spark_dsg/mesh.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+namespace {
+
+// triangulated, slightly curved grid with vertices every 2 cm
+spark_dsg::Mesh::Ptr createGridMesh(size_t size) {
+  auto mesh = std::make_shared<spark_dsg::Mesh>(true, true, true, true);
+  for (size_t r = 0; r < size; ++r) {
+    for (size_t c = 0; c < size; ++c) {
+      const float x = 0.02f * c;
+      const float y = 0.02f * r;
+      mesh->points.emplace_back(x, y, 0.1f * std::sin(x) * std::cos(y));
+      mesh->colors.emplace_back(r % 256, c % 256, 128);
+      mesh->stamps.push_back(1700000000000000000u + 100000 * r);
+      mesh->first_seen_stamps.push_back(1700000000000000000u + 100000 * r);
+      mesh->labels.push_back((r / 50) % 10);
+    }
+  }
+
+  for (size_t r = 0; r + 1 < size; ++r) {
+    for (size_t c = 0; c + 1 < size; ++c) {
+      const size_t i = r * size + c;
+      mesh->faces.push_back({{i, i + 1, i + size}});
+      mesh->faces.push_back({{i + 1, i + size + 1, i + size}});
+    }
+  }
+
+  return mesh;
+}
+
+template <typename Func>
+double timeMs(size_t num_trials, const Func& func) {
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < num_trials; ++i) {
+    func();
+  }
+  const std::chrono::duration<double, std::milli> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count() / num_trials;
+}
+
+}  // namespace
+
+auto main(int argc, char* argv[]) -> int {
+  if (argc > 3) {
+    std::cerr << "Invalid arguments! Usage: mesh_codec_benchmark [MESH_PATH] "
+                 "[RESOLUTION]"
+              << std::endl;
+    return 1;
+  }
+
+  // benchmark a synthetic mesh with one million vertices if no mesh is provided
+  const auto mesh =
+      argc >= 2 ? spark_dsg::Mesh::load(std::string(argv[1])) : createGridMesh(1000);
+  const float resolution = argc >= 3 ? std::strtof(argv[2], nullptr) : 0.001f;
+  constexpr size_t num_trials = 5;
+
+  std::vector<uint8_t> raw;
+  const double raw_encode_ms = timeMs(num_trials, [&]() {
+    raw.clear();
+    mesh->serializeToBinary(raw);
+  });
+  const double raw_decode_ms = timeMs(num_trials, [&]() {
+    spark_dsg::Mesh::deserializeFromBinary(raw.data(), raw.size());
+  });
+
+  std::vector<uint8_t> compressed;
+  const double encode_ms = timeMs(num_trials, [&]() {
+    compressed.clear();
+    mesh->serializeToCompressedBinary(compressed, resolution);
+  });
+  spark_dsg::Mesh::Ptr result;
+  const double decode_ms = timeMs(num_trials, [&]() {
+    result = spark_dsg::Mesh::deserializeFromCompressedBinary(compressed.data(),
+                                                              compressed.size());
+  });
+
+  float max_error = 0.0f;
+  for (size_t i = 0; i < mesh->numVertices(); ++i) {
+    const auto error = (result->pos(i) - mesh->pos(i)).cwiseAbs().maxCoeff();
+    max_error = std::max(max_error, error);
+  }
+
+  const double raw_mb = raw.size() / 1.0e6;
+  std::cout << "mesh: " << mesh->numVertices() << " vertices, " << mesh->numFaces()
+            << " faces" << std::endl;
+  std::cout << "raw: " << raw_mb << " MB, encode " << raw_encode_ms << " ms, decode "
+            << raw_decode_ms << " ms" << std::endl;
+  std::cout << "compressed @ " << resolution << " m: " << compressed.size() / 1.0e6
+            << " MB (" << raw.size() / static_cast<double>(compressed.size())
+            << "x smaller), encode " << encode_ms << " ms (" << raw_mb / encode_ms * 1e3
+            << " MB/s), decode " << decode_ms << " ms (" << raw_mb / decode_ms * 1e3
+            << " MB/s)" << std::endl;
+  std::cout << "max position error: " << max_error << " m" << std::endl;
+  return 0;
+}
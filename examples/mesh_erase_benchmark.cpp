@@ -0,0 +1,127 @@
+#include <spark_dsg/mesh.h>
+
+#include <chrono>
+#include <iostream>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace {
+
+using spark_dsg::Mesh;
+
+// strip of triangles with two vertices per face
+Mesh createStripMesh(size_t num_vertices) {
+  Mesh mesh(true, true, true, true);
+  for (size_t i = 0; i < num_vertices; ++i) {
+    const float x = 0.01f * (i / 2);
+    mesh.points.emplace_back(x, i % 2 ? 0.01f : 0.0f, 0.0f);
+    mesh.colors.emplace_back(i % 256, 128, 128);
+    mesh.stamps.push_back(i);
+    mesh.first_seen_stamps.push_back(i);
+    mesh.labels.push_back(i % 10);
+  }
+
+  for (size_t i = 0; i + 2 < num_vertices; i += 2) {
+    mesh.faces.push_back({{i, i + 1, i + 2}});
+  }
+
+  return mesh;
+}
+
+// erasure by index set (with a remap table and per-face vector::erase) used before
+// Mesh::eraseVerticesByMask
+void eraseVerticesBySet(Mesh& mesh, const std::unordered_set<size_t>& indices) {
+  std::unordered_map<size_t, size_t> old_to_new;
+  Mesh::Positions new_points;
+  Mesh::Colors new_colors;
+  Mesh::Timestamps new_stamps;
+  Mesh::Timestamps new_first_seen_stamps;
+  Mesh::Labels new_labels;
+  size_t new_index = 0;
+  for (size_t old_index = 0; old_index < mesh.numVertices(); ++old_index) {
+    if (indices.count(old_index)) {
+      continue;
+    }
+
+    old_to_new[old_index] = new_index++;
+    new_points.push_back(mesh.points[old_index]);
+    new_colors.push_back(mesh.colors[old_index]);
+    new_stamps.push_back(mesh.stamps[old_index]);
+    new_first_seen_stamps.push_back(mesh.first_seen_stamps[old_index]);
+    new_labels.push_back(mesh.labels[old_index]);
+  }
+
+  mesh.points = std::move(new_points);
+  mesh.colors = std::move(new_colors);
+  mesh.stamps = std::move(new_stamps);
+  mesh.first_seen_stamps = std::move(new_first_seen_stamps);
+  mesh.labels = std::move(new_labels);
+
+  auto face_it = mesh.faces.begin();
+  while (face_it != mesh.faces.end()) {
+    bool erase_face = false;
+    for (size_t& index : *face_it) {
+      const auto new_index = old_to_new.find(index);
+      if (new_index == old_to_new.end()) {
+        erase_face = true;
+        break;
+      }
+      index = new_index->second;
+    }
+
+    face_it = erase_face ? mesh.faces.erase(face_it) : face_it + 1;
+  }
+}
+
+template <typename Func>
+double timeMs(const Func& func) {
+  const auto start = std::chrono::steady_clock::now();
+  func();
+  const std::chrono::duration<double, std::milli> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
+}  // namespace
+
+auto main(int argc, char* argv[]) -> int {
+  if (argc > 3) {
+    std::cerr << "Invalid arguments! Usage: mesh_erase_benchmark [NUM_VERTICES] "
+                 "[ERASE_STRIDE]"
+              << std::endl;
+    return 1;
+  }
+
+  // one million vertices and half a million faces with every 4th vertex erased by
+  // default (the set-based erasure takes minutes at this size)
+  const size_t num_vertices = argc >= 2 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+  const size_t stride = argc >= 3 ? std::strtoul(argv[2], nullptr, 10) : 4;
+  if (num_vertices < 3 || !stride) {
+    std::cerr << "Invalid benchmark parameters!" << std::endl;
+    return 1;
+  }
+
+  const auto original = createStripMesh(num_vertices);
+  std::vector<bool> mask(num_vertices, false);
+  std::unordered_set<size_t> indices;
+  for (size_t i = 0; i < num_vertices; i += stride) {
+    mask[i] = true;
+    indices.insert(i);
+  }
+
+  auto by_mask = original;
+  const double mask_ms = timeMs([&]() { by_mask.eraseVerticesByMask(mask); });
+
+  auto by_set = original;
+  const double set_ms = timeMs([&]() { eraseVerticesBySet(by_set, indices); });
+
+  std::cout << "mesh: " << original.numVertices() << " vertices, "
+            << original.numFaces() << " faces, erasing " << indices.size()
+            << " vertices" << std::endl;
+  std::cout << "eraseVerticesByMask: " << mask_ms << " ms" << std::endl;
+  std::cout << "set-based erasure: " << set_ms << " ms" << std::endl;
+  std::cout << "results match: " << std::boolalpha
+            << (by_mask.points == by_set.points && by_mask.faces == by_set.faces)
+            << std::endl;
+  return 0;
+}
@@ -0,0 +1,180 @@
+#include <spark_dsg/bounding_box_extraction.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <list>
+#include <random>
+
+namespace {
+
+using Points = std::vector<Eigen::Vector3f>;
+
+// noisy walls of a rotated 6 x 4 m room
+Points createRoomBoundary(size_t num_points) {
+  std::mt19937 gen(0);
+  std::uniform_real_distribution<float> along(0.0f, 20.0f);
+  std::uniform_real_distribution<float> height(0.0f, 2.5f);
+  std::normal_distribution<float> noise(0.0f, 0.02f);
+  const Eigen::Rotation2Df rotation(0.5f);
+
+  Points points;
+  points.reserve(num_points);
+  for (size_t i = 0; i < num_points; ++i) {
+    // walk along the perimeter
+    const float s = along(gen);
+    Eigen::Vector2f pos;
+    if (s < 6.0f) {
+      pos << s, 0.0f;
+    } else if (s < 10.0f) {
+      pos << 6.0f, s - 6.0f;
+    } else if (s < 16.0f) {
+      pos << 16.0f - s, 4.0f;
+    } else {
+      pos << 0.0f, 20.0f - s;
+    }
+
+    pos = rotation * (pos + Eigen::Vector2f(noise(gen), noise(gen)));
+    points.emplace_back(pos.x(), pos.y(), height(gen));
+  }
+
+  return points;
+}
+
+float getAngle(const Eigen::Vector3f& curr, const Eigen::Vector3f& root) {
+  const Eigen::Vector2f vec = (curr.head<2>() - root.head<2>()).normalized();
+  return 1.0f - vec.x();
+}
+
+float getDist(const Eigen::Vector3f& curr, const Eigen::Vector3f& root) {
+  return (curr.head<2>() - root.head<2>()).array().abs().sum();
+}
+
+float getJointDirection(const Eigen::Vector3f& prev,
+                        const Eigen::Vector3f& curr,
+                        const Eigen::Vector3f& next) {
+  const Eigen::Vector2f v1 = curr.head<2>() - prev.head<2>();
+  const Eigen::Vector2f v2 = next.head<2>() - prev.head<2>();
+  return v1.x() * v2.y() - v1.y() * v2.x();
+}
+
+// angle-sorted hull used before the monotone chain
+std::vector<size_t> angleSortedHull(const Points& points) {
+  size_t root = 0;
+  for (size_t i = 0; i < points.size(); ++i) {
+    const auto& curr = points[i];
+    const auto& best = points[root];
+    if (curr.y() < best.y() || (curr.y() == best.y() && curr.x() <= best.x())) {
+      root = i;
+    }
+  }
+
+  const Eigen::Vector3f root_pos = points[root];
+  std::vector<size_t> indices;
+  for (size_t i = 0; i < points.size(); ++i) {
+    if (i != root) {
+      indices.push_back(i);
+    }
+  }
+
+  std::sort(indices.begin(), indices.end(), [&](size_t i, size_t j) {
+    const auto a_i = getAngle(points[i], root_pos);
+    const auto a_j = getAngle(points[j], root_pos);
+    if (std::abs(a_i - a_j) < 1.0e-9f) {
+      return getDist(points[i], root_pos) < getDist(points[j], root_pos);
+    }
+    return a_i < a_j;
+  });
+
+  std::list<size_t> hull{root};
+  for (const auto idx : indices) {
+    while (hull.size() > 1) {
+      auto prev = --hull.cend();
+      auto curr = prev;
+      --curr;
+      if (getJointDirection(points[*prev], points[*curr], points[idx]) < 0.0f) {
+        break;
+      }
+
+      hull.pop_back();
+    }
+
+    hull.push_back(idx);
+  }
+
+  return {hull.begin(), hull.end()};
+}
+
+// minimum area over hull edges, scanning every hull point per edge
+float scannedBoxArea(const Points& points, const std::vector<size_t>& hull) {
+  float min_area = std::numeric_limits<float>::infinity();
+  for (size_t i = 0; i < hull.size(); ++i) {
+    const Eigen::Vector2f x_c = points[hull[i]].head<2>();
+    const Eigen::Vector2f x_n = points[hull[(i + 1) % hull.size()]].head<2>();
+    const Eigen::Vector2f n_h = (x_n - x_c).normalized();
+    const Eigen::Vector2f n_w(-n_h.y(), n_h.x());
+    float max_w = 0.0f;
+    float min_h = 0.0f;
+    float max_h = 0.0f;
+    for (size_t j = 1; j < hull.size(); ++j) {
+      const Eigen::Vector2f x_j = points[hull[(i + j) % hull.size()]].head<2>();
+      max_w = std::max(max_w, n_w.dot(x_j - x_c));
+      min_h = std::min(min_h, n_h.dot(x_j - x_c));
+      max_h = std::max(max_h, n_h.dot(x_j - x_c));
+    }
+
+    min_area = std::min(min_area, max_w * (max_h - min_h));
+  }
+
+  return min_area;
+}
+
+template <typename Func>
+double timeMs(size_t num_trials, const Func& func) {
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < num_trials; ++i) {
+    func();
+  }
+  const std::chrono::duration<double, std::milli> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count() / num_trials;
+}
+
+}  // namespace
+
+auto main(int argc, char* argv[]) -> int {
+  if (argc > 2) {
+    std::cerr << "Invalid arguments! Usage: room_box_benchmark [NUM_POINTS]"
+              << std::endl;
+    return 1;
+  }
+
+  const size_t num_points = argc >= 2 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+  if (num_points < 3) {
+    std::cerr << "Invalid benchmark parameters!" << std::endl;
+    return 1;
+  }
+
+  const auto points = createRoomBoundary(num_points);
+  constexpr size_t num_trials = 5;
+
+  spark_dsg::BoundingBox box;
+  const double raabb_ms = timeMs(num_trials, [&]() {
+    box = spark_dsg::bounding_box::extract(
+        points.data(), points.size(), spark_dsg::BoundingBox::Type::RAABB);
+  });
+
+  float scanned_area = 0.0f;
+  const double scanned_ms = timeMs(num_trials, [&]() {
+    scanned_area = scannedBoxArea(points, angleSortedHull(points));
+  });
+
+  std::cout << "points: " << num_points << std::endl;
+  std::cout << "RAABB extraction: " << raabb_ms << " ms (area "
+            << box.dimensions.x() * box.dimensions.y() << " m^2)" << std::endl;
+  std::cout << "angle-sorted hull and box scan: " << scanned_ms << " ms (area "
+            << scanned_area << " m^2)" << std::endl;
+  return 0;
+}
@@ -0,0 +1,96 @@
+#include <spark_dsg/adjacency_matrix.h>
+
+#include <chrono>
+#include <iostream>
+
+namespace {
+
+using spark_dsg::EdgeAttributes;
+using spark_dsg::NodeId;
+
+// 4-connected grid of nodes with weighted edges
+std::unique_ptr<spark_dsg::IsolatedSceneGraphLayer> createGridLayer(size_t size) {
+  auto layer = std::make_unique<spark_dsg::IsolatedSceneGraphLayer>(1);
+  for (size_t i = 0; i < size * size; ++i) {
+    layer->emplaceNode(i, std::make_unique<spark_dsg::NodeAttributes>());
+  }
+
+  for (size_t r = 0; r < size; ++r) {
+    for (size_t c = 0; c < size; ++c) {
+      const size_t i = r * size + c;
+      if (c + 1 < size) {
+        layer->insertEdge(i, i + 1, std::make_unique<EdgeAttributes>(0.5));
+      }
+      if (r + 1 < size) {
+        layer->insertEdge(i, i + size, std::make_unique<EdgeAttributes>(1.5));
+      }
+    }
+  }
+
+  return layer;
+}
+
+template <typename Func>
+double timeMs(size_t num_trials, const Func& func) {
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < num_trials; ++i) {
+    func();
+  }
+  const std::chrono::duration<double, std::milli> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count() / num_trials;
+}
+
+}  // namespace
+
+auto main(int argc, char* argv[]) -> int {
+  if (argc > 3) {
+    std::cerr << "Invalid arguments! Usage: sparse_laplacian_benchmark [GRID_SIZE] "
+                 "[NUM_THREADS]"
+              << std::endl;
+    return 1;
+  }
+
+  // 300 x 300 grid (90k nodes) on a single core by default
+  const size_t grid_size = argc >= 2 ? std::strtoul(argv[1], nullptr, 10) : 300;
+  const size_t num_threads = argc >= 3 ? std::strtoul(argv[2], nullptr, 10) : 1;
+  if (!grid_size) {
+    std::cerr << "Invalid benchmark parameters!" << std::endl;
+    return 1;
+  }
+
+  const auto layer = createGridLayer(grid_size);
+  std::map<NodeId, size_t> ordering;
+  for (const auto& id_node_pair : layer->nodes()) {
+    ordering.emplace(id_node_pair.first, ordering.size());
+  }
+
+  constexpr size_t num_trials = 5;
+  spark_dsg::SparseMatrixXd expected;
+  const double triplet_ms = timeMs(num_trials, [&]() {
+    expected = spark_dsg::getSparseLaplacian(
+        *layer, ordering, [&](NodeId source, NodeId target) {
+          return layer->getEdge(source, target).info->weight;
+        });
+  });
+
+  std::unique_ptr<spark_dsg::SparseMatrixBuilder> builder;
+  const double setup_ms = timeMs(num_trials, [&]() {
+    builder = std::make_unique<spark_dsg::SparseMatrixBuilder>(*layer, num_threads);
+  });
+
+  spark_dsg::SparseMatrixXd result;
+  const double build_ms = timeMs(num_trials, [&]() {
+    result = builder->laplacian(spark_dsg::EdgeWeight::ATTRIBUTE);
+  });
+
+  std::cout << "layer: " << layer->numNodes() << " nodes, " << layer->numEdges()
+            << " edges" << std::endl;
+  std::cout << "getSparseLaplacian: " << triplet_ms << " ms" << std::endl;
+  std::cout << "builder setup: " << setup_ms << " ms" << std::endl;
+  std::cout << "builder laplacian: " << build_ms << " ms" << std::endl;
+  std::cout << "matrices match: " << std::boolalpha
+            << (spark_dsg::SparseMatrixXd(result - expected).norm() == 0.0)
+            << std::endl;
+  return 0;
+}
@@ -35,7 +35,10 @@
 #pragma once
 #include <Eigen/Dense>
 #include <Eigen/SparseCore>
+#include <unordered_map>
+#include <vector>
 
+#include "spark_dsg/edge_attributes.h"
 #include "spark_dsg/scene_graph_layer.h"
 
 namespace spark_dsg {
@@ -79,4 +82,87 @@ inline SparseMatrixXd getSparseLaplacian(const SceneGraphLayer& layer,
   return getSparseLaplacian(layer, ordering, [](NodeId, NodeId) { return 1.0; });
 }
 
+/**
+ * @brief Source of edge weights when assembling matrices with SparseMatrixBuilder
+ */
+enum class EdgeWeight {
+  UNIT,      /**< every edge has weight 1 */
+  ATTRIBUTE  /**< EdgeAttributes::weight for weighted edges and 1 otherwise */
+};
+
+/**
+ * @brief Assembles sparse adjacency and Laplacian matrices for a layer
+ *
+ * The dense index of every node and the sparsity pattern of the matrices are computed
+ * once (on construction or update) and reused by every matrix built afterwards, so
+ * building a matrix only evaluates the edge weights. Matrices are written directly in
+ * compressed form (no triplets or sorting) and both the pattern and the values are
+ * assembled by multiple threads for large layers.
+ *
+ * The builder keeps a reference to the layer: call update() after the layer changes.
+ * Weight functions may be called concurrently from multiple threads.
+ */
+class SparseMatrixBuilder {
+ public:
+  /**
+   * @brief Index the nodes of the layer in ascending id order
+   * @param num_threads Number of threads for assembly (0 uses the hardware concurrency)
+   */
+  explicit SparseMatrixBuilder(const SceneGraphLayer& layer, size_t num_threads = 0);
+
+  /**
+   * @brief Index the nodes of the layer in the provided order
+   *
+   * Nodes that are not part of the layer result in empty rows and columns.
+   */
+  SparseMatrixBuilder(const SceneGraphLayer& layer,
+                      const std::vector<NodeId>& ordering,
+                      size_t num_threads = 0);
+
+  /**
+   * @brief Recompute the node indices and the sparsity pattern
+   */
+  void update();
+
+  inline size_t size() const { return nodes_.size(); }
+
+  /**
+   * @brief Node for each row (and column) of the matrices
+   */
+  inline const std::vector<NodeId>& nodes() const { return nodes_; }
+
+  inline bool hasNode(NodeId node) const { return indices_.count(node); }
+
+  /**
+   * @brief Row (and column) of a node in the matrices (throws if not indexed)
+   */
+  size_t index(NodeId node) const;
+
+  SparseMatrixXd adjacency(EdgeWeight weight = EdgeWeight::UNIT) const;
+
+  SparseMatrixXd adjacency(const WeightFunc& weight_func) const;
+
+  SparseMatrixXd laplacian(EdgeWeight weight = EdgeWeight::UNIT) const;
+
+  SparseMatrixXd laplacian(const WeightFunc& weight_func) const;
+
+ private:
+  template <typename Func>
+  SparseMatrixXd build(bool laplacian, const Func& weight_func) const;
+
+  const SceneGraphLayer& layer_;
+  const size_t num_threads_;
+  const bool ascending_order_;
+  std::vector<NodeId> nodes_;
+  std::unordered_map<NodeId, size_t> indices_;
+
+  //! adjacency pattern in compressed column form
+  std::vector<int> outer_;
+  std::vector<int> inner_;
+  //! attributes of the edge for every non-zero entry of the adjacency matrix
+  std::vector<const EdgeAttributes*> edges_;
+  //! number of entries above the diagonal for every column
+  std::vector<int> upper_;
+};
+
 }  // namespace spark_dsg
@@ -0,0 +1,187 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <Eigen/Dense>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "spark_dsg/mesh.h"
+
+namespace spark_dsg {
+
+/**
+ * @brief Mesh split into fixed-size cubic blocks
+ *
+ * Each vertex belongs to the block containing its position and each face belongs to
+ * the block of its first vertex. Blocks store their own vertices and faces (as a
+ * Mesh) along with the index of every vertex and face in the flat mesh, so that
+ * any subset of blocks can be merged back into a flat mesh. Vertices of faces that
+ * straddle a block boundary are copied into the block that owns the face, which
+ * makes every block self-contained (e.g., for rendering or streaming).
+ */
+class BlockedMesh {
+ public:
+  using BlockIndex = Eigen::Vector3i;
+  using BlockIndices = std::vector<BlockIndex>;
+
+  struct Block {
+    explicit Block(const BlockIndex& index = BlockIndex::Zero(),
+                   const Mesh& mesh = Mesh());
+
+    BlockIndex index;
+    //! bounds of all vertices of the block (including copies)
+    Eigen::AlignedBox3f bounds;
+    //! vertices and faces of the block (faces use local vertex indices)
+    Mesh mesh;
+    //! number of vertices inside the block (the remaining vertices are copies)
+    size_t num_owned = 0;
+    //! index in the flat mesh of every vertex of the block
+    std::vector<size_t> vertex_indices;
+    //! index in the flat mesh of every face of the block
+    std::vector<size_t> face_indices;
+  };
+
+  explicit BlockedMesh(float block_size = 1.0f,
+                       bool has_colors = true,
+                       bool has_timestamps = true,
+                       bool has_labels = true,
+                       bool has_first_seen_stamps = false);
+
+  /**
+   * @brief Split a flat mesh into blocks
+   *
+   * Faces that refer to vertices that do not exist are dropped. Throws
+   * std::invalid_argument if any vertex position is not finite.
+   */
+  static BlockedMesh fromMesh(const Mesh& mesh, float block_size);
+
+  /**
+   * @brief Merge all blocks into a flat mesh
+   *
+   * Vertices and faces keep the relative order that they had in the original flat
+   * mesh (and the result is identical to it if no blocks were removed).
+   */
+  Mesh toMesh() const;
+
+  /**
+   * @brief Merge the given blocks into a flat mesh (missing blocks are skipped)
+   */
+  Mesh extract(const BlockIndices& blocks) const;
+
+  inline float blockSize() const { return block_size_; }
+
+  inline size_t numBlocks() const { return blocks_.size(); }
+
+  bool hasBlock(const BlockIndex& index) const;
+
+  /**
+   * @brief Get a block (throws std::out_of_range if the block does not exist)
+   */
+  const Block& block(const BlockIndex& index) const;
+
+  /**
+   * @brief Get the indices of all blocks in lexicographic order
+   */
+  BlockIndices blockIndices() const;
+
+  /**
+   * @brief Get the index of the block containing a position
+   *
+   * Throws std::invalid_argument if the position is not finite.
+   */
+  BlockIndex blockIndex(const Mesh::Pos& pos) const;
+
+  /**
+   * @brief Get the blocks whose bounds intersect the box (in lexicographic order)
+   */
+  BlockIndices blocksIntersecting(const Eigen::AlignedBox3f& box) const;
+
+  /**
+   * @brief Get the blocks containing the given flat mesh vertices
+   *
+   * Useful to load only the blocks needed for an object's mesh connections. Vertices
+   * that are not in any block are skipped.
+   */
+  BlockIndices blocksForVertices(const std::vector<size_t>& vertices) const;
+
+  /**
+   * @brief Add or replace a block
+   */
+  void insertBlock(Block block);
+
+  /**
+   * @brief Remove a block
+   * @returns true if the block existed
+   */
+  bool eraseBlock(const BlockIndex& index);
+
+  /**
+   * @brief Serialize a single block
+   */
+  void serializeBlock(const BlockIndex& index, std::vector<uint8_t>& buffer) const;
+
+  /**
+   * @brief Parse a block serialized by serializeBlock and add or replace it
+   * @throws std::invalid_argument if the block was created with another block size
+   * @returns Index of the block
+   */
+  BlockIndex insertBlockFromBinary(const uint8_t* const buffer, size_t length);
+
+ public:
+  const bool has_colors;
+  const bool has_timestamps;
+  const bool has_labels;
+  const bool has_first_seen_stamps;
+
+ private:
+  struct BlockHash {
+    size_t operator()(const BlockIndex& index) const;
+  };
+
+  //! record the block as the owner of its vertices
+  void indexBlock(const Block& block);
+
+  float block_size_;
+  std::unordered_map<BlockIndex, Block, BlockHash> blocks_;
+  //! slot of the block owning each flat mesh vertex (-1 if not owned by any block)
+  std::vector<int32_t> vertex_slots_;
+  //! block index of each slot (slots of erased blocks are reused)
+  std::vector<BlockIndex> slot_blocks_;
+  std::vector<int32_t> free_slots_;
+  std::unordered_map<BlockIndex, int32_t, BlockHash> block_slots_;
+};
+
+}  // namespace spark_dsg
@@ -33,7 +33,7 @@
  * purposes notwithstanding any copyright notation herein.
  * -------------------------------------------------------------------------- */
 #pragma once
-#include <list>
+#include <vector>
 
 #include "spark_dsg/bounding_box.h"
 
@@ -47,10 +47,13 @@ using PointAdaptor = BoundingBox::PointAdaptor;
  *
  * Exposed primarily for testing
  *
+ * Uses a monotone chain over the x-y projection of the points (O(n log n)).
+ * Collinear points on the hull are dropped.
+ *
  * @param points Point adaptor to use
- * @returns indices of hull points in ccw order
+ * @returns indices of hull points in ccw order, starting from the lowest point
  */
-std::list<size_t> get2dConvexHull(const PointAdaptor& points);
+std::vector<size_t> get2dConvexHull(const PointAdaptor& points);
 
 /**
  * @brief construct a bounding box directly from a pointcloud
@@ -58,6 +61,33 @@ std::list<size_t> get2dConvexHull(const PointAdaptor& points);
 BoundingBox extract(const PointAdaptor& points,
                     BoundingBox::Type type = BoundingBox::Type::AABB);
 
+/**
+ * @brief construct a bounding box from contiguous points
+ *
+ * Reads the points directly instead of through the virtual PointAdaptor interface
+ * (extract also takes this path for mesh and point vector adaptors).
+ */
+BoundingBox extract(const Eigen::Vector3f* points,
+                    size_t num_points,
+                    BoundingBox::Type type = BoundingBox::Type::AABB);
+
+/**
+ * @brief construct a bounding box from a subset of contiguous points
+ *
+ * Throws std::out_of_range if any index is not less than num_points.
+ */
+BoundingBox extract(const Eigen::Vector3f* points,
+                    size_t num_points,
+                    const std::vector<size_t>& indices,
+                    BoundingBox::Type type = BoundingBox::Type::AABB);
+
+BoundingBox extract(const Mesh& mesh,
+                    BoundingBox::Type type = BoundingBox::Type::AABB);
+
+BoundingBox extract(const Mesh& mesh,
+                    const std::vector<size_t>& indices,
+                    BoundingBox::Type type = BoundingBox::Type::AABB);
+
 }  // namespace bounding_box
 
 }  // namespace spark_dsg
@@ -0,0 +1,171 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <Eigen/Dense>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "spark_dsg/bounding_box.h"
+#include "spark_dsg/scene_graph_types.h"
+
+namespace spark_dsg {
+
+/**
+ * @brief Bounding-volume hierarchy over node bounding boxes
+ *
+ * Every indexed box is bounded by its world-frame axis-aligned extents and stored as
+ * a leaf of a binary tree of axis-aligned volumes. Inserting, removing or moving a
+ * box only touches the path between its leaf and the root (the internal volumes are
+ * refit and the insertion point is picked to keep the volumes small); rebuild()
+ * constructs a balanced tree from scratch. Invalid bounding boxes are not indexed.
+ *
+ * Point queries use BoundingBox::contains and are exact for every box type.
+ * Intersection and IoU queries use the axis-aligned extents of each box, which
+ * matches BoundingBox::intersects and BoundingBox::computeIoU for AABBs.
+ */
+class BoundingBoxIndex {
+ public:
+  using NodePair = std::pair<NodeId, NodeId>;
+
+  BoundingBoxIndex() = default;
+
+  inline size_t size() const { return leaves_.size(); }
+
+  inline bool contains(NodeId node) const { return leaves_.count(node); }
+
+  /**
+   * @brief Add a bounding box or update the bounding box of a node
+   *
+   * Removes the node from the index if the bounding box is invalid.
+   */
+  void insert(NodeId node, const BoundingBox& bounding_box);
+
+  /**
+   * @brief Remove a node if it exists
+   * @returns true if the node was indexed
+   */
+  bool erase(NodeId node);
+
+  void clear();
+
+  /**
+   * @brief Rebuild a balanced tree over the current boxes
+   */
+  void rebuild();
+
+  /**
+   * @brief Height of the tree (0 if empty, 1 if a single box is indexed)
+   */
+  size_t height() const;
+
+  /**
+   * @brief Nodes whose bounding box contains the point in ascending id order
+   */
+  std::vector<NodeId> containing(const Eigen::Vector3f& point) const;
+
+  std::vector<NodeId> containing(const Eigen::Vector3d& point) const;
+
+  /**
+   * @brief Nodes whose bounding box intersects the query box in ascending id order
+   */
+  std::vector<NodeId> intersecting(const BoundingBox& query) const;
+
+  /**
+   * @brief All pairs of boxes that overlap with an IoU of at least min_iou
+   *
+   * Pairs are ordered (first < second) and returned in ascending order. A min_iou of
+   * zero returns every pair of intersecting boxes.
+   */
+  std::vector<NodePair> overlappingPairs(float min_iou = 0.0f) const;
+
+ private:
+  static constexpr int32_t NULL_NODE = -1;
+
+  struct Volume {
+    Eigen::Vector3f min;
+    Eigen::Vector3f max;
+
+    static Volume fromBox(const BoundingBox& box);
+    Volume merged(const Volume& other) const;
+    float area() const;
+    float volume() const;
+    bool overlaps(const Volume& other) const;
+    bool contains(const Eigen::Vector3f& point) const;
+    float iou(const Volume& other) const;
+  };
+
+  struct TreeNode {
+    Volume volume;
+    int32_t parent = NULL_NODE;
+    int32_t left = NULL_NODE;
+    int32_t right = NULL_NODE;
+    //! node id (only valid for leaves)
+    NodeId id = 0;
+    //! next free entry (only valid for unused entries)
+    int32_t next = NULL_NODE;
+
+    inline bool isLeaf() const { return left == NULL_NODE; }
+  };
+
+  struct Leaf {
+    int32_t index;
+    BoundingBox box;
+  };
+
+  int32_t allocate();
+
+  void release(int32_t index);
+
+  void insertLeaf(int32_t leaf);
+
+  void removeLeaf(int32_t leaf);
+
+  void refit(int32_t index);
+
+  int32_t buildRecursive(std::vector<int32_t>& leaves, size_t begin, size_t end);
+
+  size_t heightRecursive(int32_t index) const;
+
+  template <typename Prune, typename Visitor>
+  void visit(const Prune& prune, const Visitor& visitor) const;
+
+  int32_t root_ = NULL_NODE;
+  int32_t free_list_ = NULL_NODE;
+  std::vector<TreeNode> tree_;
+  std::unordered_map<NodeId, Leaf> leaves_;
+};
+
+}  // namespace spark_dsg
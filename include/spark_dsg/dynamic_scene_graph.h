@@ -53,6 +53,7 @@ class DynamicSceneGraph {
  public:
   //! Desired pointer type of the scene graph
   using Ptr = std::shared_ptr<DynamicSceneGraph>;
+  using ConstPtr = std::shared_ptr<const DynamicSceneGraph>;
   //! container type for the layer ids
   using LayerIds = std::vector<LayerId>;
   //! Edge container
@@ -499,9 +500,10 @@ class DynamicSceneGraph {
 
   /**
    * @brief Clone the scene graph
+   * @param include_mesh Whether to deep-copy the mesh as well
    * @returns Copy of the scene graph
    */
-  DynamicSceneGraph::Ptr clone() const;
+  DynamicSceneGraph::Ptr clone(bool include_mesh = true) const;
 
   /**
    * @brief Save the DSG to file. By default, this will save a binary version of the
@@ -511,6 +513,14 @@ class DynamicSceneGraph {
    */
   void save(std::string filepath, bool include_mesh = true) const;
 
+  /**
+   * @brief Save the DSG to file with a different mesh (e.g., a simplified version of
+   * the graph mesh, see simplifyMesh).
+   * @param filepath Filepath to save graph to.
+   * @param mesh Mesh to save in place of the graph mesh
+   */
+  void save(std::string filepath, const Mesh& mesh) const;
+
   /**
    * @brief parse graph from binary or JSON file
    * @param filepath Complete path to file to read, including extension.
@@ -568,6 +578,18 @@ class DynamicSceneGraph {
 
   Mesh::Ptr mesh() const;
 
+  /**
+   * @brief Nodes of the static layers connected to any of the mesh vertices in
+   * ascending id order (see SceneGraphLayer::meshConnectionIndex)
+   */
+  std::vector<NodeId> getMeshConnectedNodes(const std::vector<size_t>& vertices) const;
+
+  /**
+   * @brief Erase vertices from the mesh and remap the mesh connections of the nodes
+   * in the static layers to match (see MeshConnectionIndex::remapConnections)
+   */
+  void eraseMeshVertices(const std::unordered_set<size_t>& indices);
+
   //! current static layer ids in the graph
   const LayerIds layer_ids;
 
@@ -578,6 +600,8 @@ class DynamicSceneGraph {
 
   SceneGraphNode* getNodePtr(NodeId node, const LayerKey& key) const;
 
+  void refreshIndices(NodeId node, const LayerKey& key) const;
+
   bool hasEdge(NodeId source,
                NodeId target,
                LayerKey* source_key,
@@ -0,0 +1,106 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <map>
+#include <vector>
+
+#include "spark_dsg/scene_graph_layer.h"
+
+namespace spark_dsg {
+
+/**
+ * @brief Assignment of the nodes of a layer to parts along with the part boundaries
+ */
+struct GraphPartition {
+  //! part of every node in the layer
+  std::map<NodeId, size_t> assignments;
+  //! nodes of every part in ascending order
+  std::vector<std::vector<NodeId>> parts;
+  //! nodes of every part with at least one sibling in a different part
+  std::vector<std::vector<NodeId>> boundary;
+  //! nodes outside of every part that are siblings of a node in the part
+  std::vector<std::vector<NodeId>> halo;
+  //! number of edges between nodes in different parts
+  size_t edge_cut = 0;
+
+  inline size_t numParts() const { return parts.size(); }
+
+  /**
+   * @brief Part of a node (throws if the node is not assigned)
+   */
+  size_t part(NodeId node) const;
+
+  /**
+   * @brief Derive the parts, boundaries and halos from an assignment of every node
+   * @param layer Layer that was partitioned
+   * @param assignments Part of every node (nodes outside the layer are ignored)
+   * @param num_parts Number of parts (at least one larger than the largest part index)
+   */
+  static GraphPartition fromAssignments(const SceneGraphLayer& layer,
+                                        const std::map<NodeId, size_t>& assignments,
+                                        size_t num_parts);
+};
+
+struct PartitionConfig {
+  //! number of parts to split the layer into
+  size_t num_parts = 2;
+  //! allowed relative deviation of every part size from the average part size
+  double balance_tolerance = 0.05;
+  //! maximum number of passes moving boundary nodes to reduce the edge cut
+  size_t refinement_passes = 8;
+};
+
+/**
+ * @brief Split a layer into parts of (roughly) equal size using node positions
+ *
+ * The nodes are first split by recursive coordinate bisection: every split divides
+ * the nodes at the (weighted) median along the axis of largest extent, which gives
+ * spatially compact parts that differ in size by at most one node. Boundary nodes are
+ * then moved greedily to the part holding most of their siblings as long as every part
+ * stays within the balance tolerance.
+ */
+GraphPartition partitionLayer(const SceneGraphLayer& layer,
+                              const PartitionConfig& config = {});
+
+/**
+ * @brief Split a layer into one part per parent node
+ *
+ * Parts are ordered by the id of the parent. Nodes without a parent join the part of
+ * the closest node (in hops) with a parent; nodes that cannot reach any node with a
+ * parent form one additional part.
+ */
+GraphPartition partitionByParent(const SceneGraphLayer& layer);
+
+}  // namespace spark_dsg
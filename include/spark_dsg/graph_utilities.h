@@ -33,12 +33,18 @@
  * purposes notwithstanding any copyright notation herein.
  * -------------------------------------------------------------------------- */
 #pragma once
+#include <algorithm>
+#include <atomic>
 #include <deque>
 #include <functional>
+#include <limits>
 #include <list>
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "spark_dsg/node_symbol.h"
+#include "spark_dsg/parallel_blocks.h"
 #include "spark_dsg/scene_graph_types.h"
 
 namespace spark_dsg {
@@ -48,6 +54,126 @@ namespace graph_utilities {
 template <typename Graph>
 struct graph_traits {};
 
+/**
+ * @brief Reusable scratch space for graph traversals
+ *
+ * Nodes are assigned a compact index the first time they are seen. Visited flags are
+ * tracked per index with an epoch counter, so starting a new traversal does not clear
+ * or reallocate anything. The frontier is a ring buffer that only grows. Once every
+ * node of a graph has been indexed, traversals using the workspace do not allocate.
+ */
+class TraversalWorkspace {
+ public:
+  //! Start a new traversal (invalidates visited flags, costs and the frontier)
+  void reset() {
+    head_ = 0;
+    size_ = 0;
+    if (++epoch_ == 0) {
+      std::fill(epochs_.begin(), epochs_.end(), 0);
+      epoch_ = 1;
+    }
+  }
+
+  //! Drop the node index (e.g., after many nodes were removed from the graph)
+  void clear() {
+    index_.clear();
+    epochs_.clear();
+    costs_.clear();
+    reset();
+  }
+
+  //! Number of nodes with an index
+  size_t numIndexed() const { return index_.size(); }
+
+  bool visited(NodeId node) const {
+    const auto iter = index_.find(node);
+    return iter != index_.end() && epochs_[iter->second] == epoch_;
+  }
+
+  /**
+   * @brief Mark a node as visited in the current traversal
+   * @returns False if the node was already visited
+   */
+  bool visit(NodeId node, size_t cost = 0) {
+    const auto [iter, inserted] = index_.emplace(node, epochs_.size());
+    if (inserted) {
+      epochs_.push_back(0);
+      costs_.push_back(0);
+    }
+
+    const size_t index = iter->second;
+    if (epochs_[index] == epoch_) {
+      return false;
+    }
+
+    epochs_[index] = epoch_;
+    costs_[index] = cost;
+    return true;
+  }
+
+  //! Cost (number of hops from the roots) of a visited node
+  size_t cost(NodeId node) const { return costs_[index_.at(node)]; }
+
+  void push(NodeId node) {
+    if (size_ == ring_.size()) {
+      std::vector<NodeId> grown(std::max<size_t>(16, 2 * ring_.size()));
+      for (size_t i = 0; i < size_; ++i) {
+        grown[i] = ring_[(head_ + i) % ring_.size()];
+      }
+
+      ring_.swap(grown);
+      head_ = 0;
+    }
+
+    ring_[(head_ + size_) % ring_.size()] = node;
+    ++size_;
+  }
+
+  NodeId pop() {
+    const NodeId node = ring_[head_];
+    head_ = (head_ + 1) % ring_.size();
+    --size_;
+    return node;
+  }
+
+  bool frontierEmpty() const { return size_ == 0; }
+
+ private:
+  std::unordered_map<NodeId, size_t> index_;
+  std::vector<uint32_t> epochs_;
+  std::vector<size_t> costs_;
+  uint32_t epoch_ = 1;
+
+  std::vector<NodeId> ring_;
+  size_t head_ = 0;
+  size_t size_ = 0;
+};
+
+/**
+ * @brief Expand the frontier of a workspace, visiting nodes at most limit hops away
+ */
+template <typename Graph>
+void expandFrontier(const Graph& graph,
+                    TraversalWorkspace& workspace,
+                    size_t limit,
+                    typename graph_traits<Graph>::visitor callback_function) {
+  while (!workspace.frontierEmpty()) {
+    const NodeId curr_node = workspace.pop();
+    callback_function(graph, curr_node);
+
+    const size_t cost = workspace.cost(curr_node);
+    if (cost >= limit) {
+      continue;
+    }
+
+    for (const auto& neighbor : graph_traits<Graph>::neighbors(graph, curr_node)) {
+      if (workspace.visit(neighbor, cost + 1)) {
+        workspace.push(neighbor);
+      }
+    }
+  }
+}
+
 template <typename Graph, typename NodeSet>
 void breadthFirstSearch(const Graph& graph,
                         std::deque<NodeId>& frontier,
@@ -59,7 +185,7 @@ void breadthFirstSearch(const Graph& graph,
 
     callback_function(graph, curr_node);
 
-    auto neighbors = graph_traits<Graph>::neighbors(graph, curr_node);
+    const auto& neighbors = graph_traits<Graph>::neighbors(graph, curr_node);
     for (const auto& neighbor : neighbors) {
       if (seen.count(neighbor)) {
         continue;
@@ -83,7 +209,7 @@ void breadthFirstSearch(const Graph& graph,
 
     callback_function(graph, curr_node);
 
-    auto neighbors = graph_traits<Graph>::neighbors(graph, curr_node);
+    const auto& neighbors = graph_traits<Graph>::neighbors(graph, curr_node);
     for (const auto& neighbor : neighbors) {
       if (seen.count(neighbor)) {
         continue;
@@ -116,7 +242,7 @@ void breadthFirstSearch(const Graph& graph,
     }
 
     const typename CostMap::mapped_type new_cost = costs[curr_node] + 1;
-    auto neighbors = graph_traits<Graph>::neighbors(graph, curr_node);
+    const auto& neighbors = graph_traits<Graph>::neighbors(graph, curr_node);
     for (const auto& neighbor : neighbors) {
       if (!AllowEqual && costs.count(neighbor) && costs[neighbor] <= new_cost) {
         continue;
@@ -205,6 +331,71 @@ void breadthFirstSearch(const Graph& graph,
   breadthFirstSearch(graph, frontier, limit, costs, callback_function);
 }
 
+template <typename Graph>
+void breadthFirstSearch(const Graph& graph,
+                        NodeId root_node,
+                        size_t limit,
+                        TraversalWorkspace& workspace,
+                        typename graph_traits<Graph>::visitor callback_function) {
+  workspace.reset();
+  if (!graph_traits<Graph>::contains(graph, root_node)) {
+    return;
+  }
+
+  workspace.visit(root_node);
+  workspace.push(root_node);
+  expandFrontier(graph, workspace, limit, callback_function);
+}
+
+template <typename Graph>
+void breadthFirstSearch(const Graph& graph,
+                        NodeId root_node,
+                        TraversalWorkspace& workspace,
+                        typename graph_traits<Graph>::visitor callback_function) {
+  breadthFirstSearch(graph,
+                     root_node,
+                     std::numeric_limits<size_t>::max(),
+                     workspace,
+                     callback_function);
+}
+
+template <typename Graph, typename Nodes>
+void breadthFirstSearch(const Graph& graph,
+                        const Nodes& root_nodes,
+                        size_t limit,
+                        TraversalWorkspace& workspace,
+                        typename graph_traits<Graph>::visitor callback_function) {
+  workspace.reset();
+
+  // like the other multi-root searches, nothing is visited if any root is missing
+  const auto missing = [&](NodeId node) {
+    return !graph_traits<Graph>::contains(graph, node);
+  };
+  if (std::any_of(root_nodes.begin(), root_nodes.end(), missing)) {
+    return;
+  }
+
+  for (const auto root_node : root_nodes) {
+    if (workspace.visit(root_node)) {
+      workspace.push(root_node);
+    }
+  }
+
+  expandFrontier(graph, workspace, limit, callback_function);
+}
+
+template <typename Graph, typename Nodes>
+void breadthFirstSearch(const Graph& graph,
+                        const Nodes& root_nodes,
+                        TraversalWorkspace& workspace,
+                        typename graph_traits<Graph>::visitor callback_function) {
+  breadthFirstSearch(graph,
+                     root_nodes,
+                     std::numeric_limits<size_t>::max(),
+                     workspace,
+                     callback_function);
+}
+
 template <typename Graph, typename NodeSet = std::unordered_set<NodeId>>
 std::vector<std::vector<NodeId>> getConnectedComponents(const Graph& graph,
                                                         const NodeSet& root_nodes,
@@ -240,44 +431,150 @@ std::vector<std::vector<NodeId>> getConnectedComponents(const Graph& graph,
   return components;
 }
 
+template <typename Graph, typename NodeSet>
+std::vector<std::vector<NodeId>> getConnectedComponents(const Graph& graph,
+                                                        const NodeSet& root_nodes,
+                                                        TraversalWorkspace& workspace,
+                                                        bool only_root_nodes = false) {
+  std::vector<std::vector<NodeId>> components;
+
+  workspace.reset();
+  for (const auto& node : root_nodes) {
+    if (!graph_traits<Graph>::contains(graph, node)) {
+      continue;
+    }
+
+    if (!workspace.visit(node)) {
+      continue;
+    }
+
+    std::vector<NodeId> component;
+    workspace.push(node);
+    while (!workspace.frontierEmpty()) {
+      const NodeId curr_node = workspace.pop();
+      component.push_back(curr_node);
+      for (const auto& neighbor : graph_traits<Graph>::neighbors(graph, curr_node)) {
+        if (only_root_nodes && !root_nodes.count(neighbor)) {
+          continue;
+        }
+
+        if (workspace.visit(neighbor)) {
+          workspace.push(neighbor);
+        }
+      }
+    }
+
+    components.push_back(std::move(component));
+  }
+
+  return components;
+}
+
 using Components = std::vector<std::vector<NodeId>>;
 
+/**
+ * @brief Disjoint-set forest over the indices [0, size)
+ *
+ * Uses union by rank and path compression, so any sequence of operations runs in
+ * near-linear time.
+ */
+class DisjointSet {
+ public:
+  explicit DisjointSet(size_t size = 0) { reset(size); }
+
+  void reset(size_t size) {
+    parents_.resize(size);
+    ranks_.assign(size, 0);
+    for (size_t i = 0; i < size; ++i) {
+      parents_[i] = i;
+    }
+  }
+
+  size_t size() const { return parents_.size(); }
+
+  size_t findSet(size_t index) {
+    size_t root = index;
+    while (parents_[root] != root) {
+      root = parents_[root];
+    }
+
+    while (parents_[index] != root) {
+      const size_t next = parents_[index];
+      parents_[index] = root;
+      index = next;
+    }
+
+    return root;
+  }
+
+  /**
+   * @brief Merge the sets containing both indices
+   * @returns False if the indices were already in the same set
+   */
+  bool unionSets(size_t lhs, size_t rhs) {
+    lhs = findSet(lhs);
+    rhs = findSet(rhs);
+    if (lhs == rhs) {
+      return false;
+    }
+
+    if (ranks_[lhs] < ranks_[rhs]) {
+      std::swap(lhs, rhs);
+    }
+
+    parents_[rhs] = lhs;
+    if (ranks_[lhs] == ranks_[rhs]) {
+      ++ranks_[lhs];
+    }
+
+    return true;
+  }
+
+ private:
+  std::vector<size_t> parents_;
+  std::vector<uint8_t> ranks_;
+};
+
+/**
+ * @brief Merge node sets that share at least one node (transitively)
+ *
+ * Merged components are ordered by the index of the first set they contain and list
+ * every node once, in order of first appearance.
+ */
 template <typename NodeSet>
 Components getMergedComponents(const std::vector<NodeSet>& unmerged_components) {
   Components components;
-
   if (unmerged_components.empty()) {
     return components;
   }
 
-  std::unordered_set<size_t> added_components;
+  // sets are merged whenever a node was already claimed by another set
+  DisjointSet sets(unmerged_components.size());
+  std::unordered_map<NodeId, size_t> node_sets;
   for (size_t i = 0; i < unmerged_components.size(); ++i) {
-    if (added_components.count(i)) {
-      continue;
-    }
-
-    NodeSet curr_component = unmerged_components.at(i);
-
-    for (size_t j = i + 1; j < unmerged_components.size(); ++j) {
-      if (added_components.count(j)) {
-        continue;
+    for (const auto node : unmerged_components[i]) {
+      const auto [iter, inserted] = node_sets.emplace(node, i);
+      if (!inserted) {
+        sets.unionSets(iter->second, i);
       }
+    }
+  }
 
-      for (const auto node : unmerged_components[j]) {
-        if (curr_component.count(node)) {
-          added_components.insert(j);
+  std::vector<size_t> component_indices(unmerged_components.size(), 0);
+  for (size_t i = 0; i < unmerged_components.size(); ++i) {
+    // roots are not necessarily the first set of their group
+    const size_t root = sets.findSet(i);
+    if (!component_indices[root]) {
+      components.emplace_back();
+      component_indices[root] = components.size();
+    }
 
-          curr_component.insert(unmerged_components.at(j).begin(),
-                                unmerged_components.at(j).end());
-          break;
-        }
+    auto& component = components[component_indices[root] - 1];
+    for (const auto node : unmerged_components[i]) {
+      if (node_sets.at(node) == i) {
+        component.push_back(node);
       }
     }
-
-    added_components.insert(i);
-
-    std::vector<NodeId> new_component_vec(curr_component.begin(), curr_component.end());
-    components.push_back(new_component_vec);
   }
 
   return components;
@@ -333,7 +630,7 @@ void breadthFirstSearch(
 
     callback_function(graph, curr_id);
 
-    auto neighbors = graph_traits<Graph>::neighbors(graph, curr_id);
+    const auto& neighbors = graph_traits<Graph>::neighbors(graph, curr_id);
     for (const auto& neighbor : neighbors) {
       if (seen.count(neighbor)) {
         continue;
@@ -391,5 +688,172 @@ std::vector<std::vector<NodeId>> getConnectedComponents(
   return components;
 }
 
+template <typename Graph>
+std::vector<std::vector<NodeId>> getConnectedComponents(
+    const Graph& graph,
+    const typename graph_traits<Graph>::node_valid_func& node_valid,
+    const typename graph_traits<Graph>::edge_valid_func& edge_valid,
+    TraversalWorkspace& workspace) {
+  std::vector<std::vector<NodeId>> components;
+
+  workspace.reset();
+  for (const auto& node_container : graph_traits<Graph>::nodes(graph)) {
+    const auto& node = graph_traits<Graph>::unwrap_node(node_container);
+    const NodeId node_id = graph_traits<Graph>::unwrap_node_id(node_container);
+    if (workspace.visited(node_id) || !node_valid(node)) {
+      continue;
+    }
+
+    std::vector<NodeId> component;
+    workspace.visit(node_id);
+    workspace.push(node_id);
+    while (!workspace.frontierEmpty()) {
+      const NodeId curr_id = workspace.pop();
+      component.push_back(curr_id);
+      for (const auto& neighbor : graph_traits<Graph>::neighbors(graph, curr_id)) {
+        if (workspace.visited(neighbor)) {
+          continue;
+        }
+
+        const auto& neighbor_node = graph_traits<Graph>::get_node(graph, neighbor);
+        if (!node_valid(neighbor_node)) {
+          workspace.visit(neighbor);  // save some computation
+          continue;
+        }
+
+        const auto& edge = graph_traits<Graph>::get_edge(graph, curr_id, neighbor);
+        if (!edge_valid(edge)) {
+          continue;
+        }
+
+        workspace.visit(neighbor);
+        workspace.push(neighbor);
+      }
+    }
+
+    components.push_back(std::move(component));
+  }
+
+  return components;
+}
+
+/**
+ * @brief Compute connected components with multiple threads
+ *
+ * Produces the same components as the serial filtered overload, using a lock-free
+ * union-find over the valid edges. The result is deterministic: components are
+ * ordered by their minimum node id and nodes within a component are sorted.
+ * Both filters may be called concurrently and must be thread-safe.
+ *
+ * @param num_threads Number of worker threads (0 uses the hardware concurrency)
+ */
+template <typename Graph>
+std::vector<std::vector<NodeId>> getConnectedComponentsParallel(
+    const Graph& graph,
+    const typename graph_traits<Graph>::node_valid_func& node_valid,
+    const typename graph_traits<Graph>::edge_valid_func& edge_valid,
+    size_t num_threads = 0) {
+  std::vector<NodeId> node_ids;
+  for (const auto& node_container : graph_traits<Graph>::nodes(graph)) {
+    node_ids.push_back(graph_traits<Graph>::unwrap_node_id(node_container));
+  }
+
+  // roots are always linked to the smaller index, so each root is the minimum id
+  std::sort(node_ids.begin(), node_ids.end());
+  const size_t num_nodes = node_ids.size();
+  std::vector<uint8_t> valid(num_nodes, 0);
+  std::vector<std::atomic<size_t>> parents(num_nodes);
+  for (size_t i = 0; i < num_nodes; ++i) {
+    parents[i].store(i, std::memory_order_relaxed);
+  }
+
+  const auto index_of = [&](NodeId node) {
+    return std::lower_bound(node_ids.begin(), node_ids.end(), node) - node_ids.begin();
+  };
+
+  const auto find_set = [&](size_t index) {
+    size_t parent = parents[index].load(std::memory_order_relaxed);
+    while (parent != index) {
+      // path halving (losing the race only skips the shortcut)
+      const size_t grandparent = parents[parent].load(std::memory_order_relaxed);
+      parents[index].compare_exchange_weak(parent, grandparent);
+      index = parent;
+      parent = parents[index].load(std::memory_order_relaxed);
+    }
+
+    return index;
+  };
+
+  const auto union_sets = [&](size_t lhs, size_t rhs) {
+    while (true) {
+      lhs = find_set(lhs);
+      rhs = find_set(rhs);
+      if (lhs == rhs) {
+        return;
+      }
+
+      if (lhs < rhs) {
+        std::swap(lhs, rhs);
+      }
+
+      size_t expected = lhs;
+      if (parents[lhs].compare_exchange_strong(expected, rhs)) {
+        return;
+      }
+    }
+  };
+
+  // threads claim fixed-size blocks of nodes until none are left
+  constexpr size_t block_size = 1024;
+  const auto run_blocks = [&](const auto& process_node) {
+    detail::parallelFor(num_nodes, block_size, num_threads, process_node);
+  };
+
+  run_blocks([&](size_t i) {
+    valid[i] = node_valid(graph_traits<Graph>::get_node(graph, node_ids[i]));
+  });
+
+  run_blocks([&](size_t i) {
+    if (!valid[i]) {
+      return;
+    }
+
+    const NodeId source = node_ids[i];
+    for (const auto& target : graph_traits<Graph>::neighbors(graph, source)) {
+      // each edge is only processed from the endpoint with the smaller id
+      if (target < source) {
+        continue;
+      }
+
+      const size_t j = index_of(target);
+      if (j == num_nodes || node_ids[j] != target || !valid[j]) {
+        continue;
+      }
+
+      if (edge_valid(graph_traits<Graph>::get_edge(graph, source, target))) {
+        union_sets(i, j);
+      }
+    }
+  });
+
+  std::vector<std::vector<NodeId>> components;
+  std::vector<size_t> component_indices(num_nodes, 0);
+  for (size_t i = 0; i < num_nodes; ++i) {
+    if (!valid[i]) {
+      continue;
+    }
+
+    const size_t root = find_set(i);
+    if (root == i) {
+      components.emplace_back();
+      component_indices[i] = components.size() - 1;
+    }
+
+    components[component_indices[root]].push_back(node_ids[i]);
+  }
+
+  return components;
+}
+
 }  // namespace graph_utilities
 }  // namespace spark_dsg
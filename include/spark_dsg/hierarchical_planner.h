@@ -0,0 +1,108 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <memory>
+#include <vector>
+
+#include "spark_dsg/dynamic_scene_graph.h"
+
+namespace spark_dsg {
+
+/**
+ * @brief Shortest paths between places that use the room layer to limit the search
+ *
+ * Queries first find a route through the rooms (using the room positions) and then
+ * search for a path through the places of the rooms along that route. Rooms are
+ * adjacent if one of their places has a sibling in the other room. These "portal"
+ * places are cached per room and recomputed for rooms touched by graph changes.
+ * Paths are not guaranteed to be optimal; queries fall back to a search over all
+ * places if no path exists within the rooms along the route.
+ */
+class HierarchicalPlanner {
+ public:
+  /**
+   * @brief Construct a planner for a graph
+   * @param graph Graph to plan over (has to outlive the planner)
+   * @param place_layer Layer to plan paths in
+   * @param room_layer Parent layer of the places
+   */
+  explicit HierarchicalPlanner(const DynamicSceneGraph& graph,
+                               LayerId place_layer = DsgLayers::PLACES,
+                               LayerId room_layer = DsgLayers::ROOMS);
+
+  ~HierarchicalPlanner();
+
+  /**
+   * @brief Find a path between two places
+   * @param source Place to start from
+   * @param target Place to reach
+   * @param path Places along the path (including source and target)
+   * @returns Cost of the path (infinity if no path exists)
+   */
+  double findPath(NodeId source, NodeId target, std::vector<NodeId>& path);
+
+  //! Rooms traversed by the last query (empty if the room layer was not used)
+  const std::vector<NodeId>& roomPath() const;
+
+  //! Places in the room with siblings in other rooms
+  const std::vector<NodeId>& getPortals(NodeId room);
+
+  /**
+   * @brief Invalidate the cached portals of rooms affected by changes
+   * @param nodes Added or removed places or rooms
+   * @param edges Added or removed edges (including parent edges)
+   */
+  void invalidate(const std::vector<NodeId>& nodes, const std::vector<EdgeKey>& edges);
+
+  /**
+   * @brief Invalidate rooms using the new and removed node and edge tracking
+   *
+   * Tracking is only cleared if requested. Otherwise, the same changes are reported
+   * (and invalidate the same rooms) until the tracking is cleared elsewhere.
+   *
+   * @param graph Graph the planner was constructed with
+   * @param clear_tracking Clear new and removed nodes and edges of the graph
+   */
+  void update(DynamicSceneGraph& graph, bool clear_tracking = false);
+
+  //! Drop all cached portals
+  void reset();
+
+ private:
+  struct Detail;
+  std::unique_ptr<Detail> internals_;
+};
+
+}  // namespace spark_dsg
@@ -37,14 +37,91 @@
 #include <Eigen/Dense>
 #include <array>
 #include <cstdint>
+#include <map>
 #include <memory>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "spark_dsg/color.h"
 
 namespace spark_dsg {
 
+/**
+ * @brief Set of sorted, disjoint half-open index ranges [start, end)
+ *
+ * Overlapping or adjacent ranges are merged on insertion.
+ */
+class IndexRanges {
+ public:
+  using Range = std::pair<size_t, size_t>;
+
+  /**
+   * @brief Add the range [start, end) (empty ranges are ignored)
+   */
+  void add(size_t start, size_t end);
+
+  /**
+   * @brief Drop all indices greater than or equal to size
+   */
+  void truncate(size_t size);
+
+  void clear();
+
+  bool empty() const;
+
+  bool contains(size_t index) const;
+
+  /**
+   * @brief Get the total number of indices covered by the ranges
+   */
+  size_t count() const;
+
+  /**
+   * @brief Get the ranges in ascending order
+   */
+  std::vector<Range> ranges() const;
+
+  bool operator==(const IndexRanges& other) const;
+
+ private:
+  //! map from start to end of each range
+  std::map<size_t, size_t> ranges_;
+};
+
+/**
+ * @brief Changes to a mesh recorded for a single consumer (see Mesh::trackChanges)
+ */
+class MeshChangeTracker {
+ public:
+  /**
+   * @brief Check whether the mesh was modified since the changes were last cleared
+   */
+  bool hasChanges() const { return has_changes_; }
+
+  /**
+   * @brief Get the vertices that changed since the changes were last cleared
+   */
+  const IndexRanges& changedVertices() const { return changed_vertices_; }
+
+  /**
+   * @brief Get the faces that changed since the changes were last cleared
+   */
+  const IndexRanges& changedFaces() const { return changed_faces_; }
+
+  /**
+   * @brief Forget the recorded changes
+   */
+  void clearChanges();
+
+ private:
+  friend class Mesh;
+
+  bool has_changes_ = false;
+  IndexRanges changed_vertices_;
+  IndexRanges changed_faces_;
+};
+
 class Mesh {
  public:
   using Ptr = std::shared_ptr<Mesh>;
@@ -169,6 +246,9 @@ class Mesh {
 
   /**
    * @brief Get a face (non-const)
+   *
+   * Modifications through the returned reference are not tracked (see
+   * markFacesChanged)
    */
   Face& face(size_t index);
 
@@ -199,6 +279,27 @@ class Mesh {
    */
   static Ptr deserializeFromBinary(const uint8_t* const buffer, size_t length);
 
+  /**
+   * @brief Save mesh to a compact, lossy binary representation
+   *
+   * Positions are quantized to a grid with the given resolution, so that each
+   * coordinate is off by at most half of the resolution after decoding. Positions,
+   * timestamps, labels and face indices are delta-encoded (relative to the previous
+   * vertex or index) as variable-length integers; colors are stored as-is.
+   *
+   * @param buffer Buffer to serialize to
+   * @param resolution Position quantization step [m]
+   */
+  void serializeToCompressedBinary(std::vector<uint8_t>& buffer,
+                                   float resolution = 0.001f) const;
+
+  /**
+   * @brief parse mesh from data written by serializeToCompressedBinary
+   * @throws std::runtime_error if the data is not a valid compressed mesh
+   */
+  static Ptr deserializeFromCompressedBinary(const uint8_t* const buffer,
+                                             size_t length);
+
   /**
    * @brief Save the mesh to file.
    *
@@ -236,12 +337,209 @@ class Mesh {
   void eraseFaces(const std::unordered_set<size_t>& indices,
                   const bool update_vertices = true);
 
+  /**
+   * @brief Erase every vertex that is set in the mask. Vertex attributes and faces are
+   * compacted in place with a single pass each; faces that reference an erased vertex
+   * are removed.
+   * @param erase_mask Flag per vertex (vertices past the end of the mask are kept).
+   */
+  void eraseVerticesByMask(const std::vector<bool>& erase_mask);
+
+  /**
+   * @brief Erase the vertices with the given indices (in ascending order).
+   */
+  void eraseVerticesSorted(const std::vector<size_t>& sorted_indices);
+
+  /**
+   * @brief Erase every face that is set in the mask, compacting the faces in place. If
+   * update_vertices is true, vertices that are no longer referenced by any face are
+   * also removed.
+   * @param erase_mask Flag per face (faces past the end of the mask are kept).
+   * @param update_vertices Whether to remove vertices that are no longer referenced by
+   * any faces.
+   */
+  void eraseFacesByMask(const std::vector<bool>& erase_mask,
+                        const bool update_vertices = true);
+
+  /**
+   * @brief Erase the faces with the given indices (in ascending order).
+   */
+  void eraseFacesSorted(const std::vector<size_t>& sorted_indices,
+                        const bool update_vertices = true);
+
+  /**
+   * @brief Erase the vertices in [start, end) (see eraseVerticesByMask)
+   */
+  void eraseVertexRange(size_t start, size_t end);
+
+  /**
+   * @brief Erase the faces in [start, end) (see eraseFacesByMask)
+   */
+  void eraseFaceRange(size_t start, size_t end, const bool update_vertices = true);
+
+  /**
+   * @brief Add default-initialized vertices to the end of the mesh
+   * @returns Index of the first new vertex
+   */
+  size_t appendVertices(size_t count);
+
+  /**
+   * @brief Add faces to the end of the mesh (indices are used as-is)
+   * @returns Index of the first new face
+   */
+  size_t appendFaces(const Faces& new_faces);
+
+  /**
+   * @brief Add the vertices and faces of another mesh to the end of this mesh
+   *
+   * Faces of the other mesh are offset to refer to the appended vertices and
+   * attributes that only one of the meshes has are default-initialized or dropped.
+   *
+   * @returns Index of the first appended vertex
+   */
+  size_t append(const Mesh& other);
+
+  /**
+   * @brief Overwrite the vertices starting at start with the vertices of another mesh
+   * @throws std::out_of_range if the vertices of other do not fit in this mesh
+   */
+  void updateVertices(size_t start, const Mesh& other);
+
+  /**
+   * @brief Overwrite the faces starting at start with the given faces
+   * @throws std::out_of_range if the faces do not fit in this mesh
+   */
+  void updateFaces(size_t start, const Faces& new_faces);
+
+  // ------ Change tracking ------
+  // Every modification made through the methods of the mesh increments the version and
+  // records the vertex and face ranges it touched. Code that writes to the public
+  // fields directly has to call markVerticesChanged or markFacesChanged itself.
+
+  /**
+   * @brief Get the number of modifications made to the mesh
+   */
+  uint64_t version() const;
+
+  /**
+   * @brief Get the version of the mesh when the changes were last cleared
+   */
+  uint64_t baseVersion() const;
+
+  /**
+   * @brief Get the random id identifying the history that the versions belong to
+   *
+   * Every newly constructed mesh starts a new stream (copies keep the id of their
+   * source). Receivers take on the id of the sender when applying full changes.
+   */
+  uint64_t streamId() const;
+
+  /**
+   * @brief Check whether the mesh was modified since the changes were last cleared
+   */
+  bool hasChanges() const;
+
+  /**
+   * @brief Get the vertices that changed since the changes were last cleared
+   */
+  const IndexRanges& changedVertices() const;
+
+  /**
+   * @brief Get the faces that changed since the changes were last cleared
+   */
+  const IndexRanges& changedFaces() const;
+
+  /**
+   * @brief Record that the vertices in [start, end) changed
+   */
+  void markVerticesChanged(size_t start, size_t end);
+
+  /**
+   * @brief Record that the faces in [start, end) changed
+   */
+  void markFacesChanged(size_t start, size_t end);
+
+  /**
+   * @brief Forget the recorded changes (the current version becomes the base version)
+   */
+  void clearChanges();
+
+  /**
+   * @brief Record the changes to the mesh for an additional consumer
+   *
+   * The tracker records every change made after its creation independently of
+   * clearChanges and of other trackers (e.g., so that the mesh can be simplified
+   * while a sender clears the changes after every message) for as long as it is
+   * alive. Trackers are not copied along with the mesh. Not thread-safe.
+   */
+  std::shared_ptr<MeshChangeTracker> trackChanges() const;
+
+  /**
+   * @brief Serialize the vertices and faces that changed since the base version
+   *
+   * The result also contains the current number of vertices and faces, so that
+   * removals are applied as well. A receiver takes on the current version, so the
+   * changes have to be cleared after every message that is sent (see
+   * takeChangesToBinary): otherwise the next partial message still starts from the
+   * old base version and is rejected. This makes the sender the only code that may
+   * clear the changes of the mesh.
+   *
+   * @param buffer Buffer to serialize to
+   * @param full Serialize every vertex and face instead of only the changed ones
+   */
+  void serializeChangesToBinary(std::vector<uint8_t>& buffer, bool full = false) const;
+
+  /**
+   * @brief Serialize the changes (see serializeChangesToBinary) and clear them so
+   * that the next message continues from this one
+   */
+  void takeChangesToBinary(std::vector<uint8_t>& buffer, bool full = false);
+
+  /**
+   * @brief Apply changes serialized by serializeChangesToBinary
+   *
+   * Partial changes can only be applied to a mesh from the same stream that is at
+   * their base version (i.e., that has received every previous change); full changes
+   * can always be applied. The mesh takes on the version of the sender on success.
+   * Malformed changes are rejected before the mesh is modified.
+   *
+   * @returns false if the changes do not apply to this mesh
+   */
+  bool applyChangesFromBinary(const uint8_t* const buffer, size_t length);
+
+  // ------ Geometry ------
+  // These operate on all vertices at once (treating the positions as a 3xN matrix so
+  // that Eigen can vectorize them) and split large meshes across multiple threads.
+
   /**
    * @brief Transform the mesh coordinates by the given transformation.
    * @param transform The transformation to in homogeneous coordinates.
    */
   void transform(const Eigen::Isometry3f& transform);
 
+  /**
+   * @brief Get the axis-aligned bounds of the vertices (empty if there are none).
+   */
+  Eigen::AlignedBox3f bounds() const;
+
+  /**
+   * @brief Get the mean vertex position (zero if there are no vertices).
+   */
+  Pos centroid() const;
+
+  /**
+   * @brief Count the vertices with each label (empty if the mesh has no labels).
+   */
+  std::map<Label, size_t> labelHistogram() const;
+
+  /**
+   * @brief Get the indices of all vertices with a timestamp in [start, end].
+   * @param use_first_seen Use the first seen timestamps instead of the last seen ones.
+   */
+  std::vector<size_t> verticesInTimeRange(Timestamp start,
+                                          Timestamp end,
+                                          bool use_first_seen = false) const;
+
  public:
   const bool has_colors;
   const bool has_timestamps;
@@ -253,6 +551,32 @@ class Mesh {
   Timestamps first_seen_stamps;
   Labels labels;
   Faces faces;
+
+ private:
+  uint64_t stream_id_;
+  uint64_t version_ = 0;
+  uint64_t base_version_ = 0;
+  IndexRanges changed_vertices_;
+  IndexRanges changed_faces_;
+
+  //! consumers of the changes (not transferred by copies or moves)
+  struct Trackers {
+    Trackers() = default;
+    Trackers(const Trackers&) {}
+    Trackers& operator=(const Trackers&) { return *this; }
+
+    std::vector<std::weak_ptr<MeshChangeTracker>> trackers;
+  };
+
+  mutable Trackers trackers_;
+
+  //! drop changes at or after the new number of vertices or faces
+  void truncateChangedVertices(size_t size);
+  void truncateChangedFaces(size_t size);
+  //! record that the whole mesh changed for the trackers (e.g., after assignment)
+  void markAllChangedForTrackers();
+  template <typename Update>
+  void updateTrackers(const Update& update) const;
 };
 
 bool operator==(const Mesh& lhs, const Mesh& rhs);
@@ -0,0 +1,151 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "spark_dsg/scene_graph_types.h"
+
+namespace spark_dsg {
+
+struct NodeAttributes;
+
+/**
+ * @brief Reverse index from mesh vertices to the nodes connected to them
+ *
+ * Node attributes store the mesh vertices they are connected to (see
+ * getConnections); this index answers the opposite query. Nodes are stored in
+ * compressed sparse rows over the vertex ids (the nodes connected to vertex v are
+ * nodes_[offsets_[v], offsets_[v + 1]) in ascending order). Inserting or removing a
+ * node only updates the per-node connections; the rows are rebuilt in O(vertices +
+ * connections) by the next query or by compact(). Const queries may run
+ * concurrently with each other (the rebuild is guarded by a mutex) but not with
+ * insert or erase.
+ */
+class MeshConnectionIndex {
+ public:
+  MeshConnectionIndex() = default;
+
+  inline size_t size() const { return connections_.size(); }
+
+  inline bool contains(NodeId node) const { return connections_.count(node); }
+
+  /**
+   * @brief One past the largest connected vertex
+   */
+  size_t numVertices() const;
+
+  /**
+   * @brief Set the vertices connected to a node (removes the node if empty)
+   */
+  void insert(NodeId node, std::vector<size_t> vertices);
+
+  /**
+   * @brief Remove a node if it exists
+   * @returns true if the node was indexed
+   */
+  bool erase(NodeId node);
+
+  void clear();
+
+  /**
+   * @brief Rebuild the rows of the index if any node changed since the last query
+   */
+  void compact() const;
+
+  /**
+   * @brief Sorted (unique) vertices connected to a node (throws if not indexed)
+   */
+  const std::vector<size_t>& connections(NodeId node) const;
+
+  /**
+   * @brief Nodes connected to the vertex in ascending id order
+   */
+  std::vector<NodeId> nodes(size_t vertex) const;
+
+  /**
+   * @brief Nodes connected to any of the vertices in ascending id order
+   */
+  std::vector<NodeId> nodes(const std::vector<size_t>& vertices) const;
+
+  std::vector<NodeId> nodes(const std::unordered_set<size_t>& vertices) const;
+
+  /**
+   * @brief Nodes connected to any vertex in [start, end) in ascending id order
+   */
+  std::vector<NodeId> nodesInRange(size_t start, size_t end) const;
+
+  /**
+   * @brief Nodes connected to each of the vertices (in the same order)
+   */
+  std::vector<std::vector<NodeId>> nodesPerVertex(
+      const std::vector<size_t>& vertices) const;
+
+  /**
+   * @brief Mesh vertices referenced by the attributes
+   *
+   * Collects the object mesh connections and the place mesh, deformation and
+   * boundary connections.
+   */
+  static std::vector<size_t> getConnections(const NodeAttributes& attrs);
+
+  /**
+   * @brief Update the connections stored in the attributes after erasing vertices
+   *
+   * Connections to erased vertices are dropped (along with the labels or boundary
+   * points stored alongside them) and the remaining connections are shifted to
+   * match a mesh compacted in order (see Mesh::eraseVertices).
+   *
+   * @param attrs Attributes to update
+   * @param sorted_erased Erased vertices in ascending order
+   * @returns true if any connection changed
+   */
+  static bool remapConnections(NodeAttributes& attrs,
+                               const std::vector<size_t>& sorted_erased);
+
+ private:
+  template <typename Visitor>
+  void visitRange(size_t start, size_t end, const Visitor& visitor) const;
+
+  std::unordered_map<NodeId, std::vector<size_t>> connections_;
+  mutable std::mutex mutex_;
+  mutable bool dirty_ = false;
+  mutable std::vector<size_t> offsets_;
+  mutable std::vector<NodeId> nodes_;
+};
+
+}  // namespace spark_dsg
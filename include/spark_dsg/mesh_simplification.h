@@ -0,0 +1,195 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <Eigen/Dense>
+#include <array>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "spark_dsg/mesh.h"
+
+namespace spark_dsg {
+
+/**
+ * @brief Simplify a mesh by clustering its vertices on a voxel grid
+ *
+ * Every occupied voxel becomes a single vertex with the mean position and color of
+ * the vertices inside it, their most common label, latest timestamp and earliest
+ * first seen timestamp. Faces are mapped to the voxels of their vertices; faces that
+ * collapse (two or more vertices in the same voxel) and duplicate faces are removed.
+ * Vertices are ordered by the first mesh vertex in their voxel and faces by the first
+ * mesh face that maps to them. Vertices without a finite position (and the faces
+ * using them) are left out.
+ */
+Mesh::Ptr simplifyMesh(const Mesh& mesh, float voxel_size);
+
+/**
+ * @brief Incrementally maintained simplification (see simplifyMesh) of a single mesh
+ *
+ * Updates only revisit the voxels that changed and the faces that changed or touch a
+ * vertex that moved to another voxel since the previous update. The changes are
+ * recorded by a tracker of the mesh (see Mesh::trackChanges), so other code may clear
+ * the changes of the mesh between updates. The simplified mesh is patched in place:
+ * vertices and faces keep their index until they are removed (when the last vertex or
+ * face is moved into their place), and the changes of the simplified mesh describe
+ * the last update.
+ *
+ * The simplification is recomputed from scratch for a different mesh (i.e., another
+ * mesh object or stream id).
+ */
+class MeshSimplifier {
+ public:
+  explicit MeshSimplifier(float voxel_size);
+
+  //! copies would share the change tracker of the mesh
+  MeshSimplifier(const MeshSimplifier& other) = delete;
+  MeshSimplifier(MeshSimplifier&& other) = default;
+  MeshSimplifier& operator=(const MeshSimplifier& other) = delete;
+  MeshSimplifier& operator=(MeshSimplifier&& other) = default;
+
+  inline float voxelSize() const { return voxel_size_; }
+
+  /**
+   * @brief Update the simplified mesh from the changes to the mesh
+   */
+  const Mesh& update(const Mesh& mesh);
+
+  /**
+   * @brief Get the simplified mesh as of the last update
+   */
+  const Mesh& simplified() const { return simplified_; }
+
+  /**
+   * @brief Forget all state (the next update starts from scratch)
+   */
+  void reset();
+
+ private:
+  using Cell = Eigen::Vector3i;
+  using FaceKey = std::array<Cell, 3>;
+
+  struct CellHash {
+    size_t operator()(const Cell& cell) const;
+  };
+
+  struct FaceKeyHash {
+    size_t operator()(const FaceKey& key) const;
+  };
+
+  struct FaceKeyEqual {
+    bool operator()(const FaceKey& lhs, const FaceKey& rhs) const;
+  };
+
+  struct Cluster {
+    std::vector<size_t> vertices;
+    //! index of the vertex of the cluster in the simplified mesh
+    size_t output = 0;
+    bool has_output = false;
+  };
+
+  struct FaceEntry {
+    //! number of mesh faces mapping to the same voxels
+    size_t count = 0;
+    //! index of the face in the simplified mesh
+    size_t output = 0;
+  };
+
+  //! voxel of a position (INVALID_CELL if the position is not finite)
+  Cell getCell(const Mesh::Pos& pos) const;
+
+  //! voxels of a face with the current vertex assignment (false if it collapses)
+  bool getFaceKey(const Mesh::Face& face, FaceKey& key) const;
+
+  void addVertex(size_t index, const Cell& cell);
+
+  void removeVertex(size_t index);
+
+  void addFace(size_t index);
+
+  void removeFace(size_t index);
+
+  void updateCluster(const Mesh& mesh, const Cell& cell);
+
+  void removeOutputVertex(size_t index);
+
+  float voxel_size_;
+  //! mesh the simplification was computed for and its changes since the last update
+  const Mesh* mesh_ = nullptr;
+  uint64_t stream_id_ = 0;
+  std::shared_ptr<MeshChangeTracker> tracker_;
+  //! voxel and position in the voxel's vertex list of every mesh vertex
+  std::vector<Cell> vertex_cells_;
+  std::vector<size_t> vertex_slots_;
+  //! mesh faces as of the last update and the faces using each vertex
+  Mesh::Faces faces_;
+  std::vector<std::vector<size_t>> vertex_faces_;
+  //! faces that refer to vertices that do not exist (yet)
+  std::unordered_set<size_t> dangling_faces_;
+  std::unordered_map<Cell, Cluster, CellHash> clusters_;
+  std::unordered_map<FaceKey, FaceEntry, FaceKeyHash, FaceKeyEqual> face_entries_;
+  //! voxel of every vertex and voxels of every face of the simplified mesh
+  std::vector<Cell> output_cells_;
+  std::vector<FaceKey> output_faces_;
+  Mesh simplified_;
+};
+
+/**
+ * @brief Incrementally maintained simplifications of a mesh at several resolutions
+ */
+class MeshLevelsOfDetail {
+ public:
+  /**
+   * @param voxel_sizes Voxel size of every level (e.g., increasing from fine to coarse)
+   */
+  explicit MeshLevelsOfDetail(const std::vector<float>& voxel_sizes);
+
+  void update(const Mesh& mesh);
+
+  inline size_t numLevels() const { return levels_.size(); }
+
+  /**
+   * @brief Get a simplified mesh (throws std::out_of_range for invalid levels)
+   */
+  const Mesh& level(size_t index) const;
+
+  float voxelSize(size_t index) const;
+
+ private:
+  std::vector<MeshSimplifier> levels_;
+};
+
+}  // namespace spark_dsg
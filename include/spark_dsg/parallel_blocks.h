@@ -0,0 +1,107 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace spark_dsg {
+namespace detail {
+
+/**
+ * @brief Resolve a requested number of threads (0 uses the hardware concurrency)
+ */
+inline size_t resolveNumThreads(size_t num_threads) {
+  return num_threads == 0 ? std::max(1u, std::thread::hardware_concurrency())
+                          : num_threads;
+}
+
+/**
+ * @brief Split [0, num_items) into blocks that threads claim until none are left
+ *
+ * The calling thread always participates, and no more threads are spawned than
+ * there are blocks to claim.
+ *
+ * @param num_items Number of items to process
+ * @param block_size Number of items claimed by a thread at a time
+ * @param num_threads Maximum number of threads (0 uses the hardware concurrency)
+ * @param func Callback taking the half-open range [start, end) of a block
+ */
+template <typename Func>
+void parallelForBlocks(size_t num_items,
+                       size_t block_size,
+                       size_t num_threads,
+                       const Func& func) {
+  block_size = std::max<size_t>(block_size, 1);
+  std::atomic<size_t> next_block(0);
+  const auto worker = [&]() {
+    size_t start;
+    while ((start = next_block.fetch_add(block_size)) < num_items) {
+      func(start, std::min(start + block_size, num_items));
+    }
+  };
+
+  const size_t num_blocks = (num_items + block_size - 1) / block_size;
+  const size_t num_workers = std::min(resolveNumThreads(num_threads), num_blocks);
+  std::vector<std::thread> workers;
+  for (size_t i = 1; i < num_workers; ++i) {
+    workers.emplace_back(worker);
+  }
+
+  worker();
+  for (auto& thread : workers) {
+    thread.join();
+  }
+}
+
+/**
+ * @brief Call func(i) for every i in [0, num_items) with parallelForBlocks
+ */
+template <typename Func>
+void parallelFor(size_t num_items,
+                 size_t block_size,
+                 size_t num_threads,
+                 const Func& func) {
+  parallelForBlocks(num_items, block_size, num_threads, [&](size_t start, size_t end) {
+    for (size_t i = start; i < end; ++i) {
+      func(i);
+    }
+  });
+}
+
+}  // namespace detail
+}  // namespace spark_dsg
@@ -34,11 +34,15 @@
  * -------------------------------------------------------------------------- */
 #pragma once
 #include <map>
+#include <mutex>
 #include <unordered_set>
 #include <vector>
 
 #include "spark_dsg/base_layer.h"
+#include "spark_dsg/bounding_box_index.h"
 #include "spark_dsg/graph_utilities.h"
+#include "spark_dsg/mesh_connection_index.h"
+#include "spark_dsg/spatial_index.h"
 
 namespace spark_dsg {
 
@@ -73,7 +77,7 @@ class SceneGraphLayer : public BaseLayer {
    */
   explicit SceneGraphLayer(LayerId layer_id);
 
-  virtual ~SceneGraphLayer() = default;
+  virtual ~SceneGraphLayer();
 
   /**
    * @brief Add an edge to the layer
@@ -174,6 +178,56 @@ class SceneGraphLayer : public BaseLayer {
    */
   Eigen::Vector3d getPosition(NodeId node) const;
 
+  /**
+   * @brief Spatial index over the positions of the nodes in the layer
+   *
+   * The index is built on first use and then kept up to date as nodes are added,
+   * removed, merged or have their attributes replaced. One index is kept per
+   * requested resolution, so references stay valid until the layer is reset (every
+   * index is updated on changes). Positions that are modified in place (i.e., via
+   * attributes()) must be reported with refreshPosition. Nodes with non-finite
+   * positions are left out of the index.
+   *
+   * Building the index is safe to do concurrently with other const queries, but not
+   * with modifications of the layer.
+   */
+  const SpatialIndex& spatialIndex(
+      double resolution = SpatialIndex::DEFAULT_RESOLUTION) const;
+
+  /**
+   * @brief Update the spatial indices (if built) with the current position of a node
+   */
+  void refreshPosition(NodeId node) const;
+
+  /**
+   * @brief Bounding-volume hierarchy over the bounding boxes of the nodes in the layer
+   *
+   * Only nodes with semantic attributes and a valid bounding box are indexed. Like
+   * spatialIndex, the hierarchy is built on first use and kept up to date afterwards;
+   * bounding boxes that are modified in place must be reported with
+   * refreshBoundingBox.
+   */
+  const BoundingBoxIndex& boundingBoxIndex() const;
+
+  /**
+   * @brief Update the bounding box index (if built) with the current box of a node
+   */
+  void refreshBoundingBox(NodeId node) const;
+
+  /**
+   * @brief Reverse index from mesh vertices to the nodes of the layer
+   *
+   * Built on first use and kept up to date like spatialIndex; connections that are
+   * modified in place must be reported with refreshMeshConnections.
+   */
+  const MeshConnectionIndex& meshConnectionIndex() const;
+
+  /**
+   * @brief Update the mesh connection index (if built) with the current connections
+   * of a node
+   */
+  void refreshMeshConnections(NodeId node) const;
+
   /**
    * @brief Get node ids of newly inserted nodes
    */
@@ -214,22 +268,40 @@ class SceneGraphLayer : public BaseLayer {
 
   /**
    * @brief Get the immediate neighborhood of a set of nodes via BFS
+   *
+   * Computes the union of the neighborhoods of every node with a single multi-source
+   * BFS (or from the cached neighborhoods if all of them are cached).
+   *
    * @param nodes Nodes to get the neighborhood of
    * @param num_hops Number of hops (1 = siblings and neighbors of siblings)
    */
   std::unordered_set<NodeId> getNeighborhood(const std::unordered_set<NodeId>& nodes,
                                              size_t num_hops = 1) const;
 
+  /**
+   * @brief Toggle caching the results of getNeighborhood
+   *
+   * Cached neighborhoods are keyed by node and number of hops. When an edge is added,
+   * removed or rewired (or a node is removed or merged), only the cached
+   * neighborhoods that contain one of the affected nodes are dropped. Disabling the
+   * cache clears it. Toggling the cache is safe while other threads query
+   * neighborhoods.
+   */
+  void enableNeighborhoodCache(bool enable = true) const;
+
+  /**
+   * @brief Number of neighborhoods currently cached
+   */
+  size_t numCachedNeighborhoods() const;
+
   //! ID of the layer
   const LayerId id;
 
  protected:
   void reset();
 
-  void fillNeighborhoodForNode(NodeId node,
-                               size_t num_hops,
-                               std::unordered_set<NodeId>& result,
-                               std::map<NodeId, size_t>& costs) const;
+  //! drop cached neighborhoods containing the node
+  void invalidateNeighborhoods(NodeId node);
 
   inline EdgeContainer& edgeContainer() override { return edges_; }
 
@@ -269,12 +341,27 @@ class SceneGraphLayer : public BaseLayer {
 
   virtual void cloneImpl(SceneGraphLayer& other, const NodeChecker& is_valid) const;
 
+  //! update every constructed index with the current attributes of a node
+  void refreshIndices(NodeId node) const;
+
   //! internal node container
   Nodes nodes_;
   //! internal node status tracking
   NodeCheckup nodes_status_;
   //! internal edge container
   EdgeContainer edges_;
+  //! guards the lazy construction of the indices below
+  mutable std::mutex index_mutex_;
+  //! lazily constructed indices over node positions (by resolution)
+  mutable std::map<double, std::unique_ptr<SpatialIndex>> spatial_indices_;
+  //! lazily constructed hierarchy over node bounding boxes
+  mutable std::unique_ptr<BoundingBoxIndex> bounding_box_index_;
+  //! lazily constructed reverse index over node mesh connections
+  mutable std::unique_ptr<MeshConnectionIndex> mesh_connection_index_;
+  //! optional cache of node neighborhoods (only accessed via atomic load and store)
+  struct NeighborhoodCache;
+  mutable std::shared_ptr<NeighborhoodCache> neighborhood_cache_;
+  std::shared_ptr<NeighborhoodCache> neighborhoodCache() const;
 
  public:
   /**
@@ -326,7 +413,8 @@ struct graph_traits<SceneGraphLayer> {
   using node_valid_func = const std::function<bool(const SceneGraphNode&)>&;
   using edge_valid_func = const std::function<bool(const SceneGraphEdge&)>&;
 
-  static inline std::set<NodeId> neighbors(const SceneGraphLayer& graph, NodeId node) {
+  static inline const std::set<NodeId>& neighbors(const SceneGraphLayer& graph,
+                                                  NodeId node) {
     return get_node(graph, node).siblings();
   }
 
@@ -358,6 +446,21 @@ struct graph_traits<SceneGraphLayer> {
                                                NodeId target) {
     return graph.getEdge(source, target);
   }
+  static inline Eigen::Vector3d position(const SceneGraphLayer& graph, NodeId node) {
+    return get_node(graph, node).attributes().position;
+  }
+
+  //! Edge weight if set, otherwise the distance between the node positions
+  static inline double edge_cost(const SceneGraphLayer& graph,
+                                 NodeId source,
+                                 NodeId target) {
+    const auto& info = *get_edge(graph, source, target).info;
+    if (info.weighted) {
+      return info.weight;
+    }
+
+    return (position(graph, source) - position(graph, target)).norm();
+  }
 };
 
 }  // namespace graph_utilities
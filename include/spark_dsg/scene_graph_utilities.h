@@ -51,4 +51,32 @@ BoundingBox computeAncestorBoundingBox(
     LayerId child_layer = DsgLayers::PLACES,
     BoundingBox::Type bbox_type = BoundingBox::Type::AABB);
 
+/**
+ * @brief Fit a bounding box to the mesh connections of every node in a layer
+ *
+ * Nodes are processed in parallel and each box is fit to the mesh points directly
+ * (see bounding_box::extract). Nodes without mesh connections (see
+ * MeshConnectionIndex::getConnections) or with connections outside the mesh are
+ * skipped.
+ *
+ * @param num_threads Number of threads to use (0 uses the hardware concurrency)
+ * @returns Bounding boxes keyed by node
+ */
+std::map<NodeId, BoundingBox> computeMeshBoundingBoxes(
+    const SceneGraphLayer& layer,
+    const Mesh& mesh,
+    BoundingBox::Type bbox_type = BoundingBox::Type::AABB,
+    size_t num_threads = 0);
+
+/**
+ * @brief Refit the bounding boxes of the semantic nodes in a layer to the graph mesh
+ * (e.g., after the mesh is deformed by a loop closure)
+ *
+ * @returns Number of nodes that were updated
+ */
+size_t updateMeshBoundingBoxes(DynamicSceneGraph& graph,
+                               LayerId layer,
+                               BoundingBox::Type bbox_type = BoundingBox::Type::AABB,
+                               size_t num_threads = 0);
+
 }  // namespace spark_dsg
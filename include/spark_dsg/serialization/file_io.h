@@ -73,6 +73,16 @@ void saveDsgJson(const DynamicSceneGraph& graph,
                  const std::string& filepath,
                  bool include_mesh = false);
 
+/**
+ * @brief Save a DynamicSceneGraph to a JSON file with a different mesh.
+ * @param graph The graph to save.
+ * @param filepath The filepath including extension to save to.
+ * @param mesh The mesh to save in place of the graph mesh (e.g., a simplified mesh).
+ */
+void saveDsgJson(const DynamicSceneGraph& graph,
+                 const std::string& filepath,
+                 const Mesh& mesh);
+
 /**
  * @brief Load a DynamicSceneGraph from a JSON file.
  * @param filepath The filepath including extension to load from.
@@ -90,6 +100,17 @@ void saveDsgBinary(const DynamicSceneGraph& graph,
                    const std::string& filepath,
                    bool include_mesh = false);
 
+/**
+ * @brief Save a DynamicSceneGraph to a file in binary serialization with a different
+ * mesh.
+ * @param graph The graph to save.
+ * @param filepath The filepath including extension to save to.
+ * @param mesh The mesh to save in place of the graph mesh (e.g., a simplified mesh).
+ */
+void saveDsgBinary(const DynamicSceneGraph& graph,
+                   const std::string& filepath,
+                   const Mesh& mesh);
+
 /**
  * @brief Load a DynamicSceneGraph from a file in binary serialization.
  * @param filepath The filepath including extension to load from.
@@ -43,6 +43,24 @@ void writeGraph(const DynamicSceneGraph& graph,
                 std::vector<uint8_t>& buffer,
                 bool include_mesh = false);
 
+/**
+ * @brief Serialize the graph with a different mesh (e.g., a simplified version of the
+ * graph mesh)
+ */
+void writeGraph(const DynamicSceneGraph& graph,
+                std::vector<uint8_t>& buffer,
+                const Mesh& mesh);
+
+/**
+ * @brief Serialize the graph up to the mesh it contains
+ *
+ * The caller has to append the binary encoding of a mesh (see
+ * Mesh::serializeToBinary) to complete the graph, e.g., to stream a mesh that is not
+ * held in memory (see TieredMesh::serializeToBinary).
+ */
+void writeGraphBeforeMesh(const DynamicSceneGraph& graph,
+                          std::vector<uint8_t>& buffer);
+
 DynamicSceneGraph::Ptr readGraph(const uint8_t* const buffer, size_t length);
 
 inline DynamicSceneGraph::Ptr readGraph(const std::vector<uint8_t>& buffer) {
@@ -55,4 +73,82 @@ inline bool updateGraph(DynamicSceneGraph& graph, const std::vector<uint8_t>& bu
   return updateGraph(graph, buffer.data(), buffer.size());
 }
 
+/**
+ * @brief Serialize the part of the graph owned by a single layer
+ *
+ * A layer owns its nodes (static and dynamic), the edges between its nodes and the
+ * interlayer edges to lower layers (i.e., edges to its children). The result uses the
+ * same encoding as writeGraph (without a mesh).
+ */
+void writeLayer(const DynamicSceneGraph& graph,
+                LayerId layer,
+                std::vector<uint8_t>& buffer);
+
+/**
+ * @brief Update only the part of the graph owned by a single layer
+ *
+ * Nodes and edges owned by the layer that are not present in the buffer are removed.
+ * Interlayer edges to nodes that do not exist in the graph are skipped.
+ */
+bool updateLayer(DynamicSceneGraph& graph,
+                 LayerId layer,
+                 const uint8_t* const buffer,
+                 size_t length);
+
+inline bool updateLayer(DynamicSceneGraph& graph,
+                        LayerId layer,
+                        const std::vector<uint8_t>& buffer) {
+  return updateLayer(graph, layer, buffer.data(), buffer.size());
+}
+
+/**
+ * @brief Serialize only the mesh of the graph (along with the graph layer ids)
+ */
+void writeMesh(const DynamicSceneGraph& graph, std::vector<uint8_t>& buffer);
+
+/**
+ * @brief Serialize a different mesh in place of the graph mesh (see writeMesh)
+ */
+void writeMesh(const DynamicSceneGraph& graph,
+               std::vector<uint8_t>& buffer,
+               const Mesh& mesh);
+
+/**
+ * @brief Update only the mesh of the graph
+ */
+bool updateMesh(DynamicSceneGraph& graph, const uint8_t* const buffer, size_t length);
+
+/**
+ * @brief Serialize only the mesh changes since the mesh's base version
+ *
+ * The receiver has to apply every change message in order (see
+ * Mesh::applyChangesFromBinary); send a full message to (re-)synchronize. The changes
+ * of the mesh have to be cleared after every message (see takeMeshChanges), or the
+ * next partial message is rejected by the receiver.
+ *
+ * @param full Serialize the entire mesh instead of only the changes
+ */
+void writeMeshChanges(const DynamicSceneGraph& graph,
+                      std::vector<uint8_t>& buffer,
+                      bool full = false);
+
+/**
+ * @brief Serialize the mesh changes (see writeMeshChanges) and clear the changes of
+ * the graph mesh so that the next message continues from this one
+ */
+void takeMeshChanges(const DynamicSceneGraph& graph,
+                     std::vector<uint8_t>& buffer,
+                     bool full = false);
+
+/**
+ * @brief Apply mesh changes to the mesh of the graph
+ *
+ * Graphs without a mesh only accept full messages.
+ *
+ * @returns false if the changes do not apply to the current mesh of the graph
+ */
+bool updateMeshChanges(DynamicSceneGraph& graph,
+                       const uint8_t* const buffer,
+                       size_t length);
+
 }  // namespace spark_dsg::io::binary
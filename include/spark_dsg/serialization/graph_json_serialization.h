@@ -44,6 +44,12 @@ namespace spark_dsg::io::json {
  */
 std::string writeGraph(const DynamicSceneGraph& graph, bool include_mesh = false);
 
+/**
+ * @brief Get JSON string representing graph with a different mesh (e.g., a simplified
+ * version of the graph mesh)
+ */
+std::string writeGraph(const DynamicSceneGraph& graph, const Mesh& mesh);
+
 /**
  * @brief parse graph from JSON string
  * @param contents JSON string to parse
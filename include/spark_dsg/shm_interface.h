@@ -0,0 +1,113 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+
+#include "spark_dsg/dynamic_scene_graph.h"
+
+namespace spark_dsg {
+
+/**
+ * @brief Publish serialized graphs to a POSIX shared memory segment
+ *
+ * The segment is organized as a ring of fixed-size slots that each hold one binary
+ * graph payload (the same encoding that ZmqSender uses). Every slot is guarded by a
+ * seqlock-style sequence counter so that readers never block the writer and can
+ * detect (and retry) reads that overlap with a write. Only one sender per segment
+ * name is supported.
+ */
+class ShmSender {
+ public:
+  /**
+   * @brief Create (or recreate) the shared memory segment
+   * @param name POSIX shared memory name (e.g., "/spark_dsg")
+   * @param slot_capacity Maximum size of a single serialized graph in bytes
+   * @param num_slots Number of slots in the ring buffer
+   */
+  ShmSender(const std::string& name, size_t slot_capacity, size_t num_slots = 2);
+
+  ~ShmSender();
+
+  /**
+   * @brief Serialize and publish the graph
+   * @returns false if the serialized graph does not fit into a slot
+   */
+  bool send(const DynamicSceneGraph& graph, bool include_mesh = false);
+
+  /**
+   * @brief Publish an already serialized graph
+   * @returns false if the payload does not fit into a slot
+   */
+  bool send(const uint8_t* const buffer, size_t length);
+
+ private:
+  struct Detail;
+
+  std::unique_ptr<Detail> internals_;
+};
+
+/**
+ * @brief Attach to a shared memory segment created by a ShmSender
+ *
+ * The receiver always skips to the most recently published graph (similar to a
+ * conflated ZmqReceiver). Attaching is retried on every call to recv until the
+ * segment exists.
+ */
+class ShmReceiver {
+ public:
+  explicit ShmReceiver(const std::string& name);
+
+  ~ShmReceiver();
+
+  /**
+   * @brief Poll for a new graph
+   * @param timeout_ms Time to wait for a new graph
+   * @returns true if a new graph was received
+   */
+  bool recv(size_t timeout_ms);
+
+  DynamicSceneGraph::Ptr graph() const;
+
+  /**
+   * @brief Number of published graphs that were never read by this receiver
+   */
+  size_t numSkipped() const;
+
+ private:
+  struct Detail;
+
+  std::unique_ptr<Detail> internals_;
+};
+
+}  // namespace spark_dsg
@@ -0,0 +1,483 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <Eigen/Dense>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+#include "spark_dsg/graph_utilities.h"
+
+namespace spark_dsg {
+namespace graph_utilities {
+
+/**
+ * @brief Min-heap where every entry has D children
+ *
+ * A wider heap is shallower than a binary heap, which reduces the number of cache
+ * misses per push and pop. Entries are never updated in place: searches push a new
+ * entry when the cost of a node improves and skip outdated entries when popping.
+ */
+template <typename T, size_t D = 4, typename Compare = std::less<T>>
+class DaryHeap {
+ public:
+  static_assert(D >= 2, "heap requires at least two children per entry");
+
+  bool empty() const { return data_.empty(); }
+
+  size_t size() const { return data_.size(); }
+
+  void clear() { data_.clear(); }
+
+  const T& top() const { return data_.front(); }
+
+  void push(const T& value) {
+    data_.push_back(value);
+    siftUp(data_.size() - 1);
+  }
+
+  void pop() {
+    data_.front() = data_.back();
+    data_.pop_back();
+    if (!data_.empty()) {
+      siftDown(0);
+    }
+  }
+
+ private:
+  void siftUp(size_t index) {
+    const T value = data_[index];
+    while (index > 0) {
+      const size_t parent = (index - 1) / D;
+      if (!compare_(value, data_[parent])) {
+        break;
+      }
+
+      data_[index] = data_[parent];
+      index = parent;
+    }
+
+    data_[index] = value;
+  }
+
+  void siftDown(size_t index) {
+    const T value = data_[index];
+    const size_t size = data_.size();
+    while (true) {
+      const size_t first = D * index + 1;
+      if (first >= size) {
+        break;
+      }
+
+      size_t best = first;
+      const size_t last = std::min(first + D, size);
+      for (size_t child = first + 1; child < last; ++child) {
+        if (compare_(data_[child], data_[best])) {
+          best = child;
+        }
+      }
+
+      if (!compare_(data_[best], value)) {
+        break;
+      }
+
+      data_[index] = data_[best];
+      index = best;
+    }
+
+    data_[index] = value;
+  }
+
+  Compare compare_;
+  std::vector<T> data_;
+};
+
+/**
+ * @brief Reusable state for shortest path searches
+ *
+ * Like TraversalWorkspace, nodes are assigned a compact index the first time they are
+ * reached and per-node state is invalidated by bumping an epoch counter. Distances
+ * and parents from the last search stay queryable until the next search starts.
+ */
+class SearchWorkspace {
+ public:
+  static constexpr NodeId NO_PARENT = std::numeric_limits<NodeId>::max();
+
+  //! Start a new search (invalidates distances, parents and cached heuristics)
+  void reset() {
+    heap_.clear();
+    if (++epoch_ == 0) {
+      std::fill(epochs_.begin(), epochs_.end(), 0);
+      std::fill(heuristic_epochs_.begin(), heuristic_epochs_.end(), 0);
+      epoch_ = 1;
+    }
+  }
+
+  //! Drop the node index (e.g., after many nodes were removed from the graph)
+  void clear() {
+    index_.clear();
+    ids_.clear();
+    epochs_.clear();
+    distances_.clear();
+    parents_.clear();
+    settled_.clear();
+    heuristic_epochs_.clear();
+    heuristics_.clear();
+    reset();
+  }
+
+  size_t numIndexed() const { return index_.size(); }
+
+  //! Whether the node was reached by the last search
+  bool reached(NodeId node) const { return lookup(node) != INVALID; }
+
+  //! Whether the distance to the node is final
+  bool settled(NodeId node) const {
+    const auto index = lookup(node);
+    return index != INVALID && settled_[index];
+  }
+
+  //! Distance from the closest source (infinity if the node was not reached)
+  double distance(NodeId node) const {
+    const auto index = lookup(node);
+    return index == INVALID ? std::numeric_limits<double>::infinity()
+                            : distances_[index];
+  }
+
+  //! Path from the closest source to the node (empty if the node was not reached)
+  std::vector<NodeId> path(NodeId node) const {
+    std::vector<NodeId> result;
+    if (!reached(node)) {
+      return result;
+    }
+
+    for (NodeId curr = node; curr != NO_PARENT; curr = parents_[lookup(curr)]) {
+      result.push_back(curr);
+    }
+
+    std::reverse(result.begin(), result.end());
+    return result;
+  }
+
+  /**
+   * @brief Lower the distance to a node and queue it for expansion
+   * @param heuristic Estimated remaining cost (added to the queue priority)
+   * @returns True if the distance to the node improved
+   */
+  bool relax(NodeId node, double distance, NodeId parent, double heuristic = 0.0) {
+    const size_t index = activate(node);
+    if (settled_[index] || distance >= distances_[index]) {
+      return false;
+    }
+
+    distances_[index] = distance;
+    parents_[index] = parent;
+    heap_.push({distance + heuristic, index});
+    return true;
+  }
+
+  //! Settle the queued node with the lowest priority
+  bool popNext(NodeId& node) {
+    while (!heap_.empty()) {
+      const size_t index = heap_.top().index;
+      heap_.pop();
+      if (settled_[index]) {
+        continue;  // outdated entry
+      }
+
+      settled_[index] = true;
+      node = ids_[index];
+      return true;
+    }
+
+    return false;
+  }
+
+  //! Heuristic for a node, computed at most once per search
+  template <typename Func>
+  double heuristic(NodeId node, const Func& compute) {
+    const size_t index = indexOf(node);
+    if (heuristic_epochs_[index] != epoch_) {
+      heuristic_epochs_[index] = epoch_;
+      heuristics_[index] = compute(node);
+    }
+
+    return heuristics_[index];
+  }
+
+ private:
+  struct Entry {
+    double priority;
+    size_t index;
+    bool operator<(const Entry& other) const { return priority < other.priority; }
+  };
+
+  static constexpr size_t INVALID = std::numeric_limits<size_t>::max();
+
+  size_t lookup(NodeId node) const {
+    const auto iter = index_.find(node);
+    if (iter == index_.end() || epochs_[iter->second] != epoch_) {
+      return INVALID;
+    }
+
+    return iter->second;
+  }
+
+  size_t indexOf(NodeId node) {
+    const auto [iter, inserted] = index_.emplace(node, ids_.size());
+    if (inserted) {
+      ids_.push_back(node);
+      epochs_.push_back(0);
+      distances_.push_back(0.0);
+      parents_.push_back(NO_PARENT);
+      settled_.push_back(false);
+      heuristic_epochs_.push_back(0);
+      heuristics_.push_back(0.0);
+    }
+
+    return iter->second;
+  }
+
+  size_t activate(NodeId node) {
+    const size_t index = indexOf(node);
+    if (epochs_[index] != epoch_) {
+      epochs_[index] = epoch_;
+      distances_[index] = std::numeric_limits<double>::infinity();
+      parents_[index] = NO_PARENT;
+      settled_[index] = false;
+    }
+
+    return index;
+  }
+
+  std::unordered_map<NodeId, size_t> index_;
+  std::vector<NodeId> ids_;
+  std::vector<uint32_t> epochs_;
+  std::vector<double> distances_;
+  std::vector<NodeId> parents_;
+  std::vector<uint8_t> settled_;
+  std::vector<uint32_t> heuristic_epochs_;
+  std::vector<double> heuristics_;
+  uint32_t epoch_ = 1;
+  DaryHeap<Entry> heap_;
+};
+
+/**
+ * @brief Settle nodes in order of priority until the visitor returns false
+ *
+ * Neighbors that would exceed max_cost (or are behind an edge with infinite cost)
+ * are not queued. The heuristic has to be consistent (e.g., the straight-line
+ * distance when edge costs are at least the distance between the nodes) for settled
+ * distances to be optimal.
+ */
+template <typename Graph, typename Heuristic, typename Visitor>
+void expandSearch(const Graph& graph,
+                  SearchWorkspace& workspace,
+                  const Heuristic& heuristic,
+                  double max_cost,
+                  const Visitor& visitor) {
+  NodeId node;
+  while (workspace.popNext(node)) {
+    if (!visitor(node)) {
+      return;
+    }
+
+    const double distance = workspace.distance(node);
+    for (const auto& neighbor : graph_traits<Graph>::neighbors(graph, node)) {
+      if (workspace.settled(neighbor)) {
+        continue;
+      }
+
+      // infinite edge costs mark edges that cannot be traversed
+      const double cost =
+          distance + graph_traits<Graph>::edge_cost(graph, node, neighbor);
+      if (cost > max_cost || std::isinf(cost)) {
+        continue;
+      }
+
+      workspace.relax(neighbor, cost, node, heuristic(neighbor));
+    }
+  }
+}
+
+/**
+ * @brief Compute distances from the closest source to every node within max_cost
+ *
+ * Distances and paths are available from the workspace afterwards.
+ */
+template <typename Graph, typename Nodes>
+void dijkstra(const Graph& graph,
+              const Nodes& sources,
+              SearchWorkspace& workspace,
+              double max_cost = std::numeric_limits<double>::infinity()) {
+  workspace.reset();
+  for (const auto source : sources) {
+    if (graph_traits<Graph>::contains(graph, source)) {
+      workspace.relax(source, 0.0, SearchWorkspace::NO_PARENT);
+    }
+  }
+
+  expandSearch(
+      graph,
+      workspace,
+      [](NodeId) { return 0.0; },
+      max_cost,
+      [](NodeId) { return true; });
+}
+
+template <typename Graph>
+void dijkstra(const Graph& graph,
+              NodeId source,
+              SearchWorkspace& workspace,
+              double max_cost = std::numeric_limits<double>::infinity()) {
+  dijkstra(graph, std::vector<NodeId>{source}, workspace, max_cost);
+}
+
+/**
+ * @brief Find the shortest path from the closest source to the target
+ *
+ * Uses Dijkstra by default. Setting use_heuristic enables A* with the straight-line
+ * distance to the target as heuristic, which is only correct if every edge cost is at
+ * least the distance between its nodes (i.e., not for weighted edges that are
+ * cheaper than the distance they span).
+ *
+ * @returns Cost of the path (infinity if the target is not reachable). The path
+ * itself is available via workspace.path(target).
+ */
+template <typename Graph, typename Nodes>
+double findShortestPath(const Graph& graph,
+                        const Nodes& sources,
+                        NodeId target,
+                        SearchWorkspace& workspace,
+                        bool use_heuristic = false) {
+  workspace.reset();
+  if (!graph_traits<Graph>::contains(graph, target)) {
+    return std::numeric_limits<double>::infinity();
+  }
+
+  const Eigen::Vector3d goal = graph_traits<Graph>::position(graph, target);
+  const auto heuristic = [&](NodeId node) {
+    if (!use_heuristic) {
+      return 0.0;
+    }
+
+    return workspace.heuristic(node, [&](NodeId to_compute) {
+      return (graph_traits<Graph>::position(graph, to_compute) - goal).norm();
+    });
+  };
+
+  for (const auto source : sources) {
+    if (graph_traits<Graph>::contains(graph, source)) {
+      workspace.relax(source, 0.0, SearchWorkspace::NO_PARENT, heuristic(source));
+    }
+  }
+
+  expandSearch(graph,
+               workspace,
+               heuristic,
+               std::numeric_limits<double>::infinity(),
+               [&](NodeId node) { return node != target; });
+  return workspace.settled(target) ? workspace.distance(target)
+                                   : std::numeric_limits<double>::infinity();
+}
+
+template <typename Graph>
+double findShortestPath(const Graph& graph,
+                        NodeId source,
+                        NodeId target,
+                        SearchWorkspace& workspace,
+                        bool use_heuristic = false) {
+  return findShortestPath(
+      graph, std::vector<NodeId>{source}, target, workspace, use_heuristic);
+}
+
+/**
+ * @brief Compute the distance between every source and every target
+ *
+ * Runs one search per source that stops once all targets are settled.
+ *
+ * @returns Matrix where entry [i][j] is the distance from source i to target j
+ * (infinity if not reachable)
+ */
+template <typename Graph>
+std::vector<std::vector<double>> getDistanceMatrix(const Graph& graph,
+                                                   const std::vector<NodeId>& sources,
+                                                   const std::vector<NodeId>& targets,
+                                                   SearchWorkspace& workspace) {
+  std::unordered_map<NodeId, std::vector<size_t>> target_columns;
+  for (size_t j = 0; j < targets.size(); ++j) {
+    if (graph_traits<Graph>::contains(graph, targets[j])) {
+      target_columns[targets[j]].push_back(j);
+    }
+  }
+
+  std::vector<std::vector<double>> distances(
+      sources.size(),
+      std::vector<double>(targets.size(), std::numeric_limits<double>::infinity()));
+  for (size_t i = 0; i < sources.size(); ++i) {
+    workspace.reset();
+    if (!graph_traits<Graph>::contains(graph, sources[i]) || target_columns.empty()) {
+      continue;
+    }
+
+    size_t num_remaining = target_columns.size();
+    workspace.relax(sources[i], 0.0, SearchWorkspace::NO_PARENT);
+    expandSearch(
+        graph,
+        workspace,
+        [](NodeId) { return 0.0; },
+        std::numeric_limits<double>::infinity(),
+        [&](NodeId node) {
+          const auto iter = target_columns.find(node);
+          if (iter == target_columns.end()) {
+            return true;
+          }
+
+          for (const auto j : iter->second) {
+            distances[i][j] = workspace.distance(node);
+          }
+
+          return --num_remaining > 0;
+        });
+  }
+
+  return distances;
+}
+
+}  // namespace graph_utilities
+}  // namespace spark_dsg
@@ -0,0 +1,144 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <Eigen/Dense>
+#include <unordered_map>
+#include <vector>
+
+#include "spark_dsg/scene_graph_types.h"
+
+namespace spark_dsg {
+
+/**
+ * @brief Uniform hash grid over node positions
+ *
+ * Each node is stored in the cube of side `resolution` containing its position, so
+ * insertion, removal and position updates are O(1) and queries only visit the cells
+ * overlapping the query region. The grid is sparse (only occupied cells are stored);
+ * when a query would touch more cells than are occupied, the occupied cells are
+ * scanned instead. Queries are const and may run concurrently with each other.
+ */
+class SpatialIndex {
+ public:
+  static constexpr double DEFAULT_RESOLUTION = 1.0;
+
+  explicit SpatialIndex(double resolution = DEFAULT_RESOLUTION);
+
+  inline double resolution() const { return resolution_; }
+
+  inline size_t size() const { return positions_.size(); }
+
+  inline size_t numCells() const { return cells_.size(); }
+
+  inline bool contains(NodeId node) const { return positions_.count(node); }
+
+  /**
+   * @brief Add a node or move it to a new position
+   *
+   * Throws std::invalid_argument if the position is not finite. Searches around
+   * NaN positions return no nodes.
+   */
+  void insert(NodeId node, const Eigen::Vector3d& position);
+
+  /**
+   * @brief Remove a node if it exists
+   * @returns true if the node was indexed
+   */
+  bool erase(NodeId node);
+
+  void clear();
+
+  /**
+   * @brief Get the indexed position of a node (throws if the node is not indexed)
+   */
+  const Eigen::Vector3d& position(NodeId node) const;
+
+  /**
+   * @brief Nodes within radius of the center, ordered by increasing distance
+   */
+  std::vector<NodeId> radiusSearch(const Eigen::Vector3d& center, double radius) const;
+
+  /**
+   * @brief Up to k closest nodes to the center, ordered by increasing distance
+   * @param max_distance Optional bound on the distance of returned nodes
+   */
+  std::vector<NodeId> nearest(const Eigen::Vector3d& center,
+                              size_t k,
+                              double max_distance = -1.0) const;
+
+  /**
+   * @brief Nodes inside the axis-aligned box [min, max] in ascending id order
+   */
+  std::vector<NodeId> boxSearch(const Eigen::Vector3d& min,
+                                const Eigen::Vector3d& max) const;
+
+  std::vector<std::vector<NodeId>> radiusSearch(
+      const std::vector<Eigen::Vector3d>& centers, double radius) const;
+
+  std::vector<std::vector<NodeId>> nearest(const std::vector<Eigen::Vector3d>& centers,
+                                           size_t k,
+                                           double max_distance = -1.0) const;
+
+ private:
+  using Cell = Eigen::Vector3i;
+
+  struct CellHash {
+    size_t operator()(const Cell& cell) const;
+  };
+
+  struct Entry {
+    Eigen::Vector3d position;
+    Cell cell;
+  };
+
+  struct Candidate {
+    double distance;
+    NodeId node;
+    bool operator<(const Candidate& other) const;
+  };
+
+  Cell getCell(const Eigen::Vector3d& position) const;
+
+  size_t numCellsInRange(const Cell& min, const Cell& max) const;
+
+  template <typename Visitor>
+  void visitRange(const Cell& min, const Cell& max, const Visitor& visitor) const;
+
+  double resolution_;
+  std::unordered_map<NodeId, Entry> positions_;
+  std::unordered_map<Cell, std::vector<NodeId>, CellHash> cells_;
+};
+
+}  // namespace spark_dsg
@@ -0,0 +1,110 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace spark_dsg {
+
+/**
+ * @brief Single message of a graph stream as published by a ZmqSender
+ */
+struct StreamMessage {
+  //! Wall-clock time the message was received [ns]
+  uint64_t stamp_ns = 0;
+  //! Topic of the message (empty for senders without layer topics)
+  std::string topic;
+  //! Serialized payload
+  std::vector<uint8_t> payload;
+};
+
+/**
+ * @brief Writes stream messages to an indexed file
+ *
+ * Messages are appended as they arrive and an index of message offsets is written
+ * when the recording is closed. Recordings that were not closed (e.g., because the
+ * recorder crashed) can still be read, as the index is rebuilt by scanning the file.
+ */
+class StreamWriter {
+ public:
+  explicit StreamWriter(const std::string& filepath);
+
+  ~StreamWriter();
+
+  void write(const StreamMessage& message);
+
+  //! Write the index and close the file
+  void close();
+
+  size_t numMessages() const { return offsets_.size(); }
+
+ private:
+  std::ofstream out_;
+  uint64_t position_;
+  std::vector<uint64_t> offsets_;
+  std::vector<uint64_t> stamps_;
+};
+
+/**
+ * @brief Random access to messages of a recording written by a StreamWriter
+ */
+class StreamReader {
+ public:
+  explicit StreamReader(const std::string& filepath);
+
+  size_t size() const { return offsets_.size(); }
+
+  bool empty() const { return offsets_.empty(); }
+
+  //! Read the message at the given index
+  StreamMessage read(size_t index);
+
+  //! Timestamp of the message at the given index (without reading the payload)
+  uint64_t stamp(size_t index) const { return stamps_.at(index); }
+
+ private:
+  bool readIndex(uint64_t file_size);
+
+  void rebuildIndex(uint64_t file_size);
+
+  std::ifstream in_;
+  std::vector<uint64_t> offsets_;
+  std::vector<uint64_t> stamps_;
+};
+
+}  // namespace spark_dsg
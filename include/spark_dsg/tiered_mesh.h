@@ -0,0 +1,203 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <iosfwd>
+#include <memory>
+#include <string>
+
+#include "spark_dsg/mesh.h"
+
+namespace spark_dsg {
+
+class DynamicSceneGraph;
+
+/**
+ * @brief Mesh whose archived vertices are spilled to a memory-mapped file
+ *
+ * Vertices [0, numArchived()) live in the archive file and vertices after that in a
+ * regular in-memory Mesh (the active tier). Archiving moves the longest prefix of
+ * active vertices whose timestamps are older than a threshold into the archive, so
+ * vertex indices never change. Archived vertices are read (and written) through the
+ * mapping and paged in by the operating system on demand; evictArchive drops the
+ * resident pages. Faces always stay in memory.
+ *
+ * The accessors mirror the per-vertex accessors of Mesh and take global vertex
+ * indices. A TieredMesh is not a Mesh and cannot be the mesh held by a graph
+ * (DynamicSceneGraph::mesh); it is meant to be kept next to the graph by the
+ * producer of the mesh. It is saved in the same format as Mesh (on its own or in
+ * place of the graph mesh, see io::saveDsgBinary) without copying it into a Mesh.
+ * Only available on POSIX systems.
+ */
+class TieredMesh {
+ public:
+  using Ptr = std::shared_ptr<TieredMesh>;
+
+  struct Config {
+    //! file backing the archived vertices (created or truncated)
+    std::string archive_path;
+    //! vertices last updated more than this long before the current time are archived
+    Mesh::Timestamp archive_age_ns = 60000000000;  // 60 seconds
+    //! remove the archive file on destruction
+    bool remove_archive = true;
+  };
+
+  struct Residency {
+    size_t num_active = 0;
+    size_t num_archived = 0;
+    //! memory used by the active vertices [bytes]
+    size_t active_bytes = 0;
+    //! size of the archived vertices [bytes]
+    size_t archive_bytes = 0;
+    //! portion of the archived vertices currently in memory [bytes]
+    size_t resident_archive_bytes = 0;
+  };
+
+  /**
+   * @brief Create an empty mesh with an empty archive (throws if the archive file
+   * cannot be created)
+   */
+  TieredMesh(const Config& config,
+             bool has_colors = true,
+             bool has_timestamps = true,
+             bool has_labels = true,
+             bool has_first_seen_stamps = false);
+
+  ~TieredMesh();
+
+  TieredMesh(const TieredMesh& other) = delete;
+
+  TieredMesh& operator=(const TieredMesh& other) = delete;
+
+  const Config& config() const;
+
+  size_t numVertices() const;
+
+  size_t numArchived() const;
+
+  size_t numFaces() const;
+
+  /**
+   * @brief Append the vertices and faces of a mesh (face indices are offset)
+   */
+  void append(const Mesh& mesh);
+
+  /**
+   * @brief Archive the vertices older than the configured age (see archiveBefore)
+   * @param now Current time
+   * @returns Number of archived vertices
+   */
+  size_t archive(Mesh::Timestamp now);
+
+  /**
+   * @brief Archive the longest prefix of active vertices with timestamps before the
+   * threshold (throws if the mesh has no timestamps)
+   * @returns Number of archived vertices
+   */
+  size_t archiveBefore(Mesh::Timestamp threshold);
+
+  /**
+   * @brief Write back and drop the pages of the archive that are currently in memory
+   */
+  void evictArchive();
+
+  Residency residency() const;
+
+  // Vertex accessors (global indices, throw std::out_of_range)
+  Mesh::Pos pos(size_t index) const;
+  void setPos(size_t index, const Mesh::Pos& pos);
+  Color color(size_t index) const;
+  void setColor(size_t index, const Color& color);
+  Mesh::Timestamp timestamp(size_t index) const;
+  void setTimestamp(size_t index, Mesh::Timestamp timestamp);
+  Mesh::Timestamp firstSeenTimestamp(size_t index) const;
+  void setFirstSeenTimestamp(size_t index, Mesh::Timestamp timestamp);
+  Mesh::Label label(size_t index) const;
+  void setLabel(size_t index, Mesh::Label label);
+
+  const Mesh::Face& face(size_t index) const;
+
+  /**
+   * @brief In-memory tier (vertex i of the active mesh is vertex numArchived() + i)
+   */
+  const Mesh& active() const;
+
+  /**
+   * @brief Copy every vertex and face into a regular mesh
+   */
+  Mesh::Ptr toMesh() const;
+
+  /**
+   * @brief Write the binary encoding of Mesh::serializeToBinary to a stream
+   *
+   * The vertices are encoded straight from the mapping and the active tier in
+   * bounded chunks.
+   */
+  void serializeToBinary(std::ostream& out) const;
+
+  /**
+   * @brief Save to a file that Mesh::load can read (see Mesh::save)
+   *
+   * Binary files are streamed (see serializeToBinary); saving as JSON copies the
+   * mesh into a Mesh first.
+   */
+  void save(std::string filepath) const;
+
+  const bool has_colors;
+  const bool has_timestamps;
+  const bool has_labels;
+  const bool has_first_seen_stamps;
+
+ private:
+  struct Detail;
+
+  std::unique_ptr<Detail> internals_;
+};
+
+namespace io {
+
+/**
+ * @brief Save the graph with a tiered mesh in place of the graph mesh
+ *
+ * The file has the same format as DynamicSceneGraph::save and is read by
+ * DynamicSceneGraph::load; the mesh is streamed to the file (see
+ * TieredMesh::serializeToBinary).
+ */
+void saveDsgBinary(const DynamicSceneGraph& graph,
+                   const std::string& filepath,
+                   const TieredMesh& mesh);
+
+}  // namespace io
+
+}  // namespace spark_dsg
@@ -0,0 +1,172 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+namespace spark_dsg {
+
+/**
+ * @brief Histogram with power-of-two bucket boundaries
+ *
+ * Bucket 0 holds values in [0, 1), bucket i holds values in [2^(i-1), 2^i) and the
+ * last bucket holds everything else. Timings are recorded in microseconds.
+ */
+struct LogHistogram {
+  static constexpr size_t NUM_BUCKETS = 40;
+
+  void add(double value);
+
+  void reset();
+
+  double mean() const;
+
+  /**
+   * @brief Approximate percentile (upper bound of the bucket containing it)
+   * @param fraction Percentile in [0, 1]
+   */
+  double percentile(double fraction) const;
+
+  static double bucketUpperBound(size_t index);
+
+  size_t count = 0;
+  double total = 0.0;
+  double min = std::numeric_limits<double>::infinity();
+  double max = 0.0;
+  std::array<size_t, NUM_BUCKETS> buckets{};
+};
+
+std::ostream& operator<<(std::ostream& out, const LogHistogram& hist);
+
+/**
+ * @brief Counters and per-stage timing histograms for graph transport
+ *
+ * Not every field applies to every endpoint (e.g., a sender never receives).
+ * End-to-end latency uses the system clock and is only meaningful between hosts
+ * with synchronized clocks.
+ */
+struct TransportStats {
+  size_t messages_sent = 0;
+  size_t messages_received = 0;
+  //! messages that were published but never received (e.g., due to conflation)
+  size_t messages_dropped = 0;
+  size_t bytes_sent = 0;
+  size_t bytes_received = 0;
+
+  //! time spent serializing the graph [us]
+  LogHistogram serialize_us;
+  //! time spent handing the message to the socket [us]
+  LogHistogram send_us;
+  //! time spent reading the message from the socket [us]
+  LogHistogram recv_us;
+  //! time spent deserializing or updating the graph [us]
+  LogHistogram parse_us;
+  //! time between the send timestamp and the received graph being ready [us]
+  LogHistogram latency_us;
+  //! size of each message [bytes]
+  LogHistogram message_bytes;
+};
+
+std::ostream& operator<<(std::ostream& out, const TransportStats& stats);
+
+/**
+ * @brief Thread-safe holder for transport statistics that is disabled by default
+ */
+class TransportStatsRecorder {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  void enable(bool enabled);
+
+  bool enabled() const { return enabled_; }
+
+  TransportStats get() const;
+
+  void reset();
+
+  template <typename Func>
+  void update(Func&& func) {
+    if (!enabled_) {
+      return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    func(stats_);
+  }
+
+  static double elapsedUs(const Clock::time_point& start,
+                          const Clock::time_point& end = Clock::now());
+
+ private:
+  std::atomic<bool> enabled_{false};
+  mutable std::mutex mutex_;
+  TransportStats stats_;
+};
+
+/**
+ * @brief Metadata appended to the end of a serialized graph when stats are enabled
+ *
+ * Graph deserialization ignores trailing bytes, so receivers without stats (or older
+ * receivers) can still parse payloads with a trailer.
+ */
+struct TransportTrailer {
+  static constexpr uint64_t MAGIC = 0x5453444b52415053;  // "SPARKDST" in ascii
+  static constexpr size_t SIZE = 3 * sizeof(uint64_t);
+
+  uint64_t sequence = 0;
+  //! system clock time when the graph was handed to the sender [ns]
+  uint64_t stamp_ns = 0;
+
+  static uint64_t now();
+
+  void append(std::vector<uint8_t>& buffer) const;
+
+  /**
+   * @brief Check for and parse a trailer at the end of a payload
+   * @returns true if a trailer was present
+   */
+  static bool parse(const uint8_t* const buffer,
+                    size_t length,
+                    TransportTrailer& trailer);
+};
+
+}  // namespace spark_dsg
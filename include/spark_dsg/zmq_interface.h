@@ -35,17 +35,89 @@
 #pragma once
 
 #include "spark_dsg/dynamic_scene_graph.h"
+#include "spark_dsg/stream_recording.h"
+#include "spark_dsg/transport_stats.h"
 
 namespace spark_dsg {
 
 class ZmqSender {
  public:
-  ZmqSender(const std::string& url, size_t num_threads);
+  /**
+   * @brief Bind a publisher to the url
+   * @param url ZMQ endpoint to bind to
+   * @param num_threads Number of ZMQ IO threads
+   * @param layer_topics Publish one message per layer (and one for the mesh) under
+   * separate topics instead of a single message for the whole graph. Receivers have
+   * to be constructed with a list of layers to read these messages.
+   */
+  ZmqSender(const std::string& url, size_t num_threads, bool layer_topics = false);
 
   ~ZmqSender();
 
   void send(const DynamicSceneGraph& graph, bool include_mesh = false);
 
+  /**
+   * @brief Publish a snapshot of the graph from a background thread
+   *
+   * Only the latest snapshot is kept: snapshots handed off while another one is
+   * pending replace it (and are counted as dropped in the sender stats).
+   *
+   * This overload does not return quickly: the graph is deep-copied on the calling
+   * thread (a full clone of every layer, plus the mesh or its simplification when
+   * include_mesh is set), which costs time and memory linear in the size of the
+   * graph. Only the serialization and the socket send are moved off the calling
+   * thread. Use the ConstPtr overload to hand off a graph without copying it.
+   */
+  void sendAsync(const DynamicSceneGraph& graph, bool include_mesh = false);
+
+  /**
+   * @brief Publish a graph from a background thread without copying it
+   *
+   * This is the only path that returns without work proportional to the graph: the
+   * caller must not modify the graph (or its mesh) after handing it off (e.g., by
+   * alternating between two graphs).
+   */
+  void sendAsync(DynamicSceneGraph::ConstPtr graph, bool include_mesh = false);
+
+  /**
+   * @brief Publish a previously received message as-is (e.g., from a recording)
+   */
+  void sendRaw(const StreamMessage& message);
+
+  /**
+   * @brief Delay asynchronous sends so that snapshots arriving within the window
+   * are coalesced into a single message
+   */
+  void setCoalesceWindow(size_t window_ms);
+
+  /**
+   * @brief Send a simplified mesh (see simplifyMesh) instead of the full mesh
+   *
+   * The simplification is updated incrementally from the changes to the mesh between
+   * sends. The changes are recorded by a tracker of the mesh (see
+   * Mesh::trackChanges), so other code may clear the changes of the mesh. Updates are
+   * only incremental while the graphs that are sent share the same mesh object;
+   * sendAsync with a graph reference simplifies the mesh of the graph on the calling
+   * thread and only copies the simplified mesh.
+   *
+   * @param voxel_size Voxel size of the simplification (0 sends the full mesh)
+   */
+  void setMeshSimplification(float voxel_size);
+
+  /**
+   * @brief Block until all pending asynchronous sends are published
+   */
+  void flush();
+
+  /**
+   * @brief Toggle stats collection (and appending send timestamps to messages)
+   */
+  void enableStats(bool enable = true);
+
+  TransportStats stats() const;
+
+  void resetStats();
+
  private:
   struct Detail;
 
@@ -56,12 +128,47 @@ class ZmqReceiver {
  public:
   ZmqReceiver(const std::string& url, size_t num_threads, bool conflate = true);
 
+  /**
+   * @brief Subscribe to a subset of layers from a sender using layer topics
+   * @param url ZMQ endpoint to connect to
+   * @param num_threads Number of ZMQ IO threads
+   * @param layers Layers to subscribe to (only these layers are reconstructed)
+   * @param include_mesh Subscribe to the mesh as well
+   * @param conflate Only keep the latest message for each layer
+   */
+  ZmqReceiver(const std::string& url,
+              size_t num_threads,
+              const std::vector<LayerId>& layers,
+              bool include_mesh = false,
+              bool conflate = true);
+
   ~ZmqReceiver();
 
   bool recv(size_t timeout_ms, bool recv_all = false);
 
+  /**
+   * @brief Receive the next message without parsing it (e.g., for recording)
+   *
+   * The receiver should be constructed without conflation to avoid missing messages.
+   * The graph held by the receiver is not updated. Any transport trailer appended by
+   * the sender is stripped from the payload.
+   */
+  bool recvRaw(size_t timeout_ms, StreamMessage& message);
+
   DynamicSceneGraph::Ptr graph() const;
 
+  /**
+   * @brief Toggle stats collection
+   *
+   * Dropped messages and end-to-end latency require the sender to have stats
+   * enabled as well.
+   */
+  void enableStats(bool enable = true);
+
+  TransportStats stats() const;
+
+  void resetStats();
+
  private:
   struct Detail;
 
@@ -71,11 +178,20 @@ class ZmqReceiver {
 class ZmqGraph {
  public:
   ZmqGraph(const std::string& url, size_t num_threads, size_t poll_time_ms = 100);
+  ZmqGraph(const std::string& url,
+           size_t num_threads,
+           const std::vector<LayerId>& layers,
+           bool include_mesh = false,
+           size_t poll_time_ms = 100);
   ~ZmqGraph();
 
   bool hasChange() const;
   DynamicSceneGraph::Ptr graph() const;
 
+  void enableStats(bool enable = true);
+  TransportStats stats() const;
+  void resetStats();
+
  private:
   struct Detail;
   std::unique_ptr<Detail> internals_;
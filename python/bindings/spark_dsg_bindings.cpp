@@ -796,7 +796,7 @@ PYBIND11_MODULE(_dsg_bindings, module) {
           "mesh",
           [](const DynamicSceneGraph& graph) { return graph.mesh(); },
           [](DynamicSceneGraph& graph, const Mesh::Ptr& mesh) { graph.setMesh(mesh); })
-      .def("clone", &DynamicSceneGraph::clone)
+      .def("clone", &DynamicSceneGraph::clone, "include_mesh"_a = true)
       .def("__deepcopy__",
            [](const DynamicSceneGraph& G, py::object) { return G.clone(); })
       .def(
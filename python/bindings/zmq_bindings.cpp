@@ -34,8 +34,11 @@
  * -------------------------------------------------------------------------- */
 #include "zmq_bindings.h"
 
+#include <pybind11/stl.h>
 #include <spark_dsg/zmq_interface.h>
 
+#include <sstream>
+
 using namespace spark_dsg;
 using namespace pybind11::literals;
 
@@ -43,29 +46,103 @@ namespace py = pybind11;
 
 #if INCLUDE_ZMQ()
 void add_zmq_bindings(pybind11::module_& module) {
+  py::class_<LogHistogram>(module, "LogHistogram")
+      .def_readonly("count", &LogHistogram::count)
+      .def_readonly("total", &LogHistogram::total)
+      .def_readonly("min", &LogHistogram::min)
+      .def_readonly("max", &LogHistogram::max)
+      .def_readonly("buckets", &LogHistogram::buckets)
+      .def_property_readonly("mean", &LogHistogram::mean)
+      .def("percentile", &LogHistogram::percentile, "fraction"_a)
+      .def_static("bucket_upper_bound", &LogHistogram::bucketUpperBound, "index"_a)
+      .def("__repr__", [](const LogHistogram& hist) {
+        std::stringstream ss;
+        ss << hist;
+        return ss.str();
+      });
+
+  py::class_<TransportStats>(module, "TransportStats")
+      .def_readonly("messages_sent", &TransportStats::messages_sent)
+      .def_readonly("messages_received", &TransportStats::messages_received)
+      .def_readonly("messages_dropped", &TransportStats::messages_dropped)
+      .def_readonly("bytes_sent", &TransportStats::bytes_sent)
+      .def_readonly("bytes_received", &TransportStats::bytes_received)
+      .def_readonly("serialize_us", &TransportStats::serialize_us)
+      .def_readonly("send_us", &TransportStats::send_us)
+      .def_readonly("recv_us", &TransportStats::recv_us)
+      .def_readonly("parse_us", &TransportStats::parse_us)
+      .def_readonly("latency_us", &TransportStats::latency_us)
+      .def_readonly("message_bytes", &TransportStats::message_bytes)
+      .def("__repr__", [](const TransportStats& stats) {
+        std::stringstream ss;
+        ss << stats;
+        return ss.str();
+      });
+
   py::class_<ZmqSender>(module, "DsgSender")
-      .def(py::init<const std::string&, size_t>(), "url"_a, "num_threads"_a = 1)
-      .def("send", &ZmqSender::send, "graph"_a, "include_mesh"_a = false);
+      .def(py::init<const std::string&, size_t, bool>(),
+           "url"_a,
+           "num_threads"_a = 1,
+           "layer_topics"_a = false)
+      .def("send", &ZmqSender::send, "graph"_a, "include_mesh"_a = false)
+      .def("send_async",
+           py::overload_cast<const DynamicSceneGraph&, bool>(&ZmqSender::sendAsync),
+           "graph"_a,
+           "include_mesh"_a = false)
+      .def("set_coalesce_window", &ZmqSender::setCoalesceWindow, "window_ms"_a)
+      .def("set_mesh_simplification",
+           &ZmqSender::setMeshSimplification,
+           "voxel_size"_a)
+      .def("flush", &ZmqSender::flush, py::call_guard<py::gil_scoped_release>())
+      .def("enable_stats", &ZmqSender::enableStats, "enable"_a = true)
+      .def("reset_stats", &ZmqSender::resetStats)
+      .def_property_readonly("stats", &ZmqSender::stats);
 
   py::class_<ZmqReceiver>(module, "DsgReceiver")
       .def(py::init<const std::string&, size_t>(), "url"_a, "num_threads"_a = 1)
+      .def(py::init<const std::string&,
+                    size_t,
+                    const std::vector<LayerId>&,
+                    bool,
+                    bool>(),
+           "url"_a,
+           "num_threads"_a,
+           "layers"_a,
+           "include_mesh"_a = false,
+           "conflate"_a = true)
       .def("recv", &ZmqReceiver::recv, "timeout_ms"_a, "recv_all"_a = false)
       .def_property_readonly("graph", [](const ZmqReceiver& receiver) {
         if (!receiver.graph()) {
           throw pybind11::value_error("no graph received yet");
         }
         return receiver.graph();
-      });
+      })
+      .def("enable_stats", &ZmqReceiver::enableStats, "enable"_a = true)
+      .def("reset_stats", &ZmqReceiver::resetStats)
+      .def_property_readonly("stats", &ZmqReceiver::stats);
 
   py::class_<ZmqGraph>(module, "ZmqGraph")
       .def(py::init<const std::string&, size_t, size_t>(),
            "url"_a,
            "num_threads"_a = 1,
            "poll_time_ms"_a = 100)
+      .def(py::init<const std::string&,
+                    size_t,
+                    const std::vector<LayerId>&,
+                    bool,
+                    size_t>(),
+           "url"_a,
+           "num_threads"_a,
+           "layers"_a,
+           "include_mesh"_a = false,
+           "poll_time_ms"_a = 100)
       .def_property_readonly(
           "has_change", [](const ZmqGraph& zmq_graph) { return zmq_graph.hasChange(); })
       .def_property_readonly(
-          "graph", [](const ZmqGraph& zmq_graph) { return zmq_graph.graph(); });
+          "graph", [](const ZmqGraph& zmq_graph) { return zmq_graph.graph(); })
+      .def("enable_stats", &ZmqGraph::enableStats, "enable"_a = true)
+      .def("reset_stats", &ZmqGraph::resetStats)
+      .def_property_readonly("stats", &ZmqGraph::stats);
 }
 #else
 void add_zmq_bindings(pybind11::module_&) {}
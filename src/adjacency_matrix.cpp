@@ -35,9 +35,26 @@
 #include "spark_dsg/adjacency_matrix.h"
 
 #include <Eigen/Dense>
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+#include "spark_dsg/node_symbol.h"
+#include "spark_dsg/parallel_blocks.h"
 
 namespace spark_dsg {
 
+namespace {
+
+// number of rows or columns claimed by a thread at a time
+constexpr size_t BLOCK_SIZE = 1024;
+
+inline double attributeWeight(const EdgeAttributes* attrs) {
+  return (attrs && attrs->weighted) ? attrs->weight : 1.0;
+}
+
+}  // namespace
+
 // TODO(nathan) think about revising this API
 // TODO(nathan) think about verifying ordering (to check for duplicates)
 Eigen::MatrixXd getAdjacencyMatrix(const SceneGraphLayer& layer,
@@ -144,4 +161,170 @@ SparseMatrixXd getSparseLaplacian(const SceneGraphLayer& layer,
   return L;
 }
 
+SparseMatrixBuilder::SparseMatrixBuilder(const SceneGraphLayer& layer,
+                                         size_t num_threads)
+    : layer_(layer), num_threads_(num_threads), ascending_order_(true) {
+  update();
+}
+
+SparseMatrixBuilder::SparseMatrixBuilder(const SceneGraphLayer& layer,
+                                         const std::vector<NodeId>& ordering,
+                                         size_t num_threads)
+    : layer_(layer),
+      num_threads_(num_threads),
+      ascending_order_(false),
+      nodes_(ordering) {
+  update();
+}
+
+void SparseMatrixBuilder::update() {
+  if (ascending_order_) {
+    nodes_.clear();
+    nodes_.reserve(layer_.numNodes());
+    for (const auto& id_node_pair : layer_.nodes()) {
+      nodes_.push_back(id_node_pair.first);
+    }
+  }
+
+  const size_t num_nodes = nodes_.size();
+  indices_.clear();
+  indices_.reserve(num_nodes);
+  for (size_t i = 0; i < num_nodes; ++i) {
+    if (!indices_.emplace(nodes_[i], i).second) {
+      std::stringstream ss;
+      ss << "duplicate node " << NodeSymbol(nodes_[i]).getLabel() << " in ordering";
+      throw std::invalid_argument(ss.str());
+    }
+  }
+
+  // count the entries of every column first so that columns can be filled in parallel
+  outer_.assign(num_nodes + 1, 0);
+  detail::parallelFor(num_nodes, BLOCK_SIZE, num_threads_, [&](size_t i) {
+    const auto node = layer_.findNode(nodes_[i]);
+    if (!node) {
+      return;
+    }
+
+    int count = 0;
+    for (const auto sibling : node->siblings()) {
+      count += indices_.count(sibling);
+    }
+    outer_[i + 1] = count;
+  });
+
+  for (size_t i = 0; i < num_nodes; ++i) {
+    outer_[i + 1] += outer_[i];
+  }
+
+  inner_.resize(outer_.back());
+  edges_.resize(outer_.back());
+  upper_.assign(num_nodes, 0);
+  detail::parallelFor(num_nodes, BLOCK_SIZE, num_threads_, [&](size_t i) {
+    const auto node = layer_.findNode(nodes_[i]);
+    if (!node) {
+      return;
+    }
+
+    const auto begin = inner_.begin() + outer_[i];
+    const auto end = inner_.begin() + outer_[i + 1];
+    auto iter = begin;
+    for (const auto sibling : node->siblings()) {
+      const auto index = indices_.find(sibling);
+      if (index != indices_.end()) {
+        *iter++ = index->second;
+      }
+    }
+
+    // siblings are sorted by id, which only matches the index order by default
+    if (!ascending_order_) {
+      std::sort(begin, end);
+    }
+
+    for (auto entry = begin; entry != end; ++entry) {
+      const auto edge = layer_.findEdge(nodes_[i], nodes_[*entry]);
+      edges_[entry - inner_.begin()] = edge->info.get();
+    }
+
+    upper_[i] = std::lower_bound(begin, end, static_cast<int>(i)) - begin;
+  });
+}
+
+size_t SparseMatrixBuilder::index(NodeId node) const {
+  const auto iter = indices_.find(node);
+  if (iter == indices_.end()) {
+    std::stringstream ss;
+    ss << "node " << NodeSymbol(node).getLabel() << " not indexed";
+    throw std::out_of_range(ss.str());
+  }
+
+  return iter->second;
+}
+
+template <typename Func>
+SparseMatrixXd SparseMatrixBuilder::build(bool laplacian,
+                                          const Func& weight_func) const {
+  const int num_nodes = nodes_.size();
+  SparseMatrixXd matrix(num_nodes, num_nodes);
+  matrix.resizeNonZeros(inner_.size() + (laplacian ? num_nodes : 0));
+
+  auto outer = matrix.outerIndexPtr();
+  auto inner = matrix.innerIndexPtr();
+  auto values = matrix.valuePtr();
+  for (int i = 0; i <= num_nodes; ++i) {
+    outer[i] = outer_[i] + (laplacian ? i : 0);
+  }
+
+  detail::parallelFor(num_nodes, BLOCK_SIZE, num_threads_, [&](size_t col) {
+    int dest = outer[col];
+    double degree = 0.0;
+    for (int k = outer_[col]; k < outer_[col + 1]; ++k) {
+      if (laplacian && k - outer_[col] == upper_[col]) {
+        ++dest;  // reserve the diagonal entry
+      }
+
+      const double weight = weight_func(k, inner_[k], col);
+      inner[dest] = inner_[k];
+      values[dest] = laplacian ? -weight : weight;
+      degree += weight;
+      ++dest;
+    }
+
+    if (laplacian) {
+      const int diagonal = outer[col] + upper_[col];
+      inner[diagonal] = col;
+      values[diagonal] = degree;
+    }
+  });
+
+  return matrix;
+}
+
+SparseMatrixXd SparseMatrixBuilder::adjacency(EdgeWeight weight) const {
+  if (weight == EdgeWeight::UNIT) {
+    return build(false, [](int, int, int) { return 1.0; });
+  }
+
+  return build(false, [&](int k, int, int) { return attributeWeight(edges_[k]); });
+}
+
+SparseMatrixXd SparseMatrixBuilder::adjacency(const WeightFunc& weight_func) const {
+  return build(false, [&](int, int row, int col) {
+    return weight_func(nodes_[row], nodes_[col]);
+  });
+}
+
+SparseMatrixXd SparseMatrixBuilder::laplacian(EdgeWeight weight) const {
+  if (weight == EdgeWeight::UNIT) {
+    return build(true, [](int, int, int) { return 1.0; });
+  }
+
+  return build(true, [&](int k, int, int) { return attributeWeight(edges_[k]); });
+}
+
+SparseMatrixXd SparseMatrixBuilder::laplacian(const WeightFunc& weight_func) const {
+  return build(true, [&](int, int row, int col) {
+    return weight_func(nodes_[row], nodes_[col]);
+  });
+}
+
 }  // namespace spark_dsg
@@ -0,0 +1,401 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "spark_dsg/blocked_mesh.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+
+#include "spark_dsg/serialization/binary_conversions.h"
+
+namespace spark_dsg {
+
+using BlockIndex = BlockedMesh::BlockIndex;
+using BlockIndices = BlockedMesh::BlockIndices;
+
+namespace {
+
+// keeps block indices well inside the range of an int for far-away positions
+constexpr double MAX_BLOCK_INDEX = 1.0e9;
+
+inline bool indexLess(const BlockIndex& lhs, const BlockIndex& rhs) {
+  return std::lexicographical_compare(
+      lhs.data(), lhs.data() + 3, rhs.data(), rhs.data() + 3);
+}
+
+void appendVertex(const Mesh& from, size_t index, Mesh& to) {
+  to.points.push_back(from.points[index]);
+  if (index < from.colors.size()) {
+    to.colors.push_back(from.colors[index]);
+  }
+  if (index < from.stamps.size()) {
+    to.stamps.push_back(from.stamps[index]);
+  }
+  if (index < from.first_seen_stamps.size()) {
+    to.first_seen_stamps.push_back(from.first_seen_stamps[index]);
+  }
+  if (index < from.labels.size()) {
+    to.labels.push_back(from.labels[index]);
+  }
+}
+
+}  // namespace
+
+BlockedMesh::Block::Block(const BlockIndex& index, const Mesh& mesh)
+    : index(index), mesh(mesh) {}
+
+size_t BlockedMesh::BlockHash::operator()(const BlockIndex& index) const {
+  // same spatial hash as the spatial index (Teschner et al., 2003)
+  return static_cast<size_t>(index.x()) * 73856093 ^
+         static_cast<size_t>(index.y()) * 19349663 ^
+         static_cast<size_t>(index.z()) * 83492791;
+}
+
+BlockedMesh::BlockedMesh(float block_size,
+                         bool has_colors,
+                         bool has_timestamps,
+                         bool has_labels,
+                         bool has_first_seen_stamps)
+    : has_colors(has_colors),
+      has_timestamps(has_timestamps),
+      has_labels(has_labels),
+      has_first_seen_stamps(has_first_seen_stamps),
+      block_size_(block_size) {
+  if (!(block_size_ > 0.0f)) {
+    std::stringstream ss;
+    ss << "invalid mesh block size: " << block_size;
+    throw std::invalid_argument(ss.str());
+  }
+}
+
+BlockedMesh BlockedMesh::fromMesh(const Mesh& mesh, float block_size) {
+  BlockedMesh result(block_size,
+                     mesh.has_colors,
+                     mesh.has_timestamps,
+                     mesh.has_labels,
+                     mesh.has_first_seen_stamps);
+  const Mesh prototype(mesh.has_colors,
+                       mesh.has_timestamps,
+                       mesh.has_labels,
+                       mesh.has_first_seen_stamps);
+
+  // assign vertices to blocks (consecutive vertices are usually in the same block)
+  const size_t num_vertices = mesh.numVertices();
+  std::vector<Block*> vertex_blocks(num_vertices, nullptr);
+  std::vector<size_t> local_indices(num_vertices);
+  Block* block = nullptr;
+  for (size_t i = 0; i < num_vertices; ++i) {
+    const auto index = result.blockIndex(mesh.points[i]);
+    if (!block || block->index != index) {
+      auto iter = result.blocks_.find(index);
+      if (iter == result.blocks_.end()) {
+        iter = result.blocks_.emplace(index, Block(index, prototype)).first;
+      }
+      block = &iter->second;
+    }
+
+    vertex_blocks[i] = block;
+    local_indices[i] = block->vertex_indices.size();
+    appendVertex(mesh, i, block->mesh);
+    block->vertex_indices.push_back(i);
+  }
+
+  result.vertex_slots_.assign(num_vertices, -1);
+  for (auto& [index, block] : result.blocks_) {
+    block.num_owned = block.vertex_indices.size();
+    result.indexBlock(block);
+  }
+
+  // assign faces to the block of their first vertex, copying vertices if necessary
+  std::unordered_map<Block*, std::unordered_map<size_t, size_t>> copies;
+  for (size_t f = 0; f < mesh.numFaces(); ++f) {
+    const auto& face = mesh.faces[f];
+    if (face[0] >= num_vertices || face[1] >= num_vertices ||
+        face[2] >= num_vertices) {
+      continue;
+    }
+
+    Block* owner = vertex_blocks[face[0]];
+    Mesh::Face local_face;
+    for (size_t k = 0; k < 3; ++k) {
+      const size_t vertex = face[k];
+      if (vertex_blocks[vertex] == owner) {
+        local_face[k] = local_indices[vertex];
+        continue;
+      }
+
+      auto& block_copies = copies[owner];
+      const auto [iter, inserted] =
+          block_copies.emplace(vertex, owner->vertex_indices.size());
+      if (inserted) {
+        appendVertex(mesh, vertex, owner->mesh);
+        owner->vertex_indices.push_back(vertex);
+      }
+
+      local_face[k] = iter->second;
+    }
+
+    owner->mesh.faces.push_back(local_face);
+    owner->face_indices.push_back(f);
+  }
+
+  for (auto& [index, block] : result.blocks_) {
+    block.bounds = block.mesh.bounds();
+  }
+
+  return result;
+}
+
+Mesh BlockedMesh::toMesh() const { return extract(blockIndices()); }
+
+Mesh BlockedMesh::extract(const BlockIndices& blocks) const {
+  struct Element {
+    size_t global;
+    const Block* block;
+    size_t local;
+    bool operator<(const Element& other) const { return global < other.global; }
+  };
+
+  std::vector<Element> vertices;
+  std::vector<Element> faces;
+  for (const auto& index : blocks) {
+    auto iter = blocks_.find(index);
+    if (iter == blocks_.end()) {
+      continue;
+    }
+
+    const auto& block = iter->second;
+    for (size_t i = 0; i < block.vertex_indices.size(); ++i) {
+      vertices.push_back({block.vertex_indices[i], &block, i});
+    }
+    for (size_t i = 0; i < block.face_indices.size(); ++i) {
+      faces.push_back({block.face_indices[i], &block, i});
+    }
+  }
+
+  // copies of a vertex hold the same values as the original, so any one of them works
+  std::sort(vertices.begin(), vertices.end());
+  const auto last = std::unique(
+      vertices.begin(), vertices.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.global == rhs.global;
+      });
+  vertices.erase(last, vertices.end());
+  std::sort(faces.begin(), faces.end());
+
+  Mesh result(has_colors, has_timestamps, has_labels, has_first_seen_stamps);
+  result.points.reserve(vertices.size());
+  for (const auto& vertex : vertices) {
+    appendVertex(vertex.block->mesh, vertex.local, result);
+  }
+
+  result.faces.reserve(faces.size());
+  for (const auto& face : faces) {
+    const auto& local_face = face.block->mesh.faces[face.local];
+    Mesh::Face new_face;
+    for (size_t k = 0; k < 3; ++k) {
+      const Element key{face.block->vertex_indices[local_face[k]], nullptr, 0};
+      const auto iter = std::lower_bound(vertices.begin(), vertices.end(), key);
+      new_face[k] = iter - vertices.begin();
+    }
+    result.faces.push_back(new_face);
+  }
+
+  return result;
+}
+
+bool BlockedMesh::hasBlock(const BlockIndex& index) const {
+  return blocks_.count(index);
+}
+
+const BlockedMesh::Block& BlockedMesh::block(const BlockIndex& index) const {
+  auto iter = blocks_.find(index);
+  if (iter == blocks_.end()) {
+    std::stringstream ss;
+    ss << "missing mesh block [" << index.transpose() << "]";
+    throw std::out_of_range(ss.str());
+  }
+
+  return iter->second;
+}
+
+BlockIndices BlockedMesh::blockIndices() const {
+  BlockIndices indices;
+  indices.reserve(blocks_.size());
+  for (const auto& [index, block] : blocks_) {
+    indices.push_back(index);
+  }
+
+  std::sort(indices.begin(), indices.end(), indexLess);
+  return indices;
+}
+
+BlockIndex BlockedMesh::blockIndex(const Mesh::Pos& pos) const {
+  // NaN survives the clamp below and casting it to int is undefined
+  if (!pos.allFinite()) {
+    std::stringstream ss;
+    ss << "cannot assign non-finite position to a mesh block: " << pos.transpose();
+    throw std::invalid_argument(ss.str());
+  }
+
+  BlockIndex index;
+  for (int i = 0; i < 3; ++i) {
+    const double value = std::floor(static_cast<double>(pos(i)) / block_size_);
+    index(i) = static_cast<int>(std::clamp(value, -MAX_BLOCK_INDEX, MAX_BLOCK_INDEX));
+  }
+  return index;
+}
+
+BlockIndices BlockedMesh::blocksIntersecting(const Eigen::AlignedBox3f& box) const {
+  BlockIndices indices;
+  for (const auto& [index, block] : blocks_) {
+    if (!block.bounds.isEmpty() && block.bounds.intersects(box)) {
+      indices.push_back(index);
+    }
+  }
+
+  std::sort(indices.begin(), indices.end(), indexLess);
+  return indices;
+}
+
+BlockIndices BlockedMesh::blocksForVertices(const std::vector<size_t>& vertices) const {
+  BlockIndices indices;
+  for (const auto vertex : vertices) {
+    if (vertex < vertex_slots_.size() && vertex_slots_[vertex] >= 0) {
+      indices.push_back(slot_blocks_[vertex_slots_[vertex]]);
+    }
+  }
+
+  std::sort(indices.begin(), indices.end(), indexLess);
+  indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+  return indices;
+}
+
+void BlockedMesh::insertBlock(Block block) {
+  eraseBlock(block.index);
+  indexBlock(block);
+  block.bounds = block.mesh.bounds();
+  const BlockIndex index = block.index;
+  blocks_.emplace(index, std::move(block));
+}
+
+bool BlockedMesh::eraseBlock(const BlockIndex& index) {
+  auto iter = blocks_.find(index);
+  if (iter == blocks_.end()) {
+    return false;
+  }
+
+  auto slot_iter = block_slots_.find(index);
+  const int32_t slot = slot_iter->second;
+  const auto& block = iter->second;
+  const size_t num_owned = std::min(block.num_owned, block.vertex_indices.size());
+  for (size_t i = 0; i < num_owned; ++i) {
+    const size_t vertex = block.vertex_indices[i];
+    if (vertex < vertex_slots_.size() && vertex_slots_[vertex] == slot) {
+      vertex_slots_[vertex] = -1;
+    }
+  }
+
+  free_slots_.push_back(slot);
+  block_slots_.erase(slot_iter);
+  blocks_.erase(iter);
+  return true;
+}
+
+void BlockedMesh::indexBlock(const Block& block) {
+  int32_t slot;
+  if (free_slots_.empty()) {
+    slot = static_cast<int32_t>(slot_blocks_.size());
+    slot_blocks_.push_back(block.index);
+  } else {
+    slot = free_slots_.back();
+    free_slots_.pop_back();
+    slot_blocks_[slot] = block.index;
+  }
+
+  block_slots_[block.index] = slot;
+  const size_t num_owned = std::min(block.num_owned, block.vertex_indices.size());
+  for (size_t i = 0; i < num_owned; ++i) {
+    const size_t vertex = block.vertex_indices[i];
+    if (vertex >= vertex_slots_.size()) {
+      vertex_slots_.resize(vertex + 1, -1);
+    }
+
+    vertex_slots_[vertex] = slot;
+  }
+}
+
+void BlockedMesh::serializeBlock(const BlockIndex& index,
+                                 std::vector<uint8_t>& buffer) const {
+  const auto& to_write = block(index);
+  serialization::BinarySerializer serializer(&buffer);
+  serializer.write(block_size_);
+  serializer.write(to_write.index.x());
+  serializer.write(to_write.index.y());
+  serializer.write(to_write.index.z());
+  serializer.write(static_cast<uint64_t>(to_write.num_owned));
+  serializer.write(to_write.vertex_indices);
+  serializer.write(to_write.face_indices);
+  serializer.write(to_write.mesh);
+}
+
+BlockIndex BlockedMesh::insertBlockFromBinary(const uint8_t* const buffer,
+                                              size_t length) {
+  serialization::BinaryDeserializer deserializer(buffer, length);
+  float block_size;
+  deserializer.read(block_size);
+  if (block_size != block_size_) {
+    std::stringstream ss;
+    ss << "mesh block size " << block_size << " does not match " << block_size_;
+    throw std::invalid_argument(ss.str());
+  }
+
+  Block block;
+  deserializer.read(block.index.x());
+  deserializer.read(block.index.y());
+  deserializer.read(block.index.z());
+  uint64_t num_owned;
+  deserializer.read(num_owned);
+  block.num_owned = num_owned;
+  deserializer.read(block.vertex_indices);
+  deserializer.read(block.face_indices);
+  deserializer.read(block.mesh);
+
+  const BlockIndex index = block.index;
+  insertBlock(std::move(block));
+  return index;
+}
+
+}  // namespace spark_dsg
@@ -76,11 +76,11 @@ BoundingBox::BoundingBox(const PointAdaptor& points, BoundingBox::Type type) {
 
 BoundingBox::BoundingBox(const std::vector<Eigen::Vector3f>& points,
                          BoundingBox::Type type) {
-  *this = bounding_box::extract(PointVectorAdaptor(points), type);
+  *this = bounding_box::extract(points.data(), points.size(), type);
 }
 
 BoundingBox::BoundingBox(const Mesh& mesh, BoundingBox::Type type) {
-  *this = bounding_box::extract(MeshAdaptor(mesh), type);
+  *this = bounding_box::extract(mesh, type);
 }
 
 bool BoundingBox::isValid() const {
@@ -173,8 +173,7 @@ void BoundingBox::mergeGeneral(const BoundingBox& other) {
   }
 
   // Compute the new bounding box of the same type.
-  PointVectorAdaptor adaptor(points);
-  *this = bounding_box::extract(adaptor, type);
+  *this = bounding_box::extract(points.data(), points.size(), type);
 }
 
 Eigen::Vector3f BoundingBox::pointToWorldFrame(const Eigen::Vector3f& point_B) const {
@@ -34,88 +34,128 @@
  * -------------------------------------------------------------------------- */
 #include "spark_dsg/bounding_box_extraction.h"
 
+#include <algorithm>
 #include <optional>
+#include <sstream>
+#include <stdexcept>
 
 namespace spark_dsg {
 namespace bounding_box {
 
-float getAngle(const Eigen::Vector3f& curr, const Eigen::Vector3f& root) {
-  const Eigen::Vector2f vec = (curr.head<2>() - root.head<2>()).normalized();
-  // range of x should be between 1 and -1 (with y >= 0)
-  // we want function mapping [1, -1] to [0, c]
-  return 1.0f - vec.x();
-}
+namespace {
 
-float getDist(const Eigen::Vector3f& curr, const Eigen::Vector3f& root) {
-  return (curr.head<2>() - root.head<2>()).array().abs().sum();
-}
+// non-virtual point accessors for the templated kernels (PointAdaptor also works)
+struct ContiguousPoints {
+  size_t size() const { return num_points; }
+  const Eigen::Vector3f& operator[](size_t index) const { return points[index]; }
+  const Eigen::Vector3f* points;
+  size_t num_points;
+};
 
-float getJointDirection(const Eigen::Vector3f& prev,
-                        const Eigen::Vector3f& curr,
-                        const Eigen::Vector3f& next) {
-  const Eigen::Vector2f v1 = curr.head<2>() - prev.head<2>();
-  const Eigen::Vector2f v2 = next.head<2>() - prev.head<2>();
-  return v1.x() * v2.y() - v1.y() * v2.x();
-}
+struct IndexedPoints {
+  size_t size() const { return indices.size(); }
+  const Eigen::Vector3f& operator[](size_t index) const {
+    return points[indices[index]];
+  }
+  const Eigen::Vector3f* points;
+  const std::vector<size_t>& indices;
+};
 
-std::list<size_t> get2dConvexHull(const PointAdaptor& points) {
-  size_t root = 0;
-  Eigen::Vector3f root_pos = points[0];
-  for (size_t i = 0; i < points.size(); ++i) {
-    const auto curr_pos = points[i];
-    if (curr_pos.y() > root_pos.y()) {
-      continue;
+void checkIndices(size_t num_points, const std::vector<size_t>& indices) {
+  for (const auto index : indices) {
+    if (index >= num_points) {
+      std::stringstream ss;
+      ss << "point index " << index << " out of range [0, " << num_points << ")";
+      throw std::out_of_range(ss.str());
     }
+  }
+}
 
-    if (curr_pos.y() == root_pos.y() && curr_pos.x() > root_pos.x()) {
-      continue;
-    }
+}  // namespace
 
-    root_pos = curr_pos;
-    root = i;
-  }
-
-  const auto compare = [&](size_t i, size_t j) -> bool {
-    const auto p_i = points[i];
-    const auto p_j = points[j];
-    const auto a_i = getAngle(p_i, root_pos);
-    const auto a_j = getAngle(p_j, root_pos);
-    if (std::abs(a_i - a_j) < 1.0e-9f) {
-      const auto d_i = getDist(p_i, root_pos);
-      const auto d_j = getDist(p_j, root_pos);
-      return d_i < d_j;
-    } else {
-      return a_i < a_j;
-    }
-  };
+struct HullPoint {
+  float x;
+  float y;
+  size_t index;
 
-  std::vector<size_t> indices;
-  for (size_t i = 0; i < points.size(); ++i) {
-    if (i != root) {
-      indices.push_back(i);
+  Eigen::Vector2f pos() const { return Eigen::Vector2f(x, y); }
+
+  bool operator<(const HullPoint& other) const {
+    if (x != other.x) {
+      return x < other.x;
     }
+
+    return y != other.y ? y < other.y : index < other.index;
   }
+};
 
-  std::sort(indices.begin(), indices.end(), compare);
+// positive if o -> a -> b turns counter-clockwise
+inline float cross(const HullPoint& o, const HullPoint& a, const HullPoint& b) {
+  return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+}
 
-  std::list<size_t> hull{root};
-  for (const auto& idx : indices) {
-    while (hull.size() > 1) {
-      auto prev = --hull.cend();
-      auto curr = prev;
-      --curr;
-      const auto angle = getJointDirection(points[*prev], points[*curr], points[idx]);
-      if (angle < 0.0f) {
-        break;
-      }
+// start the hull at the point with the lowest y (and then x) coordinate
+std::vector<HullPoint> rotateToLowest(std::vector<HullPoint>&& hull) {
+  const auto lowest = std::min_element(
+      hull.begin(), hull.end(), [](const HullPoint& a, const HullPoint& b) {
+        return a.y != b.y ? a.y < b.y : a.x < b.x;
+      });
+  std::rotate(hull.begin(), lowest, hull.end());
+  return std::move(hull);
+}
+
+/**
+ * @brief Andrew's monotone chain over the x-y projection of the points
+ *
+ * Points are projected into a contiguous array once and sorted lexicographically.
+ * The hull is returned in ccw order (without collinear points), starting from the
+ * point with the lowest y (and then x) coordinate.
+ */
+template <typename Points>
+std::vector<HullPoint> get2dConvexHullPoints(const Points& points) {
+  const size_t num_points = points.size();
+  std::vector<HullPoint> sorted(num_points);
+  for (size_t i = 0; i < num_points; ++i) {
+    const Eigen::Vector3f& point = points[i];
+    sorted[i] = {point.x(), point.y(), i};
+  }
+
+  std::sort(sorted.begin(), sorted.end());
+  if (num_points < 3) {
+    return rotateToLowest(std::move(sorted));
+  }
 
-      hull.pop_back();
+  // lower chain left to right, then upper chain right to left
+  std::vector<HullPoint> hull(2 * num_points);
+  size_t k = 0;
+  for (size_t i = 0; i < num_points; ++i) {
+    while (k >= 2 && cross(hull[k - 2], hull[k - 1], sorted[i]) <= 0.0f) {
+      --k;
     }
+    hull[k++] = sorted[i];
+  }
 
-    hull.push_back(idx);
+  const size_t lower_size = k + 1;
+  for (size_t i = num_points - 1; i-- > 0;) {
+    while (k >= lower_size && cross(hull[k - 2], hull[k - 1], sorted[i]) <= 0.0f) {
+      --k;
+    }
+    hull[k++] = sorted[i];
   }
 
-  return hull;
+  // the last point is the first point of the lower chain
+  hull.resize(k > 1 ? k - 1 : k);
+  return rotateToLowest(std::move(hull));
+}
+
+std::vector<size_t> get2dConvexHull(const PointAdaptor& points) {
+  const auto hull = get2dConvexHullPoints(points);
+  std::vector<size_t> indices(hull.size());
+  for (size_t i = 0; i < hull.size(); ++i) {
+    indices[i] = hull[i].index;
+  }
+
+  return indices;
 }
 
 struct BoxResult2D {
@@ -125,43 +165,65 @@ struct BoxResult2D {
   float yaw = 0.0f;
 };
 
-BoxResult2D getMin2DBox(const PointAdaptor& points, const std::list<size_t>& hull) {
+/**
+ * @brief Minimum-area rectangle containing the hull via rotating calipers
+ *
+ * One side of the rectangle lies on a hull edge. For each edge, the extreme hull
+ * points along the edge normal and in both directions along the edge only move
+ * forward around the hull, so every edge is checked in amortized constant time.
+ */
+BoxResult2D getMin2DBox(const std::vector<HullPoint>& hull) {
   BoxResult2D result;
-  std::vector<size_t> indices(hull.begin(), hull.end());
-  // technically this can be implemented in O(n) instead via rotation calipers,
-  // but this is easier to understand and n << points.size() due to 2d projection
-  for (size_t i = 0; i < indices.size(); ++i) {
-    const auto curr_idx = indices[i];
-    const auto next_idx = indices[(i + 1) % indices.size()];
-    const Eigen::Vector2f x_c = points[curr_idx].head<2>();
-    const Eigen::Vector2f x_n = points[next_idx].head<2>();
+  const size_t num_hull = hull.size();
+  if (num_hull == 0) {
+    return result;
+  }
+
+  const auto pos = [&](size_t i) { return hull[i % num_hull].pos(); };
+  // advance an index while the next hull point is further along the direction
+  const auto advance = [&](size_t& idx, const Eigen::Vector2f& dir) {
+    for (size_t step = 0; step < num_hull; ++step) {
+      if (dir.dot(pos(idx + 1)) <= dir.dot(pos(idx))) {
+        break;
+      }
+
+      idx = (idx + 1) % num_hull;
+    }
+  };
+
+  size_t w_idx = 0;
+  size_t h_max_idx = 0;
+  size_t h_min_idx = 0;
+  for (size_t i = 0; i < num_hull; ++i) {
+    const Eigen::Vector2f x_c = pos(i);
+    const Eigen::Vector2f x_n = pos(i + 1);
     // normals and offsets for height / width hyperplanes
     const Eigen::Vector2f n_h = (x_n - x_c).normalized();
     const Eigen::Vector2f n_w(-n_h.y(), n_h.x());  // equivalent to a 90 degree rotation
     const auto b_w = -n_w.dot(x_c);
     const auto b_h = -n_h.dot(x_c);
 
-    // distances from hyperplanes
-    float max_w = 0.0f;
-    float min_h = 0.0f;
-    float max_h = 0.0f;
-    for (size_t j = 1; j < indices.size(); ++j) {
-      const Eigen::Vector2f x_j = points[indices[(i + j) % indices.size()]].head<2>();
-      const auto w_dist = n_w.dot(x_j) + b_w;
-      const auto h_dist = n_h.dot(x_j) + b_h;
-      if (w_dist >= max_w) {
-        max_w = w_dist;
-      }
-
-      if (h_dist <= min_h) {
-        min_h = h_dist;
-      }
+    // in ccw order: edge, furthest along the edge, furthest from the edge, furthest
+    // behind the edge (the minimum along the edge is found by starting past the
+    // point furthest from the edge)
+    if (i == 0) {
+      w_idx = 1 % num_hull;
+      h_max_idx = 1 % num_hull;
+    }
 
-      if (h_dist >= max_h) {
-        max_h = h_dist;
-      }
+    advance(h_max_idx, n_h);
+    advance(w_idx, n_w);
+    if (i == 0) {
+      h_min_idx = w_idx;
     }
 
+    advance(h_min_idx, -n_h);
+
+    // distances from hyperplanes (the current edge point has distance zero)
+    const float max_w = std::max(0.0f, n_w.dot(pos(w_idx)) + b_w);
+    const float min_h = std::min(0.0f, n_h.dot(pos(h_min_idx)) + b_h);
+    const float max_h = std::max(0.0f, n_h.dot(pos(h_max_idx)) + b_h);
+
     // technically (max_w - min_w) * (max_h - min_h) but min_w is 0
     const auto area = max_w * (max_h - min_h);
     if (result.min_area && area >= *result.min_area) {
@@ -186,32 +248,73 @@ BoxResult2D getMin2DBox(const PointAdaptor& points, const std::list<size_t>& hul
   return result;
 }
 
-BoundingBox extractAABB(const PointAdaptor& points) {
-  Eigen::Vector3f min = points[0];
-  Eigen::Vector3f max = min;
+template <typename Points>
+void getBounds(const Points& points, Eigen::Vector3f& min, Eigen::Vector3f& max) {
+  min = points[0];
+  max = min;
   for (size_t i = 1; i < points.size(); ++i) {
-    min = min.array().min(points[i].array());
-    max = max.array().max(points[i].array());
+    const Eigen::Vector3f& point = points[i];
+    min = min.cwiseMin(point);
+    max = max.cwiseMax(point);
   }
+}
+
+void getBounds(const ContiguousPoints& points,
+               Eigen::Vector3f& min,
+               Eigen::Vector3f& max) {
+  // reduce four points at a time as a single 12-float array (vectorized by eigen)
+  using Block = Eigen::Array<float, 12, 1>;
+  const size_t num_points = points.size();
+  min = points[0];
+  max = min;
+  size_t i = 0;
+  if (num_points >= 4) {
+    Block block_min = Eigen::Map<const Block>(points[0].data());
+    Block block_max = block_min;
+    for (i = 4; i + 4 <= num_points; i += 4) {
+      const Eigen::Map<const Block> block(points[i].data());
+      block_min = block_min.min(block);
+      block_max = block_max.max(block);
+    }
+
+    for (size_t k = 0; k < 4; ++k) {
+      min = min.cwiseMin(block_min.segment<3>(3 * k).matrix());
+      max = max.cwiseMax(block_max.segment<3>(3 * k).matrix());
+    }
+  }
+
+  for (; i < num_points; ++i) {
+    min = min.cwiseMin(points[i]);
+    max = max.cwiseMax(points[i]);
+  }
+}
+
+template <typename Points>
+BoundingBox extractAABB(const Points& points) {
+  Eigen::Vector3f min;
+  Eigen::Vector3f max;
+  getBounds(points, min, max);
   return BoundingBox(max - min, (min + max) / 2.0f);
 }
 
-BoundingBox extractOBB(const PointAdaptor&) { return {}; }
+template <typename Points>
+BoundingBox extractOBB(const Points&) {
+  return {};
+}
 
-BoundingBox extractRAABB(const PointAdaptor& points) {
-  auto hull = get2dConvexHull(points);
-  const auto min_2d_box = getMin2DBox(points, hull);
+template <typename Points>
+BoundingBox extractRAABB(const Points& points) {
+  const auto hull = get2dConvexHullPoints(points);
+  const auto min_2d_box = getMin2DBox(hull);
   if (!min_2d_box.min_area) {
     return {};
   }
 
-  float min_z = points[0].z();
-  float max_z = min_z;
-  for (size_t i = 1; i < points.size(); ++i) {
-    const auto curr_z = points[i].z();
-    min_z = std::min(curr_z, min_z);
-    max_z = std::max(curr_z, max_z);
-  }
+  Eigen::Vector3f bounds_min;
+  Eigen::Vector3f bounds_max;
+  getBounds(points, bounds_min, bounds_max);
+  const float min_z = bounds_min.z();
+  const float max_z = bounds_max.z();
 
   const auto& yaw = min_2d_box.yaw;
   Eigen::Vector3f p_min;
@@ -224,7 +327,8 @@ BoundingBox extractRAABB(const PointAdaptor& points) {
   return result;
 }
 
-BoundingBox extract(const PointAdaptor& points, BoundingBox::Type type) {
+template <typename Points>
+BoundingBox extractImpl(const Points& points, BoundingBox::Type type) {
   if (points.size() == 0 || type == BoundingBox::Type::INVALID) {
     return {};
   }
@@ -241,6 +345,45 @@ BoundingBox extract(const PointAdaptor& points, BoundingBox::Type type) {
   }
 }
 
+BoundingBox extract(const PointAdaptor& points, BoundingBox::Type type) {
+  // skip the virtual interface for adaptors over contiguous points
+  if (const auto mesh = dynamic_cast<const BoundingBox::MeshAdaptor*>(&points)) {
+    return mesh->indices ? extract(mesh->mesh, *mesh->indices, type)
+                         : extract(mesh->mesh, type);
+  }
+
+  using VectorAdaptor = BoundingBox::PointVectorAdaptor;
+  if (const auto cloud = dynamic_cast<const VectorAdaptor*>(&points)) {
+    return extract(cloud->points.data(), cloud->points.size(), type);
+  }
+
+  return extractImpl(points, type);
+}
+
+BoundingBox extract(const Eigen::Vector3f* points,
+                    size_t num_points,
+                    BoundingBox::Type type) {
+  return extractImpl(ContiguousPoints{points, num_points}, type);
+}
+
+BoundingBox extract(const Eigen::Vector3f* points,
+                    size_t num_points,
+                    const std::vector<size_t>& indices,
+                    BoundingBox::Type type) {
+  checkIndices(num_points, indices);
+  return extractImpl(IndexedPoints{points, indices}, type);
+}
+
+BoundingBox extract(const Mesh& mesh, BoundingBox::Type type) {
+  return extract(mesh.points.data(), mesh.points.size(), type);
+}
+
+BoundingBox extract(const Mesh& mesh,
+                    const std::vector<size_t>& indices,
+                    BoundingBox::Type type) {
+  return extract(mesh.points.data(), mesh.points.size(), indices, type);
+}
+
 }  // namespace bounding_box
 
 }  // namespace spark_dsg
@@ -0,0 +1,394 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "spark_dsg/bounding_box_index.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace spark_dsg {
+
+BoundingBoxIndex::Volume BoundingBoxIndex::Volume::fromBox(const BoundingBox& box) {
+  if (box.type == BoundingBox::Type::AABB) {
+    return {box.world_P_center - box.dimensions / 2,
+            box.world_P_center + box.dimensions / 2};
+  }
+
+  const auto corners = box.corners();
+  Volume volume{corners[0], corners[0]};
+  for (const auto& corner : corners) {
+    volume.min = volume.min.cwiseMin(corner);
+    volume.max = volume.max.cwiseMax(corner);
+  }
+
+  return volume;
+}
+
+BoundingBoxIndex::Volume BoundingBoxIndex::Volume::merged(const Volume& other) const {
+  return {min.cwiseMin(other.min), max.cwiseMax(other.max)};
+}
+
+float BoundingBoxIndex::Volume::area() const {
+  const Eigen::Vector3f size = max - min;
+  return size.x() * size.y() + size.y() * size.z() + size.z() * size.x();
+}
+
+float BoundingBoxIndex::Volume::volume() const { return (max - min).prod(); }
+
+bool BoundingBoxIndex::Volume::overlaps(const Volume& other) const {
+  // strict inequalities to match BoundingBox::intersects
+  return (min.array() < other.max.array()).all() &&
+         (max.array() > other.min.array()).all();
+}
+
+bool BoundingBoxIndex::Volume::contains(const Eigen::Vector3f& point) const {
+  return (point.array() >= min.array()).all() && (point.array() <= max.array()).all();
+}
+
+float BoundingBoxIndex::Volume::iou(const Volume& other) const {
+  const Eigen::Vector3f size = (max.cwiseMin(other.max) - min.cwiseMax(other.min));
+  const float intersection = size.cwiseMax(0.0f).prod();
+  return intersection / (volume() + other.volume() - intersection);
+}
+
+int32_t BoundingBoxIndex::allocate() {
+  if (free_list_ == NULL_NODE) {
+    tree_.emplace_back();
+    return static_cast<int32_t>(tree_.size() - 1);
+  }
+
+  const int32_t index = free_list_;
+  free_list_ = tree_[index].next;
+  tree_[index] = TreeNode();
+  return index;
+}
+
+void BoundingBoxIndex::release(int32_t index) {
+  tree_[index].next = free_list_;
+  free_list_ = index;
+}
+
+void BoundingBoxIndex::refit(int32_t index) {
+  while (index != NULL_NODE) {
+    auto& node = tree_[index];
+    node.volume = tree_[node.left].volume.merged(tree_[node.right].volume);
+    index = node.parent;
+  }
+}
+
+void BoundingBoxIndex::insertLeaf(int32_t leaf) {
+  if (root_ == NULL_NODE) {
+    root_ = leaf;
+    tree_[leaf].parent = NULL_NODE;
+    return;
+  }
+
+  // descend towards the sibling that increases the total surface area the least
+  const Volume leaf_volume = tree_[leaf].volume;
+  int32_t sibling = root_;
+  while (!tree_[sibling].isLeaf()) {
+    const auto& node = tree_[sibling];
+    const float area = node.volume.area();
+    const float combined_area = node.volume.merged(leaf_volume).area();
+
+    // cost of pairing the leaf with this node and the cost pushed down to children
+    const float cost = 2.0f * combined_area;
+    const float inherited_cost = 2.0f * (combined_area - area);
+
+    const auto child_cost = [&](int32_t child) {
+      const auto& child_volume = tree_[child].volume;
+      const float merged_area = child_volume.merged(leaf_volume).area();
+      const float growth =
+          tree_[child].isLeaf() ? merged_area : merged_area - child_volume.area();
+      return growth + inherited_cost;
+    };
+
+    const float left_cost = child_cost(node.left);
+    const float right_cost = child_cost(node.right);
+    if (cost < left_cost && cost < right_cost) {
+      break;
+    }
+
+    sibling = left_cost < right_cost ? node.left : node.right;
+  }
+
+  const int32_t old_parent = tree_[sibling].parent;
+  const int32_t new_parent = allocate();
+  tree_[new_parent].parent = old_parent;
+  tree_[new_parent].left = sibling;
+  tree_[new_parent].right = leaf;
+  tree_[new_parent].volume = leaf_volume.merged(tree_[sibling].volume);
+  tree_[sibling].parent = new_parent;
+  tree_[leaf].parent = new_parent;
+
+  if (old_parent == NULL_NODE) {
+    root_ = new_parent;
+    return;
+  }
+
+  auto& grandparent = tree_[old_parent];
+  (grandparent.left == sibling ? grandparent.left : grandparent.right) = new_parent;
+  refit(old_parent);
+}
+
+void BoundingBoxIndex::removeLeaf(int32_t leaf) {
+  if (leaf == root_) {
+    root_ = NULL_NODE;
+    return;
+  }
+
+  const int32_t parent = tree_[leaf].parent;
+  const int32_t grandparent = tree_[parent].parent;
+  const int32_t sibling =
+      tree_[parent].left == leaf ? tree_[parent].right : tree_[parent].left;
+
+  tree_[sibling].parent = grandparent;
+  release(parent);
+  if (grandparent == NULL_NODE) {
+    root_ = sibling;
+    return;
+  }
+
+  auto& node = tree_[grandparent];
+  (node.left == parent ? node.left : node.right) = sibling;
+  refit(grandparent);
+}
+
+void BoundingBoxIndex::insert(NodeId node, const BoundingBox& bounding_box) {
+  if (!bounding_box.isValid()) {
+    erase(node);
+    return;
+  }
+
+  const auto volume = Volume::fromBox(bounding_box);
+  auto iter = leaves_.find(node);
+  if (iter != leaves_.end()) {
+    iter->second.box = bounding_box;
+    auto& leaf = tree_[iter->second.index];
+    if (leaf.volume.min == volume.min && leaf.volume.max == volume.max) {
+      return;
+    }
+
+    removeLeaf(iter->second.index);
+    leaf.volume = volume;
+    insertLeaf(iter->second.index);
+    return;
+  }
+
+  const int32_t index = allocate();
+  tree_[index].id = node;
+  tree_[index].volume = volume;
+  leaves_.emplace(node, Leaf{index, bounding_box});
+  insertLeaf(index);
+}
+
+bool BoundingBoxIndex::erase(NodeId node) {
+  auto iter = leaves_.find(node);
+  if (iter == leaves_.end()) {
+    return false;
+  }
+
+  removeLeaf(iter->second.index);
+  release(iter->second.index);
+  leaves_.erase(iter);
+  return true;
+}
+
+void BoundingBoxIndex::clear() {
+  root_ = NULL_NODE;
+  free_list_ = NULL_NODE;
+  tree_.clear();
+  leaves_.clear();
+}
+
+void BoundingBoxIndex::rebuild() {
+  root_ = NULL_NODE;
+  free_list_ = NULL_NODE;
+  tree_.clear();
+  tree_.reserve(2 * leaves_.size());
+
+  std::vector<int32_t> indices;
+  indices.reserve(leaves_.size());
+  for (auto& [node, leaf] : leaves_) {
+    leaf.index = allocate();
+    tree_[leaf.index].id = node;
+    tree_[leaf.index].volume = Volume::fromBox(leaf.box);
+    indices.push_back(leaf.index);
+  }
+
+  if (!indices.empty()) {
+    root_ = buildRecursive(indices, 0, indices.size());
+    tree_[root_].parent = NULL_NODE;
+  }
+}
+
+int32_t BoundingBoxIndex::buildRecursive(std::vector<int32_t>& leaves,
+                                         size_t begin,
+                                         size_t end) {
+  if (end - begin == 1) {
+    return leaves[begin];
+  }
+
+  // split at the median of the box centers along the widest axis
+  Eigen::Vector3f min = Eigen::Vector3f::Constant(std::numeric_limits<float>::max());
+  Eigen::Vector3f max = -min;
+  for (size_t i = begin; i < end; ++i) {
+    const auto& volume = tree_[leaves[i]].volume;
+    const Eigen::Vector3f center = volume.min + volume.max;
+    min = min.cwiseMin(center);
+    max = max.cwiseMax(center);
+  }
+
+  int axis;
+  (max - min).maxCoeff(&axis);
+  const size_t mid = begin + (end - begin) / 2;
+  std::nth_element(leaves.begin() + begin,
+                   leaves.begin() + mid,
+                   leaves.begin() + end,
+                   [&](int32_t lhs, int32_t rhs) {
+                     const auto& l = tree_[lhs].volume;
+                     const auto& r = tree_[rhs].volume;
+                     return l.min(axis) + l.max(axis) < r.min(axis) + r.max(axis);
+                   });
+
+  const int32_t left = buildRecursive(leaves, begin, mid);
+  const int32_t right = buildRecursive(leaves, mid, end);
+  const int32_t index = allocate();
+  tree_[index].left = left;
+  tree_[index].right = right;
+  tree_[index].volume = tree_[left].volume.merged(tree_[right].volume);
+  tree_[left].parent = index;
+  tree_[right].parent = index;
+  return index;
+}
+
+size_t BoundingBoxIndex::height() const { return heightRecursive(root_); }
+
+size_t BoundingBoxIndex::heightRecursive(int32_t index) const {
+  if (index == NULL_NODE) {
+    return 0;
+  }
+
+  const auto& node = tree_[index];
+  if (node.isLeaf()) {
+    return 1;
+  }
+
+  return 1 + std::max(heightRecursive(node.left), heightRecursive(node.right));
+}
+
+template <typename Prune, typename Visitor>
+void BoundingBoxIndex::visit(const Prune& prune, const Visitor& visitor) const {
+  if (root_ == NULL_NODE) {
+    return;
+  }
+
+  std::vector<int32_t> stack{root_};
+  while (!stack.empty()) {
+    const auto& node = tree_[stack.back()];
+    stack.pop_back();
+    if (prune(node.volume)) {
+      continue;
+    }
+
+    if (node.isLeaf()) {
+      visitor(node);
+    } else {
+      stack.push_back(node.left);
+      stack.push_back(node.right);
+    }
+  }
+}
+
+std::vector<NodeId> BoundingBoxIndex::containing(const Eigen::Vector3f& point) const {
+  std::vector<NodeId> result;
+  visit([&](const Volume& volume) { return !volume.contains(point); },
+        [&](const TreeNode& leaf) {
+          if (leaves_.at(leaf.id).box.contains(point)) {
+            result.push_back(leaf.id);
+          }
+        });
+
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+std::vector<NodeId> BoundingBoxIndex::containing(const Eigen::Vector3d& point) const {
+  return containing(static_cast<Eigen::Vector3f>(point.cast<float>()));
+}
+
+std::vector<NodeId> BoundingBoxIndex::intersecting(const BoundingBox& query) const {
+  std::vector<NodeId> result;
+  if (!query.isValid()) {
+    return result;
+  }
+
+  const auto query_volume = Volume::fromBox(query);
+  visit([&](const Volume& volume) { return !volume.overlaps(query_volume); },
+        [&](const TreeNode& leaf) { result.push_back(leaf.id); });
+
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+std::vector<BoundingBoxIndex::NodePair> BoundingBoxIndex::overlappingPairs(
+    float min_iou) const {
+  std::vector<NodePair> result;
+  for (const auto& [node, leaf] : leaves_) {
+    const auto& query = tree_[leaf.index].volume;
+    // IoU(A, B) <= |A n B| / |A| <= |A n V| / |A| for every B inside volume V
+    const float min_overlap = min_iou * query.volume();
+    const auto prune = [&](const Volume& volume) {
+      if (!volume.overlaps(query)) {
+        return true;
+      }
+
+      const Eigen::Vector3f size =
+          volume.max.cwiseMin(query.max) - volume.min.cwiseMax(query.min);
+      return size.prod() < min_overlap;
+    };
+
+    const NodeId source = node;
+    visit(prune, [&](const TreeNode& other) {
+      if (other.id > source && query.iou(other.volume) >= min_iou) {
+        result.emplace_back(source, other.id);
+      }
+    });
+  }
+
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+}  // namespace spark_dsg
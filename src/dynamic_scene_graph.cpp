@@ -39,8 +39,10 @@
 #include <pcl/point_cloud.h>
 #include <pcl/point_types.h>
 
+#include <algorithm>
 #include <filesystem>
 #include <fstream>
+#include <limits>
 #include <memory>
 #include <nlohmann/json.hpp>
 #include <nlohmann/json_fwd.hpp>
@@ -224,6 +226,7 @@ bool DynamicSceneGraph::addOrUpdateNode(LayerId layer_id,
   auto iter = node_lookup_.find(node_id);
   if (iter != node_lookup_.end()) {
     getNodePtr(node_id, iter->second)->attributes_ = std::move(attrs);
+    refreshIndices(node_id, iter->second);
     return true;
   }
 
@@ -318,6 +321,7 @@ bool DynamicSceneGraph::setNodeAttributes(NodeId node, NodeAttributes::Ptr&& att
   }
 
   getNodePtr(node, iter->second)->attributes_ = std::move(attrs);
+  refreshIndices(node, iter->second);
   return true;
 }
 
@@ -643,11 +647,13 @@ bool DynamicSceneGraph::updateFromLayer(SceneGraphLayer& other_layer,
       // just copy the attributes (prior edge information should be preserved)
       internal_layer.nodes_[id_node_pair.first]->attributes_ =
           std::move(id_node_pair.second->attributes_);
+      internal_layer.refreshIndices(id_node_pair.first);
     } else {
       // we need to let the scene graph know about new nodes
       node_lookup_[id_node_pair.first] = internal_layer.id;
       internal_layer.nodes_[id_node_pair.first] = std::move(id_node_pair.second);
       internal_layer.nodes_status_[id_node_pair.first] = NodeStatus::NEW;
+      internal_layer.refreshIndices(id_node_pair.first);
     }
   }
 
@@ -803,7 +809,7 @@ void DynamicSceneGraph::removeAllStaleEdges() {
   removeStaleEdges(dynamic_interlayer_edges_);
 }
 
-DynamicSceneGraph::Ptr DynamicSceneGraph::clone() const {
+DynamicSceneGraph::Ptr DynamicSceneGraph::clone(bool include_mesh) const {
   auto to_return = std::make_shared<DynamicSceneGraph>(layer_ids);
   for (const auto id_layer_pair : node_lookup_) {
     auto node = getNodePtr(id_layer_pair.first, id_layer_pair.second);
@@ -841,7 +847,7 @@ DynamicSceneGraph::Ptr DynamicSceneGraph::clone() const {
     to_return->insertEdge(edge.source, edge.target, edge.info->clone());
   }
 
-  if (mesh_) {
+  if (mesh_ && include_mesh) {
     to_return->mesh_ = mesh_->clone();
   }
 
@@ -859,6 +865,16 @@ void DynamicSceneGraph::save(std::string filepath, bool include_mesh) const {
   io::saveDsgBinary(*this, filepath, include_mesh);
 }
 
+void DynamicSceneGraph::save(std::string filepath, const Mesh& mesh) const {
+  const auto type = io::verifyFileExtension(filepath);
+  if (type == io::FileType::JSON) {
+    io::saveDsgJson(*this, filepath, mesh);
+    return;
+  }
+
+  io::saveDsgBinary(*this, filepath, mesh);
+}
+
 DynamicSceneGraph::Ptr DynamicSceneGraph::load(std::string filepath) {
   if (!std::filesystem::exists(filepath)) {
     throw std::runtime_error("graph file does not exist: " + filepath);
@@ -879,6 +895,53 @@ bool DynamicSceneGraph::hasMesh() const { return mesh_ != nullptr; }
 
 Mesh::Ptr DynamicSceneGraph::mesh() const { return mesh_; }
 
+std::vector<NodeId> DynamicSceneGraph::getMeshConnectedNodes(
+    const std::vector<size_t>& vertices) const {
+  std::vector<NodeId> nodes;
+  for (const auto& id_layer_pair : layers_) {
+    const auto& index = id_layer_pair.second->meshConnectionIndex();
+    const auto layer_nodes = index.nodes(vertices);
+    nodes.insert(nodes.end(), layer_nodes.begin(), layer_nodes.end());
+  }
+
+  std::sort(nodes.begin(), nodes.end());
+  return nodes;
+}
+
+void DynamicSceneGraph::eraseMeshVertices(const std::unordered_set<size_t>& indices) {
+  if (!mesh_) {
+    return;
+  }
+
+  std::vector<size_t> sorted_erased;
+  sorted_erased.reserve(indices.size());
+  for (const auto index : indices) {
+    if (index < mesh_->numVertices()) {
+      sorted_erased.push_back(index);
+    }
+  }
+
+  if (sorted_erased.empty()) {
+    return;
+  }
+
+  std::sort(sorted_erased.begin(), sorted_erased.end());
+  mesh_->eraseVerticesSorted(sorted_erased);
+
+  // only nodes connected to a vertex at or after the first erased vertex change
+  for (const auto& id_layer_pair : layers_) {
+    auto& layer = *id_layer_pair.second;
+    const auto affected = layer.meshConnectionIndex().nodesInRange(
+        sorted_erased.front(), std::numeric_limits<size_t>::max());
+    for (const auto node : affected) {
+      auto& attrs = *layer.nodes_.at(node)->attributes_;
+      if (MeshConnectionIndex::remapConnections(attrs, sorted_erased)) {
+        layer.refreshMeshConnections(node);
+      }
+    }
+  }
+}
+
 BaseLayer& DynamicSceneGraph::layerFromKey(const LayerKey& key) {
   const auto& layer = static_cast<const DynamicSceneGraph*>(this)->layerFromKey(key);
   return const_cast<BaseLayer&>(layer);
@@ -901,6 +964,12 @@ SceneGraphNode* DynamicSceneGraph::getNodePtr(NodeId node, const LayerKey& info)
   }
 }
 
+void DynamicSceneGraph::refreshIndices(NodeId node, const LayerKey& info) const {
+  if (!info.dynamic) {
+    layers_.at(info.layer)->refreshIndices(node);
+  }
+}
+
 bool DynamicSceneGraph::hasEdge(NodeId source,
                                 NodeId target,
                                 LayerKey* source_key,
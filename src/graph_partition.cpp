@@ -0,0 +1,280 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "spark_dsg/graph_partition.h"
+
+#include <algorithm>
+#include <cmath>
+#include <queue>
+#include <sstream>
+#include <stdexcept>
+
+#include "spark_dsg/node_symbol.h"
+
+namespace spark_dsg {
+
+namespace {
+
+struct PositionedNode {
+  NodeId id;
+  Eigen::Vector3d position;
+};
+
+using NodeIter = std::vector<PositionedNode>::iterator;
+
+void bisect(NodeIter begin,
+            NodeIter end,
+            size_t num_parts,
+            size_t first_part,
+            std::map<NodeId, size_t>& assignments) {
+  const size_t num_nodes = end - begin;
+  if (num_parts == 1 || num_nodes <= 1) {
+    for (auto iter = begin; iter != end; ++iter) {
+      assignments[iter->id] = first_part;
+    }
+    return;
+  }
+
+  Eigen::Vector3d min = begin->position;
+  Eigen::Vector3d max = begin->position;
+  for (auto iter = begin; iter != end; ++iter) {
+    min = min.cwiseMin(iter->position);
+    max = max.cwiseMax(iter->position);
+  }
+
+  int axis;
+  (max - min).maxCoeff(&axis);
+
+  // split the nodes proportionally to the number of parts on each side
+  const size_t left_parts = num_parts / 2;
+  const size_t left_size = (num_nodes * left_parts + num_parts / 2) / num_parts;
+  const auto mid = begin + left_size;
+  std::nth_element(
+      begin, mid, end, [axis](const PositionedNode& lhs, const PositionedNode& rhs) {
+        return lhs.position(axis) == rhs.position(axis)
+                   ? lhs.id < rhs.id
+                   : lhs.position(axis) < rhs.position(axis);
+      });
+
+  bisect(begin, mid, left_parts, first_part, assignments);
+  bisect(mid, end, num_parts - left_parts, first_part + left_parts, assignments);
+}
+
+void refine(const SceneGraphLayer& layer,
+            const PartitionConfig& config,
+            std::map<NodeId, size_t>& assignments) {
+  const size_t num_parts = config.num_parts;
+  const double average = static_cast<double>(assignments.size()) / num_parts;
+  const double tolerance = std::max(config.balance_tolerance, 0.0);
+  const size_t max_size = std::ceil(average * (1.0 + tolerance));
+  const size_t min_size = std::floor(average * std::max(1.0 - tolerance, 0.0));
+
+  std::vector<size_t> sizes(num_parts, 0);
+  for (const auto& id_part_pair : assignments) {
+    ++sizes[id_part_pair.second];
+  }
+
+  std::vector<size_t> counts(num_parts, 0);
+  std::vector<size_t> touched;
+  for (size_t pass = 0; pass < config.refinement_passes; ++pass) {
+    size_t num_moved = 0;
+    for (auto& [node_id, part] : assignments) {
+      const auto& siblings = layer.getNode(node_id).siblings();
+      touched.clear();
+      for (const auto sibling : siblings) {
+        const size_t sibling_part = assignments.at(sibling);
+        if (counts[sibling_part]++ == 0) {
+          touched.push_back(sibling_part);
+        }
+      }
+
+      size_t best = part;
+      for (const auto other : touched) {
+        const bool better = counts[other] > counts[best] ||
+                            (counts[other] == counts[best] && other < best);
+        if (better) {
+          best = other;
+        }
+      }
+
+      const bool improves = best != part && counts[best] > counts[part];
+      if (improves && sizes[best] < max_size && sizes[part] > min_size) {
+        --sizes[part];
+        ++sizes[best];
+        part = best;
+        ++num_moved;
+      }
+
+      for (const auto other : touched) {
+        counts[other] = 0;
+      }
+    }
+
+    if (num_moved == 0) {
+      break;
+    }
+  }
+}
+
+}  // namespace
+
+size_t GraphPartition::part(NodeId node) const {
+  const auto iter = assignments.find(node);
+  if (iter == assignments.end()) {
+    std::stringstream ss;
+    ss << "node " << NodeSymbol(node).getLabel() << " not in partition";
+    throw std::out_of_range(ss.str());
+  }
+
+  return iter->second;
+}
+
+GraphPartition GraphPartition::fromAssignments(
+    const SceneGraphLayer& layer,
+    const std::map<NodeId, size_t>& assignments,
+    size_t num_parts) {
+  GraphPartition partition;
+  partition.parts.resize(num_parts);
+  partition.boundary.resize(num_parts);
+  partition.halo.resize(num_parts);
+
+  for (const auto& [node_id, part] : assignments) {
+    if (!layer.hasNode(node_id)) {
+      continue;
+    }
+
+    if (part >= num_parts) {
+      std::stringstream ss;
+      ss << "node " << NodeSymbol(node_id).getLabel() << " assigned to part " << part
+         << " of " << num_parts;
+      throw std::out_of_range(ss.str());
+    }
+
+    partition.assignments[node_id] = part;
+    partition.parts[part].push_back(node_id);
+  }
+
+  for (const auto& [node_id, part] : partition.assignments) {
+    bool on_boundary = false;
+    for (const auto sibling : layer.getNode(node_id).siblings()) {
+      const auto iter = partition.assignments.find(sibling);
+      if (iter == partition.assignments.end() || iter->second == part) {
+        continue;
+      }
+
+      on_boundary = true;
+      partition.halo[part].push_back(sibling);
+      if (node_id < sibling) {
+        ++partition.edge_cut;
+      }
+    }
+
+    if (on_boundary) {
+      partition.boundary[part].push_back(node_id);
+    }
+  }
+
+  for (auto& halo : partition.halo) {
+    std::sort(halo.begin(), halo.end());
+    halo.erase(std::unique(halo.begin(), halo.end()), halo.end());
+  }
+
+  return partition;
+}
+
+GraphPartition partitionLayer(const SceneGraphLayer& layer,
+                              const PartitionConfig& config) {
+  if (config.num_parts == 0) {
+    throw std::invalid_argument("cannot partition a layer into zero parts");
+  }
+
+  std::vector<PositionedNode> nodes;
+  nodes.reserve(layer.numNodes());
+  for (const auto& [node_id, node] : layer.nodes()) {
+    nodes.push_back({node_id, node->attributes().position});
+  }
+
+  std::map<NodeId, size_t> assignments;
+  bisect(nodes.begin(), nodes.end(), config.num_parts, 0, assignments);
+  refine(layer, config, assignments);
+  return GraphPartition::fromAssignments(layer, assignments, config.num_parts);
+}
+
+GraphPartition partitionByParent(const SceneGraphLayer& layer) {
+  std::map<NodeId, size_t> parent_parts;
+  for (const auto& id_node_pair : layer.nodes()) {
+    const auto parent = id_node_pair.second->getParent();
+    if (parent) {
+      parent_parts.emplace(*parent, 0);
+    }
+  }
+
+  size_t num_parts = 0;
+  for (auto& id_part_pair : parent_parts) {
+    id_part_pair.second = num_parts++;
+  }
+
+  // multi-source BFS from every node with a parent
+  std::map<NodeId, size_t> assignments;
+  std::queue<NodeId> frontier;
+  for (const auto& [node_id, node] : layer.nodes()) {
+    const auto parent = node->getParent();
+    if (parent) {
+      assignments[node_id] = parent_parts.at(*parent);
+      frontier.push(node_id);
+    }
+  }
+
+  while (!frontier.empty()) {
+    const NodeId node_id = frontier.front();
+    frontier.pop();
+    const size_t part = assignments.at(node_id);
+    for (const auto sibling : layer.getNode(node_id).siblings()) {
+      if (assignments.emplace(sibling, part).second) {
+        frontier.push(sibling);
+      }
+    }
+  }
+
+  if (assignments.size() < layer.numNodes()) {
+    for (const auto& id_node_pair : layer.nodes()) {
+      assignments.emplace(id_node_pair.first, num_parts);
+    }
+    ++num_parts;
+  }
+
+  return GraphPartition::fromAssignments(layer, assignments, num_parts);
+}
+
+}  // namespace spark_dsg
@@ -0,0 +1,360 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "spark_dsg/hierarchical_planner.h"
+
+#include <cmath>
+#include <limits>
+#include <optional>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "spark_dsg/shortest_paths.h"
+
+namespace spark_dsg {
+
+namespace {
+
+struct RoomInfo {
+  bool valid = false;
+  std::vector<NodeId> places;
+  std::vector<NodeId> portals;
+  std::set<NodeId> neighbors;
+};
+
+//! Rooms connected via portals
+struct RoomGraph {
+  const SceneGraphLayer* layer = nullptr;
+  std::unordered_map<NodeId, RoomInfo> rooms;
+};
+
+//! Places restricted to a set of allowed places
+struct PlaceCorridor {
+  const SceneGraphLayer& layer;
+  const std::unordered_set<NodeId>& allowed;
+};
+
+}  // namespace
+
+namespace graph_utilities {
+
+template <>
+struct graph_traits<RoomGraph> {
+  static inline const std::set<NodeId>& neighbors(const RoomGraph& graph, NodeId room) {
+    return graph.rooms.at(room).neighbors;
+  }
+
+  static inline bool contains(const RoomGraph& graph, NodeId room) {
+    return graph.rooms.count(room);
+  }
+
+  static inline Eigen::Vector3d position(const RoomGraph& graph, NodeId room) {
+    return graph.layer->getNode(room).attributes().position;
+  }
+
+  static inline double edge_cost(const RoomGraph& graph, NodeId source, NodeId target) {
+    return (position(graph, source) - position(graph, target)).norm();
+  }
+};
+
+template <>
+struct graph_traits<PlaceCorridor> {
+  using LayerTraits = graph_traits<SceneGraphLayer>;
+
+  static inline const std::set<NodeId>& neighbors(const PlaceCorridor& graph,
+                                                  NodeId node) {
+    return LayerTraits::neighbors(graph.layer, node);
+  }
+
+  static inline bool contains(const PlaceCorridor& graph, NodeId node) {
+    return graph.allowed.count(node);
+  }
+
+  static inline Eigen::Vector3d position(const PlaceCorridor& graph, NodeId node) {
+    return LayerTraits::position(graph.layer, node);
+  }
+
+  static inline double edge_cost(const PlaceCorridor& graph,
+                                 NodeId source,
+                                 NodeId target) {
+    if (!graph.allowed.count(target)) {
+      return std::numeric_limits<double>::infinity();
+    }
+
+    return LayerTraits::edge_cost(graph.layer, source, target);
+  }
+};
+
+}  // namespace graph_utilities
+
+using graph_utilities::findShortestPath;
+using graph_utilities::SearchWorkspace;
+
+struct HierarchicalPlanner::Detail {
+  Detail(const DynamicSceneGraph& graph, LayerId place_layer, LayerId room_layer)
+      : graph(graph), place_layer(place_layer), room_layer(room_layer) {}
+
+  const SceneGraphLayer* getLayer(LayerId layer) const {
+    return graph.hasLayer(layer) ? &graph.getLayer(layer) : nullptr;
+  }
+
+  std::optional<NodeId> getRoom(NodeId place) const {
+    const auto node = graph.findNode(place);
+    if (!node) {
+      return std::nullopt;
+    }
+
+    const auto parent = node->getParent();
+    if (!parent || !rooms.layer || !rooms.layer->hasNode(*parent)) {
+      return std::nullopt;
+    }
+
+    return parent;
+  }
+
+  void invalidateRoom(NodeId room) {
+    auto iter = rooms.rooms.find(room);
+    if (iter == rooms.rooms.end() || !iter->second.valid) {
+      return;
+    }
+
+    // neighbors may refer to portals of this room
+    iter->second.valid = false;
+    for (const auto neighbor : iter->second.neighbors) {
+      auto neighbor_iter = rooms.rooms.find(neighbor);
+      if (neighbor_iter != rooms.rooms.end()) {
+        neighbor_iter->second.valid = false;
+      }
+    }
+  }
+
+  void invalidateNode(NodeId node) {
+    invalidateRoom(node);
+
+    const auto prev = place_rooms.find(node);
+    if (prev != place_rooms.end()) {
+      invalidateRoom(prev->second);
+    }
+
+    const auto room = getRoom(node);
+    if (room) {
+      invalidateRoom(*room);
+    }
+  }
+
+  void updateRoom(NodeId room, RoomInfo& info) {
+    info.places.clear();
+    info.portals.clear();
+    info.neighbors.clear();
+
+    const auto& room_node = rooms.layer->getNode(room);
+    for (const auto child : room_node.children()) {
+      if (!places || !places->hasNode(child)) {
+        continue;
+      }
+
+      info.places.push_back(child);
+      place_rooms[child] = room;
+
+      bool is_portal = false;
+      for (const auto sibling : places->getNode(child).siblings()) {
+        const auto sibling_room = getRoom(sibling);
+        if (sibling_room == room) {
+          continue;
+        }
+
+        is_portal = true;
+        if (sibling_room) {
+          info.neighbors.insert(*sibling_room);
+        }
+      }
+
+      if (is_portal) {
+        info.portals.push_back(child);
+      }
+    }
+
+    info.valid = true;
+  }
+
+  void refresh() {
+    places = getLayer(place_layer);
+    rooms.layer = getLayer(room_layer);
+    if (!rooms.layer) {
+      rooms.rooms.clear();
+      return;
+    }
+
+    // drop rooms that no longer exist (and invalidate rooms that pointed to them)
+    auto iter = rooms.rooms.begin();
+    while (iter != rooms.rooms.end()) {
+      if (rooms.layer->hasNode(iter->first)) {
+        ++iter;
+        continue;
+      }
+
+      for (const auto neighbor : iter->second.neighbors) {
+        invalidateRoom(neighbor);
+      }
+      iter = rooms.rooms.erase(iter);
+    }
+
+    for (const auto& id_node_pair : rooms.layer->nodes()) {
+      auto& info = rooms.rooms[id_node_pair.first];
+      if (!info.valid) {
+        updateRoom(id_node_pair.first, info);
+      }
+    }
+  }
+
+  double searchRooms(const std::vector<NodeId>& route,
+                     NodeId source,
+                     NodeId target,
+                     std::vector<NodeId>& path) {
+    corridor.clear();
+    for (const auto room : route) {
+      const auto& info = rooms.rooms.at(room);
+      corridor.insert(info.places.begin(), info.places.end());
+    }
+
+    const PlaceCorridor view{*places, corridor};
+    // edge weights may be cheaper than the straight-line distance, so no heuristic
+    const double cost = findShortestPath(view, source, target, place_workspace, false);
+    path = place_workspace.path(target);
+    return cost;
+  }
+
+  double findPath(NodeId source, NodeId target, std::vector<NodeId>& path) {
+    path.clear();
+    room_path.clear();
+    refresh();
+    if (!places || !places->hasNode(source) || !places->hasNode(target)) {
+      return std::numeric_limits<double>::infinity();
+    }
+
+    const auto source_room = getRoom(source);
+    const auto target_room = getRoom(target);
+    if (source_room && target_room) {
+      if (*source_room == *target_room) {
+        room_path.push_back(*source_room);
+      } else if (std::isfinite(findShortestPath(
+                     rooms, *source_room, *target_room, room_workspace, false))) {
+        room_path = room_workspace.path(*target_room);
+      }
+    }
+
+    if (!room_path.empty()) {
+      const double cost = searchRooms(room_path, source, target, path);
+      if (std::isfinite(cost)) {
+        return cost;
+      }
+
+      room_path.clear();
+    }
+
+    const double cost =
+        findShortestPath(*places, source, target, place_workspace, false);
+    path = place_workspace.path(target);
+    return cost;
+  }
+
+  const DynamicSceneGraph& graph;
+  const LayerId place_layer;
+  const LayerId room_layer;
+
+  const SceneGraphLayer* places = nullptr;
+  RoomGraph rooms;
+  //! room each place belonged to when its room was last updated
+  std::unordered_map<NodeId, NodeId> place_rooms;
+
+  std::vector<NodeId> room_path;
+  std::unordered_set<NodeId> corridor;
+  SearchWorkspace room_workspace;
+  SearchWorkspace place_workspace;
+};
+
+HierarchicalPlanner::HierarchicalPlanner(const DynamicSceneGraph& graph,
+                                         LayerId place_layer,
+                                         LayerId room_layer)
+    : internals_(new Detail(graph, place_layer, room_layer)) {}
+
+HierarchicalPlanner::~HierarchicalPlanner() = default;
+
+double HierarchicalPlanner::findPath(NodeId source,
+                                     NodeId target,
+                                     std::vector<NodeId>& path) {
+  return internals_->findPath(source, target, path);
+}
+
+const std::vector<NodeId>& HierarchicalPlanner::roomPath() const {
+  return internals_->room_path;
+}
+
+const std::vector<NodeId>& HierarchicalPlanner::getPortals(NodeId room) {
+  internals_->refresh();
+  static const std::vector<NodeId> empty;
+  const auto iter = internals_->rooms.rooms.find(room);
+  return iter == internals_->rooms.rooms.end() ? empty : iter->second.portals;
+}
+
+void HierarchicalPlanner::invalidate(const std::vector<NodeId>& nodes,
+                                     const std::vector<EdgeKey>& edges) {
+  for (const auto node : nodes) {
+    internals_->invalidateNode(node);
+  }
+
+  for (const auto& edge : edges) {
+    internals_->invalidateNode(edge.k1);
+    internals_->invalidateNode(edge.k2);
+  }
+}
+
+void HierarchicalPlanner::update(DynamicSceneGraph& graph, bool clear_tracking) {
+  auto nodes = graph.getNewNodes(clear_tracking);
+  const auto removed_nodes = graph.getRemovedNodes(clear_tracking);
+  nodes.insert(nodes.end(), removed_nodes.begin(), removed_nodes.end());
+
+  auto edges = graph.getNewEdges(clear_tracking);
+  const auto removed_edges = graph.getRemovedEdges(clear_tracking);
+  edges.insert(edges.end(), removed_edges.begin(), removed_edges.end());
+  invalidate(nodes, edges);
+}
+
+void HierarchicalPlanner::reset() {
+  internals_->rooms.rooms.clear();
+  internals_->place_rooms.clear();
+}
+
+}  // namespace spark_dsg
@@ -34,10 +34,119 @@
  * -------------------------------------------------------------------------- */
 #include "spark_dsg/mesh.h"
 
-#include <unordered_map>
+#include <algorithm>
+#include <random>
+#include <sstream>
+#include <thread>
+
+#include "spark_dsg/parallel_blocks.h"
 
 namespace spark_dsg {
 
+void IndexRanges::add(size_t start, size_t end) {
+  if (start >= end) {
+    return;
+  }
+
+  // fast path for growing the last range (e.g., appending or sequential updates)
+  if (!ranges_.empty()) {
+    auto last = std::prev(ranges_.end());
+    if (last->first <= start && start <= last->second) {
+      last->second = std::max(last->second, end);
+      return;
+    }
+  }
+
+  auto iter = ranges_.upper_bound(start);
+  if (iter != ranges_.begin()) {
+    auto prev = std::prev(iter);
+    if (prev->second >= start) {
+      start = prev->first;
+      end = std::max(end, prev->second);
+      iter = prev;
+    }
+  }
+
+  while (iter != ranges_.end() && iter->first <= end) {
+    end = std::max(end, iter->second);
+    iter = ranges_.erase(iter);
+  }
+
+  ranges_.emplace(start, end);
+}
+
+void IndexRanges::truncate(size_t size) {
+  ranges_.erase(ranges_.lower_bound(size), ranges_.end());
+  if (!ranges_.empty()) {
+    auto last = std::prev(ranges_.end());
+    last->second = std::min(last->second, size);
+  }
+}
+
+void IndexRanges::clear() { ranges_.clear(); }
+
+bool IndexRanges::empty() const { return ranges_.empty(); }
+
+bool IndexRanges::contains(size_t index) const {
+  auto iter = ranges_.upper_bound(index);
+  return iter != ranges_.begin() && std::prev(iter)->second > index;
+}
+
+size_t IndexRanges::count() const {
+  size_t total = 0;
+  for (const auto& [start, end] : ranges_) {
+    total += end - start;
+  }
+  return total;
+}
+
+std::vector<IndexRanges::Range> IndexRanges::ranges() const {
+  return std::vector<Range>(ranges_.begin(), ranges_.end());
+}
+
+bool IndexRanges::operator==(const IndexRanges& other) const {
+  return ranges_ == other.ranges_;
+}
+
+namespace {
+
+uint64_t newStreamId() {
+  // seeded once per thread: ids only have to differ between meshes, not be secret
+  thread_local std::mt19937_64 gen(std::random_device{}() ^
+                                   std::hash<std::thread::id>()(
+                                       std::this_thread::get_id()));
+  return gen();
+}
+
+}  // namespace
+
+void MeshChangeTracker::clearChanges() {
+  has_changes_ = false;
+  changed_vertices_.clear();
+  changed_faces_.clear();
+}
+
+template <typename Update>
+void Mesh::updateTrackers(const Update& update) const {
+  auto& trackers = trackers_.trackers;
+  if (trackers.empty()) {
+    return;
+  }
+
+  auto iter = trackers.begin();
+  while (iter != trackers.end()) {
+    const auto tracker = iter->lock();
+    if (!tracker) {
+      iter = trackers.erase(iter);
+      continue;
+    }
+
+    tracker->has_changes_ = true;
+    update(*tracker);
+    ++iter;
+  }
+}
+
 Mesh::Mesh(bool has_colors,
            bool has_timestamps,
            bool has_labels,
@@ -45,7 +154,8 @@ Mesh::Mesh(bool has_colors,
     : has_colors(has_colors),
       has_timestamps(has_timestamps),
       has_labels(has_labels),
-      has_first_seen_stamps(has_first_seen_stamps) {}
+      has_first_seen_stamps(has_first_seen_stamps),
+      stream_id_(newStreamId()) {}
 
 Mesh& Mesh::operator=(const Mesh& other) {
   const_cast<bool&>(has_colors) = other.has_colors;
@@ -58,6 +168,12 @@ Mesh& Mesh::operator=(const Mesh& other) {
   first_seen_stamps = other.first_seen_stamps;
   labels = other.labels;
   faces = other.faces;
+  stream_id_ = other.stream_id_;
+  version_ = other.version_;
+  base_version_ = other.base_version_;
+  changed_vertices_ = other.changed_vertices_;
+  changed_faces_ = other.changed_faces_;
+  markAllChangedForTrackers();
   return *this;
 }
 
@@ -72,6 +188,12 @@ Mesh& Mesh::operator=(Mesh&& other) {
   first_seen_stamps = std::move(other.first_seen_stamps);
   labels = std::move(other.labels);
   faces = std::move(other.faces);
+  stream_id_ = other.stream_id_;
+  version_ = other.version_;
+  base_version_ = other.base_version_;
+  changed_vertices_ = std::move(other.changed_vertices_);
+  changed_faces_ = std::move(other.changed_faces_);
+  markAllChangedForTrackers();
   return *this;
 }
 
@@ -84,6 +206,9 @@ void Mesh::clear() {
   first_seen_stamps.clear();
   labels.clear();
   faces.clear();
+  truncateChangedVertices(0);
+  truncateChangedFaces(0);
+  ++version_;
 }
 
 size_t Mesh::numVertices() const { return points.size(); }
@@ -91,6 +216,7 @@ size_t Mesh::numVertices() const { return points.size(); }
 size_t Mesh::numFaces() const { return faces.size(); }
 
 void Mesh::resizeVertices(size_t size) {
+  const size_t prev_size = points.size();
   points.resize(size);
   if (has_colors) {
     colors.resize(size);
@@ -104,24 +230,39 @@ void Mesh::resizeVertices(size_t size) {
   if (has_first_seen_stamps) {
     first_seen_stamps.resize(size, 0);
   }
+
+  truncateChangedVertices(size);
+  markVerticesChanged(std::min(prev_size, size), size);
 }
 
-void Mesh::resizeFaces(size_t size) { faces.resize(size); }
+void Mesh::resizeFaces(size_t size) {
+  const size_t prev_size = faces.size();
+  faces.resize(size);
+  truncateChangedFaces(size);
+  markFacesChanged(std::min(prev_size, size), size);
+}
 
 Mesh::Ptr Mesh::clone() const { return std::make_shared<Mesh>(*this); }
 
 const Mesh::Pos& Mesh::pos(size_t index) const { return points.at(index); }
 
-void Mesh::setPos(size_t index, const Mesh::Pos& pos) { points.at(index) = pos; }
+void Mesh::setPos(size_t index, const Mesh::Pos& pos) {
+  points.at(index) = pos;
+  markVerticesChanged(index, index + 1);
+}
 
 const Color& Mesh::color(size_t index) const { return colors.at(index); }
 
-void Mesh::setColor(size_t index, const Color& color) { colors.at(index) = color; }
+void Mesh::setColor(size_t index, const Color& color) {
+  colors.at(index) = color;
+  markVerticesChanged(index, index + 1);
+}
 
 Mesh::Timestamp Mesh::timestamp(size_t index) const { return stamps.at(index); }
 
 void Mesh::setTimestamp(size_t index, Mesh::Timestamp timestamp) {
   stamps.at(index) = timestamp;
+  markVerticesChanged(index, index + 1);
 }
 
 Mesh::Timestamp Mesh::firstSeenTimestamp(size_t index) const {
@@ -130,122 +271,452 @@ Mesh::Timestamp Mesh::firstSeenTimestamp(size_t index) const {
 
 void Mesh::setFirstSeenTimestamp(size_t index, Mesh::Timestamp timestamp) {
   first_seen_stamps.at(index) = timestamp;
+  markVerticesChanged(index, index + 1);
 }
 
 Mesh::Label Mesh::label(size_t index) const { return labels.at(index); }
 
-void Mesh::setLabel(size_t index, Mesh::Label label) { labels.at(index) = label; }
+void Mesh::setLabel(size_t index, Mesh::Label label) {
+  labels.at(index) = label;
+  markVerticesChanged(index, index + 1);
+}
 
 const Mesh::Face& Mesh::face(size_t index) const { return faces.at(index); }
 
 Mesh::Face& Mesh::face(size_t index) { return faces.at(index); }
 
-void Mesh::eraseVertices(const std::unordered_set<size_t>& indices) {
-  // Map old indices to new indices.
-  std::unordered_map<size_t, size_t> old_to_new;
-
-  // Allocating new storage is faster than erasing from all old storages.
-  Positions new_points;
-  Colors new_colors;
-  Timestamps new_stamps;
-  Timestamps new_first_seen_stamps;
-  Labels new_labels;
-
-  const size_t num_new_vertices = numVertices() - indices.size();
-  new_points.reserve(num_new_vertices);
-  if (has_colors) {
-    new_colors.reserve(num_new_vertices);
-  }
-  if (has_timestamps) {
-    new_stamps.reserve(num_new_vertices);
+namespace {
+
+template <typename T>
+void compact(std::vector<T>& values, const std::vector<size_t>& remap, size_t size) {
+  if (values.empty()) {
+    return;
   }
-  if (has_labels) {
-    new_labels.reserve(num_new_vertices);
+
+  for (size_t i = 0; i < remap.size(); ++i) {
+    if (remap[i] != i && remap[i] < size) {
+      values[remap[i]] = std::move(values[i]);
+    }
   }
-  if (has_first_seen_stamps) {
-    new_first_seen_stamps.reserve(num_new_vertices);
+  values.resize(size);
+}
+
+// minimum number of vertices handled by each thread
+constexpr size_t MIN_VERTICES_PER_THREAD = 1 << 16;
+
+using PointMatrix = Eigen::Map<Eigen::Matrix3Xf>;
+using ConstPointMatrix = Eigen::Map<const Eigen::Matrix3Xf>;
+
+// upper bound on the number of chunks passed to forEachChunk callbacks
+inline size_t maxChunks() { return detail::resolveNumThreads(0); }
+
+/**
+ * Split [0, size) into contiguous chunks processed by separate threads (or just call
+ * func on the full range for small sizes). Returns the number of chunks.
+ */
+template <typename Func>
+size_t forEachChunk(size_t size, const Func& func) {
+  const size_t num_chunks =
+      std::max<size_t>(1, std::min(maxChunks(), size / MIN_VERTICES_PER_THREAD));
+  if (num_chunks == 1) {
+    func(0, 0, size);
+    return 1;
   }
 
-  // Copy over the vertices that are not being removed.
-  size_t new_index = 0;
-  for (size_t old_index = 0; old_index < numVertices(); ++old_index) {
-    if (indices.count(old_index)) {
-      continue;
-    }
-    old_to_new[old_index] = new_index++;
-    new_points.push_back(points[old_index]);
-    if (has_colors) {
-      new_colors.push_back(colors[old_index]);
-    }
-    if (has_timestamps) {
-      new_stamps.push_back(stamps[old_index]);
-    }
-    if (has_labels) {
-      new_labels.push_back(labels[old_index]);
+  const size_t chunk_size = (size + num_chunks - 1) / num_chunks;
+  const auto process_chunk = [&](size_t start, size_t end) {
+    func(start / chunk_size, start, end);
+  };
+  detail::parallelForBlocks(size, chunk_size, num_chunks, process_chunk);
+  return num_chunks;
+}
+
+template <typename Indices>
+std::vector<bool> indicesToMask(const Indices& indices, size_t size) {
+  std::vector<bool> mask(size, false);
+  for (const auto index : indices) {
+    if (index < size) {
+      mask[index] = true;
     }
-    if (has_first_seen_stamps) {
-      new_first_seen_stamps.push_back(first_seen_stamps[old_index]);
+  }
+  return mask;
+}
+
+}  // namespace
+
+void Mesh::eraseVertices(const std::unordered_set<size_t>& indices) {
+  eraseVerticesByMask(indicesToMask(indices, numVertices()));
+}
+
+void Mesh::eraseFaces(const std::unordered_set<size_t>& indices,
+                      const bool update_vertices) {
+  eraseFacesByMask(indicesToMask(indices, numFaces()), update_vertices);
+}
+
+void Mesh::eraseVerticesSorted(const std::vector<size_t>& sorted_indices) {
+  eraseVerticesByMask(indicesToMask(sorted_indices, numVertices()));
+}
+
+void Mesh::eraseFacesSorted(const std::vector<size_t>& sorted_indices,
+                            const bool update_vertices) {
+  eraseFacesByMask(indicesToMask(sorted_indices, numFaces()), update_vertices);
+}
+
+void Mesh::eraseVerticesByMask(const std::vector<bool>& erase_mask) {
+  // Dense map from old to new indices (invalid for erased vertices).
+  const size_t num_vertices = numVertices();
+  const size_t invalid = num_vertices;
+  std::vector<size_t> remap(num_vertices);
+  size_t num_kept = 0;
+  size_t first_erased = num_vertices;
+  for (size_t i = 0; i < num_vertices; ++i) {
+    const bool erase = i < erase_mask.size() && erase_mask[i];
+    remap[i] = erase ? invalid : num_kept++;
+    if (erase && first_erased == num_vertices) {
+      first_erased = i;
     }
   }
 
-  points = std::move(new_points);
-  colors = std::move(new_colors);
-  stamps = std::move(new_stamps);
-  labels = std::move(new_labels);
-  first_seen_stamps = std::move(new_first_seen_stamps);
-
-  // Update the faces.
-  auto face_it = faces.begin();
-  while (face_it != faces.end()) {
-    bool erase_face = false;
-    for (size_t& index : *face_it) {
-      const auto new_index = old_to_new.find(index);
-      if (new_index == old_to_new.end()) {
-        erase_face = true;
-        break;
-      }
-      index = new_index->second;
+  if (num_kept == num_vertices) {
+    return;
+  }
+
+  // Move the kept vertices to their new index (which is never after the old index).
+  compact(points, remap, num_kept);
+  compact(colors, remap, num_kept);
+  compact(stamps, remap, num_kept);
+  compact(first_seen_stamps, remap, num_kept);
+  compact(labels, remap, num_kept);
+
+  // Re-index the faces and drop faces that reference an erased vertex.
+  size_t num_faces = 0;
+  size_t first_changed = faces.size();
+  for (size_t f = 0; f < faces.size(); ++f) {
+    const auto& face = faces[f];
+    Face new_face;
+    bool valid = true;
+    for (size_t i = 0; i < 3; ++i) {
+      new_face[i] = face[i] < num_vertices ? remap[face[i]] : invalid;
+      valid &= new_face[i] != invalid;
     }
-    if (erase_face) {
-      face_it = faces.erase(face_it);
-    } else {
-      ++face_it;
+
+    const bool changed = !valid || num_faces != f || new_face != face;
+    if (changed && first_changed == faces.size()) {
+      first_changed = num_faces;
+    }
+
+    if (valid) {
+      faces[num_faces++] = new_face;
     }
   }
+  faces.resize(num_faces);
+
+  // Everything after the first erased vertex (and first changed face) moved.
+  truncateChangedVertices(num_kept);
+  markVerticesChanged(first_erased, num_kept);
+  truncateChangedFaces(num_faces);
+  markFacesChanged(std::min(first_changed, num_faces), num_faces);
 }
 
-void Mesh::eraseFaces(const std::unordered_set<size_t>& indices,
-                      const bool update_vertices) {
-  Faces new_faces;
-  new_faces.reserve(numFaces() - indices.size());
-  for (size_t old_index = 0; old_index < numFaces(); ++old_index) {
-    if (!indices.count(old_index)) {
-      new_faces.push_back(faces[old_index]);
+void Mesh::eraseFacesByMask(const std::vector<bool>& erase_mask,
+                            const bool update_vertices) {
+  size_t num_faces = 0;
+  size_t first_erased = faces.size();
+  for (size_t i = 0; i < faces.size(); ++i) {
+    if (i >= erase_mask.size() || !erase_mask[i]) {
+      faces[num_faces++] = faces[i];
+    } else if (first_erased == faces.size()) {
+      first_erased = i;
     }
   }
-  faces = std::move(new_faces);
+
+  if (num_faces != faces.size()) {
+    faces.resize(num_faces);
+    truncateChangedFaces(num_faces);
+    markFacesChanged(first_erased, num_faces);
+  }
 
   if (!update_vertices) {
     return;
   }
 
-  std::unordered_set<size_t> unused_vertices;
-  unused_vertices.reserve(numVertices());
-  for (size_t i = 0; i < numVertices(); ++i) {
-    unused_vertices.insert(i);
-  }
+  std::vector<bool> unused(numVertices(), true);
   for (const auto& face : faces) {
     for (const auto index : face) {
-      unused_vertices.erase(index);
+      if (index < unused.size()) {
+        unused[index] = false;
+      }
     }
   }
-  eraseVertices(unused_vertices);
+
+  eraseVerticesByMask(unused);
+}
+
+void Mesh::eraseVertexRange(size_t start, size_t end) {
+  std::vector<bool> mask(std::min(end, numVertices()), false);
+  for (size_t i = start; i < mask.size(); ++i) {
+    mask[i] = true;
+  }
+  eraseVerticesByMask(mask);
+}
+
+void Mesh::eraseFaceRange(size_t start, size_t end, const bool update_vertices) {
+  std::vector<bool> mask(std::min(end, numFaces()), false);
+  for (size_t i = start; i < mask.size(); ++i) {
+    mask[i] = true;
+  }
+  eraseFacesByMask(mask, update_vertices);
+}
+
+size_t Mesh::appendVertices(size_t count) {
+  const size_t start = numVertices();
+  resizeVertices(start + count);
+  return start;
+}
+
+size_t Mesh::appendFaces(const Faces& new_faces) {
+  const size_t start = numFaces();
+  faces.insert(faces.end(), new_faces.begin(), new_faces.end());
+  markFacesChanged(start, numFaces());
+  return start;
+}
+
+namespace {
+
+template <typename T>
+void copyAttribute(const std::vector<T>& from, std::vector<T>& to, size_t start) {
+  if (start >= to.size()) {
+    return;
+  }
+
+  const size_t num_to_copy = std::min(from.size(), to.size() - start);
+  std::copy(from.begin(), from.begin() + num_to_copy, to.begin() + start);
+}
+
+}  // namespace
+
+size_t Mesh::append(const Mesh& other) {
+  const size_t vertex_start = appendVertices(other.numVertices());
+  updateVertices(vertex_start, other);
+
+  const size_t face_start = numFaces();
+  faces.reserve(face_start + other.numFaces());
+  for (const auto& face : other.faces) {
+    faces.push_back({{face[0] + vertex_start,
+                      face[1] + vertex_start,
+                      face[2] + vertex_start}});
+  }
+
+  markFacesChanged(face_start, numFaces());
+  return vertex_start;
+}
+
+void Mesh::updateVertices(size_t start, const Mesh& other) {
+  if (start + other.numVertices() > numVertices()) {
+    std::stringstream ss;
+    ss << "cannot update vertices [" << start << ", " << start + other.numVertices()
+       << ") of mesh with " << numVertices() << " vertices";
+    throw std::out_of_range(ss.str());
+  }
+
+  copyAttribute(other.points, points, start);
+  copyAttribute(other.colors, colors, start);
+  copyAttribute(other.stamps, stamps, start);
+  copyAttribute(other.first_seen_stamps, first_seen_stamps, start);
+  copyAttribute(other.labels, labels, start);
+  markVerticesChanged(start, start + other.numVertices());
+}
+
+void Mesh::updateFaces(size_t start, const Faces& new_faces) {
+  if (start + new_faces.size() > numFaces()) {
+    std::stringstream ss;
+    ss << "cannot update faces [" << start << ", " << start + new_faces.size()
+       << ") of mesh with " << numFaces() << " faces";
+    throw std::out_of_range(ss.str());
+  }
+
+  std::copy(new_faces.begin(), new_faces.end(), faces.begin() + start);
+  markFacesChanged(start, start + new_faces.size());
+}
+
+uint64_t Mesh::version() const { return version_; }
+
+uint64_t Mesh::baseVersion() const { return base_version_; }
+
+uint64_t Mesh::streamId() const { return stream_id_; }
+
+bool Mesh::hasChanges() const { return version_ != base_version_; }
+
+const IndexRanges& Mesh::changedVertices() const { return changed_vertices_; }
+
+const IndexRanges& Mesh::changedFaces() const { return changed_faces_; }
+
+void Mesh::markVerticesChanged(size_t start, size_t end) {
+  changed_vertices_.add(start, end);
+  updateTrackers([&](MeshChangeTracker& tracker) {
+    tracker.changed_vertices_.add(start, end);
+  });
+  ++version_;
+}
+
+void Mesh::markFacesChanged(size_t start, size_t end) {
+  changed_faces_.add(start, end);
+  updateTrackers([&](MeshChangeTracker& tracker) {
+    tracker.changed_faces_.add(start, end);
+  });
+  ++version_;
+}
+
+void Mesh::clearChanges() {
+  changed_vertices_.clear();
+  changed_faces_.clear();
+  base_version_ = version_;
+}
+
+std::shared_ptr<MeshChangeTracker> Mesh::trackChanges() const {
+  auto tracker = std::make_shared<MeshChangeTracker>();
+  trackers_.trackers.push_back(tracker);
+  return tracker;
+}
+
+void Mesh::truncateChangedVertices(size_t size) {
+  changed_vertices_.truncate(size);
+  updateTrackers([size](MeshChangeTracker& tracker) {
+    tracker.changed_vertices_.truncate(size);
+  });
+}
+
+void Mesh::truncateChangedFaces(size_t size) {
+  changed_faces_.truncate(size);
+  updateTrackers([size](MeshChangeTracker& tracker) {
+    tracker.changed_faces_.truncate(size);
+  });
+}
+
+void Mesh::markAllChangedForTrackers() {
+  const size_t num_vertices = numVertices();
+  const size_t num_faces = numFaces();
+  updateTrackers([&](MeshChangeTracker& tracker) {
+    tracker.changed_vertices_.truncate(num_vertices);
+    tracker.changed_vertices_.add(0, num_vertices);
+    tracker.changed_faces_.truncate(num_faces);
+    tracker.changed_faces_.add(0, num_faces);
+  });
 }
 
 void Mesh::transform(const Eigen::Isometry3f& transform) {
-  for (auto& point : points) {
-    point = transform * point;
+  constexpr size_t block_size = 4096;
+  const Eigen::Matrix3f rotation = transform.linear();
+  const Eigen::Vector3f translation = transform.translation();
+  forEachChunk(points.size(), [&](size_t, size_t start, size_t end) {
+    // transform blocks that fit in cache through a fixed-size buffer
+    Eigen::Matrix3Xf buffer(3, block_size);
+    for (size_t i = start; i < end; i += block_size) {
+      const size_t num_cols = std::min(block_size, end - i);
+      PointMatrix block(points[i].data(), 3, num_cols);
+      buffer.leftCols(num_cols).noalias() = rotation * block;
+      block = buffer.leftCols(num_cols).colwise() + translation;
+    }
+  });
+
+  markVerticesChanged(0, points.size());
+}
+
+Eigen::AlignedBox3f Mesh::bounds() const {
+  std::vector<Eigen::AlignedBox3f> partial(maxChunks());
+  const auto chunk_bounds = [&](size_t chunk, size_t start, size_t end) {
+    if (end > start) {
+      const ConstPointMatrix block(points[start].data(), 3, end - start);
+      partial[chunk] = Eigen::AlignedBox3f(block.rowwise().minCoeff(),
+                                           block.rowwise().maxCoeff());
+    }
+  };
+
+  const size_t num_chunks = forEachChunk(points.size(), chunk_bounds);
+
+  Eigen::AlignedBox3f result;
+  for (size_t i = 0; i < num_chunks; ++i) {
+    if (!partial[i].isEmpty()) {
+      result.extend(partial[i]);
+    }
+  }
+  return result;
+}
+
+Mesh::Pos Mesh::centroid() const {
+  if (points.empty()) {
+    return Pos::Zero();
+  }
+
+  // accumulate in double precision to avoid drift on large meshes
+  std::vector<Eigen::Vector3d> partial(maxChunks(), Eigen::Vector3d::Zero());
+  const auto chunk_sum = [&](size_t chunk, size_t start, size_t end) {
+    const ConstPointMatrix block(points[start].data(), 3, end - start);
+    partial[chunk] = block.cast<double>().rowwise().sum();
+  };
+
+  const size_t num_chunks = forEachChunk(points.size(), chunk_sum);
+
+  Eigen::Vector3d total = Eigen::Vector3d::Zero();
+  for (size_t i = 0; i < num_chunks; ++i) {
+    total += partial[i];
+  }
+  return (total / static_cast<double>(points.size())).cast<float>();
+}
+
+std::map<Mesh::Label, size_t> Mesh::labelHistogram() const {
+  std::vector<std::map<Label, size_t>> partial(maxChunks());
+  const auto chunk_counts = [&](size_t chunk, size_t start, size_t end) {
+    // labels tend to come in runs, so count runs before touching the map
+    auto& counts = partial[chunk];
+    size_t i = start;
+    while (i < end) {
+      const Label label = labels[i];
+      const size_t run_start = i;
+      while (i < end && labels[i] == label) {
+        ++i;
+      }
+      counts[label] += i - run_start;
+    }
+  };
+
+  const size_t num_chunks = forEachChunk(labels.size(), chunk_counts);
+
+  std::map<Label, size_t> result = std::move(partial[0]);
+  for (size_t i = 1; i < num_chunks; ++i) {
+    for (const auto& [label, count] : partial[i]) {
+      result[label] += count;
+    }
+  }
+  return result;
+}
+
+std::vector<size_t> Mesh::verticesInTimeRange(Timestamp start,
+                                              Timestamp end,
+                                              bool use_first_seen) const {
+  if (end < start) {
+    return {};
+  }
+
+  const auto& values = use_first_seen ? first_seen_stamps : stamps;
+  const Timestamp range = end - start;
+  std::vector<std::vector<size_t>> partial(maxChunks());
+  const auto chunk_filter = [&](size_t chunk, size_t first, size_t last) {
+    auto& indices = partial[chunk];
+    for (size_t i = first; i < last; ++i) {
+      // single (unsigned) comparison for start <= value <= end
+      if (values[i] - start <= range) {
+        indices.push_back(i);
+      }
+    }
+  };
+
+  const size_t num_chunks = forEachChunk(values.size(), chunk_filter);
+  std::vector<size_t> result = std::move(partial[0]);
+  for (size_t i = 1; i < num_chunks; ++i) {
+    result.insert(result.end(), partial[i].begin(), partial[i].end());
   }
+  return result;
 }
 
 bool operator==(const Mesh& lhs, const Mesh& rhs) {
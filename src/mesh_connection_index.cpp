@@ -0,0 +1,334 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "spark_dsg/mesh_connection_index.h"
+
+#include <algorithm>
+#include <list>
+#include <sstream>
+#include <stdexcept>
+
+#include "spark_dsg/node_attributes.h"
+#include "spark_dsg/node_symbol.h"
+
+namespace spark_dsg {
+
+namespace {
+
+inline void sortUnique(std::vector<size_t>& values) {
+  std::sort(values.begin(), values.end());
+  values.erase(std::unique(values.begin(), values.end()), values.end());
+}
+
+inline void sortUniqueNodes(std::vector<NodeId>& nodes) {
+  std::sort(nodes.begin(), nodes.end());
+  nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+}
+
+// update a vertex index for a mesh compacted in order; returns false if erased
+inline bool remapVertex(const std::vector<size_t>& sorted_erased, size_t& vertex) {
+  const auto begin = sorted_erased.begin();
+  const auto iter = std::lower_bound(begin, sorted_erased.end(), vertex);
+  if (iter != sorted_erased.end() && *iter == vertex) {
+    return false;
+  }
+
+  vertex -= iter - begin;
+  return true;
+}
+
+// remap vertices in place, dropping the matching entries of a parallel vector
+template <typename T = size_t>
+bool remapVertices(std::vector<size_t>& vertices,
+                   const std::vector<size_t>& sorted_erased,
+                   std::vector<T>* parallel = nullptr) {
+  const bool has_parallel = parallel && parallel->size() == vertices.size();
+  bool changed = false;
+  size_t num_kept = 0;
+  for (size_t i = 0; i < vertices.size(); ++i) {
+    size_t vertex = vertices[i];
+    if (!remapVertex(sorted_erased, vertex)) {
+      changed = true;
+      continue;
+    }
+
+    changed |= vertex != vertices[i];
+    if (has_parallel && num_kept != i) {
+      (*parallel)[num_kept] = std::move((*parallel)[i]);
+    }
+
+    vertices[num_kept++] = vertex;
+  }
+
+  vertices.resize(num_kept);
+  if (has_parallel) {
+    parallel->resize(num_kept);
+  }
+
+  return changed;
+}
+
+bool remapVertices(std::list<size_t>& vertices,
+                   const std::vector<size_t>& sorted_erased) {
+  bool changed = false;
+  auto iter = vertices.begin();
+  while (iter != vertices.end()) {
+    const size_t prev = *iter;
+    if (!remapVertex(sorted_erased, *iter)) {
+      iter = vertices.erase(iter);
+      changed = true;
+      continue;
+    }
+
+    changed |= prev != *iter;
+    ++iter;
+  }
+
+  return changed;
+}
+
+}  // namespace
+
+size_t MeshConnectionIndex::numVertices() const {
+  compact();
+  return offsets_.empty() ? 0 : offsets_.size() - 1;
+}
+
+void MeshConnectionIndex::insert(NodeId node, std::vector<size_t> vertices) {
+  if (vertices.empty()) {
+    erase(node);
+    return;
+  }
+
+  sortUnique(vertices);
+  auto iter = connections_.find(node);
+  if (iter != connections_.end() && iter->second == vertices) {
+    return;
+  }
+
+  connections_[node] = std::move(vertices);
+  dirty_ = true;
+}
+
+bool MeshConnectionIndex::erase(NodeId node) {
+  if (!connections_.erase(node)) {
+    return false;
+  }
+
+  dirty_ = true;
+  return true;
+}
+
+void MeshConnectionIndex::clear() {
+  connections_.clear();
+  offsets_.clear();
+  nodes_.clear();
+  dirty_ = false;
+}
+
+void MeshConnectionIndex::compact() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!dirty_) {
+    return;
+  }
+
+  dirty_ = false;
+  std::vector<NodeId> sorted_nodes;
+  sorted_nodes.reserve(connections_.size());
+  size_t num_vertices = 0;
+  size_t num_entries = 0;
+  for (const auto& [node, vertices] : connections_) {
+    sorted_nodes.push_back(node);
+    num_vertices = std::max(num_vertices, vertices.back() + 1);
+    num_entries += vertices.size();
+  }
+
+  std::sort(sorted_nodes.begin(), sorted_nodes.end());
+
+  // counting sort by vertex: visiting nodes in order keeps every row sorted
+  offsets_.assign(num_vertices + 1, 0);
+  for (const auto& [node, vertices] : connections_) {
+    for (const auto vertex : vertices) {
+      ++offsets_[vertex + 1];
+    }
+  }
+
+  for (size_t v = 0; v < num_vertices; ++v) {
+    offsets_[v + 1] += offsets_[v];
+  }
+
+  std::vector<size_t> next(offsets_.begin(), offsets_.end() - 1);
+  nodes_.resize(num_entries);
+  for (const auto node : sorted_nodes) {
+    for (const auto vertex : connections_.at(node)) {
+      nodes_[next[vertex]++] = node;
+    }
+  }
+
+  if (num_vertices == 0) {
+    offsets_.clear();
+  }
+}
+
+const std::vector<size_t>& MeshConnectionIndex::connections(NodeId node) const {
+  auto iter = connections_.find(node);
+  if (iter == connections_.end()) {
+    std::stringstream ss;
+    ss << "node " << NodeSymbol(node).getLabel() << " not in mesh connection index";
+    throw std::out_of_range(ss.str());
+  }
+
+  return iter->second;
+}
+
+template <typename Visitor>
+void MeshConnectionIndex::visitRange(size_t start,
+                                     size_t end,
+                                     const Visitor& visitor) const {
+  compact();
+  const size_t num_vertices = offsets_.empty() ? 0 : offsets_.size() - 1;
+  end = std::min(end, num_vertices);
+  if (start >= end) {
+    return;
+  }
+
+  for (size_t i = offsets_[start]; i < offsets_[end]; ++i) {
+    visitor(nodes_[i]);
+  }
+}
+
+std::vector<NodeId> MeshConnectionIndex::nodes(size_t vertex) const {
+  std::vector<NodeId> result;
+  visitRange(vertex, vertex + 1, [&](NodeId node) { result.push_back(node); });
+  return result;
+}
+
+std::vector<NodeId> MeshConnectionIndex::nodes(
+    const std::vector<size_t>& vertices) const {
+  std::vector<NodeId> result;
+  for (const auto vertex : vertices) {
+    visitRange(vertex, vertex + 1, [&](NodeId node) { result.push_back(node); });
+  }
+
+  sortUniqueNodes(result);
+  return result;
+}
+
+std::vector<NodeId> MeshConnectionIndex::nodes(
+    const std::unordered_set<size_t>& vertices) const {
+  return nodes(std::vector<size_t>(vertices.begin(), vertices.end()));
+}
+
+std::vector<NodeId> MeshConnectionIndex::nodesInRange(size_t start, size_t end) const {
+  std::vector<NodeId> result;
+  visitRange(start, end, [&](NodeId node) { result.push_back(node); });
+  sortUniqueNodes(result);
+  return result;
+}
+
+std::vector<std::vector<NodeId>> MeshConnectionIndex::nodesPerVertex(
+    const std::vector<size_t>& vertices) const {
+  std::vector<std::vector<NodeId>> result(vertices.size());
+  for (size_t i = 0; i < vertices.size(); ++i) {
+    visitRange(vertices[i], vertices[i] + 1, [&](NodeId node) {
+      result[i].push_back(node);
+    });
+  }
+
+  return result;
+}
+
+std::vector<size_t> MeshConnectionIndex::getConnections(const NodeAttributes& attrs) {
+  std::vector<size_t> vertices;
+  if (const auto object = dynamic_cast<const ObjectNodeAttributes*>(&attrs)) {
+    vertices.assign(object->mesh_connections.begin(), object->mesh_connections.end());
+  } else if (const auto place = dynamic_cast<const PlaceNodeAttributes*>(&attrs)) {
+    vertices = place->pcl_mesh_connections;
+    vertices.insert(vertices.end(),
+                    place->deformation_connections.begin(),
+                    place->deformation_connections.end());
+  } else if (const auto place = dynamic_cast<const Place2dNodeAttributes*>(&attrs)) {
+    vertices = place->pcl_mesh_connections;
+    vertices.insert(vertices.end(),
+                    place->pcl_boundary_connections.begin(),
+                    place->pcl_boundary_connections.end());
+    vertices.insert(vertices.end(),
+                    place->deformation_connections.begin(),
+                    place->deformation_connections.end());
+  }
+
+  sortUnique(vertices);
+  return vertices;
+}
+
+bool MeshConnectionIndex::remapConnections(NodeAttributes& attrs,
+                                           const std::vector<size_t>& sorted_erased) {
+  if (sorted_erased.empty()) {
+    return false;
+  }
+
+  if (auto object = dynamic_cast<ObjectNodeAttributes*>(&attrs)) {
+    return remapVertices(object->mesh_connections, sorted_erased);
+  }
+
+  if (auto place = dynamic_cast<PlaceNodeAttributes*>(&attrs)) {
+    bool changed = remapVertices(
+        place->pcl_mesh_connections, sorted_erased, &place->mesh_vertex_labels);
+    changed |= remapVertices(place->deformation_connections, sorted_erased);
+    return changed;
+  }
+
+  if (auto place = dynamic_cast<Place2dNodeAttributes*>(&attrs)) {
+    bool changed = remapVertices(
+        place->pcl_mesh_connections, sorted_erased, &place->mesh_vertex_labels);
+    changed |= remapVertices(
+        place->pcl_boundary_connections, sorted_erased, &place->boundary);
+    changed |= remapVertices(place->deformation_connections, sorted_erased);
+    if (changed && place->pcl_mesh_connections.empty()) {
+      place->pcl_min_index = 0;
+      place->pcl_max_index = 0;
+    } else if (changed) {
+      const auto bounds = std::minmax_element(place->pcl_mesh_connections.begin(),
+                                              place->pcl_mesh_connections.end());
+      place->pcl_min_index = *bounds.first;
+      place->pcl_max_index = *bounds.second;
+    }
+
+    return changed;
+  }
+
+  return false;
+}
+
+}  // namespace spark_dsg
@@ -0,0 +1,522 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "spark_dsg/mesh_simplification.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_set>
+
+namespace spark_dsg {
+
+namespace {
+
+// keeps voxel indices well inside the range of an int for far-away positions
+constexpr double MAX_CELL_INDEX = 1.0e9;
+
+// voxel of vertices without a finite position (outside the clamped range)
+const Eigen::Vector3i INVALID_CELL =
+    Eigen::Vector3i::Constant(std::numeric_limits<int>::min());
+
+inline bool cellLess(const Eigen::Vector3i& lhs, const Eigen::Vector3i& rhs) {
+  return std::lexicographical_compare(
+      lhs.data(), lhs.data() + 3, rhs.data(), rhs.data() + 3);
+}
+
+}  // namespace
+
+Mesh::Ptr simplifyMesh(const Mesh& mesh, float voxel_size) {
+  MeshSimplifier simplifier(voxel_size);
+  return std::make_shared<Mesh>(simplifier.update(mesh));
+}
+
+size_t MeshSimplifier::CellHash::operator()(const Cell& cell) const {
+  // same spatial hash as the spatial index (Teschner et al., 2003)
+  return static_cast<size_t>(cell.x()) * 73856093 ^
+         static_cast<size_t>(cell.y()) * 19349663 ^
+         static_cast<size_t>(cell.z()) * 83492791;
+}
+
+size_t MeshSimplifier::FaceKeyHash::operator()(const FaceKey& key) const {
+  const CellHash hash;
+  size_t seed = 0;
+  for (const auto& cell : key) {
+    seed ^= hash(cell) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+  }
+  return seed;
+}
+
+bool MeshSimplifier::FaceKeyEqual::operator()(const FaceKey& lhs,
+                                              const FaceKey& rhs) const {
+  return lhs[0] == rhs[0] && lhs[1] == rhs[1] && lhs[2] == rhs[2];
+}
+
+MeshSimplifier::MeshSimplifier(float voxel_size) : voxel_size_(voxel_size) {
+  if (!(voxel_size_ > 0.0f)) {
+    std::stringstream ss;
+    ss << "invalid mesh simplification voxel size: " << voxel_size;
+    throw std::invalid_argument(ss.str());
+  }
+}
+
+void MeshSimplifier::reset() {
+  mesh_ = nullptr;
+  stream_id_ = 0;
+  tracker_.reset();
+  vertex_cells_.clear();
+  vertex_slots_.clear();
+  faces_.clear();
+  vertex_faces_.clear();
+  dangling_faces_.clear();
+  clusters_.clear();
+  face_entries_.clear();
+  output_cells_.clear();
+  output_faces_.clear();
+  simplified_ = Mesh();
+}
+
+const Mesh& MeshSimplifier::update(const Mesh& mesh) {
+  const size_t num_vertices = mesh.numVertices();
+  const size_t num_faces = mesh.numFaces();
+  if (!tracker_ || &mesh != mesh_ || mesh.streamId() != stream_id_) {
+    reset();
+    simplified_ = Mesh(mesh.has_colors,
+                       mesh.has_timestamps,
+                       mesh.has_labels,
+                       mesh.has_first_seen_stamps);
+    mesh_ = &mesh;
+    stream_id_ = mesh.streamId();
+    tracker_ = mesh.trackChanges();
+  } else if (!tracker_->hasChanges() && num_vertices == vertex_cells_.size() &&
+             num_faces == faces_.size()) {
+    return simplified_;
+  }
+
+  simplified_.clearChanges();
+  const size_t prev_vertices = vertex_cells_.size();
+  const size_t prev_faces = faces_.size();
+  const size_t num_existing = std::min(num_vertices, prev_vertices);
+  const size_t faces_existing = std::min(num_faces, prev_faces);
+
+  // voxels to update (in order of first use so that new vertices are ordered)
+  std::vector<Cell> dirty;
+  std::unordered_set<Cell, CellHash> dirty_set;
+  const auto mark_dirty = [&](const Cell& cell) {
+    if (dirty_set.insert(cell).second) {
+      dirty.push_back(cell);
+    }
+  };
+
+  // faces that changed or use a vertex that moves to another voxel or is removed
+  std::vector<size_t> affected;
+  std::vector<std::pair<size_t, Cell>> moves;
+  for (const auto& [start, end] : tracker_->changedVertices().ranges()) {
+    for (size_t i = start; i < std::min(end, num_existing); ++i) {
+      const auto cell = getCell(mesh.points[i]);
+      mark_dirty(cell);
+      if (cell == vertex_cells_[i]) {
+        continue;
+      }
+
+      mark_dirty(vertex_cells_[i]);
+      moves.emplace_back(i, cell);
+      affected.insert(affected.end(), vertex_faces_[i].begin(), vertex_faces_[i].end());
+    }
+  }
+
+  for (size_t i = num_vertices; i < prev_vertices; ++i) {
+    mark_dirty(vertex_cells_[i]);
+    affected.insert(affected.end(), vertex_faces_[i].begin(), vertex_faces_[i].end());
+  }
+
+  for (const auto& [start, end] : tracker_->changedFaces().ranges()) {
+    for (size_t i = start; i < std::min(end, faces_existing); ++i) {
+      affected.push_back(i);
+    }
+  }
+
+  for (size_t i = num_faces; i < prev_faces; ++i) {
+    affected.push_back(i);
+  }
+
+  if (num_vertices > prev_vertices) {
+    affected.insert(affected.end(), dangling_faces_.begin(), dangling_faces_.end());
+  }
+
+  std::sort(affected.begin(), affected.end());
+  affected.erase(std::unique(affected.begin(), affected.end()), affected.end());
+
+  // detach faces while their vertices are still assigned to the previous voxels
+  for (const auto index : affected) {
+    removeFace(index);
+  }
+
+  for (size_t i = num_vertices; i < prev_vertices; ++i) {
+    removeVertex(i);
+  }
+
+  vertex_cells_.resize(num_vertices);
+  vertex_slots_.resize(num_vertices);
+  vertex_faces_.resize(num_vertices);
+  for (const auto& [index, cell] : moves) {
+    removeVertex(index);
+    addVertex(index, cell);
+  }
+
+  for (size_t i = num_existing; i < num_vertices; ++i) {
+    const auto cell = getCell(mesh.points[i]);
+    mark_dirty(cell);
+    addVertex(i, cell);
+  }
+
+  for (const auto& cell : dirty) {
+    updateCluster(mesh, cell);
+  }
+
+  // reattach faces with the updated voxels
+  faces_.resize(num_faces);
+  for (const auto index : affected) {
+    if (index < num_faces) {
+      faces_[index] = mesh.faces[index];
+      addFace(index);
+    }
+  }
+
+  for (size_t i = faces_existing; i < num_faces; ++i) {
+    faces_[i] = mesh.faces[i];
+    addFace(i);
+  }
+
+  tracker_->clearChanges();
+  return simplified_;
+}
+
+MeshSimplifier::Cell MeshSimplifier::getCell(const Mesh::Pos& pos) const {
+  // NaN survives the clamp below and casting it to int is undefined
+  if (!pos.allFinite()) {
+    return INVALID_CELL;
+  }
+
+  Cell cell;
+  for (int i = 0; i < 3; ++i) {
+    const double index = std::floor(static_cast<double>(pos(i)) / voxel_size_);
+    cell(i) = static_cast<int>(std::clamp(index, -MAX_CELL_INDEX, MAX_CELL_INDEX));
+  }
+  return cell;
+}
+
+bool MeshSimplifier::getFaceKey(const Mesh::Face& face, FaceKey& key) const {
+  for (size_t i = 0; i < 3; ++i) {
+    if (face[i] >= vertex_cells_.size()) {
+      return false;
+    }
+
+    key[i] = vertex_cells_[face[i]];
+    if (key[i] == INVALID_CELL) {
+      return false;
+    }
+  }
+
+  if (key[0] == key[1] || key[1] == key[2] || key[0] == key[2]) {
+    return false;
+  }
+
+  // rotate the smallest voxel to the front (keeping the winding order)
+  size_t first = 0;
+  for (size_t i = 1; i < 3; ++i) {
+    if (cellLess(key[i], key[first])) {
+      first = i;
+    }
+  }
+
+  std::rotate(key.begin(), key.begin() + first, key.end());
+  return true;
+}
+
+void MeshSimplifier::addVertex(size_t index, const Cell& cell) {
+  vertex_cells_[index] = cell;
+  if (cell == INVALID_CELL) {
+    return;
+  }
+
+  auto& vertices = clusters_[cell].vertices;
+  vertex_slots_[index] = vertices.size();
+  vertices.push_back(index);
+}
+
+void MeshSimplifier::removeVertex(size_t index) {
+  if (vertex_cells_[index] == INVALID_CELL) {
+    return;
+  }
+
+  auto& vertices = clusters_.at(vertex_cells_[index]).vertices;
+  const size_t slot = vertex_slots_[index];
+  const size_t last = vertices.back();
+  vertices[slot] = last;
+  vertex_slots_[last] = slot;
+  vertices.pop_back();
+}
+
+void MeshSimplifier::addFace(size_t index) {
+  const auto& face = faces_[index];
+  bool dangling = false;
+  for (const auto vertex : face) {
+    if (vertex < vertex_faces_.size()) {
+      vertex_faces_[vertex].push_back(index);
+    } else {
+      dangling = true;
+    }
+  }
+
+  if (dangling) {
+    dangling_faces_.insert(index);
+  }
+
+  FaceKey key;
+  if (!getFaceKey(face, key)) {
+    return;
+  }
+
+  auto& entry = face_entries_[key];
+  if (entry.count++ > 0) {
+    return;
+  }
+
+  entry.output = output_faces_.size();
+  output_faces_.push_back(key);
+  simplified_.faces.push_back({{clusters_.at(key[0]).output,
+                                clusters_.at(key[1]).output,
+                                clusters_.at(key[2]).output}});
+  simplified_.markFacesChanged(entry.output, entry.output + 1);
+}
+
+void MeshSimplifier::removeFace(size_t index) {
+  const auto& face = faces_[index];
+  for (const auto vertex : face) {
+    if (vertex >= vertex_faces_.size()) {
+      continue;
+    }
+
+    auto& faces = vertex_faces_[vertex];
+    *std::find(faces.begin(), faces.end(), index) = faces.back();
+    faces.pop_back();
+  }
+
+  dangling_faces_.erase(index);
+
+  FaceKey key;
+  if (!getFaceKey(face, key)) {
+    return;
+  }
+
+  auto iter = face_entries_.find(key);
+  if (--iter->second.count > 0) {
+    return;
+  }
+
+  // move the last face into the place of the removed one
+  const size_t output = iter->second.output;
+  const size_t last = output_faces_.size() - 1;
+  face_entries_.erase(iter);
+  if (output != last) {
+    output_faces_[output] = output_faces_[last];
+    simplified_.faces[output] = simplified_.faces[last];
+    face_entries_.at(output_faces_[output]).output = output;
+    simplified_.markFacesChanged(output, output + 1);
+  }
+
+  output_faces_.pop_back();
+  simplified_.resizeFaces(last);
+}
+
+void MeshSimplifier::updateCluster(const Mesh& mesh, const Cell& cell) {
+  auto iter = clusters_.find(cell);
+  if (iter == clusters_.end()) {
+    return;
+  }
+
+  auto& cluster = iter->second;
+  if (cluster.vertices.empty()) {
+    if (cluster.has_output) {
+      removeOutputVertex(cluster.output);
+    }
+
+    clusters_.erase(iter);
+    return;
+  }
+
+  if (!cluster.has_output) {
+    cluster.output = output_cells_.size();
+    cluster.has_output = true;
+    output_cells_.push_back(cell);
+    simplified_.resizeVertices(output_cells_.size());
+  }
+
+  Eigen::Vector3d pos = Eigen::Vector3d::Zero();
+  std::array<size_t, 4> color{0, 0, 0, 0};
+  size_t num_colors = 0;
+  std::unordered_map<Mesh::Label, size_t> labels;
+  Mesh::Timestamp stamp = 0;
+  Mesh::Timestamp first_seen = std::numeric_limits<Mesh::Timestamp>::max();
+  for (const auto index : cluster.vertices) {
+    pos += mesh.points[index].cast<double>();
+    if (index < mesh.colors.size()) {
+      const auto& c = mesh.colors[index];
+      color[0] += c.r;
+      color[1] += c.g;
+      color[2] += c.b;
+      color[3] += c.a;
+      ++num_colors;
+    }
+    if (index < mesh.labels.size()) {
+      ++labels[mesh.labels[index]];
+    }
+    if (index < mesh.stamps.size()) {
+      stamp = std::max(stamp, mesh.stamps[index]);
+    }
+    if (index < mesh.first_seen_stamps.size()) {
+      first_seen = std::min(first_seen, mesh.first_seen_stamps[index]);
+    }
+  }
+
+  const size_t output = cluster.output;
+  simplified_.points[output] = (pos / cluster.vertices.size()).cast<float>();
+  if (simplified_.has_colors) {
+    Color mean_color;
+    if (num_colors) {
+      const auto mean = [&](size_t i) {
+        return static_cast<uint8_t>((color[i] + num_colors / 2) / num_colors);
+      };
+      mean_color = Color(mean(0), mean(1), mean(2), mean(3));
+    }
+    simplified_.colors[output] = mean_color;
+  }
+
+  if (simplified_.has_labels) {
+    // most common label (ties go to the smallest label)
+    Mesh::Label best_label = 0;
+    size_t best_count = 0;
+    for (const auto& [label, count] : labels) {
+      if (count > best_count || (count == best_count && label < best_label)) {
+        best_label = label;
+        best_count = count;
+      }
+    }
+    simplified_.labels[output] = best_label;
+  }
+
+  if (simplified_.has_timestamps) {
+    simplified_.stamps[output] = stamp;
+  }
+
+  if (simplified_.has_first_seen_stamps) {
+    const bool valid = first_seen != std::numeric_limits<Mesh::Timestamp>::max();
+    simplified_.first_seen_stamps[output] = valid ? first_seen : 0;
+  }
+
+  simplified_.markVerticesChanged(output, output + 1);
+}
+
+void MeshSimplifier::removeOutputVertex(size_t index) {
+  // move the last vertex into the place of the removed one
+  const size_t last = output_cells_.size() - 1;
+  if (index != last) {
+    const Cell moved = output_cells_[last];
+    output_cells_[index] = moved;
+    auto& cluster = clusters_.at(moved);
+    cluster.output = index;
+
+    simplified_.points[index] = simplified_.points[last];
+    if (simplified_.has_colors) {
+      simplified_.colors[index] = simplified_.colors[last];
+    }
+    if (simplified_.has_labels) {
+      simplified_.labels[index] = simplified_.labels[last];
+    }
+    if (simplified_.has_timestamps) {
+      simplified_.stamps[index] = simplified_.stamps[last];
+    }
+    if (simplified_.has_first_seen_stamps) {
+      simplified_.first_seen_stamps[index] = simplified_.first_seen_stamps[last];
+    }
+    simplified_.markVerticesChanged(index, index + 1);
+
+    // only faces using a vertex of the moved voxel can refer to it
+    for (const auto vertex : cluster.vertices) {
+      for (const auto face : vertex_faces_[vertex]) {
+        FaceKey key;
+        if (!getFaceKey(faces_[face], key)) {
+          continue;
+        }
+
+        const size_t output = face_entries_.at(key).output;
+        for (auto& face_vertex : simplified_.faces[output]) {
+          if (face_vertex == last) {
+            face_vertex = index;
+          }
+        }
+        simplified_.markFacesChanged(output, output + 1);
+      }
+    }
+  }
+
+  output_cells_.pop_back();
+  simplified_.resizeVertices(last);
+}
+
+MeshLevelsOfDetail::MeshLevelsOfDetail(const std::vector<float>& voxel_sizes) {
+  levels_.reserve(voxel_sizes.size());
+  for (const auto voxel_size : voxel_sizes) {
+    levels_.emplace_back(voxel_size);
+  }
+}
+
+void MeshLevelsOfDetail::update(const Mesh& mesh) {
+  for (auto& level : levels_) {
+    level.update(mesh);
+  }
+}
+
+const Mesh& MeshLevelsOfDetail::level(size_t index) const {
+  return levels_.at(index).simplified();
+}
+
+float MeshLevelsOfDetail::voxelSize(size_t index) const {
+  return levels_.at(index).voxelSize();
+}
+
+}  // namespace spark_dsg
@@ -34,23 +34,107 @@
  * -------------------------------------------------------------------------- */
 #include "spark_dsg/scene_graph_layer.h"
 
+#include <algorithm>
+#include <memory>
+#include <mutex>
 #include <queue>
 #include <sstream>
 
 #include "spark_dsg/edge_attributes.h"
 #include "spark_dsg/logging.h"
+#include "spark_dsg/node_attributes.h"
 
 namespace spark_dsg {
 
 using Node = SceneGraphNode;
 using Edge = SceneGraphEdge;
+using graph_utilities::TraversalWorkspace;
+
+namespace {
+
+inline TraversalWorkspace& getWorkspace(size_t num_nodes) {
+  // shared by every layer queried from this thread: drop the node index when it is
+  // mostly made up of nodes from other (or removed) layers
+  thread_local TraversalWorkspace workspace;
+  if (workspace.numIndexed() > std::max<size_t>(2 * num_nodes, 1 << 18)) {
+    workspace.clear();
+  }
+
+  return workspace;
+}
+
+}  // namespace
+
+using NodeSet = std::unordered_set<NodeId>;
+
+struct SceneGraphLayer::NeighborhoodCache {
+  using Key = std::pair<NodeId, size_t>;
+
+  struct KeyHash {
+    size_t operator()(const Key& key) const {
+      return std::hash<NodeId>()(key.first) ^ (key.second * 0x9e3779b97f4a7c15ULL);
+    }
+  };
+
+  void insert(const Key& key, const NodeSet& result) {
+    if (!entries.emplace(key, result).second) {
+      return;
+    }
+
+    for (const auto node : result) {
+      members[node].push_back(key);
+    }
+  }
+
+  void invalidate(NodeId node) {
+    auto iter = members.find(node);
+    if (iter == members.end()) {
+      return;
+    }
+
+    const auto keys = std::move(iter->second);
+    members.erase(iter);
+    for (const auto& key : keys) {
+      auto entry = entries.find(key);
+      // drop the entry from the lists of every other member
+      for (const auto member : entry->second) {
+        auto list = members.find(member);
+        if (list == members.end()) {
+          continue;
+        }
+
+        auto& entry_keys = list->second;
+        *std::find(entry_keys.begin(), entry_keys.end(), key) = entry_keys.back();
+        entry_keys.pop_back();
+        if (entry_keys.empty()) {
+          members.erase(list);
+        }
+      }
+
+      entries.erase(entry);
+    }
+  }
+
+  std::mutex mutex;
+  std::unordered_map<Key, NodeSet, KeyHash> entries;
+  //! keys of the cached neighborhoods containing each node
+  std::unordered_map<NodeId, std::vector<Key>> members;
+};
 
 SceneGraphLayer::SceneGraphLayer(LayerId layer_id) : id(layer_id) {}
 
+SceneGraphLayer::~SceneGraphLayer() = default;
+
 bool SceneGraphLayer::emplaceNode(NodeId node_id, NodeAttributes::Ptr&& attrs) {
   nodes_status_[node_id] = NodeStatus::NEW;
-  return nodes_.emplace(node_id, std::make_unique<Node>(node_id, id, std::move(attrs)))
-      .second;
+  const bool inserted =
+      nodes_.emplace(node_id, std::make_unique<Node>(node_id, id, std::move(attrs)))
+          .second;
+  if (inserted) {
+    refreshIndices(node_id);
+  }
+
+  return inserted;
 }
 
 bool SceneGraphLayer::insertNode(SceneGraphNode::Ptr&& node) {
@@ -73,6 +157,7 @@ bool SceneGraphLayer::insertNode(SceneGraphNode::Ptr&& node) {
   NodeId to_insert = node->id;
   nodes_status_[to_insert] = NodeStatus::NEW;
   nodes_[to_insert] = std::move(node);
+  refreshIndices(to_insert);
   return true;
 }
 
@@ -102,6 +187,8 @@ bool SceneGraphLayer::insertEdge(NodeId source,
   nodes_[target]->siblings_.insert(source);
 
   edges_.insert(source, target, std::move(edge_info));
+  invalidateNeighborhoods(source);
+  invalidateNeighborhoods(target);
   return true;
 }
 
@@ -143,6 +230,8 @@ bool SceneGraphLayer::removeNode(NodeId node_id) {
   // remove the actual node
   nodes_.erase(node_id);
   nodes_status_[node_id] = NodeStatus::DELETED;
+  refreshIndices(node_id);
+  invalidateNeighborhoods(node_id);
   return true;
 }
 
@@ -164,6 +253,8 @@ bool SceneGraphLayer::mergeNodes(NodeId node_from, NodeId node_to) {
   // remove the actual node
   nodes_.erase(node_from);
   nodes_status_[node_from] = NodeStatus::MERGED;
+  refreshIndices(node_from);
+  invalidateNeighborhoods(node_from);
   return true;
 }
 
@@ -176,6 +267,8 @@ bool SceneGraphLayer::removeEdge(NodeId source, NodeId target) {
   nodes_[target]->siblings_.erase(source);
 
   edges_.remove(source, target);
+  invalidateNeighborhoods(source);
+  invalidateNeighborhoods(target);
   return true;
 }
 
@@ -207,6 +300,9 @@ bool SceneGraphLayer::rewireEdge(NodeId source,
   nodes_[target]->siblings_.erase(source);
   nodes_[new_source]->siblings_.insert(new_target);
   nodes_[new_target]->siblings_.insert(new_source);
+  for (const auto node : {source, target, new_source, new_target}) {
+    invalidateNeighborhoods(node);
+  }
   return true;
 }
 
@@ -236,12 +332,14 @@ bool SceneGraphLayer::mergeLayer(const SceneGraphLayer& other_layer,
       }
 
       iter->second->attributes_ = other.attributes_->clone();
+      refreshIndices(iter->first);
       continue;
     }
 
     auto attrs = other.attributes_->clone();
     nodes_[other.id] = Node::Ptr(new Node(other.id, id, std::move(attrs)));
     nodes_status_[other.id] = NodeStatus::NEW;
+    refreshIndices(other.id);
 
     if (layer_lookup) {
       layer_lookup->insert({other.id, id});
@@ -277,6 +375,109 @@ Eigen::Vector3d SceneGraphLayer::getPosition(NodeId node) const {
   return nodes_.at(node)->attributes().position;
 }
 
+const SpatialIndex& SceneGraphLayer::spatialIndex(double resolution) const {
+  std::lock_guard<std::mutex> lock(index_mutex_);
+  auto iter = spatial_indices_.find(resolution);
+  if (iter != spatial_indices_.end()) {
+    return *iter->second;
+  }
+
+  auto index = std::make_unique<SpatialIndex>(resolution);
+  for (const auto& id_node_pair : nodes_) {
+    const auto& attrs = id_node_pair.second->attributes_;
+    if (attrs && attrs->position.allFinite()) {
+      index->insert(id_node_pair.first, attrs->position);
+    }
+  }
+
+  return *spatial_indices_.emplace(resolution, std::move(index)).first->second;
+}
+
+void SceneGraphLayer::refreshPosition(NodeId node) const {
+  if (spatial_indices_.empty()) {
+    return;
+  }
+
+  auto iter = nodes_.find(node);
+  const bool valid = iter != nodes_.end() && iter->second->attributes_ &&
+                     iter->second->attributes_->position.allFinite();
+  for (auto& resolution_index_pair : spatial_indices_) {
+    auto& index = *resolution_index_pair.second;
+    if (valid) {
+      index.insert(node, iter->second->attributes_->position);
+    } else {
+      index.erase(node);
+    }
+  }
+}
+
+const BoundingBoxIndex& SceneGraphLayer::boundingBoxIndex() const {
+  std::lock_guard<std::mutex> lock(index_mutex_);
+  if (bounding_box_index_) {
+    return *bounding_box_index_;
+  }
+
+  bounding_box_index_ = std::make_unique<BoundingBoxIndex>();
+  for (const auto& id_node_pair : nodes_) {
+    refreshBoundingBox(id_node_pair.first);
+  }
+
+  bounding_box_index_->rebuild();
+  return *bounding_box_index_;
+}
+
+void SceneGraphLayer::refreshBoundingBox(NodeId node) const {
+  if (!bounding_box_index_) {
+    return;
+  }
+
+  auto iter = nodes_.find(node);
+  const auto attrs = iter == nodes_.end()
+                         ? nullptr
+                         : dynamic_cast<const SemanticNodeAttributes*>(
+                               iter->second->attributes_.get());
+  if (!attrs) {
+    bounding_box_index_->erase(node);
+    return;
+  }
+
+  bounding_box_index_->insert(node, attrs->bounding_box);
+}
+
+const MeshConnectionIndex& SceneGraphLayer::meshConnectionIndex() const {
+  std::lock_guard<std::mutex> lock(index_mutex_);
+  if (!mesh_connection_index_) {
+    mesh_connection_index_ = std::make_unique<MeshConnectionIndex>();
+    for (const auto& id_node_pair : nodes_) {
+      refreshMeshConnections(id_node_pair.first);
+    }
+  }
+
+  mesh_connection_index_->compact();
+  return *mesh_connection_index_;
+}
+
+void SceneGraphLayer::refreshMeshConnections(NodeId node) const {
+  if (!mesh_connection_index_) {
+    return;
+  }
+
+  auto iter = nodes_.find(node);
+  if (iter == nodes_.end() || !iter->second->attributes_) {
+    mesh_connection_index_->erase(node);
+    return;
+  }
+
+  mesh_connection_index_->insert(
+      node, MeshConnectionIndex::getConnections(*iter->second->attributes_));
+}
+
+void SceneGraphLayer::refreshIndices(NodeId node) const {
+  refreshPosition(node);
+  refreshBoundingBox(node);
+  refreshMeshConnections(node);
+}
+
 void SceneGraphLayer::getNewNodes(std::vector<NodeId>& new_nodes, bool clear_new) {
   auto iter = nodes_status_.begin();
   while (iter != nodes_status_.end()) {
@@ -332,25 +533,97 @@ void SceneGraphLayer::reset() {
   nodes_.clear();
   nodes_status_.clear();
   edges_.reset();
+  spatial_indices_.clear();
+  bounding_box_index_.reset();
+  mesh_connection_index_.reset();
+  if (neighborhoodCache()) {
+    enableNeighborhoodCache(true);
+  }
 }
 
-using NodeSet = std::unordered_set<NodeId>;
+void SceneGraphLayer::enableNeighborhoodCache(bool enable) const {
+  // queries in flight keep using (and then release) the previous cache
+  std::atomic_store(&neighborhood_cache_,
+                    enable ? std::make_shared<NeighborhoodCache>() : nullptr);
+}
+
+std::shared_ptr<SceneGraphLayer::NeighborhoodCache>
+SceneGraphLayer::neighborhoodCache() const {
+  return std::atomic_load(&neighborhood_cache_);
+}
+
+size_t SceneGraphLayer::numCachedNeighborhoods() const {
+  const auto cache = neighborhoodCache();
+  if (!cache) {
+    return 0;
+  }
+
+  std::lock_guard<std::mutex> lock(cache->mutex);
+  return cache->entries.size();
+}
+
+void SceneGraphLayer::invalidateNeighborhoods(NodeId node) {
+  const auto cache = neighborhoodCache();
+  if (!cache) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(cache->mutex);
+  cache->invalidate(node);
+}
 
 NodeSet SceneGraphLayer::getNeighborhood(NodeId node, size_t num_hops) const {
+  const NeighborhoodCache::Key key{node, num_hops};
+  const auto cache = neighborhoodCache();
+  if (cache) {
+    std::lock_guard<std::mutex> lock(cache->mutex);
+    const auto iter = cache->entries.find(key);
+    if (iter != cache->entries.end()) {
+      return iter->second;
+    }
+  }
+
   NodeSet result;
   graph_utilities::breadthFirstSearch(
-      *this, node, num_hops, [&](const SceneGraphLayer&, NodeId visited) {
-        result.insert(visited);
-      });
+      *this,
+      node,
+      num_hops,
+      getWorkspace(nodes_.size()),
+      [&](const SceneGraphLayer&, NodeId visited) { result.insert(visited); });
+
+  if (cache && hasNode(node)) {
+    std::lock_guard<std::mutex> lock(cache->mutex);
+    cache->insert(key, result);
+  }
+
   return result;
 }
 
 NodeSet SceneGraphLayer::getNeighborhood(const NodeSet& nodes, size_t num_hops) const {
   NodeSet result;
+  const auto cache = neighborhoodCache();
+  if (cache) {
+    std::lock_guard<std::mutex> lock(cache->mutex);
+    const auto& entries = cache->entries;
+    const bool all_cached = std::all_of(nodes.begin(), nodes.end(), [&](NodeId node) {
+      return entries.count({node, num_hops});
+    });
+
+    if (all_cached) {
+      for (const auto node : nodes) {
+        const auto& neighborhood = entries.at({node, num_hops});
+        result.insert(neighborhood.begin(), neighborhood.end());
+      }
+      return result;
+    }
+  }
+
   graph_utilities::breadthFirstSearch(
-      *this, nodes, num_hops, [&](const SceneGraphLayer&, NodeId visited) {
-        result.insert(visited);
-      });
+      *this,
+      nodes,
+      num_hops,
+      getWorkspace(nodes_.size()),
+      [&](const SceneGraphLayer&, NodeId visited) { result.insert(visited); });
   return result;
 }
 
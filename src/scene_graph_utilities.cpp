@@ -35,6 +35,8 @@
 #include "spark_dsg/scene_graph_utilities.h"
 
 #include "spark_dsg/bounding_box_extraction.h"
+#include "spark_dsg/mesh_connection_index.h"
+#include "spark_dsg/parallel_blocks.h"
 
 namespace spark_dsg {
 
@@ -97,4 +99,65 @@ BoundingBox computeAncestorBoundingBox(const DynamicSceneGraph& graph,
   return bounding_box::extract(adaptor, bbox_type);
 }
 
+std::map<NodeId, BoundingBox> computeMeshBoundingBoxes(const SceneGraphLayer& layer,
+                                                       const Mesh& mesh,
+                                                       BoundingBox::Type bbox_type,
+                                                       size_t num_threads) {
+  std::vector<const SceneGraphNode*> nodes;
+  nodes.reserve(layer.numNodes());
+  for (const auto& id_node_pair : layer.nodes()) {
+    nodes.push_back(id_node_pair.second.get());
+  }
+
+  // nodes vary widely in size, so threads claim small blocks of nodes at a time
+  constexpr size_t block_size = 16;
+  std::vector<BoundingBox> boxes(nodes.size());
+  detail::parallelFor(nodes.size(), block_size, num_threads, [&](size_t i) {
+    const auto connections =
+        MeshConnectionIndex::getConnections(nodes[i]->attributes());
+    if (connections.empty() || connections.back() >= mesh.numVertices()) {
+      return;
+    }
+
+    boxes[i] = bounding_box::extract(mesh, connections, bbox_type);
+  });
+
+  std::map<NodeId, BoundingBox> result;
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    if (boxes[i].type != BoundingBox::Type::INVALID) {
+      result.emplace(nodes[i]->id, boxes[i]);
+    }
+  }
+
+  return result;
+}
+
+size_t updateMeshBoundingBoxes(DynamicSceneGraph& graph,
+                               LayerId layer_id,
+                               BoundingBox::Type bbox_type,
+                               size_t num_threads) {
+  if (!graph.hasMesh() || !graph.hasLayer(layer_id)) {
+    return 0;
+  }
+
+  const auto& layer = graph.getLayer(layer_id);
+  const auto boxes =
+      computeMeshBoundingBoxes(layer, *graph.mesh(), bbox_type, num_threads);
+
+  size_t num_updated = 0;
+  for (const auto& [node_id, box] : boxes) {
+    auto attrs =
+        dynamic_cast<SemanticNodeAttributes*>(&layer.getNode(node_id).attributes());
+    if (!attrs) {
+      continue;
+    }
+
+    attrs->bounding_box = box;
+    layer.refreshBoundingBox(node_id);
+    ++num_updated;
+  }
+
+  return num_updated;
+}
+
 }  // namespace spark_dsg
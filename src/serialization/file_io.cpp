@@ -79,23 +79,34 @@ FileType verifyFileExtension(std::string& filepath) {
   return type;
 }
 
-void saveDsgBinary(const DynamicSceneGraph& graph,
-                   const std::string& filepath,
-                   bool include_mesh) {
+void writeBinaryFile(const std::string& filepath,
+                     const std::vector<uint8_t>& graph_buffer) {
   // Get the header data.
   const FileHeader header = FileHeader::current();
   const std::vector<uint8_t> header_buffer = header.serializeToBinary();
 
-  // Get the DSG data.
-  std::vector<uint8_t> graph_buffer;
-  binary::writeGraph(graph, graph_buffer, include_mesh);
-
   // Write the header and graph data to the file.
   std::ofstream out(filepath, std::ios::out | std::ios::binary);
   out.write(reinterpret_cast<const char*>(header_buffer.data()), header_buffer.size());
   out.write(reinterpret_cast<const char*>(graph_buffer.data()), graph_buffer.size());
 }
 
+void saveDsgBinary(const DynamicSceneGraph& graph,
+                   const std::string& filepath,
+                   bool include_mesh) {
+  std::vector<uint8_t> graph_buffer;
+  binary::writeGraph(graph, graph_buffer, include_mesh);
+  writeBinaryFile(filepath, graph_buffer);
+}
+
+void saveDsgBinary(const DynamicSceneGraph& graph,
+                   const std::string& filepath,
+                   const Mesh& mesh) {
+  std::vector<uint8_t> graph_buffer;
+  binary::writeGraph(graph, graph_buffer, mesh);
+  writeBinaryFile(filepath, graph_buffer);
+}
+
 DynamicSceneGraph::Ptr loadDsgBinary(const std::string& filepath) {
   // Read the file into a buffer.
   std::ifstream infile(filepath, std::ios::in | std::ios::binary);
@@ -122,6 +133,13 @@ void saveDsgJson(const DynamicSceneGraph& graph,
   outfile << json::writeGraph(graph, include_mesh);
 }
 
+void saveDsgJson(const DynamicSceneGraph& graph,
+                 const std::string& filepath,
+                 const Mesh& mesh) {
+  std::ofstream outfile(filepath);
+  outfile << json::writeGraph(graph, mesh);
+}
+
 DynamicSceneGraph::Ptr loadDsgJson(const std::string& filepath) {
   std::ifstream infile(filepath);
   std::stringstream ss;
@@ -81,9 +81,9 @@ NodeId parseNode(const AttributeFactory<NodeAttributes>& factory,
   return node;
 }
 
-void parseEdge(const AttributeFactory<EdgeAttributes>& factory,
-               const BinaryDeserializer& deserializer,
-               DynamicSceneGraph& graph) {
+EdgeKey parseEdge(const AttributeFactory<EdgeAttributes>& factory,
+                  const BinaryDeserializer& deserializer,
+                  DynamicSceneGraph& graph) {
   deserializer.checkFixedArrayLength(3);
   NodeId source;
   deserializer.read(source);
@@ -93,17 +93,30 @@ void parseEdge(const AttributeFactory<EdgeAttributes>& factory,
   // last argument always forces parents to rewire
   auto attrs = serialization::Visitor::from(factory, deserializer);
   graph.addOrUpdateEdge(source, target, std::move(attrs));
+  return EdgeKey(source, target);
 }
 
-void writeGraph(const DynamicSceneGraph& graph,
-                std::vector<uint8_t>& buffer,
-                bool include_mesh) {
-  BinarySerializer serializer(&buffer);
+void writeHeader(BinarySerializer& serializer, const DynamicSceneGraph& graph) {
   serializer.write(graph.layer_ids);
 
   // saves names to type index mapping
   serializer.write(serialization::AttributeRegistry<NodeAttributes>::names());
   serializer.write(serialization::AttributeRegistry<EdgeAttributes>::names());
+}
+
+// interlayer edges belong to the layer of the parent (i.e., the higher layer)
+bool ownsEdge(const DynamicSceneGraph& graph, LayerId layer, const EdgeKey& key) {
+  const auto k1 = graph.getLayerForNode(key.k1);
+  const auto k2 = graph.getLayerForNode(key.k2);
+  if (!k1 || !k2) {
+    return false;
+  }
+
+  return std::max(k1->layer, k2->layer) == layer;
+}
+
+void writeNodesAndEdges(BinarySerializer& serializer, const DynamicSceneGraph& graph) {
+  writeHeader(serializer, graph);
 
   serializer.startDynamicArray();
   for (const auto& id_layer_pair : graph.layers()) {
@@ -146,9 +159,14 @@ void writeGraph(const DynamicSceneGraph& graph,
     serializer.write(id_edge_pair.second);
   }
   serializer.endDynamicArray();
+}
 
-  auto mesh = graph.mesh();
-  if (!include_mesh || !mesh) {
+void writeGraphWithMesh(const DynamicSceneGraph& graph,
+                        std::vector<uint8_t>& buffer,
+                        const Mesh* mesh) {
+  BinarySerializer serializer(&buffer);
+  writeNodesAndEdges(serializer, graph);
+  if (!mesh) {
     serializer.write(false);
     return;
   }
@@ -157,6 +175,104 @@ void writeGraph(const DynamicSceneGraph& graph,
   mesh->serializeToBinary(buffer);
 }
 
+void writeGraph(const DynamicSceneGraph& graph,
+                std::vector<uint8_t>& buffer,
+                bool include_mesh) {
+  writeGraphWithMesh(graph, buffer, include_mesh ? graph.mesh().get() : nullptr);
+}
+
+void writeGraph(const DynamicSceneGraph& graph,
+                std::vector<uint8_t>& buffer,
+                const Mesh& mesh) {
+  writeGraphWithMesh(graph, buffer, &mesh);
+}
+
+void writeGraphBeforeMesh(const DynamicSceneGraph& graph,
+                          std::vector<uint8_t>& buffer) {
+  BinarySerializer serializer(&buffer);
+  writeNodesAndEdges(serializer, graph);
+  serializer.write(true);
+}
+
+void writeLayer(const DynamicSceneGraph& graph,
+                LayerId layer,
+                std::vector<uint8_t>& buffer) {
+  BinarySerializer serializer(&buffer);
+  writeHeader(serializer, graph);
+
+  const auto static_layer = graph.layers().find(layer);
+  const auto& dynamic_layers = graph.dynamicLayersOfType(layer);
+
+  serializer.startDynamicArray();
+  if (static_layer != graph.layers().end()) {
+    for (const auto& id_node_pair : static_layer->second->nodes()) {
+      serializer.write(*id_node_pair.second);
+    }
+  }
+  serializer.endDynamicArray();
+
+  serializer.startDynamicArray();
+  for (const auto& prefix_layer_pair : dynamic_layers) {
+    for (const auto& node : prefix_layer_pair.second->nodes()) {
+      serializer.write(*node);
+    }
+  }
+  serializer.endDynamicArray();
+
+  serializer.startDynamicArray();
+  if (static_layer != graph.layers().end()) {
+    for (const auto& id_edge_pair : static_layer->second->edges()) {
+      serializer.write(id_edge_pair.second);
+    }
+  }
+
+  for (const auto& prefix_layer_pair : dynamic_layers) {
+    for (const auto& id_edge_pair : prefix_layer_pair.second->edges()) {
+      serializer.write(id_edge_pair.second);
+    }
+  }
+
+  for (const auto& id_edge_pair : graph.interlayer_edges()) {
+    if (ownsEdge(graph, layer, id_edge_pair.first)) {
+      serializer.write(id_edge_pair.second);
+    }
+  }
+
+  for (const auto& id_edge_pair : graph.dynamic_interlayer_edges()) {
+    if (ownsEdge(graph, layer, id_edge_pair.first)) {
+      serializer.write(id_edge_pair.second);
+    }
+  }
+  serializer.endDynamicArray();
+
+  serializer.write(false);
+}
+
+void writeMeshPayload(const DynamicSceneGraph& graph,
+                      std::vector<uint8_t>& buffer,
+                      const Mesh* mesh) {
+  BinarySerializer serializer(&buffer);
+  serializer.write(graph.layer_ids);
+
+  if (!mesh) {
+    serializer.write(false);
+    return;
+  }
+
+  serializer.write(true);
+  mesh->serializeToBinary(buffer);
+}
+
+void writeMesh(const DynamicSceneGraph& graph, std::vector<uint8_t>& buffer) {
+  writeMeshPayload(graph, buffer, graph.mesh().get());
+}
+
+void writeMesh(const DynamicSceneGraph& graph,
+               std::vector<uint8_t>& buffer,
+               const Mesh& mesh) {
+  writeMeshPayload(graph, buffer, &mesh);
+}
+
 template <typename Attrs>
 AttributeFactory<Attrs> loadFactory(const io::FileHeader& header,
                                     const BinaryDeserializer& deserializer) {
@@ -244,5 +360,164 @@ bool updateGraph(DynamicSceneGraph& graph, const uint8_t* const buffer, size_t l
   return updateGraph(graph, deserializer);
 }
 
+bool updateLayer(DynamicSceneGraph& graph,
+                 LayerId layer,
+                 const uint8_t* const buffer,
+                 size_t length) {
+  BinaryDeserializer deserializer(buffer, length);
+
+  std::vector<LayerId> layer_ids;
+  deserializer.read(layer_ids);
+
+  if (graph.layer_ids != layer_ids) {
+    graph.reset(layer_ids);
+  }
+
+  const auto& header = io::GlobalInfo::loadedHeader();
+  const auto node_factory = loadFactory<NodeAttributes>(header, deserializer);
+  const auto edge_factory = loadFactory<EdgeAttributes>(header, deserializer);
+
+  std::unordered_set<NodeId> stale_nodes;
+  for (const auto& id_key_pair : graph.node_lookup()) {
+    if (id_key_pair.second.layer == layer) {
+      stale_nodes.insert(id_key_pair.first);
+    }
+  }
+
+  deserializer.checkDynamicArray();
+  while (!deserializer.isDynamicArrayEnd()) {
+    stale_nodes.erase(parseNode(node_factory, deserializer, graph));
+  }
+
+  deserializer.checkDynamicArray();
+  while (!deserializer.isDynamicArrayEnd()) {
+    stale_nodes.erase(parseNode(node_factory, deserializer, graph));
+  }
+
+  for (const auto& node_id : stale_nodes) {
+    graph.removeNode(node_id);
+  }
+
+  std::set<EdgeKey> stale_edges;
+  const auto add_owned = [&](const DynamicSceneGraph::Edges& edges) {
+    for (const auto& key_edge_pair : edges) {
+      if (ownsEdge(graph, layer, key_edge_pair.first)) {
+        stale_edges.insert(key_edge_pair.first);
+      }
+    }
+  };
+
+  if (graph.hasLayer(layer)) {
+    add_owned(graph.getLayer(layer).edges());
+  }
+
+  for (const auto& prefix_layer_pair : graph.dynamicLayersOfType(layer)) {
+    add_owned(prefix_layer_pair.second->edges());
+  }
+
+  add_owned(graph.interlayer_edges());
+  add_owned(graph.dynamic_interlayer_edges());
+
+  deserializer.checkDynamicArray();
+  while (!deserializer.isDynamicArrayEnd()) {
+    stale_edges.erase(parseEdge(edge_factory, deserializer, graph));
+  }
+
+  for (const auto& key : stale_edges) {
+    graph.removeEdge(key.k1, key.k2);
+  }
+
+  if (!deserializer.checkIfTrue()) {
+    return true;
+  }
+
+  auto mesh = std::make_shared<Mesh>();
+  deserializer.read(*mesh);
+  graph.setMesh(mesh);
+  return true;
+}
+
+bool updateMesh(DynamicSceneGraph& graph, const uint8_t* const buffer, size_t length) {
+  BinaryDeserializer deserializer(buffer, length);
+
+  std::vector<LayerId> layer_ids;
+  deserializer.read(layer_ids);
+
+  if (graph.layer_ids != layer_ids) {
+    graph.reset(layer_ids);
+  }
+
+  if (!deserializer.checkIfTrue()) {
+    graph.setMesh(nullptr);
+    return true;
+  }
+
+  auto mesh = std::make_shared<Mesh>();
+  deserializer.read(*mesh);
+  graph.setMesh(mesh);
+  return true;
+}
+
+void writeMeshChanges(const DynamicSceneGraph& graph,
+                      std::vector<uint8_t>& buffer,
+                      bool full) {
+  BinarySerializer serializer(&buffer);
+  serializer.write(graph.layer_ids);
+
+  auto mesh = graph.mesh();
+  if (!mesh) {
+    serializer.write(false);
+    return;
+  }
+
+  serializer.write(true);
+  mesh->serializeChangesToBinary(buffer, full);
+}
+
+void takeMeshChanges(const DynamicSceneGraph& graph,
+                     std::vector<uint8_t>& buffer,
+                     bool full) {
+  writeMeshChanges(graph, buffer, full);
+  if (graph.mesh()) {
+    graph.mesh()->clearChanges();
+  }
+}
+
+bool updateMeshChanges(DynamicSceneGraph& graph,
+                       const uint8_t* const buffer,
+                       size_t length) {
+  BinaryDeserializer deserializer(buffer, length);
+
+  std::vector<LayerId> layer_ids;
+  deserializer.read(layer_ids);
+
+  if (graph.layer_ids != layer_ids) {
+    graph.reset(layer_ids);
+  }
+
+  if (!deserializer.checkIfTrue()) {
+    graph.setMesh(nullptr);
+    return true;
+  }
+
+  const size_t offset = deserializer.pos();
+  auto mesh = graph.mesh();
+  if (!mesh) {
+    // a new mesh can only be initialized from a full message
+    if (!deserializer.checkIfTrue()) {
+      return false;
+    }
+
+    mesh = std::make_shared<Mesh>();
+  }
+
+  if (!mesh->applyChangesFromBinary(buffer + offset, length - offset)) {
+    return false;
+  }
+
+  graph.setMesh(mesh);
+  return true;
+}
+
 }  // namespace io::binary
 }  // namespace spark_dsg
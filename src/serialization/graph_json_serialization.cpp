@@ -105,7 +105,7 @@ void read_edge_from_json(const serialization::AttributeFactory<EdgeAttributes>&
 
 namespace io::json {
 
-std::string writeGraph(const DynamicSceneGraph& graph, bool include_mesh) {
+std::string writeGraphWithMesh(const DynamicSceneGraph& graph, const Mesh* mesh) {
   nlohmann::json record;
   record[io::FileHeader::IDENTIFIER_STRING + "_header"] = io::FileHeader::current();
 
@@ -151,8 +151,7 @@ std::string writeGraph(const DynamicSceneGraph& graph, bool include_mesh) {
     }
   }
 
-  auto mesh = graph.mesh();
-  if (!mesh || !include_mesh) {
+  if (!mesh) {
     return record.dump();
   }
 
@@ -161,6 +160,14 @@ std::string writeGraph(const DynamicSceneGraph& graph, bool include_mesh) {
   return record.dump();
 }
 
+std::string writeGraph(const DynamicSceneGraph& graph, bool include_mesh) {
+  return writeGraphWithMesh(graph, include_mesh ? graph.mesh().get() : nullptr);
+}
+
+std::string writeGraph(const DynamicSceneGraph& graph, const Mesh& mesh) {
+  return writeGraphWithMesh(graph, &mesh);
+}
+
 DynamicSceneGraph::Ptr readGraph(const std::string& contents) {
   const auto record = nlohmann::json::parse(contents);
 
@@ -32,8 +32,12 @@
  * Government is authorized to reproduce and distribute reprints for Government
  * purposes notwithstanding any copyright notation herein.
  * -------------------------------------------------------------------------- */
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
+#include <sstream>
 
 #include "spark_dsg/mesh.h"
 #include "spark_dsg/serialization/binary_conversions.h"
@@ -175,6 +179,448 @@ void read_binary(const serialization::BinaryDeserializer& deserializer, Mesh& me
   deserializer.read(mesh.faces);
 }
 
+namespace {
+
+template <typename T>
+void writeRange(serialization::BinarySerializer& serializer,
+                const std::vector<T>& values,
+                size_t start,
+                size_t end) {
+  end = std::min(end, values.size());
+  start = std::min(start, end);
+  serializer.startFixedArray(end - start);
+  for (size_t i = start; i < end; ++i) {
+    serializer.write(values[i]);
+  }
+}
+
+// read the values of a range and check that they fit in a vector of the given size
+template <typename T>
+std::vector<T> readRange(const serialization::BinaryDeserializer& deserializer,
+                         size_t start,
+                         size_t size) {
+  std::vector<T> values;
+  deserializer.read(values);
+  if (!values.empty() && start + values.size() > size) {
+    std::stringstream ss;
+    ss << "range [" << start << ", " << start + values.size() << ") exceeds size "
+       << size;
+    throw std::out_of_range(ss.str());
+  }
+
+  return values;
+}
+
+template <typename T>
+void applyRange(const std::vector<T>& values, size_t start, std::vector<T>& target) {
+  if (values.empty()) {
+    return;
+  }
+
+  // attributes that are not part of the mesh spec may still be sent (see write_binary)
+  if (target.size() < start + values.size()) {
+    target.resize(start + values.size());
+  }
+
+  std::copy(values.begin(), values.end(), target.begin() + start);
+}
+
+struct VertexRange {
+  uint64_t start;
+  uint64_t end;
+  Mesh::Positions points;
+  Mesh::Colors colors;
+  Mesh::Timestamps stamps;
+  Mesh::Labels labels;
+  Mesh::Timestamps first_seen_stamps;
+};
+
+struct FaceRange {
+  uint64_t start;
+  uint64_t end;
+  Mesh::Faces faces;
+};
+
+void readBounds(const serialization::BinaryDeserializer& deserializer,
+                uint64_t& start,
+                uint64_t& end,
+                size_t size) {
+  deserializer.read(start);
+  deserializer.read(end);
+  if (start > end || end > size) {
+    std::stringstream ss;
+    ss << "invalid range [" << start << ", " << end << ") for size " << size;
+    throw std::out_of_range(ss.str());
+  }
+}
+
+}  // namespace
+
+void Mesh::serializeChangesToBinary(std::vector<uint8_t>& buffer, bool full) const {
+  serialization::BinarySerializer serializer(&buffer);
+  serializer.write(full);
+  serializer.write(has_colors);
+  serializer.write(has_timestamps);
+  serializer.write(has_labels);
+  serializer.write(has_first_seen_stamps);
+  serializer.write(stream_id_);
+  serializer.write(base_version_);
+  serializer.write(version_);
+  serializer.write(static_cast<uint64_t>(numVertices()));
+  serializer.write(static_cast<uint64_t>(numFaces()));
+
+  const auto vertex_ranges = full ? std::vector<IndexRanges::Range>{{0, numVertices()}}
+                                  : changed_vertices_.ranges();
+  serializer.startFixedArray(vertex_ranges.size());
+  for (const auto& [start, end] : vertex_ranges) {
+    serializer.write(static_cast<uint64_t>(start));
+    serializer.write(static_cast<uint64_t>(end));
+    writeRange(serializer, points, start, end);
+    writeRange(serializer, colors, start, end);
+    writeRange(serializer, stamps, start, end);
+    writeRange(serializer, labels, start, end);
+    writeRange(serializer, first_seen_stamps, start, end);
+  }
+
+  const auto face_ranges = full ? std::vector<IndexRanges::Range>{{0, numFaces()}}
+                                : changed_faces_.ranges();
+  serializer.startFixedArray(face_ranges.size());
+  for (const auto& [start, end] : face_ranges) {
+    serializer.write(static_cast<uint64_t>(start));
+    serializer.write(static_cast<uint64_t>(end));
+    writeRange(serializer, faces, start, end);
+  }
+}
+
+void Mesh::takeChangesToBinary(std::vector<uint8_t>& buffer, bool full) {
+  serializeChangesToBinary(buffer, full);
+  clearChanges();
+}
+
+bool Mesh::applyChangesFromBinary(const uint8_t* const buffer, size_t length) {
+  serialization::BinaryDeserializer deserializer(buffer, length);
+  bool full, colors_flag, timestamps_flag, labels_flag, first_seen_flag;
+  deserializer.read(full);
+  deserializer.read(colors_flag);
+  deserializer.read(timestamps_flag);
+  deserializer.read(labels_flag);
+  deserializer.read(first_seen_flag);
+
+  uint64_t stream_id, base_version, version, num_vertices, num_faces;
+  deserializer.read(stream_id);
+  deserializer.read(base_version);
+  deserializer.read(version);
+  deserializer.read(num_vertices);
+  deserializer.read(num_faces);
+
+  if (!full) {
+    const bool same_layout = colors_flag == has_colors &&
+                             timestamps_flag == has_timestamps &&
+                             labels_flag == has_labels &&
+                             first_seen_flag == has_first_seen_stamps;
+    if (!same_layout || stream_id != stream_id_ || base_version != version_) {
+      return false;
+    }
+  }
+
+  // read and check every range before touching the mesh, so that malformed changes
+  // cannot leave it partially updated
+  std::vector<VertexRange> vertex_ranges(deserializer.readFixedArrayLength());
+  for (auto& range : vertex_ranges) {
+    readBounds(deserializer, range.start, range.end, num_vertices);
+    range.points = readRange<Pos>(deserializer, range.start, num_vertices);
+    range.colors = readRange<Color>(deserializer, range.start, num_vertices);
+    range.stamps = readRange<Timestamp>(deserializer, range.start, num_vertices);
+    range.labels = readRange<Label>(deserializer, range.start, num_vertices);
+    range.first_seen_stamps =
+        readRange<Timestamp>(deserializer, range.start, num_vertices);
+  }
+
+  std::vector<FaceRange> face_ranges(deserializer.readFixedArrayLength());
+  for (auto& range : face_ranges) {
+    readBounds(deserializer, range.start, range.end, num_faces);
+    range.faces = readRange<Face>(deserializer, range.start, num_faces);
+  }
+
+  if (full) {
+    *this = Mesh(colors_flag, timestamps_flag, labels_flag, first_seen_flag);
+    stream_id_ = stream_id;
+  }
+
+  resizeVertices(num_vertices);
+  resizeFaces(num_faces);
+  for (const auto& range : vertex_ranges) {
+    applyRange(range.points, range.start, points);
+    applyRange(range.colors, range.start, colors);
+    applyRange(range.stamps, range.start, stamps);
+    applyRange(range.labels, range.start, labels);
+    applyRange(range.first_seen_stamps, range.start, first_seen_stamps);
+    markVerticesChanged(range.start, range.end);
+  }
+
+  for (const auto& range : face_ranges) {
+    applyRange(range.faces, range.start, faces);
+    markFacesChanged(range.start, range.end);
+  }
+
+  version_ = version;
+  return true;
+}
+
+namespace {
+
+// Compressed mesh encoding (all multi-byte values are little-endian)
+constexpr uint32_t COMPRESSED_MAGIC = 0x514d4453;  // "SDMQ" in ascii
+constexpr uint8_t COMPRESSED_VERSION = 1;
+
+class Encoder {
+ public:
+  explicit Encoder(std::vector<uint8_t>& buffer) : buffer_(buffer) {}
+
+  template <typename T>
+  void writeRaw(T value) {
+    for (size_t i = 0; i < sizeof(T); ++i) {
+      buffer_.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+  }
+
+  void writeFloat(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    writeRaw(bits);
+  }
+
+  void writeDouble(double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    writeRaw(bits);
+  }
+
+  void writeVarint(uint64_t value) {
+    while (value >= 0x80) {
+      buffer_.push_back(static_cast<uint8_t>(value) | 0x80);
+      value >>= 7;
+    }
+    buffer_.push_back(static_cast<uint8_t>(value));
+  }
+
+  //! zigzag encoding maps small negative values to small unsigned values
+  void writeSigned(int64_t value) {
+    const uint64_t bits = static_cast<uint64_t>(value);
+    writeVarint((bits << 1) ^ static_cast<uint64_t>(value >> 63));
+  }
+
+  template <typename T>
+  void writeDeltas(const std::vector<T>& values) {
+    writeVarint(values.size());
+    uint64_t prev = 0;
+    for (const auto value : values) {
+      writeSigned(static_cast<int64_t>(static_cast<uint64_t>(value) - prev));
+      prev = value;
+    }
+  }
+
+ private:
+  std::vector<uint8_t>& buffer_;
+};
+
+class Decoder {
+ public:
+  Decoder(const uint8_t* const buffer, size_t length)
+      : buffer_(buffer), length_(length), pos_(0) {}
+
+  template <typename T>
+  T readRaw() {
+    check(sizeof(T));
+    T value = 0;
+    for (size_t i = 0; i < sizeof(T); ++i) {
+      value |= static_cast<T>(buffer_[pos_++]) << (8 * i);
+    }
+    return value;
+  }
+
+  float readFloat() {
+    const auto bits = readRaw<uint32_t>();
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+  }
+
+  double readDouble() {
+    const auto bits = readRaw<uint64_t>();
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+  }
+
+  uint64_t readVarint() {
+    uint64_t value = 0;
+    for (size_t shift = 0; shift < 64; shift += 7) {
+      check(1);
+      const uint8_t byte = buffer_[pos_++];
+      value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if (!(byte & 0x80)) {
+        return value;
+      }
+    }
+
+    throw std::runtime_error("invalid compressed mesh: malformed integer");
+  }
+
+  int64_t readSigned() {
+    const uint64_t value = readVarint();
+    return static_cast<int64_t>((value >> 1) ^ (~(value & 1) + 1));
+  }
+
+  //! read the number of elements that follow (each taking at least min_bytes)
+  size_t readCount(size_t min_bytes = 1) {
+    const uint64_t count = readVarint();
+    if (count > (length_ - pos_) / min_bytes) {
+      throw std::runtime_error("invalid compressed mesh: truncated data");
+    }
+    return count;
+  }
+
+  template <typename T>
+  void readDeltas(std::vector<T>& values) {
+    values.resize(readCount());
+    uint64_t prev = 0;
+    for (auto& value : values) {
+      prev += static_cast<uint64_t>(readSigned());
+      value = static_cast<T>(prev);
+    }
+  }
+
+ private:
+  void check(size_t num_bytes) const {
+    if (length_ - pos_ < num_bytes) {
+      throw std::runtime_error("invalid compressed mesh: truncated data");
+    }
+  }
+
+  const uint8_t* const buffer_;
+  const size_t length_;
+  size_t pos_;
+};
+
+}  // namespace
+
+void Mesh::serializeToCompressedBinary(std::vector<uint8_t>& buffer,
+                                       float resolution) const {
+  if (!(resolution > 0.0f)) {
+    std::stringstream ss;
+    ss << "invalid mesh quantization resolution: " << resolution;
+    throw std::invalid_argument(ss.str());
+  }
+
+  // rough guess assuming small deltas
+  buffer.reserve(buffer.size() + 64 + 8 * points.size() + 4 * colors.size() +
+                 2 * (stamps.size() + first_seen_stamps.size() + labels.size()) +
+                 6 * faces.size());
+
+  Encoder encoder(buffer);
+  encoder.writeRaw(COMPRESSED_MAGIC);
+  encoder.writeRaw(COMPRESSED_VERSION);
+  encoder.writeRaw(static_cast<uint8_t>(has_colors | has_timestamps << 1 |
+                                        has_labels << 2 | has_first_seen_stamps << 3));
+  encoder.writeFloat(resolution);
+
+  // positions are quantized relative to the minimum corner of the mesh
+  Eigen::Vector3d origin = Eigen::Vector3d::Zero();
+  if (!points.empty()) {
+    origin = bounds().min().cast<double>();
+  }
+  for (size_t i = 0; i < 3; ++i) {
+    encoder.writeDouble(origin(i));
+  }
+
+  encoder.writeVarint(points.size());
+  Eigen::Matrix<int64_t, 3, 1> prev = Eigen::Matrix<int64_t, 3, 1>::Zero();
+  for (const auto& point : points) {
+    for (size_t i = 0; i < 3; ++i) {
+      const int64_t value = std::llround((point(i) - origin(i)) / resolution);
+      encoder.writeSigned(value - prev(i));
+      prev(i) = value;
+    }
+  }
+
+  encoder.writeVarint(colors.size());
+  for (const auto& color : colors) {
+    encoder.writeRaw(color.r);
+    encoder.writeRaw(color.g);
+    encoder.writeRaw(color.b);
+    encoder.writeRaw(color.a);
+  }
+
+  encoder.writeDeltas(stamps);
+  encoder.writeDeltas(labels);
+  encoder.writeDeltas(first_seen_stamps);
+
+  encoder.writeVarint(faces.size());
+  uint64_t prev_index = 0;
+  for (const auto& face : faces) {
+    for (const auto index : face) {
+      encoder.writeSigned(static_cast<int64_t>(index - prev_index));
+      prev_index = index;
+    }
+  }
+}
+
+Mesh::Ptr Mesh::deserializeFromCompressedBinary(const uint8_t* const buffer,
+                                                size_t length) {
+  Decoder decoder(buffer, length);
+  if (decoder.readRaw<uint32_t>() != COMPRESSED_MAGIC) {
+    throw std::runtime_error("invalid compressed mesh: bad magic number");
+  }
+
+  const auto version = decoder.readRaw<uint8_t>();
+  if (version != COMPRESSED_VERSION) {
+    std::stringstream ss;
+    ss << "invalid compressed mesh: unknown version " << static_cast<int>(version);
+    throw std::runtime_error(ss.str());
+  }
+
+  const auto flags = decoder.readRaw<uint8_t>();
+  auto mesh = std::make_shared<Mesh>(flags & 1, flags & 2, flags & 4, flags & 8);
+  const double resolution = decoder.readFloat();
+  Eigen::Vector3d origin;
+  for (size_t i = 0; i < 3; ++i) {
+    origin(i) = decoder.readDouble();
+  }
+
+  mesh->points.resize(decoder.readCount(3));
+  Eigen::Matrix<int64_t, 3, 1> prev = Eigen::Matrix<int64_t, 3, 1>::Zero();
+  for (auto& point : mesh->points) {
+    for (size_t i = 0; i < 3; ++i) {
+      prev(i) += decoder.readSigned();
+      point(i) = static_cast<float>(origin(i) + prev(i) * resolution);
+    }
+  }
+
+  mesh->colors.resize(decoder.readCount(4));
+  for (auto& color : mesh->colors) {
+    color.r = decoder.readRaw<uint8_t>();
+    color.g = decoder.readRaw<uint8_t>();
+    color.b = decoder.readRaw<uint8_t>();
+    color.a = decoder.readRaw<uint8_t>();
+  }
+
+  decoder.readDeltas(mesh->stamps);
+  decoder.readDeltas(mesh->labels);
+  decoder.readDeltas(mesh->first_seen_stamps);
+
+  mesh->faces.resize(decoder.readCount(3));
+  uint64_t prev_index = 0;
+  for (auto& face : mesh->faces) {
+    for (auto& index : face) {
+      prev_index += static_cast<uint64_t>(decoder.readSigned());
+      index = prev_index;
+    }
+  }
+
+  return mesh;
+}
+
 std::string Mesh::serializeToJson() const {
   json record = *this;
   return record.dump();
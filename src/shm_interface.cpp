@@ -0,0 +1,350 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "spark_dsg/shm_interface.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+#include "spark_dsg/logging.h"
+#include "spark_dsg/serialization/graph_binary_serialization.h"
+
+namespace spark_dsg {
+
+namespace {
+
+// "SPARKSHM" in ascii
+constexpr uint64_t SHM_MAGIC = 0x5350415252534853;
+constexpr uint64_t SHM_LAYOUT_VERSION = 1;
+constexpr size_t SHM_ALIGNMENT = 64;
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "shared memory transport requires lock-free 64-bit atomics");
+
+struct SegmentHeader {
+  std::atomic<uint64_t> magic;
+  uint64_t layout_version;
+  uint64_t num_slots;
+  uint64_t slot_capacity;
+  //! index of latest published message (0 if nothing has been published)
+  std::atomic<uint64_t> latest;
+  //! set by the sender when the segment is about to be unlinked
+  std::atomic<uint64_t> closed;
+};
+
+struct SlotHeader {
+  //! odd while the slot is being written
+  std::atomic<uint64_t> sequence;
+  uint64_t message_index;
+  uint64_t size;
+};
+
+inline size_t alignSize(size_t size) {
+  return ((size + SHM_ALIGNMENT - 1) / SHM_ALIGNMENT) * SHM_ALIGNMENT;
+}
+
+struct SegmentLayout {
+  SegmentLayout(size_t num_slots, size_t slot_capacity)
+      : num_slots(num_slots),
+        slot_capacity(slot_capacity),
+        header_size(alignSize(sizeof(SegmentHeader))),
+        slot_stride(alignSize(sizeof(SlotHeader) + slot_capacity)) {}
+
+  size_t totalSize() const { return header_size + num_slots * slot_stride; }
+
+  SlotHeader* slot(uint8_t* base, uint64_t message_index) const {
+    const size_t offset = header_size + (message_index % num_slots) * slot_stride;
+    return reinterpret_cast<SlotHeader*>(base + offset);
+  }
+
+  static uint8_t* data(SlotHeader* slot) {
+    return reinterpret_cast<uint8_t*>(slot) + sizeof(SlotHeader);
+  }
+
+  const size_t num_slots;
+  const size_t slot_capacity;
+  const size_t header_size;
+  const size_t slot_stride;
+};
+
+}  // namespace
+
+struct ShmSender::Detail {
+  Detail(const std::string& name, size_t slot_capacity, size_t num_slots)
+      : name(name), layout(num_slots, slot_capacity) {
+    if (num_slots == 0 || slot_capacity == 0) {
+      throw std::invalid_argument("shared memory segment must have non-zero size");
+    }
+
+    // remove any stale segment left behind by a previous sender
+    shm_unlink(name.c_str());
+    const int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0666);
+    if (fd < 0) {
+      throw std::runtime_error("failed to create shared memory segment '" + name +
+                               "': " + std::strerror(errno));
+    }
+
+    size = layout.totalSize();
+    if (ftruncate(fd, size) != 0) {
+      close(fd);
+      shm_unlink(name.c_str());
+      throw std::runtime_error("failed to size shared memory segment '" + name +
+                               "': " + std::strerror(errno));
+    }
+
+    void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (ptr == MAP_FAILED) {
+      shm_unlink(name.c_str());
+      throw std::runtime_error("failed to map shared memory segment '" + name +
+                               "': " + std::strerror(errno));
+    }
+
+    base = static_cast<uint8_t*>(ptr);
+    header = reinterpret_cast<SegmentHeader*>(base);
+    header->layout_version = SHM_LAYOUT_VERSION;
+    header->num_slots = num_slots;
+    header->slot_capacity = slot_capacity;
+    header->latest.store(0, std::memory_order_relaxed);
+    header->closed.store(0, std::memory_order_relaxed);
+    // publish the header last so readers never attach to a partial segment
+    header->magic.store(SHM_MAGIC, std::memory_order_release);
+  }
+
+  ~Detail() {
+    header->closed.store(1, std::memory_order_release);
+    munmap(base, size);
+    shm_unlink(name.c_str());
+  }
+
+  bool send(const uint8_t* const buffer, size_t length) {
+    if (length > layout.slot_capacity) {
+      SG_LOG(ERROR) << "graph of " << length << " bytes exceeds shared memory slot of "
+                    << layout.slot_capacity << " bytes";
+      return false;
+    }
+
+    const uint64_t message_index = ++num_sent;
+    auto slot = layout.slot(base, message_index);
+
+    const uint64_t sequence = slot->sequence.load(std::memory_order_relaxed);
+    slot->sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    std::memcpy(SegmentLayout::data(slot), buffer, length);
+    slot->message_index = message_index;
+    slot->size = length;
+
+    slot->sequence.store(sequence + 2, std::memory_order_release);
+    header->latest.store(message_index, std::memory_order_release);
+    return true;
+  }
+
+  const std::string name;
+  const SegmentLayout layout;
+  size_t size;
+  uint8_t* base;
+  SegmentHeader* header;
+  uint64_t num_sent = 0;
+  std::vector<uint8_t> buffer;
+};
+
+ShmSender::ShmSender(const std::string& name, size_t slot_capacity, size_t num_slots)
+    : internals_(new ShmSender::Detail(name, slot_capacity, num_slots)) {}
+
+ShmSender::~ShmSender() {}
+
+bool ShmSender::send(const DynamicSceneGraph& graph, bool include_mesh) {
+  auto& buffer = internals_->buffer;
+  buffer.clear();
+  io::binary::writeGraph(graph, buffer, include_mesh);
+  return internals_->send(buffer.data(), buffer.size());
+}
+
+bool ShmSender::send(const uint8_t* const buffer, size_t length) {
+  return internals_->send(buffer, length);
+}
+
+struct ShmReceiver::Detail {
+  explicit Detail(const std::string& name) : name(name) {}
+
+  ~Detail() { detach(); }
+
+  bool attach() {
+    if (base) {
+      if (!header->closed.load(std::memory_order_acquire)) {
+        return true;
+      }
+
+      // sender went away: drop the old segment and wait for a new one
+      detach();
+    }
+
+    const int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+      return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 ||
+        static_cast<size_t>(info.st_size) < sizeof(SegmentHeader)) {
+      close(fd);
+      return false;
+    }
+
+    void* ptr = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (ptr == MAP_FAILED) {
+      return false;
+    }
+
+    auto new_header = static_cast<SegmentHeader*>(ptr);
+    if (new_header->magic.load(std::memory_order_acquire) != SHM_MAGIC ||
+        new_header->layout_version != SHM_LAYOUT_VERSION) {
+      munmap(ptr, info.st_size);
+      return false;
+    }
+
+    layout.reset(new SegmentLayout(new_header->num_slots, new_header->slot_capacity));
+    if (layout->totalSize() > static_cast<size_t>(info.st_size)) {
+      munmap(ptr, info.st_size);
+      layout.reset();
+      return false;
+    }
+
+    base = static_cast<uint8_t*>(ptr);
+    header = new_header;
+    size = info.st_size;
+    last_index = 0;
+    return true;
+  }
+
+  void detach() {
+    if (!base) {
+      return;
+    }
+
+    munmap(base, size);
+    base = nullptr;
+    header = nullptr;
+    layout.reset();
+  }
+
+  // copy the latest payload into the local buffer, returning false if the payload
+  // was overwritten while reading
+  bool tryRead(uint64_t latest) {
+    const auto slot = layout->slot(base, latest);
+    const uint64_t start = slot->sequence.load(std::memory_order_acquire);
+    if (start % 2 != 0) {
+      return false;
+    }
+
+    const uint64_t message_index = slot->message_index;
+    const uint64_t length = slot->size;
+    if (length > layout->slot_capacity || message_index <= last_index) {
+      return false;
+    }
+
+    buffer.resize(length);
+    std::memcpy(buffer.data(), SegmentLayout::data(slot), length);
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot->sequence.load(std::memory_order_relaxed) != start) {
+      return false;
+    }
+
+    num_skipped += message_index - last_index - 1;
+    last_index = message_index;
+    return true;
+  }
+
+  bool recv(size_t timeout_ms) {
+    const auto end = std::chrono::steady_clock::now() +
+                     std::chrono::milliseconds(timeout_ms);
+    while (true) {
+      if (attach()) {
+        const uint64_t latest = header->latest.load(std::memory_order_acquire);
+        if (latest > last_index && tryRead(latest)) {
+          break;
+        }
+      }
+
+      if (std::chrono::steady_clock::now() >= end) {
+        return false;
+      }
+
+      std::this_thread::sleep_for(std::chrono::microseconds(500));
+    }
+
+    if (!graph) {
+      graph = io::binary::readGraph(buffer.data(), buffer.size());
+    } else {
+      io::binary::updateGraph(*graph, buffer.data(), buffer.size());
+    }
+
+    return true;
+  }
+
+  const std::string name;
+  std::unique_ptr<SegmentLayout> layout;
+  size_t size = 0;
+  uint8_t* base = nullptr;
+  SegmentHeader* header = nullptr;
+  uint64_t last_index = 0;
+  size_t num_skipped = 0;
+  std::vector<uint8_t> buffer;
+  DynamicSceneGraph::Ptr graph;
+};
+
+ShmReceiver::ShmReceiver(const std::string& name)
+    : internals_(new ShmReceiver::Detail(name)) {}
+
+ShmReceiver::~ShmReceiver() {}
+
+bool ShmReceiver::recv(size_t timeout_ms) { return internals_->recv(timeout_ms); }
+
+DynamicSceneGraph::Ptr ShmReceiver::graph() const { return internals_->graph; }
+
+size_t ShmReceiver::numSkipped() const { return internals_->num_skipped; }
+
+}  // namespace spark_dsg
@@ -0,0 +1,341 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "spark_dsg/spatial_index.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <queue>
+#include <sstream>
+#include <stdexcept>
+
+#include "spark_dsg/node_symbol.h"
+
+namespace spark_dsg {
+
+namespace {
+
+// keeps cell indices well inside the range of an int for far-away positions
+constexpr double MAX_CELL_INDEX = 1.0e9;
+
+}  // namespace
+
+size_t SpatialIndex::CellHash::operator()(const Cell& cell) const {
+  // large primes from "Optimized Spatial Hashing for Collision Detection of
+  // Deformable Objects" (Teschner et al., 2003)
+  return static_cast<size_t>(cell.x()) * 73856093 ^
+         static_cast<size_t>(cell.y()) * 19349663 ^
+         static_cast<size_t>(cell.z()) * 83492791;
+}
+
+bool SpatialIndex::Candidate::operator<(const Candidate& other) const {
+  return distance == other.distance ? node < other.node : distance < other.distance;
+}
+
+SpatialIndex::SpatialIndex(double resolution) : resolution_(resolution) {
+  if (!(resolution_ > 0.0)) {
+    std::stringstream ss;
+    ss << "invalid spatial index resolution: " << resolution;
+    throw std::invalid_argument(ss.str());
+  }
+}
+
+SpatialIndex::Cell SpatialIndex::getCell(const Eigen::Vector3d& position) const {
+  // NaN survives the clamp below and casting it to int is undefined
+  if (position.hasNaN()) {
+    std::stringstream ss;
+    ss << "invalid spatial index position: " << position.transpose();
+    throw std::invalid_argument(ss.str());
+  }
+
+  Cell cell;
+  for (int i = 0; i < 3; ++i) {
+    const double index = std::floor(position(i) / resolution_);
+    cell(i) = static_cast<int>(std::clamp(index, -MAX_CELL_INDEX, MAX_CELL_INDEX));
+  }
+  return cell;
+}
+
+size_t SpatialIndex::numCellsInRange(const Cell& min, const Cell& max) const {
+  double count = 1.0;
+  for (int i = 0; i < 3; ++i) {
+    count *= static_cast<double>(max(i)) - min(i) + 1.0;
+  }
+  return count > cells_.size() ? cells_.size() + 1 : static_cast<size_t>(count);
+}
+
+template <typename Visitor>
+void SpatialIndex::visitRange(const Cell& min,
+                              const Cell& max,
+                              const Visitor& visitor) const {
+  if (numCellsInRange(min, max) > cells_.size()) {
+    for (const auto& [cell, nodes] : cells_) {
+      if ((cell.array() >= min.array()).all() && (cell.array() <= max.array()).all()) {
+        visitor(nodes);
+      }
+    }
+    return;
+  }
+
+  for (int x = min.x(); x <= max.x(); ++x) {
+    for (int y = min.y(); y <= max.y(); ++y) {
+      for (int z = min.z(); z <= max.z(); ++z) {
+        const auto iter = cells_.find(Cell(x, y, z));
+        if (iter != cells_.end()) {
+          visitor(iter->second);
+        }
+      }
+    }
+  }
+}
+
+void SpatialIndex::insert(NodeId node, const Eigen::Vector3d& position) {
+  if (!position.allFinite()) {
+    std::stringstream ss;
+    ss << "cannot index node " << NodeSymbol(node).getLabel()
+       << " at non-finite position: " << position.transpose();
+    throw std::invalid_argument(ss.str());
+  }
+
+  const auto cell = getCell(position);
+  auto iter = positions_.find(node);
+  if (iter == positions_.end()) {
+    positions_.emplace(node, Entry{position, cell});
+    cells_[cell].push_back(node);
+    return;
+  }
+
+  iter->second.position = position;
+  if (iter->second.cell == cell) {
+    return;
+  }
+
+  erase(node);
+  positions_.emplace(node, Entry{position, cell});
+  cells_[cell].push_back(node);
+}
+
+bool SpatialIndex::erase(NodeId node) {
+  auto iter = positions_.find(node);
+  if (iter == positions_.end()) {
+    return false;
+  }
+
+  auto cell_iter = cells_.find(iter->second.cell);
+  auto& nodes = cell_iter->second;
+  auto to_remove = std::find(nodes.begin(), nodes.end(), node);
+  *to_remove = nodes.back();
+  nodes.pop_back();
+  if (nodes.empty()) {
+    cells_.erase(cell_iter);
+  }
+
+  positions_.erase(iter);
+  return true;
+}
+
+void SpatialIndex::clear() {
+  positions_.clear();
+  cells_.clear();
+}
+
+const Eigen::Vector3d& SpatialIndex::position(NodeId node) const {
+  auto iter = positions_.find(node);
+  if (iter == positions_.end()) {
+    std::stringstream ss;
+    ss << "node " << NodeSymbol(node).getLabel() << " not in spatial index";
+    throw std::out_of_range(ss.str());
+  }
+
+  return iter->second.position;
+}
+
+std::vector<NodeId> SpatialIndex::radiusSearch(const Eigen::Vector3d& center,
+                                               double radius) const {
+  std::vector<NodeId> result;
+  if (!(radius >= 0.0) || center.hasNaN() || positions_.empty()) {
+    return result;
+  }
+
+  const Eigen::Vector3d offset = Eigen::Vector3d::Constant(radius);
+  const double radius_sq = radius * radius;
+  std::vector<Candidate> candidates;
+  visitRange(getCell(center - offset),
+             getCell(center + offset),
+             [&](const std::vector<NodeId>& nodes) {
+               for (const auto node : nodes) {
+                 const double dist_sq =
+                     (positions_.at(node).position - center).squaredNorm();
+                 if (dist_sq <= radius_sq) {
+                   candidates.push_back({dist_sq, node});
+                 }
+               }
+             });
+
+  std::sort(candidates.begin(), candidates.end());
+  result.reserve(candidates.size());
+  for (const auto& candidate : candidates) {
+    result.push_back(candidate.node);
+  }
+  return result;
+}
+
+std::vector<NodeId> SpatialIndex::nearest(const Eigen::Vector3d& center,
+                                          size_t k,
+                                          double max_distance) const {
+  std::vector<NodeId> result;
+  if (k == 0 || center.hasNaN() || positions_.empty()) {
+    return result;
+  }
+
+  const double max_dist_sq =
+      max_distance < 0.0 ? std::numeric_limits<double>::infinity()
+                         : max_distance * max_distance;
+
+  // max-heap holding the best k candidates found so far
+  std::priority_queue<Candidate> best;
+  const auto add_node = [&](NodeId node) {
+    const double dist_sq = (positions_.at(node).position - center).squaredNorm();
+    if (dist_sq > max_dist_sq) {
+      return;
+    }
+
+    const Candidate candidate{dist_sq, node};
+    if (best.size() < k) {
+      best.push(candidate);
+    } else if (candidate < best.top()) {
+      best.pop();
+      best.push(candidate);
+    }
+  };
+
+  const auto add_cell = [&](const Cell& cell) {
+    const auto iter = cells_.find(cell);
+    if (iter == cells_.end()) {
+      return;
+    }
+
+    for (const auto node : iter->second) {
+      add_node(node);
+    }
+  };
+
+  // visit shells of cells of increasing (Chebyshev) radius around the center cell.
+  // Nodes in a shell of radius r are at least (r - 1) * resolution away
+  const Cell origin = getCell(center);
+  size_t cells_visited = 0;
+  for (int r = 0;; ++r) {
+    const double bound = std::max(r - 1, 0) * resolution_;
+    if (bound * bound > max_dist_sq) {
+      break;
+    }
+
+    if (best.size() == k && best.top().distance <= bound * bound) {
+      break;
+    }
+
+    if (cells_visited > cells_.size()) {
+      // the shells are mostly empty: checking every node is cheaper
+      best = std::priority_queue<Candidate>();
+      for (const auto& id_entry_pair : positions_) {
+        add_node(id_entry_pair.first);
+      }
+      break;
+    }
+
+    for (int dx = -r; dx <= r; ++dx) {
+      for (int dy = -r; dy <= r; ++dy) {
+        const bool on_side = std::abs(dx) == r || std::abs(dy) == r;
+        const int dz_step = (on_side || r == 0) ? 1 : 2 * r;
+        for (int dz = -r; dz <= r; dz += dz_step) {
+          add_cell(origin + Cell(dx, dy, dz));
+          ++cells_visited;
+        }
+      }
+    }
+  }
+
+  result.resize(best.size());
+  for (auto iter = result.rbegin(); iter != result.rend(); ++iter) {
+    *iter = best.top().node;
+    best.pop();
+  }
+  return result;
+}
+
+std::vector<NodeId> SpatialIndex::boxSearch(const Eigen::Vector3d& min,
+                                            const Eigen::Vector3d& max) const {
+  std::vector<NodeId> result;
+  if ((min.array() > max.array()).any() || min.hasNaN() || max.hasNaN() ||
+      positions_.empty()) {
+    return result;
+  }
+
+  visitRange(getCell(min), getCell(max), [&](const std::vector<NodeId>& nodes) {
+    for (const auto node : nodes) {
+      const auto& pos = positions_.at(node).position;
+      if ((pos.array() >= min.array()).all() && (pos.array() <= max.array()).all()) {
+        result.push_back(node);
+      }
+    }
+  });
+
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+std::vector<std::vector<NodeId>> SpatialIndex::radiusSearch(
+    const std::vector<Eigen::Vector3d>& centers, double radius) const {
+  std::vector<std::vector<NodeId>> results;
+  results.reserve(centers.size());
+  for (const auto& center : centers) {
+    results.push_back(radiusSearch(center, radius));
+  }
+  return results;
+}
+
+std::vector<std::vector<NodeId>> SpatialIndex::nearest(
+    const std::vector<Eigen::Vector3d>& centers,
+    size_t k,
+    double max_distance) const {
+  std::vector<std::vector<NodeId>> results;
+  results.reserve(centers.size());
+  for (const auto& center : centers) {
+    results.push_back(nearest(center, k, max_distance));
+  }
+  return results;
+}
+
+}  // namespace spark_dsg
@@ -0,0 +1,208 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "spark_dsg/stream_recording.h"
+
+#include <sstream>
+#include <stdexcept>
+
+namespace spark_dsg {
+
+namespace {
+
+constexpr uint64_t FILE_MAGIC = 0x314d525453475344;   // "DSGSTRM1"
+constexpr uint64_t INDEX_MAGIC = 0x58444e494d525453;  // "STRMINDX"
+constexpr uint64_t FILE_HEADER_SIZE = 8;
+constexpr uint64_t RECORD_HEADER_SIZE = 20;
+constexpr uint64_t INDEX_ENTRY_SIZE = 16;
+constexpr uint64_t FOOTER_SIZE = 24;
+
+template <typename T>
+void writeLE(std::ostream& out, T value) {
+  uint8_t bytes[sizeof(T)];
+  for (size_t i = 0; i < sizeof(T); ++i) {
+    bytes[i] = static_cast<uint8_t>(value >> (8 * i));
+  }
+  out.write(reinterpret_cast<const char*>(bytes), sizeof(T));
+}
+
+template <typename T>
+T readLE(std::istream& in) {
+  uint8_t bytes[sizeof(T)] = {};
+  in.read(reinterpret_cast<char*>(bytes), sizeof(T));
+  T value = 0;
+  for (size_t i = 0; i < sizeof(T); ++i) {
+    value |= static_cast<T>(bytes[i]) << (8 * i);
+  }
+  return value;
+}
+
+}  // namespace
+
+StreamWriter::StreamWriter(const std::string& filepath)
+    : out_(filepath, std::ios::out | std::ios::binary | std::ios::trunc),
+      position_(0) {
+  if (!out_) {
+    throw std::runtime_error("could not open '" + filepath + "' for writing");
+  }
+
+  writeLE<uint64_t>(out_, FILE_MAGIC);
+  position_ = FILE_HEADER_SIZE;
+}
+
+StreamWriter::~StreamWriter() { close(); }
+
+void StreamWriter::write(const StreamMessage& message) {
+  if (!out_.is_open()) {
+    throw std::runtime_error("cannot write to closed recording");
+  }
+
+  offsets_.push_back(position_);
+  stamps_.push_back(message.stamp_ns);
+  writeLE<uint64_t>(out_, message.stamp_ns);
+  writeLE<uint32_t>(out_, message.topic.size());
+  writeLE<uint64_t>(out_, message.payload.size());
+  out_.write(message.topic.data(), message.topic.size());
+  out_.write(reinterpret_cast<const char*>(message.payload.data()),
+             message.payload.size());
+  position_ += RECORD_HEADER_SIZE + message.topic.size() + message.payload.size();
+}
+
+void StreamWriter::close() {
+  if (!out_.is_open()) {
+    return;
+  }
+
+  const uint64_t index_offset = position_;
+  for (size_t i = 0; i < offsets_.size(); ++i) {
+    writeLE<uint64_t>(out_, offsets_[i]);
+    writeLE<uint64_t>(out_, stamps_[i]);
+  }
+
+  writeLE<uint64_t>(out_, index_offset);
+  writeLE<uint64_t>(out_, offsets_.size());
+  writeLE<uint64_t>(out_, INDEX_MAGIC);
+  out_.close();
+}
+
+StreamReader::StreamReader(const std::string& filepath)
+    : in_(filepath, std::ios::in | std::ios::binary) {
+  if (!in_) {
+    throw std::runtime_error("could not open '" + filepath + "' for reading");
+  }
+
+  in_.seekg(0, std::ios::end);
+  const uint64_t file_size = in_.tellg();
+  in_.seekg(0, std::ios::beg);
+  if (file_size < FILE_HEADER_SIZE || readLE<uint64_t>(in_) != FILE_MAGIC) {
+    throw std::runtime_error("'" + filepath + "' is not a graph stream recording");
+  }
+
+  if (!readIndex(file_size)) {
+    rebuildIndex(file_size);
+  }
+}
+
+StreamMessage StreamReader::read(size_t index) {
+  in_.clear();
+  in_.seekg(offsets_.at(index));
+
+  StreamMessage message;
+  message.stamp_ns = readLE<uint64_t>(in_);
+  const auto topic_size = readLE<uint32_t>(in_);
+  const auto payload_size = readLE<uint64_t>(in_);
+  message.topic.resize(topic_size);
+  message.payload.resize(payload_size);
+  in_.read(message.topic.data(), topic_size);
+  in_.read(reinterpret_cast<char*>(message.payload.data()), payload_size);
+  if (!in_) {
+    std::stringstream ss;
+    ss << "failed to read message " << index << " from recording";
+    throw std::runtime_error(ss.str());
+  }
+
+  return message;
+}
+
+bool StreamReader::readIndex(uint64_t file_size) {
+  if (file_size < FILE_HEADER_SIZE + FOOTER_SIZE) {
+    return false;
+  }
+
+  in_.seekg(file_size - FOOTER_SIZE);
+  const auto index_offset = readLE<uint64_t>(in_);
+  const auto num_messages = readLE<uint64_t>(in_);
+  if (readLE<uint64_t>(in_) != INDEX_MAGIC) {
+    return false;
+  }
+
+  if (index_offset + num_messages * INDEX_ENTRY_SIZE + FOOTER_SIZE != file_size) {
+    return false;
+  }
+
+  in_.seekg(index_offset);
+  offsets_.resize(num_messages);
+  stamps_.resize(num_messages);
+  for (size_t i = 0; i < num_messages; ++i) {
+    offsets_[i] = readLE<uint64_t>(in_);
+    stamps_[i] = readLE<uint64_t>(in_);
+  }
+
+  return static_cast<bool>(in_);
+}
+
+void StreamReader::rebuildIndex(uint64_t file_size) {
+  offsets_.clear();
+  stamps_.clear();
+  in_.clear();
+
+  // trailing partial messages are dropped
+  uint64_t offset = FILE_HEADER_SIZE;
+  while (offset + RECORD_HEADER_SIZE <= file_size) {
+    in_.seekg(offset);
+    const auto stamp_ns = readLE<uint64_t>(in_);
+    const auto topic_size = readLE<uint32_t>(in_);
+    const auto payload_size = readLE<uint64_t>(in_);
+    const uint64_t next = offset + RECORD_HEADER_SIZE + topic_size + payload_size;
+    if (!in_ || next > file_size || next < offset) {
+      break;
+    }
+
+    offsets_.push_back(offset);
+    stamps_.push_back(stamp_ns);
+    offset = next;
+  }
+}
+
+}  // namespace spark_dsg
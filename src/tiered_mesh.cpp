@@ -0,0 +1,599 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "spark_dsg/tiered_mesh.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include "spark_dsg/serialization/binary_conversions.h"
+#include "spark_dsg/serialization/file_io.h"
+#include "spark_dsg/serialization/graph_binary_serialization.h"
+#include "spark_dsg/serialization/versioning.h"
+
+namespace spark_dsg {
+
+namespace {
+
+// every vertex is stored as a fixed-size record (in native byte order)
+constexpr size_t POS_OFFSET = 0;
+constexpr size_t COLOR_OFFSET = POS_OFFSET + 3 * sizeof(float);
+constexpr size_t STAMP_OFFSET = COLOR_OFFSET + 4;
+constexpr size_t LABEL_OFFSET = STAMP_OFFSET + sizeof(Mesh::Timestamp);
+constexpr size_t FIRST_SEEN_OFFSET = LABEL_OFFSET + sizeof(Mesh::Label);
+constexpr size_t RECORD_SIZE = FIRST_SEEN_OFFSET + sizeof(Mesh::Timestamp);
+
+// encoded bytes buffered at a time when serializing
+constexpr size_t CHUNK_BYTES = 1 << 20;
+// minimum growth of the archive file
+constexpr size_t MIN_ARCHIVE_RECORDS = 1 << 16;
+
+template <typename T>
+inline T readField(const uint8_t* record, size_t offset) {
+  T value;
+  std::memcpy(&value, record + offset, sizeof(T));
+  return value;
+}
+
+template <typename T>
+inline void writeField(uint8_t* record, size_t offset, const T& value) {
+  std::memcpy(record + offset, &value, sizeof(T));
+}
+
+inline Mesh::Pos readPos(const uint8_t* record) {
+  Mesh::Pos pos;
+  std::memcpy(pos.data(), record + POS_OFFSET, 3 * sizeof(float));
+  return pos;
+}
+
+inline Color readColor(const uint8_t* record) {
+  const uint8_t* c = record + COLOR_OFFSET;
+  return Color(c[0], c[1], c[2], c[3]);
+}
+
+inline void writeColor(uint8_t* record, const Color& color) {
+  uint8_t* c = record + COLOR_OFFSET;
+  c[0] = color.r;
+  c[1] = color.g;
+  c[2] = color.b;
+  c[3] = color.a;
+}
+
+// encode vertex i of the mesh (missing attributes are zeroed)
+void encodeRecord(const Mesh& mesh, size_t i, uint8_t* record) {
+  std::memset(record, 0, RECORD_SIZE);
+  const auto& pos = mesh.points[i];
+  std::memcpy(record + POS_OFFSET, pos.data(), 3 * sizeof(float));
+  if (mesh.has_colors) {
+    writeColor(record, mesh.colors[i]);
+  }
+  if (mesh.has_timestamps) {
+    writeField(record, STAMP_OFFSET, mesh.stamps[i]);
+  }
+  if (mesh.has_labels) {
+    writeField(record, LABEL_OFFSET, mesh.labels[i]);
+  }
+  if (mesh.has_first_seen_stamps) {
+    writeField(record, FIRST_SEEN_OFFSET, mesh.first_seen_stamps[i]);
+  }
+}
+
+void decodeRecord(const uint8_t* record, Mesh& mesh, size_t i) {
+  std::memcpy(mesh.points[i].data(), record + POS_OFFSET, 3 * sizeof(float));
+  if (mesh.has_colors) {
+    mesh.colors[i] = readColor(record);
+  }
+  if (mesh.has_timestamps) {
+    mesh.stamps[i] = readField<Mesh::Timestamp>(record, STAMP_OFFSET);
+  }
+  if (mesh.has_labels) {
+    mesh.labels[i] = readField<Mesh::Label>(record, LABEL_OFFSET);
+  }
+  if (mesh.has_first_seen_stamps) {
+    mesh.first_seen_stamps[i] = readField<Mesh::Timestamp>(record, FIRST_SEEN_OFFSET);
+  }
+}
+
+template <typename T>
+size_t vectorBytes(const std::vector<T>& values) {
+  return values.size() * sizeof(T);
+}
+
+[[noreturn]] void throwSystemError(const std::string& what, const std::string& path) {
+  std::stringstream ss;
+  ss << what << " '" << path << "': " << std::strerror(errno);
+  throw std::runtime_error(ss.str());
+}
+
+}  // namespace
+
+struct TieredMesh::Detail {
+  Detail(const Config& config, Mesh&& active)
+      : config(config), active(std::move(active)) {}
+
+  ~Detail() {
+    if (data) {
+      munmap(data, capacity * RECORD_SIZE);
+    }
+
+    if (fd >= 0) {
+      close(fd);
+    }
+
+    if (config.remove_archive) {
+      std::error_code ec;
+      std::filesystem::remove(config.archive_path, ec);
+    }
+  }
+
+  void open() {
+    fd = ::open(config.archive_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+      throwSystemError("failed to create mesh archive", config.archive_path);
+    }
+  }
+
+  void reserve(size_t num_records) {
+    if (num_records <= capacity) {
+      return;
+    }
+
+    const size_t new_capacity =
+        std::max({num_records, 2 * capacity, MIN_ARCHIVE_RECORDS});
+    if (ftruncate(fd, new_capacity * RECORD_SIZE) != 0) {
+      throwSystemError("failed to resize mesh archive", config.archive_path);
+    }
+
+    // map the grown file before releasing the old mapping so that a failure leaves
+    // the archive usable
+    void* mapped = mmap(nullptr,
+                        new_capacity * RECORD_SIZE,
+                        PROT_READ | PROT_WRITE,
+                        MAP_SHARED,
+                        fd,
+                        0);
+    if (mapped == MAP_FAILED) {
+      throwSystemError("failed to map mesh archive", config.archive_path);
+    }
+
+    if (data) {
+      munmap(data, capacity * RECORD_SIZE);
+    }
+
+    data = static_cast<uint8_t*>(mapped);
+    capacity = new_capacity;
+  }
+
+  inline uint8_t* record(size_t index) const { return data + index * RECORD_SIZE; }
+
+  const Config config;
+  Mesh active;
+  Mesh::Faces faces;
+  int fd = -1;
+  uint8_t* data = nullptr;
+  size_t capacity = 0;
+  size_t num_archived = 0;
+};
+
+TieredMesh::TieredMesh(const Config& config,
+                       bool has_colors,
+                       bool has_timestamps,
+                       bool has_labels,
+                       bool has_first_seen_stamps)
+    : has_colors(has_colors),
+      has_timestamps(has_timestamps),
+      has_labels(has_labels),
+      has_first_seen_stamps(has_first_seen_stamps),
+      internals_(new Detail(
+          config,
+          Mesh(has_colors, has_timestamps, has_labels, has_first_seen_stamps))) {
+  internals_->open();
+}
+
+TieredMesh::~TieredMesh() = default;
+
+const TieredMesh::Config& TieredMesh::config() const { return internals_->config; }
+
+size_t TieredMesh::numVertices() const {
+  return internals_->num_archived + internals_->active.numVertices();
+}
+
+size_t TieredMesh::numArchived() const { return internals_->num_archived; }
+
+size_t TieredMesh::numFaces() const { return internals_->faces.size(); }
+
+void TieredMesh::append(const Mesh& mesh) {
+  auto& active = internals_->active;
+  const size_t offset = numVertices();
+  const size_t start = active.appendVertices(mesh.numVertices());
+  std::copy(mesh.points.begin(), mesh.points.end(), active.points.begin() + start);
+  for (size_t i = 0; i < mesh.numVertices(); ++i) {
+    if (has_colors && mesh.has_colors) {
+      active.colors[start + i] = mesh.colors[i];
+    }
+    if (has_timestamps && mesh.has_timestamps) {
+      active.stamps[start + i] = mesh.stamps[i];
+    }
+    if (has_labels && mesh.has_labels) {
+      active.labels[start + i] = mesh.labels[i];
+    }
+    if (has_first_seen_stamps && mesh.has_first_seen_stamps) {
+      active.first_seen_stamps[start + i] = mesh.first_seen_stamps[i];
+    }
+  }
+
+  auto& faces = internals_->faces;
+  faces.reserve(faces.size() + mesh.numFaces());
+  for (const auto& face : mesh.faces) {
+    faces.push_back({{face[0] + offset, face[1] + offset, face[2] + offset}});
+  }
+}
+
+size_t TieredMesh::archive(Mesh::Timestamp now) {
+  const auto age = internals_->config.archive_age_ns;
+  return archiveBefore(now > age ? now - age : 0);
+}
+
+size_t TieredMesh::archiveBefore(Mesh::Timestamp threshold) {
+  if (!has_timestamps) {
+    throw std::runtime_error("cannot archive mesh vertices without timestamps");
+  }
+
+  auto& active = internals_->active;
+  const auto iter =
+      std::find_if(active.stamps.begin(), active.stamps.end(), [threshold](auto t) {
+        return t >= threshold;
+      });
+  const size_t num_to_archive = iter - active.stamps.begin();
+  if (num_to_archive == 0) {
+    return 0;
+  }
+
+  const size_t start = internals_->num_archived;
+  internals_->reserve(start + num_to_archive);
+  for (size_t i = 0; i < num_to_archive; ++i) {
+    encodeRecord(active, i, internals_->record(start + i));
+  }
+
+  internals_->num_archived += num_to_archive;
+  active.eraseVertexRange(0, num_to_archive);
+  return num_to_archive;
+}
+
+void TieredMesh::evictArchive() {
+  if (!internals_->data) {
+    return;
+  }
+
+  const size_t num_bytes = internals_->capacity * RECORD_SIZE;
+  msync(internals_->data, num_bytes, MS_SYNC);
+  madvise(internals_->data, num_bytes, MADV_DONTNEED);
+}
+
+TieredMesh::Residency TieredMesh::residency() const {
+  const auto& active = internals_->active;
+  Residency result;
+  result.num_active = active.numVertices();
+  result.num_archived = internals_->num_archived;
+  result.active_bytes = vectorBytes(active.points) + vectorBytes(active.colors) +
+                        vectorBytes(active.stamps) + vectorBytes(active.labels) +
+                        vectorBytes(active.first_seen_stamps);
+  result.archive_bytes = internals_->num_archived * RECORD_SIZE;
+  if (result.archive_bytes == 0) {
+    return result;
+  }
+
+  const size_t page_size = sysconf(_SC_PAGESIZE);
+  const size_t num_pages = (result.archive_bytes + page_size - 1) / page_size;
+#ifdef __APPLE__
+  std::vector<char> pages(num_pages);
+#else
+  std::vector<unsigned char> pages(num_pages);
+#endif
+  if (mincore(internals_->data, result.archive_bytes, pages.data()) != 0) {
+    return result;
+  }
+
+  for (size_t i = 0; i < num_pages; ++i) {
+    if (pages[i] & 1) {
+      const size_t page_end = std::min((i + 1) * page_size, result.archive_bytes);
+      result.resident_archive_bytes += page_end - i * page_size;
+    }
+  }
+
+  return result;
+}
+
+namespace {
+
+inline void checkIndex(size_t index, size_t size) {
+  if (index >= size) {
+    std::stringstream ss;
+    ss << "vertex " << index << " out of range [0, " << size << ")";
+    throw std::out_of_range(ss.str());
+  }
+}
+
+inline void checkAttribute(bool has_attribute, const char* name) {
+  if (!has_attribute) {
+    throw std::out_of_range(std::string("mesh has no ") + name);
+  }
+}
+
+}  // namespace
+
+Mesh::Pos TieredMesh::pos(size_t index) const {
+  checkIndex(index, numVertices());
+  if (index >= internals_->num_archived) {
+    return internals_->active.pos(index - internals_->num_archived);
+  }
+
+  return readPos(internals_->record(index));
+}
+
+void TieredMesh::setPos(size_t index, const Mesh::Pos& pos) {
+  checkIndex(index, numVertices());
+  if (index >= internals_->num_archived) {
+    internals_->active.setPos(index - internals_->num_archived, pos);
+    return;
+  }
+
+  std::memcpy(internals_->record(index) + POS_OFFSET, pos.data(), 3 * sizeof(float));
+}
+
+Color TieredMesh::color(size_t index) const {
+  checkIndex(index, numVertices());
+  if (index >= internals_->num_archived) {
+    return internals_->active.color(index - internals_->num_archived);
+  }
+
+  checkAttribute(has_colors, "colors");
+  return readColor(internals_->record(index));
+}
+
+void TieredMesh::setColor(size_t index, const Color& color) {
+  checkIndex(index, numVertices());
+  if (index >= internals_->num_archived) {
+    internals_->active.setColor(index - internals_->num_archived, color);
+    return;
+  }
+
+  checkAttribute(has_colors, "colors");
+  writeColor(internals_->record(index), color);
+}
+
+Mesh::Timestamp TieredMesh::timestamp(size_t index) const {
+  checkIndex(index, numVertices());
+  if (index >= internals_->num_archived) {
+    return internals_->active.timestamp(index - internals_->num_archived);
+  }
+
+  return readField<Mesh::Timestamp>(internals_->record(index), STAMP_OFFSET);
+}
+
+void TieredMesh::setTimestamp(size_t index, Mesh::Timestamp timestamp) {
+  checkIndex(index, numVertices());
+  if (index >= internals_->num_archived) {
+    internals_->active.setTimestamp(index - internals_->num_archived, timestamp);
+    return;
+  }
+
+  writeField(internals_->record(index), STAMP_OFFSET, timestamp);
+}
+
+Mesh::Timestamp TieredMesh::firstSeenTimestamp(size_t index) const {
+  checkIndex(index, numVertices());
+  if (index >= internals_->num_archived) {
+    return internals_->active.firstSeenTimestamp(index - internals_->num_archived);
+  }
+
+  checkAttribute(has_first_seen_stamps, "first seen timestamps");
+  return readField<Mesh::Timestamp>(internals_->record(index), FIRST_SEEN_OFFSET);
+}
+
+void TieredMesh::setFirstSeenTimestamp(size_t index, Mesh::Timestamp timestamp) {
+  checkIndex(index, numVertices());
+  if (index >= internals_->num_archived) {
+    const size_t active_index = index - internals_->num_archived;
+    internals_->active.setFirstSeenTimestamp(active_index, timestamp);
+    return;
+  }
+
+  checkAttribute(has_first_seen_stamps, "first seen timestamps");
+  writeField(internals_->record(index), FIRST_SEEN_OFFSET, timestamp);
+}
+
+Mesh::Label TieredMesh::label(size_t index) const {
+  checkIndex(index, numVertices());
+  if (index >= internals_->num_archived) {
+    return internals_->active.label(index - internals_->num_archived);
+  }
+
+  checkAttribute(has_labels, "labels");
+  return readField<Mesh::Label>(internals_->record(index), LABEL_OFFSET);
+}
+
+void TieredMesh::setLabel(size_t index, Mesh::Label label) {
+  checkIndex(index, numVertices());
+  if (index >= internals_->num_archived) {
+    internals_->active.setLabel(index - internals_->num_archived, label);
+    return;
+  }
+
+  checkAttribute(has_labels, "labels");
+  writeField(internals_->record(index), LABEL_OFFSET, label);
+}
+
+const Mesh::Face& TieredMesh::face(size_t index) const {
+  return internals_->faces.at(index);
+}
+
+const Mesh& TieredMesh::active() const { return internals_->active; }
+
+Mesh::Ptr TieredMesh::toMesh() const {
+  auto mesh = std::make_shared<Mesh>(
+      has_colors, has_timestamps, has_labels, has_first_seen_stamps);
+  mesh->resizeVertices(numVertices());
+  const size_t num_archived = internals_->num_archived;
+  for (size_t i = 0; i < num_archived; ++i) {
+    decodeRecord(internals_->record(i), *mesh, i);
+  }
+
+  const auto& active = internals_->active;
+  const auto copy_to = [num_archived](const auto& from, auto& to) {
+    std::copy(from.begin(), from.end(), to.begin() + num_archived);
+  };
+  copy_to(active.points, mesh->points);
+  copy_to(active.colors, mesh->colors);
+  copy_to(active.stamps, mesh->stamps);
+  copy_to(active.labels, mesh->labels);
+  copy_to(active.first_seen_stamps, mesh->first_seen_stamps);
+  mesh->faces = internals_->faces;
+  return mesh;
+}
+
+void TieredMesh::serializeToBinary(std::ostream& out) const {
+  std::vector<uint8_t> buffer;
+  buffer.reserve(CHUNK_BYTES + RECORD_SIZE);
+  serialization::BinarySerializer serializer(&buffer);
+  const auto flush = [&](bool force) {
+    if (force || buffer.size() >= CHUNK_BYTES) {
+      out.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+      buffer.clear();
+    }
+  };
+
+  // same layout as write_binary for Mesh: flags, per-vertex arrays and faces
+  serializer.write(has_colors);
+  serializer.write(has_timestamps);
+  serializer.write(has_labels);
+  serializer.write(has_first_seen_stamps);
+
+  const auto& active = internals_->active;
+  const size_t num_archived = internals_->num_archived;
+  const auto write_vertices =
+      [&](bool has_values, const auto& active_values, const auto& read_archived) {
+        const size_t num_values = has_values ? numVertices() : 0;
+        serializer.startFixedArray(num_values);
+        for (size_t i = 0; i < num_values; ++i) {
+          if (i < num_archived) {
+            serializer.write(read_archived(internals_->record(i)));
+          } else {
+            serializer.write(active_values[i - num_archived]);
+          }
+
+          flush(false);
+        }
+      };
+
+  const auto read_stamp = [](const uint8_t* record) {
+    return readField<Mesh::Timestamp>(record, STAMP_OFFSET);
+  };
+  const auto read_label = [](const uint8_t* record) {
+    return readField<Mesh::Label>(record, LABEL_OFFSET);
+  };
+  const auto read_first_seen = [](const uint8_t* record) {
+    return readField<Mesh::Timestamp>(record, FIRST_SEEN_OFFSET);
+  };
+
+  write_vertices(true, active.points, readPos);
+  write_vertices(has_colors, active.colors, readColor);
+  write_vertices(has_timestamps, active.stamps, read_stamp);
+  write_vertices(has_labels, active.labels, read_label);
+  write_vertices(has_first_seen_stamps, active.first_seen_stamps, read_first_seen);
+
+  serializer.startFixedArray(internals_->faces.size());
+  for (const auto& face : internals_->faces) {
+    serializer.write(face);
+    flush(false);
+  }
+
+  flush(true);
+}
+
+void TieredMesh::save(std::string filepath) const {
+  const auto type = io::verifyFileExtension(filepath);
+  if (type == io::FileType::JSON) {
+    toMesh()->save(filepath);
+    return;
+  }
+
+  std::ofstream out(filepath, std::ios::out | std::ios::binary);
+  if (!out) {
+    throw std::runtime_error("failed to open '" + filepath + "' for writing");
+  }
+
+  const auto header_buffer = io::FileHeader::current().serializeToBinary();
+  out.write(reinterpret_cast<const char*>(header_buffer.data()), header_buffer.size());
+  serializeToBinary(out);
+  if (!out) {
+    throw std::runtime_error("failed to write '" + filepath + "'");
+  }
+}
+
+namespace io {
+
+void saveDsgBinary(const DynamicSceneGraph& graph,
+                   const std::string& filepath,
+                   const TieredMesh& mesh) {
+  std::ofstream out(filepath, std::ios::out | std::ios::binary);
+  if (!out) {
+    throw std::runtime_error("failed to open '" + filepath + "' for writing");
+  }
+
+  const auto header_buffer = FileHeader::current().serializeToBinary();
+  out.write(reinterpret_cast<const char*>(header_buffer.data()), header_buffer.size());
+
+  std::vector<uint8_t> graph_buffer;
+  binary::writeGraphBeforeMesh(graph, graph_buffer);
+  out.write(reinterpret_cast<const char*>(graph_buffer.data()), graph_buffer.size());
+  mesh.serializeToBinary(out);
+  if (!out) {
+    throw std::runtime_error("failed to write '" + filepath + "'");
+  }
+}
+
+}  // namespace io
+
+}  // namespace spark_dsg
@@ -0,0 +1,173 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "spark_dsg/transport_stats.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace spark_dsg {
+
+namespace {
+
+inline void writeU64(uint8_t* ptr, uint64_t value) {
+  for (size_t i = 0; i < sizeof(uint64_t); ++i) {
+    ptr[i] = static_cast<uint8_t>(value >> (8 * i));
+  }
+}
+
+inline uint64_t readU64(const uint8_t* ptr) {
+  uint64_t value = 0;
+  for (size_t i = 0; i < sizeof(uint64_t); ++i) {
+    value |= static_cast<uint64_t>(ptr[i]) << (8 * i);
+  }
+  return value;
+}
+
+}  // namespace
+
+void LogHistogram::add(double value) {
+  value = std::max(value, 0.0);
+  size_t index = 0;
+  if (value >= 1.0) {
+    index = static_cast<size_t>(std::floor(std::log2(value))) + 1;
+  }
+
+  ++buckets[std::min(index, NUM_BUCKETS - 1)];
+  ++count;
+  total += value;
+  min = std::min(min, value);
+  max = std::max(max, value);
+}
+
+void LogHistogram::reset() { *this = LogHistogram(); }
+
+double LogHistogram::mean() const { return count ? total / count : 0.0; }
+
+double LogHistogram::bucketUpperBound(size_t index) {
+  if (index + 1 >= NUM_BUCKETS) {
+    return std::numeric_limits<double>::infinity();
+  }
+
+  return std::ldexp(1.0, index);
+}
+
+double LogHistogram::percentile(double fraction) const {
+  if (!count) {
+    return 0.0;
+  }
+
+  const double target = std::clamp(fraction, 0.0, 1.0) * count;
+  size_t seen = 0;
+  for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+    seen += buckets[i];
+    if (seen >= target && seen > 0) {
+      return std::min(bucketUpperBound(i), max);
+    }
+  }
+
+  return max;
+}
+
+std::ostream& operator<<(std::ostream& out, const LogHistogram& hist) {
+  if (!hist.count) {
+    return out << "n=0";
+  }
+
+  return out << "n=" << hist.count << ", mean=" << hist.mean() << ", min=" << hist.min
+             << ", p50=" << hist.percentile(0.5) << ", p99=" << hist.percentile(0.99)
+             << ", max=" << hist.max;
+}
+
+std::ostream& operator<<(std::ostream& out, const TransportStats& stats) {
+  out << "sent: " << stats.messages_sent << " (" << stats.bytes_sent << " bytes)"
+      << ", received: " << stats.messages_received << " (" << stats.bytes_received
+      << " bytes), dropped: " << stats.messages_dropped << std::endl;
+  out << "  serialize [us]: " << stats.serialize_us << std::endl;
+  out << "  send [us]: " << stats.send_us << std::endl;
+  out << "  recv [us]: " << stats.recv_us << std::endl;
+  out << "  parse [us]: " << stats.parse_us << std::endl;
+  out << "  latency [us]: " << stats.latency_us << std::endl;
+  out << "  message size [bytes]: " << stats.message_bytes;
+  return out;
+}
+
+void TransportStatsRecorder::enable(bool enabled) { enabled_ = enabled; }
+
+TransportStats TransportStatsRecorder::get() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+void TransportStatsRecorder::reset() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  stats_ = TransportStats();
+}
+
+double TransportStatsRecorder::elapsedUs(const Clock::time_point& start,
+                                         const Clock::time_point& end) {
+  return std::chrono::duration<double, std::micro>(end - start).count();
+}
+
+uint64_t TransportTrailer::now() {
+  const auto stamp = std::chrono::system_clock::now().time_since_epoch();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(stamp).count();
+}
+
+void TransportTrailer::append(std::vector<uint8_t>& buffer) const {
+  const size_t offset = buffer.size();
+  buffer.resize(offset + SIZE);
+  writeU64(buffer.data() + offset, sequence);
+  writeU64(buffer.data() + offset + sizeof(uint64_t), stamp_ns);
+  writeU64(buffer.data() + offset + 2 * sizeof(uint64_t), MAGIC);
+}
+
+bool TransportTrailer::parse(const uint8_t* const buffer,
+                             size_t length,
+                             TransportTrailer& trailer) {
+  if (length < SIZE) {
+    return false;
+  }
+
+  const uint8_t* start = buffer + length - SIZE;
+  if (readU64(start + 2 * sizeof(uint64_t)) != MAGIC) {
+    return false;
+  }
+
+  trailer.sequence = readU64(start);
+  trailer.stamp_ns = readU64(start + sizeof(uint64_t));
+  return true;
+}
+
+}  // namespace spark_dsg
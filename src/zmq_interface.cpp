@@ -35,11 +35,16 @@
 #include "spark_dsg/zmq_interface.h"
 
 #include <atomic>
+#include <condition_variable>
+#include <map>
 #include <mutex>
+#include <optional>
+#include <set>
 #include <thread>
 #include <zmq.hpp>
 
 #include "spark_dsg/dynamic_scene_graph.h"
+#include "spark_dsg/mesh_simplification.h"
 #include "spark_dsg/serialization/graph_binary_serialization.h"
 
 namespace spark_dsg {
@@ -68,17 +73,186 @@ class ZmqContextHolder {
 
 std::unique_ptr<ZmqContextHolder> ZmqContextHolder::instance_;
 
+using Clock = TransportStatsRecorder::Clock;
+
+namespace {
+
+const std::string MESH_TOPIC = "mesh/";
+
+inline std::string layerTopic(LayerId layer) {
+  // trailing separator keeps layer 2 from matching layer 20
+  return "layer/" + std::to_string(layer) + "/";
+}
+
+}  // namespace
+
 struct ZmqSender::Detail {
-  Detail(const std::string& url, size_t) {
+  Detail(const std::string& url, size_t, bool layer_topics)
+      : layer_topics(layer_topics) {
     socket.reset(new zmq::socket_t(ZmqContextHolder::instance().context(), ZMQ_PUB));
     socket->bind(url);
   }
 
-  ~Detail() = default;
+  ~Detail() {
+    if (!worker) {
+      return;
+    }
+
+    {  // pending snapshots are still published before the worker exits
+      std::lock_guard<std::mutex> lock(async_mutex);
+      should_shutdown = true;
+    }
+    async_cv.notify_all();
+    worker->join();
+  }
+
+  void sendAsync(DynamicSceneGraph::ConstPtr graph,
+                 bool include_mesh,
+                 bool mesh_simplified = false) {
+    bool coalesced = false;
+    {
+      std::lock_guard<std::mutex> lock(async_mutex);
+      if (!worker) {
+        worker.reset(new std::thread(&Detail::sendLoop, this));
+      }
+
+      coalesced = pending != nullptr;
+      pending = std::move(graph);
+      pending_mesh = include_mesh;
+      pending_simplified = mesh_simplified;
+    }
+
+    async_cv.notify_all();
+    if (coalesced) {
+      stats.update([](TransportStats& s) { ++s.messages_dropped; });
+    }
+  }
+
+  void flush() {
+    std::unique_lock<std::mutex> lock(async_mutex);
+    async_cv.wait(lock, [this] { return !pending && !sending; });
+  }
+
+  void sendLoop() {
+    std::unique_lock<std::mutex> lock(async_mutex);
+    while (true) {
+      async_cv.wait(lock, [this] { return pending || should_shutdown; });
+      if (!pending) {
+        return;
+      }
+
+      if (coalesce_window.count() > 0 && !should_shutdown) {
+        // newer snapshots replace the pending one until the window expires
+        async_cv.wait_for(lock, coalesce_window, [this] { return should_shutdown; });
+      }
+
+      const auto graph = std::move(pending);
+      const bool include_mesh = pending_mesh;
+      const bool mesh_simplified = pending_simplified;
+      pending.reset();
+      sending = true;
+
+      lock.unlock();
+      send(*graph, include_mesh, mesh_simplified);
+      lock.lock();
+
+      sending = false;
+      async_cv.notify_all();
+    }
+  }
+
+  void sendRaw(const std::string& topic, const std::vector<uint8_t>& payload) {
+    std::lock_guard<std::mutex> lock(send_mutex);
+    const auto start = Clock::now();
+    const uint64_t stamp_ns = stats.enabled() ? TransportTrailer::now() : 0;
+    const uint64_t sequence = stats.enabled() ? ++num_sent : 0;
+    std::vector<uint8_t> buffer(payload);
+    sendPayload(topic, buffer, start, stamp_ns, sequence);
+  }
+
+  void send(const DynamicSceneGraph& graph,
+            bool include_mesh,
+            bool mesh_simplified = false) {
+    std::lock_guard<std::mutex> lock(send_mutex);
+    const uint64_t stamp_ns = stats.enabled() ? TransportTrailer::now() : 0;
+    const uint64_t sequence = stats.enabled() ? ++num_sent : 0;
+
+    if (!layer_topics) {
+      const auto start = Clock::now();
+      const auto mesh = include_mesh ? meshToSend(graph, mesh_simplified) : nullptr;
+      std::vector<uint8_t> buffer;
+      if (mesh) {
+        io::binary::writeGraph(graph, buffer, *mesh);
+      } else {
+        io::binary::writeGraph(graph, buffer, false);
+      }
+      sendPayload("", buffer, start, stamp_ns, sequence);
+      return;
+    }
+
+    // send lower layers first so that parent edges can be resolved by receivers
+    std::set<LayerId> layers(graph.layer_ids.begin(), graph.layer_ids.end());
+    for (const auto& id_layers_pair : graph.dynamicLayers()) {
+      layers.insert(id_layers_pair.first);
+    }
+
+    for (const auto layer : layers) {
+      const auto start = Clock::now();
+      std::vector<uint8_t> buffer;
+      io::binary::writeLayer(graph, layer, buffer);
+      sendPayload(layerTopic(layer), buffer, start, stamp_ns, sequence);
+    }
 
-  void send(const DynamicSceneGraph& graph, bool include_mesh) {
-    std::vector<uint8_t> buffer;
-    io::binary::writeGraph(graph, buffer, include_mesh);
+    if (include_mesh) {
+      const auto start = Clock::now();
+      const auto mesh = meshToSend(graph, mesh_simplified);
+      std::vector<uint8_t> buffer;
+      if (mesh) {
+        io::binary::writeMesh(graph, buffer, *mesh);
+      } else {
+        io::binary::writeMesh(graph, buffer);
+      }
+      sendPayload(MESH_TOPIC, buffer, start, stamp_ns, sequence);
+    }
+  }
+
+  //! copy of the simplified graph mesh (nullptr without a mesh or simplification)
+  Mesh::Ptr simplifyMesh(const DynamicSceneGraph& graph) {
+    std::lock_guard<std::mutex> lock(simplify_mutex);
+    const auto mesh = graph.mesh();
+    if (!mesh || !simplifier) {
+      return nullptr;
+    }
+
+    return std::make_shared<Mesh>(simplifier->update(*mesh));
+  }
+
+  Mesh::ConstPtr meshToSend(const DynamicSceneGraph& graph, bool mesh_simplified) {
+    const auto simplified = mesh_simplified ? nullptr : simplifyMesh(graph);
+    return simplified ? simplified : graph.mesh();
+  }
+
+  void sendPayload(const std::string& topic,
+                   std::vector<uint8_t>& buffer,
+                   const Clock::time_point& start,
+                   uint64_t stamp_ns,
+                   uint64_t sequence) {
+    const auto serialized = Clock::now();
+    if (stats.enabled()) {
+      TransportTrailer trailer;
+      trailer.sequence = sequence;
+      trailer.stamp_ns = stamp_ns;
+      trailer.append(buffer);
+    }
+
+    if (!topic.empty()) {
+      zmq::message_t topic_msg(topic.data(), topic.size());
+#if ZMQ_VERSION < ZMQ_MAKE_VERSION(4, 3, 1)
+      socket->send(topic_msg, ZMQ_SNDMORE);
+#else
+      socket->send(topic_msg, zmq::send_flags::sndmore);
+#endif
+    }
 
     // TODO(nathan) it'd be nice if we could avoid the memcpy
     zmq::message_t msg(buffer.data(), buffer.size());
@@ -87,13 +261,40 @@ struct ZmqSender::Detail {
 #else
     socket->send(msg, zmq::send_flags::none);
 #endif
+
+    const auto sent = Clock::now();
+    stats.update([&](TransportStats& s) {
+      ++s.messages_sent;
+      s.bytes_sent += buffer.size();
+      s.message_bytes.add(buffer.size());
+      s.serialize_us.add(TransportStatsRecorder::elapsedUs(start, serialized));
+      s.send_us.add(TransportStatsRecorder::elapsedUs(serialized, sent));
+    });
   }
 
+  const bool layer_topics;
+  std::mutex send_mutex;
+  //! optional simplification of sent meshes (guarded separately from sending so that
+  //! sendAsync can simplify on the calling thread)
+  std::mutex simplify_mutex;
+  std::unique_ptr<MeshSimplifier> simplifier;
   std::unique_ptr<zmq::socket_t> socket;
+  TransportStatsRecorder stats;
+  uint64_t num_sent = 0;
+
+  std::mutex async_mutex;
+  std::condition_variable async_cv;
+  std::chrono::milliseconds coalesce_window{0};
+  DynamicSceneGraph::ConstPtr pending;
+  bool pending_mesh = false;
+  bool pending_simplified = false;
+  bool sending = false;
+  bool should_shutdown = false;
+  std::unique_ptr<std::thread> worker;
 };
 
-ZmqSender::ZmqSender(const std::string& url, size_t num_threads)
-    : internals_(new ZmqSender::Detail(url, num_threads)) {}
+ZmqSender::ZmqSender(const std::string& url, size_t num_threads, bool layer_topics)
+    : internals_(new ZmqSender::Detail(url, num_threads, layer_topics)) {}
 
 ZmqSender::~ZmqSender() {}
 
@@ -101,8 +302,55 @@ void ZmqSender::send(const DynamicSceneGraph& graph, bool include_mesh) {
   internals_->send(graph, include_mesh);
 }
 
+void ZmqSender::sendAsync(const DynamicSceneGraph& graph, bool include_mesh) {
+  // full clone on the caller thread (see header); the mesh is usually the bulk of the
+  // graph, so only copy it when it is sent. The simplifier has to follow the changes
+  // of the original mesh (not of a copy), so the mesh is simplified here as well
+  auto snapshot = graph.clone(false);
+  const auto simplified = include_mesh ? internals_->simplifyMesh(graph) : nullptr;
+  if (simplified) {
+    snapshot->setMesh(simplified);
+  } else if (include_mesh && graph.mesh()) {
+    snapshot->setMesh(graph.mesh()->clone());
+  }
+
+  internals_->sendAsync(std::move(snapshot), include_mesh, simplified != nullptr);
+}
+
+void ZmqSender::sendAsync(DynamicSceneGraph::ConstPtr graph, bool include_mesh) {
+  if (!graph) {
+    return;
+  }
+
+  internals_->sendAsync(std::move(graph), include_mesh);
+}
+
+void ZmqSender::sendRaw(const StreamMessage& message) {
+  internals_->sendRaw(message.topic, message.payload);
+}
+
+void ZmqSender::setCoalesceWindow(size_t window_ms) {
+  std::lock_guard<std::mutex> lock(internals_->async_mutex);
+  internals_->coalesce_window = std::chrono::milliseconds(window_ms);
+}
+
+void ZmqSender::setMeshSimplification(float voxel_size) {
+  std::lock_guard<std::mutex> lock(internals_->simplify_mutex);
+  internals_->simplifier.reset(voxel_size > 0.0f ? new MeshSimplifier(voxel_size)
+                                                 : nullptr);
+}
+
+void ZmqSender::flush() { internals_->flush(); }
+
+void ZmqSender::enableStats(bool enable) { internals_->stats.enable(enable); }
+
+TransportStats ZmqSender::stats() const { return internals_->stats.get(); }
+
+void ZmqSender::resetStats() { internals_->stats.reset(); }
+
 struct ZmqReceiver::Detail {
-  Detail(const std::string& url, size_t, bool conflate) {
+  Detail(const std::string& url, size_t, bool conflate)
+      : use_topics(false), conflate(conflate) {
     socket.reset(new zmq::socket_t(ZmqContextHolder::instance().context(), ZMQ_SUB));
     socket->connect(url);
     socket->setsockopt(ZMQ_SUBSCRIBE, "", 0);
@@ -112,21 +360,39 @@ struct ZmqReceiver::Detail {
     }
   }
 
-  ~Detail() = default;
+  Detail(const std::string& url,
+         size_t,
+         const std::vector<LayerId>& layers,
+         bool include_mesh,
+         bool conflate)
+      : use_topics(true), conflate(conflate) {
+    socket.reset(new zmq::socket_t(ZmqContextHolder::instance().context(), ZMQ_SUB));
+    socket->connect(url);
+    for (const auto layer : layers) {
+      topic_layers[layerTopic(layer)] = layer;
+    }
 
-  bool recv(size_t timeout_ms) {
-    if (!socket->connected()) {
-      return false;
+    if (include_mesh) {
+      topic_layers[MESH_TOPIC] = std::nullopt;
+    }
+
+    // ZMQ_CONFLATE does not support multi-part messages, so conflation happens
+    // per-topic when reading messages instead
+    for (const auto& topic_layer_pair : topic_layers) {
+      const auto& topic = topic_layer_pair.first;
+      socket->setsockopt(ZMQ_SUBSCRIBE, topic.data(), topic.size());
     }
+  }
 
+  ~Detail() = default;
+
+  bool poll(size_t timeout_ms) {
     zmq::pollitem_t items[] = {{socket->operator void*(), 0, ZMQ_POLLIN, 0}};
     zmq::poll(&items[0], 1, std::chrono::milliseconds(timeout_ms));
+    return items[0].revents & ZMQ_POLLIN;
+  }
 
-    if (!(items[0].revents & ZMQ_POLLIN)) {
-      return false;
-    }
-
-    zmq::message_t msg;
+  void recvMessage(zmq::message_t& msg) {
 #if ZMQ_VERSION < ZMQ_MAKE_VERSION(4, 3, 1)
     socket->recv(&msg);
 #else
@@ -135,24 +401,184 @@ struct ZmqReceiver::Detail {
       throw std::runtime_error("zmq internal error: no data received");
     }
 #endif
+  }
 
+  bool recvRaw(size_t timeout_ms, StreamMessage& message) {
+    if (!socket->connected() || !poll(timeout_ms)) {
+      return false;
+    }
+
+    zmq::message_t msg;
+    recvMessage(msg);
+    message.stamp_ns = TransportTrailer::now();
+    message.topic.clear();
+    if (msg.more()) {
+      message.topic.assign(static_cast<const char*>(msg.data()), msg.size());
+      recvMessage(msg);
+    }
+
+    // drop the sender's trailer so replays do not end up with two of them
+    const auto data_ptr = static_cast<const uint8_t*>(msg.data());
+    TransportTrailer trailer;
+    const bool has_trailer = TransportTrailer::parse(data_ptr, msg.size(), trailer);
+    const size_t length = msg.size() - (has_trailer ? TransportTrailer::SIZE : 0);
+    message.payload.assign(data_ptr, data_ptr + length);
+    return true;
+  }
+
+  bool recv(size_t timeout_ms) {
+    if (!socket->connected()) {
+      return false;
+    }
+
+    if (!poll(timeout_ms)) {
+      return false;
+    }
+
+    if (use_topics) {
+      recvTopics();
+      return true;
+    }
+
+    const auto start = Clock::now();
+    zmq::message_t msg;
+    recvMessage(msg);
+    const auto received = Clock::now();
+
+    const auto data_ptr = static_cast<uint8_t*>(msg.data());
     if (!graph) {
-      graph = io::binary::readGraph(static_cast<uint8_t*>(msg.data()), msg.size());
+      graph = io::binary::readGraph(data_ptr, msg.size());
     } else {
-      const auto data_ptr = static_cast<uint8_t*>(msg.data());
       io::binary::updateGraph(*graph, data_ptr, msg.size());
     }
 
+    const auto parsed = Clock::now();
+    if (stats.enabled()) {
+      updateStats("",
+                  data_ptr,
+                  msg.size(),
+                  TransportStatsRecorder::elapsedUs(start, received),
+                  TransportStatsRecorder::elapsedUs(received, parsed));
+    }
+
     return true;
   }
 
+  void recvTopics() {
+    const auto start = Clock::now();
+
+    // frames are applied lower layers first and mesh last (see ZmqSender)
+    std::map<LayerId, std::pair<std::string, zmq::message_t>> layer_frames;
+    std::optional<zmq::message_t> mesh_frame;
+    do {
+      zmq::message_t topic_msg;
+      recvMessage(topic_msg);
+      if (!topic_msg.more()) {
+        continue;  // malformed message without payload
+      }
+
+      zmq::message_t payload;
+      recvMessage(payload);
+      const std::string topic(static_cast<const char*>(topic_msg.data()),
+                              topic_msg.size());
+      const auto iter = topic_layers.find(topic);
+      if (iter == topic_layers.end()) {
+        continue;
+      }
+
+      if (iter->second) {
+        layer_frames[*iter->second] = {topic, std::move(payload)};
+      } else {
+        mesh_frame = std::move(payload);
+      }
+    } while (conflate && poll(0));
+
+    const double recv_us = TransportStatsRecorder::elapsedUs(start);
+    if (!graph) {
+      graph = std::make_shared<DynamicSceneGraph>();
+    }
+
+    for (auto& [layer, frame] : layer_frames) {
+      const auto parse_start = Clock::now();
+      auto& msg = frame.second;
+      const auto data_ptr = static_cast<uint8_t*>(msg.data());
+      io::binary::updateLayer(*graph, layer, data_ptr, msg.size());
+      if (stats.enabled()) {
+        updateStats(frame.first,
+                    data_ptr,
+                    msg.size(),
+                    recv_us,
+                    TransportStatsRecorder::elapsedUs(parse_start));
+      }
+    }
+
+    if (mesh_frame) {
+      const auto parse_start = Clock::now();
+      const auto data_ptr = static_cast<uint8_t*>(mesh_frame->data());
+      io::binary::updateMesh(*graph, data_ptr, mesh_frame->size());
+      if (stats.enabled()) {
+        updateStats(MESH_TOPIC,
+                    data_ptr,
+                    mesh_frame->size(),
+                    recv_us,
+                    TransportStatsRecorder::elapsedUs(parse_start));
+      }
+    }
+  }
+
+  void updateStats(const std::string& topic,
+                   const uint8_t* const data,
+                   size_t length,
+                   double recv_us,
+                   double parse_us) {
+    TransportTrailer trailer;
+    const bool has_trailer = TransportTrailer::parse(data, length, trailer);
+    const uint64_t now_ns = TransportTrailer::now();
+
+    size_t num_dropped = 0;
+    if (has_trailer) {
+      // sequence numbers restart if the sender is restarted
+      auto& last_sequence = last_sequences[topic];
+      if (last_sequence && trailer.sequence > last_sequence) {
+        num_dropped = trailer.sequence - last_sequence - 1;
+      }
+      last_sequence = trailer.sequence;
+    }
+
+    stats.update([&](TransportStats& s) {
+      ++s.messages_received;
+      s.messages_dropped += num_dropped;
+      s.bytes_received += length;
+      s.message_bytes.add(length);
+      s.recv_us.add(recv_us);
+      s.parse_us.add(parse_us);
+      if (has_trailer && now_ns >= trailer.stamp_ns) {
+        s.latency_us.add((now_ns - trailer.stamp_ns) * 1.0e-3);
+      }
+    });
+  }
+
+  const bool use_topics;
+  const bool conflate;
+  //! subscribed topics (mesh topic maps to an empty layer)
+  std::map<std::string, std::optional<LayerId>> topic_layers;
   std::unique_ptr<zmq::socket_t> socket;
   DynamicSceneGraph::Ptr graph;
+  TransportStatsRecorder stats;
+  std::map<std::string, uint64_t> last_sequences;
 };
 
 ZmqReceiver::ZmqReceiver(const std::string& url, size_t num_threads, bool conflate)
     : internals_(new ZmqReceiver::Detail(url, num_threads, conflate)) {}
 
+ZmqReceiver::ZmqReceiver(const std::string& url,
+                         size_t num_threads,
+                         const std::vector<LayerId>& layers,
+                         bool include_mesh,
+                         bool conflate)
+    : internals_(new ZmqReceiver::Detail(
+          url, num_threads, layers, include_mesh, conflate)) {}
+
 ZmqReceiver::~ZmqReceiver() {}
 
 bool ZmqReceiver::recv(size_t timeout_ms, bool recv_all) {
@@ -167,16 +593,38 @@ bool ZmqReceiver::recv(size_t timeout_ms, bool recv_all) {
   return true;
 }
 
+bool ZmqReceiver::recvRaw(size_t timeout_ms, StreamMessage& message) {
+  return internals_->recvRaw(timeout_ms, message);
+}
+
 DynamicSceneGraph::Ptr ZmqReceiver::graph() const { return internals_->graph; }
 
+void ZmqReceiver::enableStats(bool enable) { internals_->stats.enable(enable); }
+
+TransportStats ZmqReceiver::stats() const { return internals_->stats.get(); }
+
+void ZmqReceiver::resetStats() { internals_->stats.reset(); }
+
 struct ZmqGraph::Detail {
  public:
   Detail(const std::string& url, size_t num_threads, size_t poll_time_ms = 100)
       : poll_time_ms_(poll_time_ms),
+        should_shutdown_(false),
         has_change_(false),
         receiver_(url, num_threads),
         recv_thread_(new std::thread(&Detail::receiveLoop, this)) {}
 
+  Detail(const std::string& url,
+         size_t num_threads,
+         const std::vector<LayerId>& layers,
+         bool include_mesh,
+         size_t poll_time_ms)
+      : poll_time_ms_(poll_time_ms),
+        should_shutdown_(false),
+        has_change_(false),
+        receiver_(url, num_threads, layers, include_mesh),
+        recv_thread_(new std::thread(&Detail::receiveLoop, this)) {}
+
   ~Detail() {
     should_shutdown_ = true;
     if (recv_thread_) {
@@ -200,6 +648,8 @@ struct ZmqGraph::Detail {
     return graph_->clone();
   }
 
+  ZmqReceiver& receiver() { return receiver_; }
+
  private:
   void receiveLoop() {
     while (!should_shutdown_) {
@@ -227,10 +677,24 @@ struct ZmqGraph::Detail {
 ZmqGraph::ZmqGraph(const std::string& url, size_t num_threads, size_t poll_time_ms)
     : internals_(new ZmqGraph::Detail(url, num_threads, poll_time_ms)) {}
 
+ZmqGraph::ZmqGraph(const std::string& url,
+                   size_t num_threads,
+                   const std::vector<LayerId>& layers,
+                   bool include_mesh,
+                   size_t poll_time_ms)
+    : internals_(new ZmqGraph::Detail(
+          url, num_threads, layers, include_mesh, poll_time_ms)) {}
+
 ZmqGraph::~ZmqGraph() {}
 
 bool ZmqGraph::hasChange() const { return internals_->hasChange(); }
 
 DynamicSceneGraph::Ptr ZmqGraph::graph() const { return internals_->graph(); }
 
+void ZmqGraph::enableStats(bool enable) { internals_->receiver().enableStats(enable); }
+
+TransportStats ZmqGraph::stats() const { return internals_->receiver().stats(); }
+
+void ZmqGraph::resetStats() { internals_->receiver().resetStats(); }
+
 }  // namespace spark_dsg
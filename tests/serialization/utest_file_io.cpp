@@ -102,4 +102,22 @@ TEST(FileIoTests, SaveLoadBinary) {
   testSaveLoad(file_name);
 }
 
+TEST(FileIoTests, SaveReplacementMesh) {
+  DynamicSceneGraph graph;
+  auto mesh = std::make_shared<Mesh>();
+  mesh->resizeVertices(4);
+  graph.setMesh(mesh);
+
+  Mesh replacement;
+  replacement.resizeVertices(2);
+  for (const auto& extension : {".json", ".sparkdsg"}) {
+    TempFile tmp_file;
+    const std::string file_name = tmp_file.path + extension;
+    graph.save(file_name, replacement);
+    auto other = DynamicSceneGraph::load(file_name);
+    ASSERT_TRUE(other->hasMesh());
+    EXPECT_EQ(other->mesh()->numVertices(), 2u);
+  }
+}
+
 }  // namespace spark_dsg::io
@@ -214,4 +214,114 @@ TEST(GraphSerialization, UpdateDsgFromBinaryWithCorrection) {
   EXPECT_EQ(original, updated);
 }
 
+TEST(GraphSerialization, UpdateLayerCorrect) {
+  using namespace std::chrono_literals;
+  DynamicSceneGraph original;
+  original.emplaceNode(2, 0, std::make_unique<NodeAttributes>());
+  original.emplaceNode(3, 1, std::make_unique<NodeAttributes>());
+  original.emplaceNode(3, 2, std::make_unique<NodeAttributes>());
+  original.emplaceNode(4, 3, std::make_unique<NodeAttributes>());
+  original.emplaceNode(2, 'a', 10ns, std::make_unique<NodeAttributes>());
+  original.insertEdge(1, 2);
+  original.insertEdge(0, 1);
+  original.insertEdge(1, 3);
+  original.insertEdge(2, "a0"_id);
+
+  // graph only containing the layers below places
+  DynamicSceneGraph updated;
+  for (const auto layer : {2, 3}) {
+    std::vector<uint8_t> buffer;
+    io::binary::writeLayer(original, layer, buffer);
+    EXPECT_TRUE(io::binary::updateLayer(updated, layer, buffer));
+  }
+
+  EXPECT_TRUE(updated.hasNode(0));
+  EXPECT_TRUE(updated.hasNode(1));
+  EXPECT_TRUE(updated.hasNode(2));
+  EXPECT_FALSE(updated.hasNode(3));
+  EXPECT_TRUE(updated.hasNode("a0"_id));
+  EXPECT_TRUE(updated.hasEdge(1, 2));
+  EXPECT_TRUE(updated.hasEdge(0, 1));
+  EXPECT_TRUE(updated.hasEdge(2, "a0"_id));
+  EXPECT_FALSE(updated.hasEdge(1, 3));
+
+  // the remaining layer should complete the graph
+  std::vector<uint8_t> buffer;
+  io::binary::writeLayer(original, 4, buffer);
+  EXPECT_TRUE(io::binary::updateLayer(updated, 4, buffer));
+  EXPECT_EQ(original, updated);
+
+  // removals only apply to the updated layer
+  original.removeNode(2);
+  original.removeNode(0);
+  buffer.clear();
+  io::binary::writeLayer(original, 3, buffer);
+  EXPECT_TRUE(io::binary::updateLayer(updated, 3, buffer));
+  EXPECT_FALSE(updated.hasNode(2));
+  EXPECT_TRUE(updated.hasNode(0));
+  EXPECT_FALSE(updated.hasEdge(2, "a0"_id));
+  EXPECT_TRUE(updated.hasEdge(1, 3));
+}
+
+TEST(GraphSerialization, UpdateMeshCorrect) {
+  DynamicSceneGraph original;
+  original.emplaceNode(2, 0, std::make_unique<NodeAttributes>());
+  auto mesh = std::make_shared<Mesh>();
+  mesh->points.push_back(Eigen::Vector3f::Zero());
+  mesh->points.push_back(Eigen::Vector3f::Ones());
+  mesh->points.push_back(Eigen::Vector3f::UnitX());
+  mesh->faces.push_back({{0, 1, 2}});
+  original.setMesh(mesh);
+
+  DynamicSceneGraph updated;
+  std::vector<uint8_t> buffer;
+  io::binary::writeMesh(original, buffer);
+  EXPECT_TRUE(io::binary::updateMesh(updated, buffer.data(), buffer.size()));
+  EXPECT_EQ(updated.numNodes(false), 0u);
+  ASSERT_TRUE(updated.mesh() != nullptr);
+  EXPECT_EQ(updated.mesh()->numVertices(), 3u);
+  EXPECT_EQ(updated.mesh()->numFaces(), 1u);
+}
+
+TEST(GraphSerialization, UpdateMeshChangesCorrect) {
+  DynamicSceneGraph original;
+  auto mesh = std::make_shared<Mesh>();
+  mesh->resizeVertices(3);
+  mesh->appendFaces({{{0, 1, 2}}});
+  original.setMesh(mesh);
+
+  // a fresh receiver can only be initialized by a full message
+  DynamicSceneGraph updated;
+  std::vector<uint8_t> buffer;
+  io::binary::writeMeshChanges(original, buffer);
+  EXPECT_FALSE(io::binary::updateMeshChanges(updated, buffer.data(), buffer.size()));
+  EXPECT_TRUE(updated.mesh() == nullptr);
+
+  buffer.clear();
+  io::binary::takeMeshChanges(original, buffer, true);
+  EXPECT_TRUE(io::binary::updateMeshChanges(updated, buffer.data(), buffer.size()));
+  ASSERT_TRUE(updated.mesh() != nullptr);
+  EXPECT_EQ(*updated.mesh(), *mesh);
+
+  mesh->appendVertices(2);
+  mesh->setPos(4, Eigen::Vector3f::Ones());
+  buffer.clear();
+  io::binary::takeMeshChanges(original, buffer);
+  EXPECT_TRUE(io::binary::updateMeshChanges(updated, buffer.data(), buffer.size()));
+  EXPECT_EQ(*updated.mesh(), *mesh);
+
+  // missing a message requires a full update
+  mesh->setPos(0, Eigen::Vector3f::Ones());
+  mesh->clearChanges();
+  mesh->setPos(1, Eigen::Vector3f::Ones());
+  buffer.clear();
+  io::binary::writeMeshChanges(original, buffer);
+  EXPECT_FALSE(io::binary::updateMeshChanges(updated, buffer.data(), buffer.size()));
+
+  buffer.clear();
+  io::binary::writeMeshChanges(original, buffer, true);
+  EXPECT_TRUE(io::binary::updateMeshChanges(updated, buffer.data(), buffer.size()));
+  EXPECT_EQ(*updated.mesh(), *mesh);
+}
+
 }  // namespace spark_dsg
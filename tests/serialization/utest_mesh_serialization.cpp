@@ -34,6 +34,8 @@
  * -------------------------------------------------------------------------- */
 #include <gtest/gtest.h>
 
+#include <random>
+
 #include "spark_dsg/mesh.h"
 
 namespace spark_dsg {
@@ -97,4 +99,220 @@ TEST(MeshSerialization, MeshBinary) {
   EXPECT_EQ(result->faces.size(), 1u);
 }
 
+TEST(MeshSerialization, MeshChangesBinary) {
+  Mesh original(true, true, true, true);
+  original.resizeVertices(6);
+  for (size_t i = 0; i < original.numVertices(); ++i) {
+    original.setPos(i, Eigen::Vector3f(i, 2 * i, 3 * i));
+    original.setColor(i, Color(i, 0, 0));
+    original.setLabel(i, i % 2);
+  }
+  original.appendFaces({{{0, 1, 2}}, {{3, 4, 5}}});
+
+  // only full changes apply to a mesh that is out of sync
+  Mesh result;
+  std::vector<uint8_t> buffer;
+  original.serializeChangesToBinary(buffer);
+  EXPECT_FALSE(result.applyChangesFromBinary(buffer.data(), buffer.size()));
+
+  buffer.clear();
+  original.takeChangesToBinary(buffer, true);
+  ASSERT_TRUE(result.applyChangesFromBinary(buffer.data(), buffer.size()));
+  EXPECT_EQ(result, original);
+  EXPECT_EQ(result.version(), original.version());
+
+  // append, patch and erase some vertices and faces
+  Mesh extra(true, true, true, true);
+  extra.resizeVertices(3);
+  extra.faces.push_back({{0, 1, 2}});
+  original.append(extra);
+  original.setPos(1, Eigen::Vector3f::Constant(-1.0f));
+  original.eraseFaceRange(0, 1, false);
+
+  buffer.clear();
+  original.serializeChangesToBinary(buffer);
+  ASSERT_TRUE(result.applyChangesFromBinary(buffer.data(), buffer.size()));
+  EXPECT_EQ(result, original);
+
+  // applying the same changes twice fails
+  EXPECT_FALSE(result.applyChangesFromBinary(buffer.data(), buffer.size()));
+
+  // removals are applied as well
+  original.clearChanges();
+  original.eraseVertexRange(4, 9);
+  buffer.clear();
+  original.serializeChangesToBinary(buffer);
+  ASSERT_TRUE(result.applyChangesFromBinary(buffer.data(), buffer.size()));
+  EXPECT_EQ(result, original);
+  EXPECT_EQ(result.numVertices(), 4u);
+  EXPECT_EQ(result.numFaces(), 0u);
+}
+
+TEST(MeshSerialization, MeshChangesRequireClearing) {
+  Mesh original;
+  original.resizeVertices(3);
+  Mesh result;
+  std::vector<uint8_t> buffer;
+  original.takeChangesToBinary(buffer, true);
+  ASSERT_TRUE(result.applyChangesFromBinary(buffer.data(), buffer.size()));
+
+  // the changes are not cleared after the first message, so the second one starts
+  // from a version the receiver already moved past
+  original.setPos(0, Eigen::Vector3f::Ones());
+  buffer.clear();
+  original.serializeChangesToBinary(buffer);
+  ASSERT_TRUE(result.applyChangesFromBinary(buffer.data(), buffer.size()));
+  original.setPos(1, Eigen::Vector3f::Ones());
+  buffer.clear();
+  original.serializeChangesToBinary(buffer);
+  EXPECT_FALSE(result.applyChangesFromBinary(buffer.data(), buffer.size()));
+
+  // taking the changes chains the messages
+  buffer.clear();
+  original.takeChangesToBinary(buffer, true);
+  ASSERT_TRUE(result.applyChangesFromBinary(buffer.data(), buffer.size()));
+  for (size_t i = 0; i < original.numVertices(); ++i) {
+    original.setPos(i, Eigen::Vector3f::Constant(i));
+    buffer.clear();
+    original.takeChangesToBinary(buffer);
+    ASSERT_TRUE(result.applyChangesFromBinary(buffer.data(), buffer.size()));
+  }
+
+  EXPECT_EQ(result, original);
+}
+
+TEST(MeshSerialization, MeshChangesRejectOtherStreams) {
+  // both meshes start at version 0, so only the stream id tells them apart
+  Mesh original;
+  original.resizeVertices(2);
+  Mesh fresh;
+  EXPECT_NE(fresh.streamId(), original.streamId());
+  EXPECT_EQ(fresh.version(), original.baseVersion());
+
+  std::vector<uint8_t> buffer;
+  original.serializeChangesToBinary(buffer);
+  EXPECT_FALSE(fresh.applyChangesFromBinary(buffer.data(), buffer.size()));
+  EXPECT_EQ(fresh.numVertices(), 0u);
+
+  // a full message switches the receiver to the stream of the sender
+  buffer.clear();
+  original.takeChangesToBinary(buffer, true);
+  ASSERT_TRUE(fresh.applyChangesFromBinary(buffer.data(), buffer.size()));
+  EXPECT_EQ(fresh.streamId(), original.streamId());
+
+  original.setPos(1, Eigen::Vector3f::Ones());
+  buffer.clear();
+  original.takeChangesToBinary(buffer);
+  ASSERT_TRUE(fresh.applyChangesFromBinary(buffer.data(), buffer.size()));
+  EXPECT_EQ(fresh, original);
+
+  // a new sender at the same version is rejected
+  Mesh other;
+  other.resizeVertices(2);
+  other.setPos(1, Eigen::Vector3f::Ones());
+  other.clearChanges();
+  ASSERT_EQ(other.version(), fresh.version());
+  other.setPos(0, Eigen::Vector3f::Ones());
+  buffer.clear();
+  other.serializeChangesToBinary(buffer);
+  EXPECT_FALSE(fresh.applyChangesFromBinary(buffer.data(), buffer.size()));
+  EXPECT_EQ(fresh, original);
+}
+
+TEST(MeshSerialization, MalformedMeshChangesLeaveMeshUnchanged) {
+  Mesh original;
+  original.resizeVertices(4);
+  original.appendFaces({{{0, 1, 2}}});
+  std::vector<uint8_t> buffer;
+  original.takeChangesToBinary(buffer, true);
+
+  Mesh result;
+  ASSERT_TRUE(result.applyChangesFromBinary(buffer.data(), buffer.size()));
+
+  // the size shrinks while the truncated face ranges are missing
+  original.resizeVertices(8);
+  original.setPos(7, Eigen::Vector3f::Ones());
+  original.appendFaces({{{4, 5, 6}}});
+  buffer.clear();
+  original.serializeChangesToBinary(buffer);
+  const Mesh expected = result;
+  EXPECT_ANY_THROW(result.applyChangesFromBinary(buffer.data(), buffer.size() - 8));
+  EXPECT_EQ(result, expected);
+  EXPECT_EQ(result.version(), expected.version());
+
+  // the intact message still applies afterwards
+  ASSERT_TRUE(result.applyChangesFromBinary(buffer.data(), buffer.size()));
+  EXPECT_EQ(result, original);
+}
+
+TEST(MeshSerialization, CompressedBinaryErrorBound) {
+  Mesh mesh(true, true, true, true);
+  std::mt19937 gen(5);
+  std::uniform_real_distribution<float> pos_dist(-50.0f, 50.0f);
+  std::uniform_int_distribution<int> byte_dist(0, 255);
+  std::uniform_int_distribution<size_t> index_dist(0, 9999);
+  for (size_t i = 0; i < 10000; ++i) {
+    mesh.points.emplace_back(pos_dist(gen), pos_dist(gen), pos_dist(gen));
+    mesh.colors.emplace_back(byte_dist(gen), byte_dist(gen), byte_dist(gen));
+    mesh.stamps.push_back(1700000000000000000u + 1000 * index_dist(gen));
+    mesh.first_seen_stamps.push_back(1700000000000000000u + i);
+    mesh.labels.push_back(index_dist(gen) % 20);
+  }
+  for (size_t i = 0; i < 20000; ++i) {
+    mesh.faces.push_back({{index_dist(gen), index_dist(gen), index_dist(gen)}});
+  }
+
+  for (const float resolution : {0.001f, 0.01f}) {
+    std::vector<uint8_t> buffer;
+    mesh.serializeToCompressedBinary(buffer, resolution);
+    const auto result =
+        Mesh::deserializeFromCompressedBinary(buffer.data(), buffer.size());
+    ASSERT_TRUE(result);
+
+    // everything but the positions is lossless
+    EXPECT_EQ(result->has_first_seen_stamps, mesh.has_first_seen_stamps);
+    EXPECT_EQ(result->colors, mesh.colors);
+    EXPECT_EQ(result->stamps, mesh.stamps);
+    EXPECT_EQ(result->first_seen_stamps, mesh.first_seen_stamps);
+    EXPECT_EQ(result->labels, mesh.labels);
+    EXPECT_EQ(result->faces, mesh.faces);
+
+    // allow for float rounding at the scale of the mesh on top of the quantization
+    ASSERT_EQ(result->points.size(), mesh.points.size());
+    float max_error = 0.0f;
+    for (size_t i = 0; i < mesh.points.size(); ++i) {
+      const float error = (result->points[i] - mesh.points[i]).cwiseAbs().maxCoeff();
+      max_error = std::max(max_error, error);
+    }
+    EXPECT_LE(max_error, 0.5f * resolution + 1.0e-5f);
+  }
+
+  std::vector<uint8_t> raw;
+  mesh.serializeToBinary(raw);
+  std::vector<uint8_t> compressed;
+  mesh.serializeToCompressedBinary(compressed);
+  EXPECT_LT(compressed.size(), raw.size() / 2);
+}
+
+TEST(MeshSerialization, CompressedBinaryInvalid) {
+  Mesh empty(false, false, false);
+  std::vector<uint8_t> buffer;
+  empty.serializeToCompressedBinary(buffer);
+  auto result = Mesh::deserializeFromCompressedBinary(buffer.data(), buffer.size());
+  ASSERT_TRUE(result);
+  EXPECT_EQ(*result, empty);
+
+  Mesh mesh;
+  mesh.resizeVertices(3);
+  mesh.faces.push_back({{0, 1, 2}});
+  buffer.clear();
+  mesh.serializeToCompressedBinary(buffer);
+  EXPECT_THROW(Mesh::deserializeFromCompressedBinary(buffer.data(), buffer.size() - 1),
+               std::runtime_error);
+  buffer[0] = 0;
+  EXPECT_THROW(Mesh::deserializeFromCompressedBinary(buffer.data(), buffer.size()),
+               std::runtime_error);
+  EXPECT_THROW(mesh.serializeToCompressedBinary(buffer, 0.0f), std::invalid_argument);
+}
+
 }  // namespace spark_dsg
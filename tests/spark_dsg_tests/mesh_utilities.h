@@ -0,0 +1,71 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <spark_dsg/mesh.h>
+
+namespace spark_dsg {
+namespace test {
+
+/**
+ * @brief Triangulated grid on the z = 0 plane with vertices every 0.5 meters
+ *
+ * Vertex colors encode the row and column, timestamps the vertex index and labels
+ * whether the vertex is in the left (1) or right (2) half of the grid.
+ */
+inline Mesh createGridMesh(size_t num_rows, size_t num_cols, float y_offset = 0.0f) {
+  Mesh mesh(true, true, true, true);
+  for (size_t r = 0; r < num_rows; ++r) {
+    for (size_t c = 0; c < num_cols; ++c) {
+      mesh.points.emplace_back(0.5f * c, 0.5f * r + y_offset, 0.0f);
+      mesh.colors.emplace_back(10 * r, 10 * c, 0);
+      mesh.stamps.push_back(r * num_cols + c);
+      mesh.first_seen_stamps.push_back(r * num_cols + c);
+      mesh.labels.push_back(c < num_cols / 2 ? 1 : 2);
+    }
+  }
+
+  for (size_t r = 0; r + 1 < num_rows; ++r) {
+    for (size_t c = 0; c + 1 < num_cols; ++c) {
+      const size_t i = r * num_cols + c;
+      mesh.faces.push_back({{i, i + 1, i + num_cols}});
+      mesh.faces.push_back({{i + 1, i + num_cols + 1, i + num_cols}});
+    }
+  }
+
+  return mesh;
+}
+
+}  // namespace test
+}  // namespace spark_dsg
@@ -172,6 +172,32 @@ TEST_P(AdjacencyMatrixFixture, LaplacianCorrect) {
   EXPECT_EQ(L, dense_L);
 }
 
+TEST_P(AdjacencyMatrixFixture, BuilderMatchesExpected) {
+  AdjacencyMatrixTestConfig config = GetParam();
+
+  std::vector<NodeId> ordering(config.ordering.size());
+  for (const auto& [node, index] : config.ordering) {
+    ordering[index] = node;
+  }
+
+  const SparseMatrixBuilder builder(layer, ordering);
+  ASSERT_EQ(builder.size(), ordering.size());
+  EXPECT_EQ(builder.nodes(), ordering);
+
+  const auto weight = config.weighted ? EdgeWeight::ATTRIBUTE : EdgeWeight::UNIT;
+  const auto weight_func = [&](const NodeId source, const NodeId target) {
+    return config.weighted ? layer.getEdge(source, target).info->weight : 1.0;
+  };
+
+  const Eigen::MatrixXd A = getAdjacencyMatrix(layer, config.ordering, weight_func);
+  EXPECT_EQ(A, Eigen::MatrixXd(builder.adjacency(weight)));
+  EXPECT_EQ(A, Eigen::MatrixXd(builder.adjacency(weight_func)));
+
+  const Eigen::MatrixXd L = getLaplacian(layer, config.ordering, weight_func);
+  EXPECT_TRUE(L.isApprox(Eigen::MatrixXd(builder.laplacian(weight))));
+  EXPECT_TRUE(L.isApprox(Eigen::MatrixXd(builder.laplacian(weight_func))));
+}
+
 // note that the diagonal entries are the degrees (so the same test can cover the
 // laplacians)
 const AdjacencyMatrixTestConfig adjacency_test_cases[] = {
@@ -189,4 +215,74 @@ INSTANTIATE_TEST_SUITE_P(MatrixMethodsMatchExpected,
                          AdjacencyMatrixFixture,
                          testing::ValuesIn(adjacency_test_cases));
 
+TEST(SparseMatrixBuilderTests, LargeLayerMatchesTriplets) {
+  // chain with extra chords so that columns span several assembly blocks
+  IsolatedSceneGraphLayer layer(1);
+  const size_t num_nodes = 5000;
+  for (size_t i = 0; i < num_nodes; ++i) {
+    layer.emplaceNode(i, std::make_unique<NodeAttributes>());
+  }
+
+  for (size_t i = 0; i + 1 < num_nodes; ++i) {
+    layer.insertEdge(i, i + 1, std::make_unique<EdgeAttributes>(0.5 + i % 3));
+    if (i % 7 == 0 && i + 1500 < num_nodes) {
+      layer.insertEdge(i, i + 1500);  // unweighted edge
+    }
+  }
+
+  std::map<NodeId, size_t> ordering;
+  for (size_t i = 0; i < num_nodes; ++i) {
+    ordering[i] = i;
+  }
+
+  const auto weight_func = [&](NodeId source, NodeId target) {
+    const auto& info = *layer.getEdge(source, target).info;
+    return info.weighted ? info.weight : 1.0;
+  };
+
+  const SparseMatrixXd expected_A =
+      getSparseAdjacencyMatrix(layer, ordering, weight_func);
+  const SparseMatrixXd expected_L = getSparseLaplacian(layer, ordering, weight_func);
+
+  for (const size_t num_threads : {1, 4}) {
+    const SparseMatrixBuilder builder(layer, num_threads);
+    const SparseMatrixXd A = builder.adjacency(EdgeWeight::ATTRIBUTE);
+    const SparseMatrixXd L = builder.laplacian(EdgeWeight::ATTRIBUTE);
+    EXPECT_TRUE(A.isCompressed());
+    EXPECT_EQ(A.nonZeros(), expected_A.nonZeros());
+    EXPECT_EQ(L.nonZeros(), expected_L.nonZeros());
+    EXPECT_NEAR((A - expected_A).norm(), 0.0, 1.0e-9);
+    EXPECT_NEAR((L - expected_L).norm(), 0.0, 1.0e-9);
+  }
+}
+
+TEST(SparseMatrixBuilderTests, UpdateAfterLayerChanges) {
+  IsolatedSceneGraphLayer layer(1);
+  for (size_t i = 0; i < 4; ++i) {
+    layer.emplaceNode(i, std::make_unique<NodeAttributes>());
+  }
+  layer.insertEdge(0, 1);
+  layer.insertEdge(1, 2);
+
+  SparseMatrixBuilder builder(layer);
+  EXPECT_EQ(builder.adjacency().nonZeros(), 4);
+  EXPECT_EQ(builder.index(3), 3u);
+  EXPECT_THROW(builder.index(4), std::out_of_range);
+
+  layer.removeNode(0);
+  layer.emplaceNode(4, std::make_unique<NodeAttributes>());
+  layer.insertEdge(3, 4);
+  builder.update();
+
+  EXPECT_EQ(builder.nodes(), std::vector<NodeId>({1, 2, 3, 4}));
+  EXPECT_FALSE(builder.hasNode(0));
+  const Eigen::MatrixXd L(builder.laplacian());
+  Eigen::MatrixXd expected(4, 4);
+  expected << 1, -1, 0, 0, -1, 1, 0, 0, 0, 0, 1, -1, 0, 0, -1, 1;
+  EXPECT_EQ(L, expected);
+
+  EXPECT_THROW(SparseMatrixBuilder(layer, std::vector<NodeId>{1, 1}),
+               std::invalid_argument);
+}
+
 }  // namespace spark_dsg
@@ -0,0 +1,142 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+
+#include <limits>
+
+#include "spark_dsg/blocked_mesh.h"
+#include "spark_dsg_tests/mesh_utilities.h"
+
+namespace spark_dsg {
+
+using test::createGridMesh;
+
+TEST(BlockedMeshTests, RoundTrip) {
+  const auto mesh = createGridMesh(10, 10);
+  const auto blocked = BlockedMesh::fromMesh(mesh, 1.0f);
+  EXPECT_EQ(blocked.numBlocks(), 25u);
+  EXPECT_TRUE(blocked.hasBlock(BlockedMesh::BlockIndex(4, 4, 0)));
+  EXPECT_FALSE(blocked.hasBlock(BlockedMesh::BlockIndex(5, 4, 0)));
+  EXPECT_THROW(blocked.block(BlockedMesh::BlockIndex(5, 4, 0)), std::out_of_range);
+
+  // every block owns the 2x2 vertices inside it and is self-contained
+  size_t num_faces = 0;
+  for (const auto& index : blocked.blockIndices()) {
+    const auto& block = blocked.block(index);
+    EXPECT_EQ(block.num_owned, 4u);
+    EXPECT_EQ(block.mesh.numVertices(), block.vertex_indices.size());
+    EXPECT_EQ(block.mesh.numFaces(), block.face_indices.size());
+    for (const auto& face : block.mesh.faces) {
+      for (const auto vertex : face) {
+        EXPECT_LT(vertex, block.mesh.numVertices());
+      }
+    }
+    num_faces += block.mesh.numFaces();
+  }
+
+  EXPECT_EQ(num_faces, mesh.numFaces());
+  EXPECT_EQ(blocked.toMesh(), mesh);
+
+  // vertices without a finite position can't be assigned to a block
+  auto invalid = mesh;
+  invalid.points[5].x() = std::numeric_limits<float>::quiet_NaN();
+  EXPECT_THROW(BlockedMesh::fromMesh(invalid, 1.0f), std::invalid_argument);
+}
+
+TEST(BlockedMeshTests, Culling) {
+  const auto mesh = createGridMesh(10, 10);
+  const auto blocked = BlockedMesh::fromMesh(mesh, 1.0f);
+
+  // block bounds include copied vertices, so neighboring blocks may intersect too
+  const Eigen::AlignedBox3f box(Eigen::Vector3f(0.1f, 0.1f, -1.0f),
+                                Eigen::Vector3f(0.4f, 0.4f, 1.0f));
+  const auto blocks = blocked.blocksIntersecting(box);
+  ASSERT_EQ(blocks.size(), 1u);
+  EXPECT_EQ(blocks[0], BlockedMesh::BlockIndex(0, 0, 0));
+
+  const auto region = blocked.extract(blocks);
+  const auto& block = blocked.block(blocks[0]);
+  EXPECT_EQ(region.numVertices(), block.mesh.numVertices());
+  EXPECT_EQ(region.numFaces(), block.mesh.numFaces());
+  for (const auto& face : region.faces) {
+    for (const auto vertex : face) {
+      EXPECT_LT(vertex, region.numVertices());
+    }
+  }
+
+  const Eigen::AlignedBox3f far(Eigen::Vector3f::Constant(10.0f),
+                                Eigen::Vector3f::Constant(11.0f));
+  EXPECT_TRUE(blocked.blocksIntersecting(far).empty());
+  EXPECT_TRUE(blocked.extract({}).empty());
+
+  // vertex 0 is in block (0, 0, 0) and vertex 99 is in block (4, 4, 0)
+  const BlockedMesh::BlockIndices expected{{0, 0, 0}, {4, 4, 0}};
+  EXPECT_EQ(blocked.blocksForVertices({99, 0, 1, 1000}), expected);
+}
+
+TEST(BlockedMeshTests, BlockSerialization) {
+  const auto mesh = createGridMesh(10, 10);
+  const auto blocked = BlockedMesh::fromMesh(mesh, 1.0f);
+
+  BlockedMesh loaded(1.0f, true, true, true, true);
+  for (const auto& index : blocked.blockIndices()) {
+    std::vector<uint8_t> buffer;
+    blocked.serializeBlock(index, buffer);
+    EXPECT_EQ(loaded.insertBlockFromBinary(buffer.data(), buffer.size()), index);
+  }
+
+  EXPECT_EQ(loaded.numBlocks(), blocked.numBlocks());
+  EXPECT_EQ(loaded.toMesh(), mesh);
+  EXPECT_EQ(loaded.blocksForVertices({99}), blocked.blocksForVertices({99}));
+
+  EXPECT_TRUE(loaded.eraseBlock(BlockedMesh::BlockIndex(4, 4, 0)));
+  EXPECT_FALSE(loaded.eraseBlock(BlockedMesh::BlockIndex(4, 4, 0)));
+  EXPECT_TRUE(loaded.blocksForVertices({99}).empty());
+  EXPECT_EQ(loaded.blocksForVertices({0}), blocked.blocksForVertices({0}));
+
+  // re-inserted blocks own their vertices again
+  loaded.insertBlock(blocked.block(BlockedMesh::BlockIndex(4, 4, 0)));
+  EXPECT_EQ(loaded.blocksForVertices({0, 99}), blocked.blocksForVertices({0, 99}));
+  loaded.insertBlock(blocked.block(BlockedMesh::BlockIndex(0, 0, 0)));
+  EXPECT_EQ(loaded.toMesh(), mesh);
+
+  std::vector<uint8_t> buffer;
+  blocked.serializeBlock(BlockedMesh::BlockIndex(0, 0, 0), buffer);
+  BlockedMesh other(0.5f);
+  EXPECT_THROW(other.insertBlockFromBinary(buffer.data(), buffer.size()),
+               std::invalid_argument);
+}
+
+}  // namespace spark_dsg
@@ -36,6 +36,7 @@
 #include <spark_dsg/bounding_box_extraction.h>
 
 #include <Eigen/Geometry>
+#include <random>
 
 namespace spark_dsg {
 
@@ -109,7 +110,7 @@ TEST(BoundingBoxExtractionTests, ConvexHull) {
   };
 
   const auto hull = bounding_box::get2dConvexHull(adaptor);
-  std::list<size_t> expected{8, 0, 6, 4};
+  std::vector<size_t> expected{8, 0, 6, 4};
   EXPECT_EQ(hull, expected);
 }
 
@@ -201,6 +202,103 @@ TEST(BoundingBoxExtractionTests, RAABBFromPointsNonTrivial) {
   EXPECT_NEAR(0.0f, getRotationError(expected_rotation, box), 1.0e-6) << box;
 }
 
+TEST(BoundingBoxExtractionTests, RAABBMatchesBruteForce) {
+  std::mt19937 gen(3);
+  std::normal_distribution<float> dist(0.0f, 2.0f);
+  for (const size_t num_points : {3u, 10u, 1000u}) {
+    TestAdaptor adaptor;
+    for (size_t i = 0; i < num_points; ++i) {
+      adaptor.points.push_back({dist(gen), 0.3f * dist(gen), dist(gen)});
+    }
+
+    // every point is on the left of (or on) every ccw hull edge
+    const auto hull = bounding_box::get2dConvexHull(adaptor);
+    ASSERT_GE(hull.size(), 3u);
+    for (size_t i = 0; i < hull.size(); ++i) {
+      const Eigen::Vector2f x_c = adaptor[hull[i]].head<2>();
+      const Eigen::Vector2f edge = adaptor[hull[(i + 1) % hull.size()]].head<2>() - x_c;
+      for (size_t j = 0; j < num_points; ++j) {
+        const Eigen::Vector2f v = adaptor[j].head<2>() - x_c;
+        EXPECT_GE(edge.x() * v.y() - edge.y() * v.x(), -1.0e-4f);
+      }
+    }
+
+    // minimum area over rectangles aligned with each hull edge
+    float min_area = std::numeric_limits<float>::max();
+    for (size_t i = 0; i < hull.size(); ++i) {
+      const Eigen::Vector2f x_c = adaptor[hull[i]].head<2>();
+      const Eigen::Vector2f u =
+          (adaptor[hull[(i + 1) % hull.size()]].head<2>() - x_c).normalized();
+      const Eigen::Vector2f n(-u.y(), u.x());
+      Eigen::Vector2f min = Eigen::Vector2f::Zero();
+      Eigen::Vector2f max = Eigen::Vector2f::Zero();
+      for (size_t j = 0; j < num_points; ++j) {
+        const Eigen::Vector2f v = adaptor[j].head<2>() - x_c;
+        const Eigen::Vector2f proj(u.dot(v), n.dot(v));
+        min = min.cwiseMin(proj);
+        max = max.cwiseMax(proj);
+      }
+      min_area = std::min(min_area, (max - min).prod());
+    }
+
+    const auto box = bounding_box::extract(adaptor, BoundingBox::Type::RAABB);
+    EXPECT_NEAR(box.dimensions.x() * box.dimensions.y(), min_area, 1.0e-3f * min_area);
+  }
+}
+
+TEST(BoundingBoxExtractionTests, ContiguousMatchesAdaptor) {
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<float> dist(-5.0f, 5.0f);
+  for (const size_t num_points : {1u, 3u, 4u, 7u, 101u}) {
+    std::vector<Eigen::Vector3f> points;
+    TestAdaptor adaptor;
+    for (size_t i = 0; i < num_points; ++i) {
+      const Eigen::Vector3f point(dist(gen), dist(gen), dist(gen));
+      points.push_back(point);
+      adaptor.points.push_back({point.x(), point.y(), point.z()});
+    }
+
+    for (const auto type : {BoundingBox::Type::AABB, BoundingBox::Type::RAABB}) {
+      if (type == BoundingBox::Type::RAABB && num_points < 3) {
+        continue;  // no well-defined yaw
+      }
+
+      const auto expected = bounding_box::extract(adaptor, type);
+      const auto result = bounding_box::extract(points.data(), points.size(), type);
+      EXPECT_EQ(result, expected) << "num_points: " << num_points;
+    }
+  }
+}
+
+TEST(BoundingBoxExtractionTests, IndexedMatchesAdaptor) {
+  Mesh mesh;
+  std::mt19937 gen(7);
+  std::uniform_real_distribution<float> dist(-5.0f, 5.0f);
+  mesh.resizeVertices(50);
+  for (size_t i = 0; i < mesh.numVertices(); ++i) {
+    mesh.setPos(i, Eigen::Vector3f(dist(gen), dist(gen), dist(gen)));
+  }
+
+  const std::vector<size_t> indices{3, 9, 10, 11, 20, 21, 40, 49};
+  TestAdaptor adaptor;
+  for (const auto index : indices) {
+    const auto& pos = mesh.pos(index);
+    adaptor.points.push_back({pos.x(), pos.y(), pos.z()});
+  }
+
+  for (const auto type : {BoundingBox::Type::AABB, BoundingBox::Type::RAABB}) {
+    const auto expected = bounding_box::extract(adaptor, type);
+    EXPECT_EQ(bounding_box::extract(mesh, indices, type), expected);
+    // mesh adaptors are dispatched to the same path
+    EXPECT_EQ(bounding_box::extract(BoundingBox::MeshAdaptor(mesh, &indices), type),
+              expected);
+  }
+
+  EXPECT_EQ(bounding_box::extract(mesh), BoundingBox(mesh));
+  EXPECT_FALSE(bounding_box::extract(mesh, std::vector<size_t>()).isValid());
+  EXPECT_THROW(bounding_box::extract(mesh, {1, 50}), std::out_of_range);
+}
+
 /*
 TEST(BoundingBoxTests, PCLConstructorOBB) {
   // tolerance is low because PCL OBB is not very accurate
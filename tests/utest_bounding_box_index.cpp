@@ -0,0 +1,218 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <spark_dsg/bounding_box_index.h>
+#include <spark_dsg/dynamic_scene_graph.h>
+#include <spark_dsg/node_attributes.h>
+
+#include <cmath>
+#include <map>
+#include <random>
+
+namespace spark_dsg {
+
+namespace {
+
+using Boxes = std::map<NodeId, BoundingBox>;
+using NodePairs = std::vector<BoundingBoxIndex::NodePair>;
+
+BoundingBox randomBox(std::mt19937& gen, float extent) {
+  std::uniform_real_distribution<float> center(-extent, extent);
+  std::uniform_real_distribution<float> size(0.2f, 2.0f);
+  return BoundingBox(Eigen::Vector3f(size(gen), size(gen), size(gen)),
+                     Eigen::Vector3f(center(gen), center(gen), center(gen)));
+}
+
+Boxes randomBoxes(size_t num_boxes, float extent, size_t seed) {
+  std::mt19937 gen(seed);
+  Boxes boxes;
+  for (size_t i = 0; i < num_boxes; ++i) {
+    boxes[i] = randomBox(gen, extent);
+  }
+  return boxes;
+}
+
+NodePairs bruteOverlaps(const Boxes& boxes, float min_iou) {
+  NodePairs result;
+  for (auto first = boxes.begin(); first != boxes.end(); ++first) {
+    for (auto second = std::next(first); second != boxes.end(); ++second) {
+      if (first->second.intersects(second->second) &&
+          first->second.computeIoU(second->second) >= min_iou) {
+        result.emplace_back(first->first, second->first);
+      }
+    }
+  }
+  return result;
+}
+
+std::vector<NodeId> bruteIntersecting(const Boxes& boxes, const BoundingBox& query) {
+  std::vector<NodeId> result;
+  for (const auto& [node, box] : boxes) {
+    if (box.intersects(query)) {
+      result.push_back(node);
+    }
+  }
+  return result;
+}
+
+std::vector<NodeId> bruteContaining(const Boxes& boxes, const Eigen::Vector3f& point) {
+  std::vector<NodeId> result;
+  for (const auto& [node, box] : boxes) {
+    if (box.contains(point)) {
+      result.push_back(node);
+    }
+  }
+  return result;
+}
+
+void checkQueries(const BoundingBoxIndex& index, const Boxes& boxes, size_t seed) {
+  std::mt19937 gen(seed);
+  for (size_t i = 0; i < 20; ++i) {
+    const auto query = randomBox(gen, 10.0f);
+    EXPECT_EQ(index.intersecting(query), bruteIntersecting(boxes, query));
+    EXPECT_EQ(index.containing(query.world_P_center),
+              bruteContaining(boxes, query.world_P_center));
+  }
+
+  EXPECT_EQ(index.overlappingPairs(), bruteOverlaps(boxes, 0.0f));
+  EXPECT_EQ(index.overlappingPairs(0.3f), bruteOverlaps(boxes, 0.3f));
+}
+
+}  // namespace
+
+TEST(BoundingBoxIndexTests, QueriesMatchBruteForce) {
+  auto boxes = randomBoxes(400, 10.0f, 1);
+  BoundingBoxIndex index;
+  for (const auto& [node, box] : boxes) {
+    index.insert(node, box);
+  }
+
+  EXPECT_EQ(index.size(), boxes.size());
+  checkQueries(index, boxes, 2);
+
+  // balanced rebuild gives the same answers
+  index.rebuild();
+  EXPECT_LE(index.height(), 10u);
+  checkQueries(index, boxes, 3);
+}
+
+TEST(BoundingBoxIndexTests, IncrementalUpdates) {
+  auto boxes = randomBoxes(300, 8.0f, 4);
+  BoundingBoxIndex index;
+  for (const auto& [node, box] : boxes) {
+    index.insert(node, box);
+  }
+
+  std::mt19937 gen(5);
+  for (NodeId node = 0; node < 300; node += 3) {
+    boxes[node] = randomBox(gen, 8.0f);
+    index.insert(node, boxes[node]);
+  }
+
+  for (NodeId node = 1; node < 300; node += 5) {
+    boxes.erase(node);
+    EXPECT_TRUE(index.erase(node));
+  }
+
+  EXPECT_FALSE(index.erase(1));
+  EXPECT_EQ(index.size(), boxes.size());
+  checkQueries(index, boxes, 6);
+
+  // invalid boxes are dropped from the index
+  index.insert(0, BoundingBox());
+  boxes.erase(0);
+  EXPECT_FALSE(index.contains(0));
+  checkQueries(index, boxes, 7);
+
+  index.clear();
+  EXPECT_EQ(index.size(), 0u);
+  EXPECT_EQ(index.height(), 0u);
+  EXPECT_TRUE(index.overlappingPairs().empty());
+}
+
+TEST(BoundingBoxIndexTests, ContainingIsExactForRotatedBoxes) {
+  BoundingBoxIndex index;
+  // thin box rotated by 45 degrees about z
+  const BoundingBox rotated(
+      Eigen::Vector3f(4.0f, 0.2f, 1.0f), Eigen::Vector3f::Zero(), M_PI / 4);
+  index.insert(1, rotated);
+  index.insert(2, BoundingBox(Eigen::Vector3f::Ones(), Eigen::Vector3f(1, 1, 0)));
+
+  EXPECT_EQ(index.containing(Eigen::Vector3f(1.0f, 1.0f, 0.0f)),
+            std::vector<NodeId>({1, 2}));
+  // inside the axis-aligned extents of the rotated box, but not the box itself
+  EXPECT_TRUE(index.containing(Eigen::Vector3f(1.0f, -1.0f, 0.0f)).empty());
+  EXPECT_EQ(index.containing(Eigen::Vector3d(-1.0, -1.0, 0.0)),
+            std::vector<NodeId>({1}));
+}
+
+TEST(BoundingBoxIndexTests, LayerIndexTracksNodes) {
+  DynamicSceneGraph graph;
+  const auto make_attrs = [](const Eigen::Vector3f& center) {
+    auto attrs = std::make_unique<ObjectNodeAttributes>();
+    attrs->position = center.cast<double>();
+    attrs->bounding_box = BoundingBox(Eigen::Vector3f::Constant(2.0f), center);
+    return attrs;
+  };
+
+  graph.emplaceNode(DsgLayers::OBJECTS, "O0"_id, make_attrs(Eigen::Vector3f::Zero()));
+  graph.emplaceNode(DsgLayers::OBJECTS, "O1"_id, make_attrs(Eigen::Vector3f(1, 0, 0)));
+  // nodes without bounding boxes are ignored
+  graph.emplaceNode(DsgLayers::OBJECTS, "O2"_id, std::make_unique<NodeAttributes>());
+
+  const auto& layer = graph.getLayer(DsgLayers::OBJECTS);
+  const auto& index = layer.boundingBoxIndex();
+  EXPECT_EQ(index.size(), 2u);
+  EXPECT_EQ(index.overlappingPairs(0.3f), NodePairs({{"O0"_id, "O1"_id}}));
+
+  graph.emplaceNode(DsgLayers::OBJECTS, "O3"_id, make_attrs(Eigen::Vector3f(0, 1, 0)));
+  EXPECT_EQ(index.containing(Eigen::Vector3f(0.0f, 1.5f, 0.0f)),
+            std::vector<NodeId>({"O3"_id}));
+
+  graph.setNodeAttributes("O1"_id, make_attrs(Eigen::Vector3f(10, 0, 0)));
+  EXPECT_EQ(index.overlappingPairs(0.3f), NodePairs({{"O0"_id, "O3"_id}}));
+
+  // in-place modifications need to be reported
+  auto& attrs = layer.getNode("O3"_id).attributes<SemanticNodeAttributes>();
+  attrs.bounding_box.world_P_center = Eigen::Vector3f(10, 1, 0);
+  layer.refreshBoundingBox("O3"_id);
+  EXPECT_EQ(index.overlappingPairs(0.3f), NodePairs({{"O1"_id, "O3"_id}}));
+
+  graph.removeNode("O1"_id);
+  EXPECT_EQ(index.size(), 2u);
+  EXPECT_TRUE(index.overlappingPairs().empty());
+}
+
+}  // namespace spark_dsg
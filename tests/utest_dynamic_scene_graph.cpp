@@ -1036,4 +1036,22 @@ TEST(DynamicSceneGraphTests, CloneCorrect) {
   EXPECT_TRUE(clone->hasEdge("a0"_id, "a1"_id));
 }
 
+// Test that the mesh is only deep-copied when requested
+TEST(DynamicSceneGraphTests, CloneWithoutMesh) {
+  DynamicSceneGraph graph;
+  graph.emplaceNode(2, "x0"_id, std::make_unique<NodeAttributes>());
+  auto mesh = std::make_shared<Mesh>();
+  mesh->resizeVertices(3);
+  graph.setMesh(mesh);
+
+  auto with_mesh = graph.clone();
+  ASSERT_TRUE(with_mesh->mesh() != nullptr);
+  EXPECT_NE(with_mesh->mesh(), mesh);
+  EXPECT_EQ(with_mesh->mesh()->numVertices(), 3u);
+
+  auto without_mesh = graph.clone(false);
+  EXPECT_TRUE(without_mesh->hasNode("x0"_id));
+  EXPECT_TRUE(without_mesh->mesh() == nullptr);
+}
+
 }  // namespace spark_dsg
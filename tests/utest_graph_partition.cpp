@@ -0,0 +1,195 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <spark_dsg/dynamic_scene_graph.h>
+#include <spark_dsg/graph_partition.h>
+
+#include <algorithm>
+#include <set>
+
+namespace spark_dsg {
+
+namespace {
+
+void fillGrid(IsolatedSceneGraphLayer& layer, size_t rows, size_t cols) {
+  for (size_t r = 0; r < rows; ++r) {
+    for (size_t c = 0; c < cols; ++c) {
+      layer.emplaceNode(r * cols + c,
+                        std::make_unique<NodeAttributes>(Eigen::Vector3d(c, r, 0.0)));
+      if (c > 0) {
+        layer.insertEdge(r * cols + c - 1, r * cols + c);
+      }
+      if (r > 0) {
+        layer.insertEdge((r - 1) * cols + c, r * cols + c);
+      }
+    }
+  }
+}
+
+void checkConsistent(const SceneGraphLayer& layer, const GraphPartition& partition) {
+  ASSERT_EQ(partition.assignments.size(), layer.numNodes());
+
+  size_t edge_cut = 0;
+  for (const auto& id_edge_pair : layer.edges()) {
+    const auto& edge = id_edge_pair.second;
+    if (partition.part(edge.source) != partition.part(edge.target)) {
+      ++edge_cut;
+    }
+  }
+  EXPECT_EQ(partition.edge_cut, edge_cut);
+
+  for (size_t p = 0; p < partition.numParts(); ++p) {
+    const auto& part = partition.parts[p];
+    EXPECT_TRUE(std::is_sorted(part.begin(), part.end()));
+
+    std::set<NodeId> expected_boundary;
+    std::set<NodeId> expected_halo;
+    for (const auto node : part) {
+      EXPECT_EQ(partition.part(node), p);
+      for (const auto sibling : layer.getNode(node).siblings()) {
+        if (partition.part(sibling) != p) {
+          expected_boundary.insert(node);
+          expected_halo.insert(sibling);
+        }
+      }
+    }
+
+    EXPECT_EQ(partition.boundary[p],
+              std::vector<NodeId>(expected_boundary.begin(), expected_boundary.end()));
+    EXPECT_EQ(partition.halo[p],
+              std::vector<NodeId>(expected_halo.begin(), expected_halo.end()));
+  }
+}
+
+}  // namespace
+
+TEST(GraphPartitionTests, SpatialPartitionBalanced) {
+  IsolatedSceneGraphLayer layer(1);
+  fillGrid(layer, 20, 30);
+
+  for (const size_t num_parts : {1, 2, 3, 4, 7}) {
+    PartitionConfig config;
+    config.num_parts = num_parts;
+    const auto partition = partitionLayer(layer, config);
+    ASSERT_EQ(partition.numParts(), num_parts);
+    checkConsistent(layer, partition);
+
+    const double average = 600.0 / num_parts;
+    for (const auto& part : partition.parts) {
+      EXPECT_LE(part.size(), std::ceil(average * 1.05));
+      EXPECT_GE(part.size(), std::floor(average * 0.95));
+    }
+  }
+
+  // a straight cut through the short side of the grid
+  PartitionConfig config;
+  config.num_parts = 2;
+  EXPECT_EQ(partitionLayer(layer, config).edge_cut, 20u);
+}
+
+TEST(GraphPartitionTests, RefinementReducesCut) {
+  // two cliques joined by a single edge, where the last node of the first clique is
+  // placed past the second clique (so the spatial split separates it from its clique)
+  IsolatedSceneGraphLayer layer(1);
+  for (size_t i = 0; i < 20; ++i) {
+    const double x = i == 9 ? 10.0 : (i < 10 ? 0.1 * i : 5.0 + 0.1 * (i - 10));
+    layer.emplaceNode(i, std::make_unique<NodeAttributes>(Eigen::Vector3d(x, 0, 0)));
+    for (size_t j = (i / 10) * 10; j < i; ++j) {
+      layer.insertEdge(j, i);
+    }
+  }
+  layer.insertEdge(0, 10);
+
+  PartitionConfig config;
+  config.refinement_passes = 0;
+  const auto initial = partitionLayer(layer, config);
+  checkConsistent(layer, initial);
+  EXPECT_EQ(initial.edge_cut, 18u);
+
+  config.refinement_passes = 4;
+  config.balance_tolerance = 0.1;
+  const auto refined = partitionLayer(layer, config);
+  checkConsistent(layer, refined);
+  EXPECT_EQ(refined.edge_cut, 1u);
+  EXPECT_EQ(refined.parts[0].size(), 10u);
+  EXPECT_EQ(refined.parts[1].size(), 10u);
+}
+
+TEST(GraphPartitionTests, PartitionByParent) {
+  DynamicSceneGraph graph;
+  for (size_t i = 0; i < 3; ++i) {
+    graph.emplaceNode(
+        DsgLayers::ROOMS, NodeSymbol('R', i), std::make_unique<NodeAttributes>());
+  }
+
+  // chain of places where only some places have a room
+  for (size_t i = 0; i < 10; ++i) {
+    graph.emplaceNode(
+        DsgLayers::PLACES, NodeSymbol('p', i), std::make_unique<NodeAttributes>());
+    if (i > 0 && i != 8) {
+      graph.insertEdge(NodeSymbol('p', i - 1), NodeSymbol('p', i));
+    }
+  }
+  graph.insertEdge(NodeSymbol('R', 0), NodeSymbol('p', 0));
+  graph.insertEdge(NodeSymbol('R', 0), NodeSymbol('p', 1));
+  graph.insertEdge(NodeSymbol('R', 2), NodeSymbol('p', 4));
+  graph.insertEdge(NodeSymbol('R', 2), NodeSymbol('p', 7));
+
+  const auto& places = graph.getLayer(DsgLayers::PLACES);
+  const auto partition = partitionByParent(places);
+  checkConsistent(places, partition);
+
+  // parts for R0 and R2 plus one part for p8 and p9 (not connected to any room)
+  ASSERT_EQ(partition.numParts(), 3u);
+  const auto p = [](size_t i) { return NodeSymbol('p', i); };
+  EXPECT_EQ(partition.parts[0], std::vector<NodeId>({p(0), p(1), p(2)}));
+  EXPECT_EQ(partition.parts[1], std::vector<NodeId>({p(3), p(4), p(5), p(6), p(7)}));
+  EXPECT_EQ(partition.parts[2], std::vector<NodeId>({p(8), p(9)}));
+  EXPECT_EQ(partition.edge_cut, 1u);
+  EXPECT_EQ(partition.halo[0], std::vector<NodeId>({p(3)}));
+}
+
+TEST(GraphPartitionTests, InvalidInputs) {
+  IsolatedSceneGraphLayer layer(1);
+  fillGrid(layer, 2, 2);
+
+  PartitionConfig config;
+  config.num_parts = 0;
+  EXPECT_THROW(partitionLayer(layer, config), std::invalid_argument);
+  EXPECT_THROW(GraphPartition::fromAssignments(layer, {{0, 2}}, 2), std::out_of_range);
+  EXPECT_THROW(GraphPartition().part(0), std::out_of_range);
+}
+
+}  // namespace spark_dsg
@@ -36,12 +36,16 @@
 #include <spark_dsg/graph_utilities.h>
 #include <spark_dsg/scene_graph_layer.h>
 
+#include <algorithm>
+#include <random>
+
 namespace spark_dsg {
 
 using NodeSet = std::set<NodeId>;
 using ResultSet = std::vector<NodeSet>;
 using graph_utilities::Components;
 using graph_utilities::getConnectedComponents;
+using graph_utilities::TraversalWorkspace;
 
 template <typename Expected, typename Result>
 bool matchesExpected(const Expected& expected, const Result& result) {
@@ -112,6 +116,18 @@ TEST_P(ConnectedComponentFixture, ResultCorrect) {
     EXPECT_TRUE(matchesExpectedSet(expected, result))
         << displayNodeSymbolContainer(expected);
   }
+
+  // workspace is reused after a traversal of the same layer
+  TraversalWorkspace workspace;
+  for (size_t i = 0; i < 2; ++i) {
+    result = getConnectedComponents<SceneGraphLayer>(
+        layer, info.query, workspace, info.restrict_to_query);
+    EXPECT_EQ(info.expected.size(), result.size());
+    for (const auto& expected : info.expected) {
+      EXPECT_TRUE(matchesExpectedSet(expected, result))
+          << displayNodeSymbolContainer(expected);
+    }
+  }
 }
 
 const ConnectedComponentTestConfig cc_test_cases[] = {
@@ -247,14 +263,33 @@ struct FilteredCCFixture : public testing::TestWithParam<FilteredCCTestConfig> {
 TEST_P(FilteredCCFixture, ResultCorrect) {
   FilteredCCTestConfig info = GetParam();
 
+  const auto node_valid = [&](const SceneGraphNode& node) {
+    return !info.disallowed_nodes.count(node.id);
+  };
+  const auto edge_valid = [&](const SceneGraphEdge& edge) {
+    return !info.disallowed_edge_nodes.count(edge.source) &&
+           !info.disallowed_edge_nodes.count(edge.target);
+  };
+
   Components result = getConnectedComponents<SceneGraphLayer>(
-      layer,
-      [&](const SceneGraphNode& node) { return !info.disallowed_nodes.count(node.id); },
-      [&](const SceneGraphEdge& edge) {
-        return !info.disallowed_edge_nodes.count(edge.source) &&
-               !info.disallowed_edge_nodes.count(edge.target);
-      });
+      layer, node_valid, edge_valid);
+  EXPECT_EQ(info.expected.size(), result.size());
+  for (const auto& expected : info.expected) {
+    EXPECT_TRUE(matchesExpectedSet(expected, result))
+        << displayNodeSymbolContainer(expected);
+  }
+
+  TraversalWorkspace workspace;
+  result = getConnectedComponents<SceneGraphLayer>(
+      layer, node_valid, edge_valid, workspace);
+  EXPECT_EQ(info.expected.size(), result.size());
+  for (const auto& expected : info.expected) {
+    EXPECT_TRUE(matchesExpectedSet(expected, result))
+        << displayNodeSymbolContainer(expected);
+  }
 
+  result = graph_utilities::getConnectedComponentsParallel<SceneGraphLayer>(
+      layer, node_valid, edge_valid, 2);
   EXPECT_EQ(info.expected.size(), result.size());
   for (const auto& expected : info.expected) {
     EXPECT_TRUE(matchesExpectedSet(expected, result))
@@ -294,4 +329,182 @@ TEST(ConnectedComponentTests, FilteredEmptyCorrect) {
   EXPECT_TRUE(result.empty());
 }
 
+TEST(TraversalWorkspaceTests, FrontierCorrect) {
+  TraversalWorkspace workspace;
+  EXPECT_TRUE(workspace.frontierEmpty());
+
+  // interleave pushes and pops so that the ring buffer wraps around when growing
+  NodeId next = 0;
+  NodeId expected = 0;
+  for (size_t round = 0; round < 10; ++round) {
+    for (size_t i = 0; i < 7; ++i) {
+      workspace.push(next++);
+    }
+
+    for (size_t i = 0; i < 3; ++i) {
+      EXPECT_EQ(workspace.pop(), expected++);
+    }
+  }
+
+  while (!workspace.frontierEmpty()) {
+    EXPECT_EQ(workspace.pop(), expected++);
+  }
+  EXPECT_EQ(next, expected);
+}
+
+TEST(TraversalWorkspaceTests, VisitedCorrect) {
+  TraversalWorkspace workspace;
+  EXPECT_FALSE(workspace.visited(5));
+  EXPECT_TRUE(workspace.visit(5, 2));
+  EXPECT_FALSE(workspace.visit(5, 3));
+  EXPECT_TRUE(workspace.visited(5));
+  EXPECT_EQ(workspace.cost(5), 2u);
+
+  // visited flags are invalidated without dropping the node index
+  workspace.reset();
+  EXPECT_FALSE(workspace.visited(5));
+  EXPECT_EQ(workspace.numIndexed(), 1u);
+  EXPECT_TRUE(workspace.visit(5));
+
+  workspace.clear();
+  EXPECT_EQ(workspace.numIndexed(), 0u);
+}
+
+TEST(TraversalWorkspaceTests, DepthLimitedSearchCorrect) {
+  IsolatedSceneGraphLayer layer(1);
+  layer.emplaceNode(0, std::make_unique<NodeAttributes>());
+  for (size_t i = 1; i < 100; ++i) {
+    layer.emplaceNode(i, std::make_unique<NodeAttributes>());
+    layer.insertEdge(i - 1, i);
+  }
+
+  TraversalWorkspace workspace;
+  std::set<NodeId> visited;
+  const auto visitor = [&](const SceneGraphLayer&, NodeId node) {
+    visited.insert(node);
+  };
+
+  const NodeId root = 50;
+  graph_utilities::breadthFirstSearch<SceneGraphLayer>(
+      layer, root, 2, workspace, visitor);
+  EXPECT_EQ(visited, std::set<NodeId>({48, 49, 50, 51, 52}));
+
+  visited.clear();
+  graph_utilities::breadthFirstSearch<SceneGraphLayer>(
+      layer, std::vector<NodeId>{0, 99}, 1, workspace, visitor);
+  EXPECT_EQ(visited, std::set<NodeId>({0, 1, 98, 99}));
+
+  // nothing is visited (or left marked as visited) if any root is missing
+  visited.clear();
+  graph_utilities::breadthFirstSearch<SceneGraphLayer>(
+      layer, std::vector<NodeId>{0, 100}, 1, workspace, visitor);
+  EXPECT_TRUE(visited.empty());
+  EXPECT_FALSE(workspace.visited(0));
+
+  visited.clear();
+  graph_utilities::breadthFirstSearch<SceneGraphLayer>(
+      layer, NodeId(0), workspace, visitor);
+  EXPECT_EQ(visited.size(), 100u);
+  EXPECT_EQ(workspace.numIndexed(), 100u);
+}
+
+TEST(MergedComponentTests, TransitiveMergeCorrect) {
+  const std::vector<NodeSet> unmerged{{0, 1}, {5}, {2, 3}, {1, 2}, {6, 5}, {7}};
+  const auto result = graph_utilities::getMergedComponents(unmerged);
+  ASSERT_EQ(result.size(), 3u);
+  EXPECT_EQ(result[0], std::vector<NodeId>({0, 1, 2, 3}));
+  EXPECT_EQ(result[1], std::vector<NodeId>({5, 6}));
+  EXPECT_EQ(result[2], std::vector<NodeId>({7}));
+}
+
+TEST(MergedComponentTests, EmptyCorrect) {
+  const std::vector<NodeSet> unmerged;
+  EXPECT_TRUE(graph_utilities::getMergedComponents(unmerged).empty());
+}
+
+TEST(MergedComponentTests, ManyOverlappingComponentsCorrect) {
+  // segments of a chain, where every segment overlaps the next one in its group
+  constexpr size_t num_groups = 200;
+  constexpr size_t segments_per_group = 50;
+  std::vector<NodeSet> unmerged;
+  for (size_t i = 0; i < segments_per_group; ++i) {
+    for (size_t group = 0; group < num_groups; ++group) {
+      const NodeId start = group * 1000 + 2 * i;
+      unmerged.push_back({start, start + 1, start + 2});
+    }
+  }
+
+  const auto result = graph_utilities::getMergedComponents(unmerged);
+  ASSERT_EQ(result.size(), num_groups);
+  for (size_t group = 0; group < num_groups; ++group) {
+    const auto& component = result[group];
+    EXPECT_EQ(component.size(), 2 * segments_per_group + 1);
+    const auto bounds = std::minmax_element(component.begin(), component.end());
+    EXPECT_EQ(*bounds.first, group * 1000);
+    EXPECT_EQ(*bounds.second, group * 1000 + 2 * segments_per_group);
+  }
+}
+
+TEST(MergedComponentTests, DepthLimitedComponentsAtScaleCorrect) {
+  // many disjoint paths, queried from every node as in room segmentation
+  constexpr size_t num_paths = 2000;
+  constexpr size_t path_length = 10;
+  IsolatedSceneGraphLayer layer(1);
+  NodeSet query;
+  for (size_t path = 0; path < num_paths; ++path) {
+    for (size_t i = 0; i < path_length; ++i) {
+      const NodeId node = path * path_length + i;
+      layer.emplaceNode(node, std::make_unique<NodeAttributes>());
+      if (i > 0) {
+        layer.insertEdge(node - 1, node);
+      }
+
+      // skip every other node to force overlapping partial components
+      if (i % 2 == 0) {
+        query.insert(node);
+      }
+    }
+  }
+
+  const auto result = getConnectedComponents<SceneGraphLayer>(layer, 1, query);
+  ASSERT_EQ(result.size(), num_paths);
+  for (const auto& component : result) {
+    EXPECT_EQ(component.size(), path_length);
+  }
+}
+
+TEST(ConnectedComponentTests, ParallelMatchesSerial) {
+  // random sparse graph with a mix of small and large components
+  IsolatedSceneGraphLayer layer(1);
+  constexpr size_t num_nodes = 20000;
+  for (size_t i = 0; i < num_nodes; ++i) {
+    layer.emplaceNode(3 * i, std::make_unique<NodeAttributes>());
+  }
+
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<size_t> dist(0, num_nodes - 1);
+  for (size_t i = 0; i < num_nodes / 2; ++i) {
+    layer.insertEdge(3 * dist(gen), 3 * dist(gen));
+  }
+
+  const std::function<bool(const SceneGraphNode&)> node_valid =
+      [](const SceneGraphNode& node) { return node.id % 7 != 0; };
+  const std::function<bool(const SceneGraphEdge&)> edge_valid =
+      [](const SceneGraphEdge& edge) { return (edge.source + edge.target) % 5 != 0; };
+
+  auto expected =
+      getConnectedComponents<SceneGraphLayer>(layer, node_valid, edge_valid);
+  for (auto& component : expected) {
+    std::sort(component.begin(), component.end());
+  }
+  std::sort(expected.begin(), expected.end());
+
+  for (const size_t num_threads : {1, 4}) {
+    using graph_utilities::getConnectedComponentsParallel;
+    const auto result = getConnectedComponentsParallel<SceneGraphLayer>(
+        layer, node_valid, edge_valid, num_threads);
+    EXPECT_EQ(result, expected) << "threads: " << num_threads;
+  }
+}
+
 }  // namespace spark_dsg
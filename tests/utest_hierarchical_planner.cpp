@@ -0,0 +1,209 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <spark_dsg/hierarchical_planner.h>
+#include <spark_dsg/node_symbol.h>
+#include <spark_dsg/shortest_paths.h>
+
+namespace spark_dsg {
+
+namespace {
+
+// rooms of size x size places (with unit spacing) and doors between neighboring rooms
+struct Building {
+  Building(size_t rows, size_t cols, size_t size)
+      : rows(rows), cols(cols), size(size) {
+    for (size_t r = 0; r < rows; ++r) {
+      for (size_t c = 0; c < cols; ++c) {
+        addRoom(r, c);
+      }
+    }
+
+    const size_t mid = size / 2;
+    for (size_t r = 0; r < rows; ++r) {
+      for (size_t c = 0; c < cols; ++c) {
+        if (c + 1 < cols) {
+          graph.insertEdge(place(r, c, mid, size - 1), place(r, c + 1, mid, 0));
+        }
+
+        if (r + 1 < rows) {
+          graph.insertEdge(place(r, c, size - 1, mid), place(r + 1, c, 0, mid));
+        }
+      }
+    }
+  }
+
+  NodeId room(size_t r, size_t c) const { return NodeSymbol('R', r * cols + c); }
+
+  NodeId place(size_t r, size_t c, size_t i, size_t j) const {
+    const size_t row = r * size + i;
+    const size_t col = c * size + j;
+    return NodeSymbol('p', row * cols * size + col);
+  }
+
+  void addRoom(size_t r, size_t c) {
+    const Eigen::Vector3d center((c + 0.5) * size, (r + 0.5) * size, 0.0);
+    graph.emplaceNode(
+        DsgLayers::ROOMS, room(r, c), std::make_unique<NodeAttributes>(center));
+    for (size_t i = 0; i < size; ++i) {
+      for (size_t j = 0; j < size; ++j) {
+        const Eigen::Vector3d pos(c * size + j, r * size + i, 0.0);
+        graph.emplaceNode(DsgLayers::PLACES,
+                          place(r, c, i, j),
+                          std::make_unique<NodeAttributes>(pos));
+        graph.insertEdge(room(r, c), place(r, c, i, j));
+        if (i > 0) {
+          graph.insertEdge(place(r, c, i - 1, j), place(r, c, i, j));
+        }
+
+        if (j > 0) {
+          graph.insertEdge(place(r, c, i, j - 1), place(r, c, i, j));
+        }
+      }
+    }
+  }
+
+  const size_t rows;
+  const size_t cols;
+  const size_t size;
+  DynamicSceneGraph graph;
+};
+
+void expectValidPath(const DynamicSceneGraph& graph,
+                     const std::vector<NodeId>& path,
+                     NodeId source,
+                     NodeId target) {
+  ASSERT_FALSE(path.empty());
+  EXPECT_EQ(path.front(), source);
+  EXPECT_EQ(path.back(), target);
+  for (size_t i = 1; i < path.size(); ++i) {
+    EXPECT_TRUE(graph.hasEdge(path[i - 1], path[i]));
+  }
+}
+
+}  // namespace
+
+TEST(HierarchicalPlannerTests, PortalsCorrect) {
+  Building building(2, 3, 5);
+  HierarchicalPlanner planner(building.graph);
+
+  // corner room has a door to the right and a door below
+  const auto& corner = planner.getPortals(building.room(0, 0));
+  EXPECT_EQ(std::set<NodeId>(corner.begin(), corner.end()),
+            std::set<NodeId>({building.place(0, 0, 2, 4), building.place(0, 0, 4, 2)}));
+
+  const auto& middle = planner.getPortals(building.room(0, 1));
+  EXPECT_EQ(middle.size(), 3u);
+  EXPECT_TRUE(planner.getPortals(NodeSymbol('R', 100)).empty());
+}
+
+TEST(HierarchicalPlannerTests, PathCorrect) {
+  Building building(6, 6, 5);
+  HierarchicalPlanner planner(building.graph);
+
+  const NodeId source = building.place(0, 0, 0, 0);
+  const NodeId target = building.place(5, 5, 4, 4);
+  std::vector<NodeId> path;
+  const double cost = planner.findPath(source, target, path);
+  expectValidPath(building.graph, path, source, target);
+  EXPECT_EQ(planner.roomPath().front(), building.room(0, 0));
+  EXPECT_EQ(planner.roomPath().back(), building.room(5, 5));
+  EXPECT_EQ(planner.roomPath().size(), 11u);
+
+  // doors are aligned, so the route through the rooms is optimal
+  graph_utilities::SearchWorkspace workspace;
+  const auto& places = building.graph.getLayer(DsgLayers::PLACES);
+  const double flat_cost =
+      graph_utilities::findShortestPath(places, source, target, workspace);
+  EXPECT_NEAR(cost, flat_cost, 1.0e-9);
+  EXPECT_NEAR(cost, 58.0, 1.0e-9);
+
+  // paths within a room only use the room
+  const NodeId other = building.place(0, 0, 4, 4);
+  EXPECT_NEAR(planner.findPath(source, other, path), 8.0, 1.0e-9);
+  EXPECT_EQ(planner.roomPath(), std::vector<NodeId>({building.room(0, 0)}));
+}
+
+TEST(HierarchicalPlannerTests, InvalidationCorrect) {
+  Building building(2, 2, 3);
+  HierarchicalPlanner planner(building.graph);
+
+  const NodeId source = building.place(0, 0, 1, 1);
+  const NodeId target = building.place(0, 1, 1, 1);
+  std::vector<NodeId> path;
+  EXPECT_NEAR(planner.findPath(source, target, path), 3.0, 1.0e-9);
+  EXPECT_EQ(planner.roomPath().size(), 2u);
+  building.graph.getNewNodes(true);
+  building.graph.getNewEdges(true);
+
+  // closing the door forces the route through the other rooms
+  building.graph.removeEdge(building.place(0, 0, 1, 2), building.place(0, 1, 1, 0));
+  planner.update(building.graph, true);
+  EXPECT_EQ(planner.getPortals(building.room(0, 0)).size(), 1u);
+
+  const double cost = planner.findPath(source, target, path);
+  expectValidPath(building.graph, path, source, target);
+  EXPECT_EQ(planner.roomPath().size(), 4u);
+  EXPECT_NEAR(cost, 9.0, 1.0e-9);
+
+  // removing the place with the other door disconnects the rooms
+  building.graph.removeNode(building.place(0, 0, 2, 1));
+  planner.update(building.graph, true);
+  EXPECT_TRUE(planner.getPortals(building.room(0, 0)).empty());
+  EXPECT_TRUE(std::isinf(planner.findPath(source, target, path)));
+  EXPECT_TRUE(path.empty());
+}
+
+TEST(HierarchicalPlannerTests, FallbackWithoutRooms) {
+  DynamicSceneGraph graph;
+  for (size_t i = 0; i < 5; ++i) {
+    graph.emplaceNode(DsgLayers::PLACES,
+                      NodeSymbol('p', i),
+                      std::make_unique<NodeAttributes>(Eigen::Vector3d(i, 0, 0)));
+    if (i > 0) {
+      graph.insertEdge(NodeSymbol('p', i - 1), NodeSymbol('p', i));
+    }
+  }
+
+  HierarchicalPlanner planner(graph);
+  std::vector<NodeId> path;
+  EXPECT_NEAR(planner.findPath(NodeSymbol('p', 0), NodeSymbol('p', 4), path),
+              4.0,
+              1.0e-9);
+  EXPECT_EQ(path.size(), 5u);
+  EXPECT_TRUE(planner.roomPath().empty());
+}
+
+}  // namespace spark_dsg
@@ -34,6 +34,7 @@
  * -------------------------------------------------------------------------- */
 #include <gtest/gtest.h>
 
+#include <random>
 #include <unordered_set>
 
 #include "spark_dsg/mesh.h"
@@ -94,6 +95,48 @@ TEST(MeshTests, EraseFaces) {
   EXPECT_EQ(mesh.timestamp(2), 11);
 }
 
+TEST(MeshTests, EraseVerticesByMask) {
+  Mesh mesh = createDummyMesh();
+  Mesh expected = createDummyMesh();
+  expected.eraseVertices({0, 1, 2, 3, 4, 6});
+
+  std::vector<bool> mask(12, false);
+  for (const auto index : {0, 1, 2, 3, 4, 6}) {
+    mask[index] = true;
+  }
+  mesh.eraseVerticesByMask(mask);
+  EXPECT_EQ(mesh, expected);
+
+  Mesh sorted = createDummyMesh();
+  sorted.eraseVerticesSorted({0, 1, 2, 3, 4, 6});
+  EXPECT_EQ(sorted, expected);
+
+  // a short mask only erases the vertices it covers
+  Mesh partial = createDummyMesh();
+  partial.eraseVerticesByMask({false, true});
+  EXPECT_EQ(partial.numVertices(), 11u);
+  EXPECT_EQ(partial.numFaces(), 3u);
+  EXPECT_EQ(partial.face(0), Mesh::Face({2, 3, 4}));
+  EXPECT_EQ(partial.timestamp(1), 2u);
+}
+
+TEST(MeshTests, EraseFacesByMask) {
+  Mesh mesh = createDummyMesh();
+  mesh.eraseFacesByMask({true, true}, false);
+  EXPECT_EQ(mesh.points.size(), 12u);
+  EXPECT_EQ(mesh.faces.size(), 2u);
+  EXPECT_EQ(mesh.face(0), Mesh::Face({6, 7, 8}));
+
+  mesh.eraseFacesSorted({0}, true);
+  EXPECT_EQ(mesh.points.size(), 3u);
+  EXPECT_EQ(mesh.colors.size(), 3u);
+  EXPECT_EQ(mesh.stamps.size(), 3u);
+  EXPECT_EQ(mesh.faces.size(), 1u);
+  EXPECT_EQ(mesh.face(0), Mesh::Face({0, 1, 2}));
+  EXPECT_EQ(mesh.timestamp(0), 9u);
+  EXPECT_EQ(mesh.timestamp(2), 11u);
+}
+
 TEST(MeshTests, transform) {
   Mesh mesh = createDummyMesh();
 
@@ -121,4 +164,174 @@ TEST(MeshTests, transform) {
   }
 }
 
+TEST(MeshTests, GeometryKernelsMatchScalar) {
+  // large enough to be split across threads on multi-core machines
+  const size_t num_vertices = 300000;
+  Mesh mesh(false, true, true, true);
+  mesh.resizeVertices(num_vertices);
+  std::mt19937 gen(3);
+  std::uniform_real_distribution<float> dist(-10.0f, 10.0f);
+  for (size_t i = 0; i < num_vertices; ++i) {
+    mesh.setPos(i, Mesh::Pos(dist(gen), dist(gen), dist(gen)));
+    mesh.setLabel(i, (i / 7) % 5);
+    mesh.setTimestamp(i, i % 1000);
+    mesh.setFirstSeenTimestamp(i, i);
+  }
+
+  Eigen::AlignedBox3f expected_bounds;
+  Eigen::Vector3d sum = Eigen::Vector3d::Zero();
+  std::map<Mesh::Label, size_t> expected_labels;
+  std::vector<size_t> expected_range;
+  for (size_t i = 0; i < num_vertices; ++i) {
+    expected_bounds.extend(mesh.pos(i));
+    sum += mesh.pos(i).cast<double>();
+    ++expected_labels[mesh.label(i)];
+    if (mesh.timestamp(i) >= 100 && mesh.timestamp(i) <= 200) {
+      expected_range.push_back(i);
+    }
+  }
+
+  EXPECT_TRUE(mesh.bounds().isApprox(expected_bounds));
+  EXPECT_TRUE(mesh.centroid().isApprox((sum / num_vertices).cast<float>(), 1.0e-4f));
+  EXPECT_EQ(mesh.labelHistogram(), expected_labels);
+  EXPECT_EQ(mesh.verticesInTimeRange(100, 200), expected_range);
+  EXPECT_EQ(mesh.verticesInTimeRange(10, 12, true), std::vector<size_t>({10, 11, 12}));
+  EXPECT_TRUE(mesh.verticesInTimeRange(200, 100).empty());
+
+  const Eigen::Isometry3f transform =
+      Eigen::Translation3f(1.0f, -2.0f, 3.0f) *
+      Eigen::AngleAxisf(0.3f, Eigen::Vector3f(1.0f, 2.0f, 3.0f).normalized());
+  Mesh expected = mesh;
+  for (auto& point : expected.points) {
+    point = transform * point;
+  }
+
+  mesh.transform(transform);
+  for (size_t i = 0; i < num_vertices; ++i) {
+    ASSERT_TRUE(mesh.pos(i).isApprox(expected.pos(i), 1.0e-5f)) << i;
+  }
+}
+
+TEST(MeshTests, GeometryKernelsEmptyMesh) {
+  Mesh mesh;
+  EXPECT_TRUE(mesh.bounds().isEmpty());
+  EXPECT_EQ(mesh.centroid(), Mesh::Pos::Zero());
+  EXPECT_TRUE(mesh.labelHistogram().empty());
+  EXPECT_TRUE(mesh.verticesInTimeRange(0, 10).empty());
+  mesh.transform(Eigen::Isometry3f::Identity());
+  EXPECT_TRUE(mesh.empty());
+}
+
+TEST(MeshTests, IndexRangesMerge) {
+  IndexRanges ranges;
+  ranges.add(10, 20);
+  ranges.add(30, 40);
+  ranges.add(5, 5);
+  EXPECT_EQ(ranges.count(), 20u);
+
+  using Ranges = std::vector<IndexRanges::Range>;
+  ranges.add(20, 25);  // adjacent ranges are merged
+  EXPECT_EQ(ranges.ranges(), Ranges({{10, 25}, {30, 40}}));
+
+  ranges.add(0, 2);
+  ranges.add(22, 35);  // overlapping ranges are merged
+  EXPECT_EQ(ranges.ranges(), Ranges({{0, 2}, {10, 40}}));
+  EXPECT_TRUE(ranges.contains(1));
+  EXPECT_FALSE(ranges.contains(2));
+  EXPECT_TRUE(ranges.contains(39));
+  EXPECT_FALSE(ranges.contains(40));
+
+  ranges.truncate(12);
+  EXPECT_EQ(ranges.ranges(), Ranges({{0, 2}, {10, 12}}));
+  ranges.truncate(1);
+  EXPECT_EQ(ranges.ranges(), Ranges({{0, 1}}));
+  ranges.clear();
+  EXPECT_TRUE(ranges.empty());
+}
+
+TEST(MeshTests, ChangeTracking) {
+  using Ranges = std::vector<IndexRanges::Range>;
+  Mesh mesh = createDummyMesh();
+  EXPECT_TRUE(mesh.hasChanges());
+  EXPECT_EQ(mesh.changedVertices().ranges(), Ranges({{0, 12}}));
+  EXPECT_TRUE(mesh.changedFaces().empty());  // faces were added directly
+
+  mesh.clearChanges();
+  EXPECT_FALSE(mesh.hasChanges());
+  EXPECT_EQ(mesh.baseVersion(), mesh.version());
+
+  // appending another mesh offsets its faces
+  const size_t start = mesh.append(createDummyMesh());
+  EXPECT_EQ(start, 12u);
+  EXPECT_EQ(mesh.numVertices(), 24u);
+  EXPECT_EQ(mesh.face(4), Mesh::Face({12, 13, 14}));
+  EXPECT_EQ(mesh.changedVertices().ranges(), Ranges({{12, 24}}));
+  EXPECT_EQ(mesh.changedFaces().ranges(), Ranges({{4, 8}}));
+
+  mesh.clearChanges();
+  Mesh patch(true, true, false);
+  patch.resizeVertices(2);
+  patch.setPos(1, Eigen::Vector3f(-1.0f, -2.0f, -3.0f));
+  mesh.updateVertices(3, patch);
+  mesh.updateFaces(1, {{{0, 1, 2}}});
+  EXPECT_EQ(mesh.pos(4), Eigen::Vector3f(-1.0f, -2.0f, -3.0f));
+  EXPECT_EQ(mesh.changedVertices().ranges(), Ranges({{3, 5}}));
+  EXPECT_EQ(mesh.changedFaces().ranges(), Ranges({{1, 2}}));
+  EXPECT_THROW(mesh.updateVertices(23, patch), std::out_of_range);
+  EXPECT_THROW(mesh.updateFaces(8, {{{0, 1, 2}}}), std::out_of_range);
+
+  // erasing shifts everything after the first erased index
+  mesh.clearChanges();
+  mesh.eraseVertexRange(18, 21);
+  EXPECT_EQ(mesh.numVertices(), 21u);
+  EXPECT_EQ(mesh.numFaces(), 7u);
+  EXPECT_EQ(mesh.face(6), Mesh::Face({18, 19, 20}));
+  EXPECT_EQ(mesh.changedVertices().ranges(), Ranges({{18, 21}}));
+  EXPECT_EQ(mesh.changedFaces().ranges(), Ranges({{6, 7}}));
+
+  mesh.clearChanges();
+  mesh.eraseFaceRange(6, 7);
+  EXPECT_EQ(mesh.numFaces(), 6u);
+  // vertices 3-5 were orphaned by updating face 1 and get removed as well
+  EXPECT_EQ(mesh.numVertices(), 15u);
+  EXPECT_EQ(mesh.changedVertices().ranges(), Ranges({{3, 15}}));
+  EXPECT_EQ(mesh.changedFaces().ranges(), Ranges({{2, 6}}));
+}
+
+TEST(MeshTests, ChangeTrackers) {
+  using Ranges = std::vector<IndexRanges::Range>;
+  Mesh mesh = createDummyMesh();
+  auto first = mesh.trackChanges();
+  EXPECT_FALSE(first->hasChanges());
+
+  // trackers are independent of the changes of the mesh and of each other
+  mesh.setPos(2, Eigen::Vector3f::Zero());
+  mesh.clearChanges();
+  auto second = mesh.trackChanges();
+  mesh.setPos(5, Eigen::Vector3f::Zero());
+  EXPECT_EQ(first->changedVertices().ranges(), Ranges({{2, 3}, {5, 6}}));
+  EXPECT_EQ(second->changedVertices().ranges(), Ranges({{5, 6}}));
+  first->clearChanges();
+  EXPECT_FALSE(first->hasChanges());
+  EXPECT_TRUE(second->hasChanges());
+
+  // removals drop the changes past the end of the mesh
+  mesh.eraseVertexRange(4, 12);
+  EXPECT_TRUE(first->hasChanges());
+  EXPECT_TRUE(first->changedVertices().empty());
+  EXPECT_TRUE(second->changedVertices().empty());
+
+  // copies do not update the trackers of their source, assignments mark everything
+  Mesh copy = mesh;
+  copy.setPos(0, Eigen::Vector3f::Ones());
+  EXPECT_TRUE(first->changedVertices().empty());
+  mesh = createDummyMesh();
+  EXPECT_EQ(first->changedVertices().ranges(), Ranges({{0, 12}}));
+
+  // expired trackers are dropped
+  second.reset();
+  mesh.setPos(0, Eigen::Vector3f::Ones());
+  EXPECT_TRUE(first->changedVertices().contains(0));
+}
+
 }  // namespace spark_dsg
@@ -0,0 +1,212 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <spark_dsg/dynamic_scene_graph.h>
+#include <spark_dsg/mesh_connection_index.h>
+#include <spark_dsg/node_attributes.h>
+
+#include <thread>
+
+namespace spark_dsg {
+
+namespace {
+
+NodeAttributes::Ptr objectAttrs(const std::list<size_t>& connections) {
+  auto attrs = std::make_unique<ObjectNodeAttributes>();
+  attrs->mesh_connections = connections;
+  return attrs;
+}
+
+NodeAttributes::Ptr placeAttrs(const std::vector<size_t>& connections) {
+  auto attrs = std::make_unique<PlaceNodeAttributes>();
+  attrs->pcl_mesh_connections = connections;
+  attrs->mesh_vertex_labels.resize(connections.size());
+  for (size_t i = 0; i < connections.size(); ++i) {
+    attrs->mesh_vertex_labels[i] = i;
+  }
+  return attrs;
+}
+
+}  // namespace
+
+TEST(MeshConnectionIndexTests, InsertEraseQuery) {
+  MeshConnectionIndex index;
+  EXPECT_EQ(index.numVertices(), 0u);
+  EXPECT_TRUE(index.nodes(3).empty());
+
+  index.insert(5, {3, 1, 3});
+  index.insert(2, {1, 4});
+  index.insert(7, {});
+  EXPECT_EQ(index.size(), 2u);
+  EXPECT_FALSE(index.contains(7));
+  EXPECT_EQ(index.connections(5), std::vector<size_t>({1, 3}));
+  EXPECT_THROW(index.connections(7), std::out_of_range);
+
+  EXPECT_EQ(index.numVertices(), 5u);
+  EXPECT_EQ(index.nodes(1), std::vector<NodeId>({2, 5}));
+  EXPECT_EQ(index.nodes(3), std::vector<NodeId>({5}));
+  EXPECT_TRUE(index.nodes(0).empty());
+  EXPECT_TRUE(index.nodes(10).empty());
+  EXPECT_EQ(index.nodes(std::vector<size_t>{3, 4, 10}), std::vector<NodeId>({2, 5}));
+  EXPECT_EQ(index.nodesInRange(2, 4), std::vector<NodeId>({5}));
+  EXPECT_EQ(index.nodesInRange(4, 100), std::vector<NodeId>({2}));
+
+  const auto per_vertex = index.nodesPerVertex({0, 1, 4});
+  ASSERT_EQ(per_vertex.size(), 3u);
+  EXPECT_TRUE(per_vertex[0].empty());
+  EXPECT_EQ(per_vertex[1], std::vector<NodeId>({2, 5}));
+  EXPECT_EQ(per_vertex[2], std::vector<NodeId>({2}));
+
+  // updates replace the previous connections of the node
+  index.insert(2, {0});
+  EXPECT_EQ(index.nodes(1), std::vector<NodeId>({5}));
+  EXPECT_EQ(index.nodes(0), std::vector<NodeId>({2}));
+  EXPECT_TRUE(index.erase(5));
+  EXPECT_FALSE(index.erase(5));
+  EXPECT_EQ(index.numVertices(), 1u);
+  EXPECT_TRUE(index.nodes(1).empty());
+}
+
+TEST(MeshConnectionIndexTests, RemapConnections) {
+  auto attrs = placeAttrs({0, 2, 5, 7});
+  auto& place = dynamic_cast<PlaceNodeAttributes&>(*attrs);
+  EXPECT_FALSE(MeshConnectionIndex::remapConnections(place, {}));
+  EXPECT_FALSE(MeshConnectionIndex::remapConnections(place, {8, 9}));
+  EXPECT_TRUE(MeshConnectionIndex::remapConnections(place, {1, 2, 6}));
+  EXPECT_EQ(place.pcl_mesh_connections, std::vector<size_t>({0, 3, 4}));
+  EXPECT_EQ(place.mesh_vertex_labels, std::vector<uint8_t>({0, 2, 3}));
+
+  ObjectNodeAttributes object;
+  object.mesh_connections = {4, 1, 3};
+  EXPECT_TRUE(MeshConnectionIndex::remapConnections(object, {3}));
+  EXPECT_EQ(object.mesh_connections, std::list<size_t>({3, 1}));
+}
+
+TEST(MeshConnectionIndexTests, RemapPlace2dBounds) {
+  Place2dNodeAttributes place;
+  place.pcl_mesh_connections = {3, 6, 8};
+  place.mesh_vertex_labels = {0, 1, 2};
+  place.pcl_min_index = 3;
+  place.pcl_max_index = 8;
+  EXPECT_TRUE(MeshConnectionIndex::remapConnections(place, {3, 4}));
+  EXPECT_EQ(place.pcl_mesh_connections, std::vector<size_t>({4, 6}));
+  EXPECT_EQ(place.pcl_min_index, 4u);
+  EXPECT_EQ(place.pcl_max_index, 6u);
+
+  // erasing every connection resets the bounds
+  EXPECT_TRUE(MeshConnectionIndex::remapConnections(place, {4, 6}));
+  EXPECT_TRUE(place.pcl_mesh_connections.empty());
+  EXPECT_EQ(place.pcl_min_index, 0u);
+  EXPECT_EQ(place.pcl_max_index, 0u);
+}
+
+TEST(MeshConnectionIndexTests, LayerIndexTracksNodes) {
+  DynamicSceneGraph graph;
+  graph.emplaceNode(DsgLayers::OBJECTS, 1, objectAttrs({0, 1}));
+  const auto& layer = graph.getLayer(DsgLayers::OBJECTS);
+  const auto& index = layer.meshConnectionIndex();
+  EXPECT_EQ(index.nodes(1), std::vector<NodeId>({1}));
+
+  // the index is kept up to date after it is built
+  graph.emplaceNode(DsgLayers::OBJECTS, 2, objectAttrs({1, 2}));
+  EXPECT_EQ(index.nodes(1), std::vector<NodeId>({1, 2}));
+  graph.setNodeAttributes(1, objectAttrs({3}));
+  EXPECT_EQ(index.nodes(1), std::vector<NodeId>({2}));
+  EXPECT_EQ(index.nodes(3), std::vector<NodeId>({1}));
+
+  // in-place modifications have to be reported
+  graph.getNode(2).attributes<ObjectNodeAttributes>().mesh_connections = {4};
+  layer.refreshMeshConnections(2);
+  EXPECT_TRUE(index.nodes(1).empty());
+  EXPECT_EQ(index.nodes(4), std::vector<NodeId>({2}));
+
+  graph.removeNode(1);
+  EXPECT_TRUE(index.nodes(3).empty());
+  EXPECT_EQ(index.size(), 1u);
+}
+
+TEST(MeshConnectionIndexTests, GraphEraseMeshVertices) {
+  DynamicSceneGraph graph;
+  auto mesh = std::make_shared<Mesh>();
+  mesh->resizeVertices(10);
+  graph.setMesh(mesh);
+
+  graph.emplaceNode(DsgLayers::OBJECTS, 1, objectAttrs({0, 1}));
+  graph.emplaceNode(DsgLayers::OBJECTS, 2, objectAttrs({5, 8}));
+  graph.emplaceNode(DsgLayers::PLACES, 3, placeAttrs({4, 9}));
+  EXPECT_EQ(graph.getMeshConnectedNodes({1, 9}), std::vector<NodeId>({1, 3}));
+  EXPECT_TRUE(graph.getMeshConnectedNodes({2, 3}).empty());
+
+  graph.eraseMeshVertices({2, 5, 9, 20});
+  EXPECT_EQ(mesh->numVertices(), 7u);
+
+  const auto& object = graph.getNode(2).attributes<ObjectNodeAttributes>();
+  EXPECT_EQ(object.mesh_connections, std::list<size_t>({6}));
+  const auto& place = graph.getNode(3).attributes<PlaceNodeAttributes>();
+  EXPECT_EQ(place.pcl_mesh_connections, std::vector<size_t>({3}));
+  EXPECT_EQ(place.mesh_vertex_labels, std::vector<uint8_t>({0}));
+  EXPECT_EQ(graph.getNode(1).attributes<ObjectNodeAttributes>().mesh_connections,
+            std::list<size_t>({0, 1}));
+
+  EXPECT_EQ(graph.getMeshConnectedNodes({6}), std::vector<NodeId>({2}));
+  EXPECT_EQ(graph.getMeshConnectedNodes({3}), std::vector<NodeId>({3}));
+  EXPECT_TRUE(graph.getMeshConnectedNodes({4, 5}).empty());
+}
+
+TEST(MeshConnectionIndexTests, ConcurrentQueries) {
+  DynamicSceneGraph graph;
+  for (size_t i = 0; i < 100; ++i) {
+    graph.emplaceNode(DsgLayers::OBJECTS, i, objectAttrs({i, i + 1}));
+  }
+
+  // the first queries build and compact the indices from several threads
+  std::vector<std::vector<NodeId>> results(8);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < results.size(); ++i) {
+    threads.emplace_back([&graph, &results, i]() {
+      results[i] = graph.getMeshConnectedNodes({10, 50});
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (const auto& result : results) {
+    EXPECT_EQ(result, std::vector<NodeId>({9, 10, 49, 50}));
+  }
+}
+
+}  // namespace spark_dsg
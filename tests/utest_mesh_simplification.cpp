@@ -0,0 +1,238 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+#include "spark_dsg/mesh_simplification.h"
+#include "spark_dsg_tests/mesh_utilities.h"
+
+namespace spark_dsg {
+
+using test::createGridMesh;
+
+namespace {
+
+// reorder vertices by position and faces by vertex index, since the order of the
+// output depends on the update history
+Mesh canonical(const Mesh& mesh) {
+  std::vector<size_t> order(mesh.numVertices());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) {
+    const auto& a = mesh.points[lhs];
+    const auto& b = mesh.points[rhs];
+    return std::lexicographical_compare(a.data(), a.data() + 3, b.data(), b.data() + 3);
+  });
+
+  Mesh result(mesh.has_colors,
+              mesh.has_timestamps,
+              mesh.has_labels,
+              mesh.has_first_seen_stamps);
+  std::vector<size_t> new_indices(mesh.numVertices());
+  for (size_t i = 0; i < order.size(); ++i) {
+    new_indices[order[i]] = i;
+    result.points.push_back(mesh.points[order[i]]);
+    result.colors.push_back(mesh.colors[order[i]]);
+    result.stamps.push_back(mesh.stamps[order[i]]);
+    result.first_seen_stamps.push_back(mesh.first_seen_stamps[order[i]]);
+    result.labels.push_back(mesh.labels[order[i]]);
+  }
+
+  for (const auto& face : mesh.faces) {
+    Mesh::Face new_face{
+        {new_indices[face[0]], new_indices[face[1]], new_indices[face[2]]}};
+    const auto first = std::min_element(new_face.begin(), new_face.end());
+    std::rotate(new_face.begin(), first, new_face.end());
+    result.faces.push_back(new_face);
+  }
+
+  std::sort(result.faces.begin(), result.faces.end());
+  return result;
+}
+
+}  // namespace
+
+TEST(MeshSimplificationTests, SimplifyGrid) {
+  const auto mesh = createGridMesh(4, 4);
+  const auto result = simplifyMesh(mesh, 1.0f);
+  ASSERT_TRUE(result);
+
+  // one vertex per 2x2 block of vertices (ordered by the first vertex in the block)
+  ASSERT_EQ(result->numVertices(), 4u);
+  EXPECT_TRUE(result->pos(0).isApprox(Eigen::Vector3f(0.25f, 0.25f, 0.0f)));
+  EXPECT_TRUE(result->pos(1).isApprox(Eigen::Vector3f(1.25f, 0.25f, 0.0f)));
+  EXPECT_TRUE(result->pos(3).isApprox(Eigen::Vector3f(1.25f, 1.25f, 0.0f)));
+  EXPECT_EQ(result->color(0), Color(5, 5, 0));
+  EXPECT_EQ(result->label(0), 1u);
+  EXPECT_EQ(result->label(1), 2u);
+  EXPECT_EQ(result->label(2), 1u);
+  EXPECT_EQ(result->timestamp(0), 5u);
+  EXPECT_EQ(result->firstSeenTimestamp(3), 10u);
+
+  // the two triangles between the four voxels survive
+  ASSERT_EQ(result->numFaces(), 2u);
+  for (const auto& face : result->faces) {
+    EXPECT_NE(face[0], face[1]);
+    EXPECT_NE(face[1], face[2]);
+    EXPECT_NE(face[0], face[2]);
+  }
+
+  EXPECT_THROW(simplifyMesh(mesh, 0.0f), std::invalid_argument);
+}
+
+TEST(MeshSimplificationTests, IncrementalMatchesFull) {
+  Mesh mesh = createGridMesh(10, 10);
+  MeshSimplifier simplifier(1.0f);
+  EXPECT_EQ(simplifier.update(mesh), *simplifyMesh(mesh, 1.0f));
+
+  // grow the mesh
+  mesh.append(createGridMesh(6, 10, 5.0f));
+  EXPECT_EQ(canonical(simplifier.update(mesh)), canonical(*simplifyMesh(mesh, 1.0f)));
+
+  // move vertices within and across voxels
+  mesh.setPos(0, Eigen::Vector3f(0.1f, 0.1f, 0.0f));
+  mesh.setPos(11, Eigen::Vector3f(3.1f, 0.1f, 0.0f));
+  mesh.setLabel(12, 7);
+  EXPECT_EQ(canonical(simplifier.update(mesh)), canonical(*simplifyMesh(mesh, 1.0f)));
+
+  // empty a voxel so that the last vertex of the simplified mesh takes its place
+  for (const size_t i : {0, 1, 10, 11}) {
+    mesh.setPos(i, Eigen::Vector3f(20.0f, 20.0f, 0.0f));
+  }
+  EXPECT_EQ(canonical(simplifier.update(mesh)), canonical(*simplifyMesh(mesh, 1.0f)));
+
+  // remove vertices and faces
+  mesh.eraseVertexRange(20, 30);
+  EXPECT_EQ(canonical(simplifier.update(mesh)), canonical(*simplifyMesh(mesh, 1.0f)));
+  mesh.eraseFaceRange(0, 10, false);
+  EXPECT_EQ(canonical(simplifier.update(mesh)), canonical(*simplifyMesh(mesh, 1.0f)));
+
+  // faces that refer to vertices before they exist
+  mesh.appendFaces({{{mesh.numVertices(), 0, 5}}});
+  EXPECT_EQ(canonical(simplifier.update(mesh)), canonical(*simplifyMesh(mesh, 1.0f)));
+  mesh.appendVertices(1);
+  mesh.setPos(mesh.numVertices() - 1, Eigen::Vector3f(-3.0f, -3.0f, 0.0f));
+  EXPECT_EQ(canonical(simplifier.update(mesh)), canonical(*simplifyMesh(mesh, 1.0f)));
+
+  // clearing the changes of the mesh (e.g., by a sender) does not hide them
+  mesh.setPos(5, Eigen::Vector3f(-4.0f, 0.0f, 0.0f));
+  mesh.clearChanges();
+  EXPECT_EQ(canonical(simplifier.update(mesh)), canonical(*simplifyMesh(mesh, 1.0f)));
+}
+
+TEST(MeshSimplificationTests, GrowthOnlyVisitsNewVertices) {
+  Mesh mesh = createGridMesh(10, 10);
+  MeshSimplifier simplifier(1.0f);
+  const size_t num_before = simplifier.update(mesh).numVertices();
+
+  // the changes of the mesh still cover the first grid, but the simplifier only
+  // revisits what changed since its last update
+  mesh.append(createGridMesh(4, 4, 20.0f));
+  const auto& after = simplifier.update(mesh);
+  ASSERT_GT(after.numVertices(), num_before);
+  const std::vector<IndexRanges::Range> expected{{num_before, after.numVertices()}};
+  EXPECT_EQ(after.changedVertices().ranges(), expected);
+  EXPECT_EQ(canonical(after), canonical(*simplifyMesh(mesh, 1.0f)));
+}
+
+TEST(MeshSimplificationTests, NonFiniteVerticesSkipped) {
+  Mesh mesh = createGridMesh(4, 4);
+  MeshSimplifier simplifier(1.0f);
+  simplifier.update(mesh);
+
+  // the vertex leaves its voxel and the faces using it are dropped
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  mesh.setPos(0, Eigen::Vector3f(nan, 0.0f, 0.0f));
+  mesh.setPos(15, Eigen::Vector3f(0.0f, std::numeric_limits<float>::infinity(), 0.0f));
+  const auto& result = simplifier.update(mesh);
+  EXPECT_EQ(canonical(result), canonical(*simplifyMesh(mesh, 1.0f)));
+  EXPECT_EQ(result.numVertices(), 4u);
+  for (const auto& pos : result.points) {
+    EXPECT_TRUE(pos.allFinite());
+  }
+
+  // and everything is restored once the position is valid again
+  mesh.setPos(0, Eigen::Vector3f::Zero());
+  mesh.setPos(15, Eigen::Vector3f(1.5f, 1.5f, 0.0f));
+  EXPECT_EQ(canonical(simplifier.update(mesh)),
+            canonical(*simplifyMesh(createGridMesh(4, 4), 1.0f)));
+}
+
+TEST(MeshSimplificationTests, UpdatesPatchOutputInPlace) {
+  Mesh mesh = createGridMesh(10, 10);
+  mesh.clearChanges();
+  MeshSimplifier simplifier(1.0f);
+  const Mesh before = simplifier.update(mesh);
+
+  // a change within one voxel only touches the vertex of that voxel
+  mesh.setPos(99, Eigen::Vector3f(4.6f, 4.6f, 0.0f));
+  const auto& after = simplifier.update(mesh);
+  ASSERT_EQ(after.numVertices(), before.numVertices());
+  ASSERT_EQ(after.numFaces(), before.numFaces());
+  EXPECT_EQ(after.faces, before.faces);
+  EXPECT_EQ(after.changedVertices().count(), 1u);
+  EXPECT_TRUE(after.changedFaces().empty());
+  for (size_t i = 0; i < after.numVertices(); ++i) {
+    if (!after.changedVertices().contains(i)) {
+      EXPECT_EQ(after.pos(i), before.pos(i));
+    }
+  }
+}
+
+TEST(MeshSimplificationTests, RebuildsForOtherMesh) {
+  const Mesh first = createGridMesh(10, 10);
+  Mesh second = createGridMesh(4, 4, 20.0f);
+  MeshSimplifier simplifier(1.0f);
+  simplifier.update(first);
+
+  EXPECT_EQ(simplifier.update(second), *simplifyMesh(second, 1.0f));
+  EXPECT_EQ(simplifier.update(first), *simplifyMesh(first, 1.0f));
+}
+
+TEST(MeshSimplificationTests, LevelsOfDetail) {
+  const auto mesh = createGridMesh(20, 20);
+  MeshLevelsOfDetail lods({0.6f, 1.2f, 2.4f});
+  lods.update(mesh);
+  ASSERT_EQ(lods.numLevels(), 3u);
+  EXPECT_FLOAT_EQ(lods.voxelSize(1), 1.2f);
+  EXPECT_LT(lods.level(0).numVertices(), mesh.numVertices());
+  EXPECT_LT(lods.level(1).numVertices(), lods.level(0).numVertices());
+  EXPECT_LT(lods.level(2).numVertices(), lods.level(1).numVertices());
+  EXPECT_THROW(lods.level(3), std::out_of_range);
+}
+
+}  // namespace spark_dsg
@@ -35,6 +35,9 @@
 #include <gtest/gtest.h>
 #include <spark_dsg/scene_graph_layer.h>
 
+#include <atomic>
+#include <thread>
+
 namespace spark_dsg {
 
 using NodeSet = std::unordered_set<NodeId>;
@@ -473,6 +476,80 @@ TEST(SceneGraphLayerTests, GetNeighborhoodFromSetCorrect) {
   }
 }
 
+TEST(SceneGraphLayerTests, NeighborhoodCacheInvalidatedLocally) {
+  // two separate chains: 0 - 1 - ... - 9 and 10 - 11 - ... - 19
+  IsolatedSceneGraphLayer layer(1);
+  for (size_t i = 0; i < 20; ++i) {
+    layer.emplaceNode(i, std::make_unique<NodeAttributes>());
+    if (i % 10 != 0) {
+      layer.insertEdge(i - 1, i);
+    }
+  }
+
+  layer.enableNeighborhoodCache();
+  EXPECT_EQ(layer.getNeighborhood(0, 2), NodeSet({0, 1, 2}));
+  EXPECT_EQ(layer.getNeighborhood(5, 1), NodeSet({4, 5, 6}));
+  EXPECT_EQ(layer.getNeighborhood(15, 1), NodeSet({14, 15, 16}));
+  EXPECT_EQ(layer.getNeighborhood(15, 1), NodeSet({14, 15, 16}));
+  EXPECT_EQ(layer.numCachedNeighborhoods(), 3u);
+
+  // union of cached neighborhoods
+  EXPECT_EQ(layer.getNeighborhood(NodeSet{0, 5}, 1), NodeSet({0, 1, 4, 5, 6}));
+  EXPECT_EQ(layer.getNeighborhood(NodeSet{0, 5}, 2), NodeSet({0, 1, 2, 3, 4, 5, 6, 7}));
+
+  // only the neighborhood of the second chain touches the new edge
+  layer.insertEdge(16, 19);
+  EXPECT_EQ(layer.numCachedNeighborhoods(), 2u);
+  EXPECT_EQ(layer.getNeighborhood(15, 1), NodeSet({14, 15, 16}));
+  EXPECT_EQ(layer.getNeighborhood(16, 1), NodeSet({15, 16, 17, 19}));
+
+  layer.removeEdge(1, 2);
+  EXPECT_EQ(layer.numCachedNeighborhoods(), 3u);
+  EXPECT_EQ(layer.getNeighborhood(0, 2), NodeSet({0, 1}));
+
+  layer.removeNode(4);
+  EXPECT_EQ(layer.getNeighborhood(5, 1), NodeSet({5, 6}));
+
+  layer.mergeNodes(6, 0);
+  EXPECT_EQ(layer.getNeighborhood(5, 1), NodeSet({0, 5}));
+  EXPECT_EQ(layer.getNeighborhood(0, 2), NodeSet({0, 1, 5, 7, 8}));
+
+  layer.enableNeighborhoodCache(false);
+  EXPECT_EQ(layer.numCachedNeighborhoods(), 0u);
+  EXPECT_EQ(layer.getNeighborhood(0, 2), NodeSet({0, 1, 5, 7, 8}));
+}
+
+TEST(SceneGraphLayerTests, NeighborhoodCacheToggledConcurrently) {
+  IsolatedSceneGraphLayer layer(1);
+  for (size_t i = 0; i < 100; ++i) {
+    layer.emplaceNode(i, std::make_unique<NodeAttributes>());
+    if (i > 0) {
+      layer.insertEdge(i - 1, i);
+    }
+  }
+
+  std::atomic<bool> done(false);
+  std::vector<std::thread> readers;
+  for (size_t t = 0; t < 4; ++t) {
+    readers.emplace_back([&]() {
+      size_t node = 1;
+      while (!done) {
+        EXPECT_EQ(layer.getNeighborhood(node, 1), NodeSet({node - 1, node, node + 1}));
+        node = node % 98 + 1;
+      }
+    });
+  }
+
+  for (size_t i = 0; i < 1000; ++i) {
+    layer.enableNeighborhoodCache(i % 2 == 0);
+  }
+
+  done = true;
+  for (auto& reader : readers) {
+    reader.join();
+  }
+}
+
 TEST(SceneGraphLayerTests, TestRemovedNodes) {
   IsolatedSceneGraphLayer layer(1);
 
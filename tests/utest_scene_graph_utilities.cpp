@@ -142,4 +142,44 @@ INSTANTIATE_TEST_SUITE_P(GetChildBoundingBox,
                          BoundingBoxTestFixture,
                          testing::ValuesIn(bbox_test_cases));
 
+TEST(SceneGraphUtilities, MeshBoundingBoxes) {
+  DynamicSceneGraph graph;
+  auto mesh = std::make_shared<Mesh>();
+  mesh->resizeVertices(100);
+  for (size_t i = 0; i < mesh->numVertices(); ++i) {
+    mesh->setPos(i, Eigen::Vector3f(i, 2.0f * i, -1.0f * i));
+  }
+  graph.setMesh(mesh);
+
+  // enough nodes to be split between threads
+  for (size_t i = 0; i < 60; ++i) {
+    auto attrs = std::make_unique<ObjectNodeAttributes>();
+    attrs->mesh_connections = {i, i + 1, i + 3};
+    graph.emplaceNode(DsgLayers::OBJECTS, i, std::move(attrs));
+  }
+
+  // no connections and connections outside the mesh are skipped
+  graph.emplaceNode(DsgLayers::OBJECTS, 100, std::make_unique<ObjectNodeAttributes>());
+  auto invalid = std::make_unique<ObjectNodeAttributes>();
+  invalid->mesh_connections = {1, 100};
+  graph.emplaceNode(DsgLayers::OBJECTS, 101, std::move(invalid));
+
+  const auto& layer = graph.getLayer(DsgLayers::OBJECTS);
+  const auto type = BoundingBox::Type::AABB;
+  const auto single = computeMeshBoundingBoxes(layer, *mesh, type, 1);
+  const auto parallel = computeMeshBoundingBoxes(layer, *mesh, type, 4);
+  EXPECT_EQ(single.size(), 60u);
+  EXPECT_EQ(single, parallel);
+
+  const BoundingBox expected(Eigen::Vector3f(3.0f, 6.0f, 3.0f),
+                             Eigen::Vector3f(6.5f, 13.0f, -6.5f));
+  EXPECT_EQ(single.at(5), expected);
+
+  const auto& index = layer.boundingBoxIndex();
+  EXPECT_EQ(updateMeshBoundingBoxes(graph, DsgLayers::OBJECTS), 60u);
+  EXPECT_EQ(graph.getNode(5).attributes<ObjectNodeAttributes>().bounding_box, expected);
+  EXPECT_EQ(index.size(), 60u);
+  EXPECT_EQ(updateMeshBoundingBoxes(graph, 42), 0u);
+}
+
 }  // namespace spark_dsg
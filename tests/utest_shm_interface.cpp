@@ -0,0 +1,163 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <spark_dsg/serialization/graph_binary_serialization.h>
+#include <spark_dsg/shm_interface.h>
+
+#include <atomic>
+#include <thread>
+
+namespace spark_dsg {
+
+TEST(ShmInterfaceTests, BasicSendReceiveCorrect) {
+  ShmSender sender("/spark_dsg_utest_basic", 1 << 16);
+  ShmReceiver receiver("/spark_dsg_utest_basic");
+  EXPECT_TRUE(receiver.graph() == nullptr);
+  EXPECT_FALSE(receiver.recv(1));
+
+  DynamicSceneGraph graph;
+  graph.emplaceNode(2, 0, std::make_unique<NodeAttributes>());
+  graph.emplaceNode(2, 1, std::make_unique<NodeAttributes>());
+  graph.insertEdge(0, 1);
+  EXPECT_TRUE(sender.send(graph));
+
+  EXPECT_TRUE(receiver.recv(10));
+  ASSERT_TRUE(receiver.graph() != nullptr);
+  EXPECT_EQ(2u, receiver.graph()->numNodes());
+  EXPECT_EQ(1u, receiver.graph()->numEdges());
+
+  // nothing new was published
+  EXPECT_FALSE(receiver.recv(1));
+
+  graph.emplaceNode(2, 2, std::make_unique<NodeAttributes>());
+  EXPECT_TRUE(sender.send(graph));
+  EXPECT_TRUE(receiver.recv(10));
+  EXPECT_EQ(3u, receiver.graph()->numNodes());
+  EXPECT_EQ(0u, receiver.numSkipped());
+}
+
+TEST(ShmInterfaceTests, ReceiverSkipsToLatest) {
+  ShmSender sender("/spark_dsg_utest_latest", 1 << 16, 3);
+  ShmReceiver receiver("/spark_dsg_utest_latest");
+
+  DynamicSceneGraph graph;
+  for (size_t i = 0; i < 5; ++i) {
+    graph.emplaceNode(2, i, std::make_unique<NodeAttributes>());
+    EXPECT_TRUE(sender.send(graph));
+  }
+
+  EXPECT_TRUE(receiver.recv(10));
+  ASSERT_TRUE(receiver.graph() != nullptr);
+  EXPECT_EQ(5u, receiver.graph()->numNodes());
+  EXPECT_EQ(4u, receiver.numSkipped());
+  EXPECT_FALSE(receiver.recv(1));
+}
+
+TEST(ShmInterfaceTests, OversizedPayloadRejected) {
+  DynamicSceneGraph graph;
+  graph.emplaceNode(2, 0, std::make_unique<NodeAttributes>());
+  std::vector<uint8_t> buffer;
+  io::binary::writeGraph(graph, buffer);
+
+  ShmSender sender("/spark_dsg_utest_oversized", buffer.size() - 1);
+  ShmReceiver receiver("/spark_dsg_utest_oversized");
+  EXPECT_FALSE(sender.send(graph));
+  EXPECT_FALSE(receiver.recv(1));
+  EXPECT_TRUE(receiver.graph() == nullptr);
+}
+
+TEST(ShmInterfaceTests, ReattachAfterSenderRestart) {
+  ShmReceiver receiver("/spark_dsg_utest_restart");
+  DynamicSceneGraph graph;
+  graph.emplaceNode(2, 0, std::make_unique<NodeAttributes>());
+
+  {
+    ShmSender sender("/spark_dsg_utest_restart", 1 << 16);
+    EXPECT_TRUE(sender.send(graph));
+    EXPECT_TRUE(receiver.recv(10));
+  }
+
+  EXPECT_FALSE(receiver.recv(1));
+
+  ShmSender sender("/spark_dsg_utest_restart", 1 << 16);
+  graph.emplaceNode(2, 1, std::make_unique<NodeAttributes>());
+  EXPECT_TRUE(sender.send(graph));
+  EXPECT_TRUE(receiver.recv(10));
+  EXPECT_EQ(2u, receiver.graph()->numNodes());
+}
+
+TEST(ShmInterfaceTests, ConcurrentReadsConsistent) {
+  ShmSender sender("/spark_dsg_utest_concurrent", 1 << 16, 2);
+  ShmReceiver receiver("/spark_dsg_utest_concurrent");
+
+  std::atomic<bool> done(false);
+  std::thread writer([&]() {
+    DynamicSceneGraph graph;
+    for (size_t i = 0; i < 200; ++i) {
+      graph.emplaceNode(2, i, std::make_unique<NodeAttributes>());
+      if (i > 0) {
+        graph.insertEdge(i - 1, i);
+      }
+      sender.send(graph);
+    }
+    done = true;
+  });
+
+  size_t last_num_nodes = 0;
+  while (!done) {
+    if (!receiver.recv(1)) {
+      continue;
+    }
+
+    // a torn read would either fail to parse or produce an inconsistent graph
+    // asserting here would skip joining the writer
+    const auto graph = receiver.graph();
+    EXPECT_TRUE(graph != nullptr);
+    if (!graph) {
+      break;
+    }
+
+    EXPECT_GE(graph->numNodes(), last_num_nodes);
+    EXPECT_EQ(graph->numNodes() - 1, graph->numEdges());
+    last_num_nodes = graph->numNodes();
+  }
+
+  writer.join();
+  EXPECT_TRUE(receiver.recv(10) || last_num_nodes == 200u);
+  ASSERT_TRUE(receiver.graph() != nullptr);
+  EXPECT_EQ(200u, receiver.graph()->numNodes());
+}
+
+}  // namespace spark_dsg
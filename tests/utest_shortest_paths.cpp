@@ -0,0 +1,223 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <spark_dsg/edge_attributes.h>
+#include <spark_dsg/scene_graph_layer.h>
+#include <spark_dsg/shortest_paths.h>
+
+#include <random>
+
+namespace spark_dsg {
+
+using graph_utilities::DaryHeap;
+using graph_utilities::dijkstra;
+using graph_utilities::findShortestPath;
+using graph_utilities::getDistanceMatrix;
+using graph_utilities::SearchWorkspace;
+
+namespace {
+
+inline NodeId gridId(size_t row, size_t col, size_t cols) { return row * cols + col; }
+
+// grid with unit spacing and a wall in the middle column (except for the last row)
+void fillGrid(IsolatedSceneGraphLayer& layer, size_t rows, size_t cols) {
+  for (size_t r = 0; r < rows; ++r) {
+    for (size_t c = 0; c < cols; ++c) {
+      layer.emplaceNode(gridId(r, c, cols),
+                        std::make_unique<NodeAttributes>(Eigen::Vector3d(c, r, 0.0)));
+    }
+  }
+
+  const size_t wall = cols / 2;
+  for (size_t r = 0; r < rows; ++r) {
+    for (size_t c = 0; c < cols; ++c) {
+      const bool in_wall = c == wall && r + 1 < rows;
+      if (in_wall) {
+        continue;
+      }
+
+      if (c + 1 < cols && !(c + 1 == wall && r + 1 < rows)) {
+        layer.insertEdge(gridId(r, c, cols), gridId(r, c + 1, cols));
+      }
+
+      if (r + 1 < rows && !(c == wall && r + 2 < rows)) {
+        layer.insertEdge(gridId(r, c, cols), gridId(r + 1, c, cols));
+      }
+    }
+  }
+}
+
+}  // namespace
+
+TEST(ShortestPathTests, DaryHeapOrderCorrect) {
+  std::mt19937 gen(1);
+  std::uniform_real_distribution<double> dist(0.0, 100.0);
+
+  DaryHeap<double> heap;
+  std::vector<double> expected;
+  for (size_t i = 0; i < 1000; ++i) {
+    expected.push_back(dist(gen));
+    heap.push(expected.back());
+  }
+
+  std::sort(expected.begin(), expected.end());
+  std::vector<double> result;
+  while (!heap.empty()) {
+    result.push_back(heap.top());
+    heap.pop();
+  }
+
+  EXPECT_EQ(result, expected);
+}
+
+TEST(ShortestPathTests, WeightedDijkstraCorrect) {
+  IsolatedSceneGraphLayer layer(1);
+  for (size_t i = 0; i < 5; ++i) {
+    layer.emplaceNode(i, std::make_unique<NodeAttributes>(Eigen::Vector3d::Zero()));
+  }
+
+  layer.insertEdge(0, 1, std::make_unique<EdgeAttributes>(1.0));
+  layer.insertEdge(1, 2, std::make_unique<EdgeAttributes>(1.0));
+  layer.insertEdge(0, 2, std::make_unique<EdgeAttributes>(5.0));
+  layer.insertEdge(2, 3, std::make_unique<EdgeAttributes>(0.5));
+
+  SearchWorkspace workspace;
+  dijkstra<SceneGraphLayer>(layer, NodeId(0), workspace);
+  EXPECT_DOUBLE_EQ(workspace.distance(0), 0.0);
+  EXPECT_DOUBLE_EQ(workspace.distance(2), 2.0);
+  EXPECT_DOUBLE_EQ(workspace.distance(3), 2.5);
+  EXPECT_FALSE(workspace.reached(4));
+  EXPECT_EQ(workspace.path(3), std::vector<NodeId>({0, 1, 2, 3}));
+  EXPECT_TRUE(workspace.path(4).empty());
+
+  // search is limited by the maximum cost
+  dijkstra<SceneGraphLayer>(layer, NodeId(0), workspace, 2.0);
+  EXPECT_TRUE(workspace.reached(2));
+  EXPECT_FALSE(workspace.reached(3));
+
+  // multiple sources use the closest source
+  dijkstra<SceneGraphLayer>(layer, std::vector<NodeId>{0, 3}, workspace);
+  EXPECT_DOUBLE_EQ(workspace.distance(2), 0.5);
+  EXPECT_DOUBLE_EQ(workspace.distance(1), 1.0);
+  EXPECT_EQ(workspace.path(2), std::vector<NodeId>({3, 2}));
+}
+
+TEST(ShortestPathTests, AStarMatchesDijkstra) {
+  IsolatedSceneGraphLayer layer(1);
+  fillGrid(layer, 20, 21);
+  SearchWorkspace workspace;
+
+  // path has to go around the wall through the last row
+  const NodeId source = gridId(0, 0, 21);
+  const NodeId target = gridId(0, 20, 21);
+  const double astar_cost = findShortestPath<SceneGraphLayer>(
+      layer, source, target, workspace, true);
+  const auto astar_path = workspace.path(target);
+
+  const double dijkstra_cost = findShortestPath<SceneGraphLayer>(
+      layer, source, target, workspace, false);
+  EXPECT_NEAR(astar_cost, dijkstra_cost, 1.0e-9);
+  EXPECT_NEAR(astar_cost, 19.0 + 20.0 + 19.0, 1.0e-9);
+  ASSERT_FALSE(astar_path.empty());
+  EXPECT_EQ(astar_path.front(), source);
+  EXPECT_EQ(astar_path.back(), target);
+  EXPECT_EQ(astar_path.size(), 59u);
+
+  dijkstra<SceneGraphLayer>(layer, source, workspace);
+  EXPECT_NEAR(workspace.distance(target), astar_cost, 1.0e-9);
+
+  // the closest of multiple sources is used
+  const std::vector<NodeId> sources{source, gridId(5, 15, 21)};
+  EXPECT_NEAR(findShortestPath<SceneGraphLayer>(layer, sources, target, workspace),
+              5.0 + 5.0,
+              1.0e-9);
+  EXPECT_EQ(workspace.path(target).front(), gridId(5, 15, 21));
+
+  // missing target
+  EXPECT_TRUE(std::isinf(
+      findShortestPath<SceneGraphLayer>(layer, source, NodeId(10000), workspace)));
+}
+
+TEST(ShortestPathTests, WeightedShortcutFound) {
+  // the shortcut through node 2 leads away from the target but has cheap edges
+  IsolatedSceneGraphLayer layer(1);
+  layer.emplaceNode(0, std::make_unique<NodeAttributes>(Eigen::Vector3d::Zero()));
+  layer.emplaceNode(1, std::make_unique<NodeAttributes>(Eigen::Vector3d(10, 0, 0)));
+  layer.emplaceNode(2, std::make_unique<NodeAttributes>(Eigen::Vector3d(-20, 0, 0)));
+  layer.emplaceNode(3, std::make_unique<NodeAttributes>(Eigen::Vector3d(1, 0, 0)));
+  layer.insertEdge(0, 3);
+  layer.insertEdge(3, 1);
+  layer.insertEdge(0, 2, std::make_unique<EdgeAttributes>(0.1));
+  layer.insertEdge(2, 1, std::make_unique<EdgeAttributes>(0.1));
+
+  SearchWorkspace workspace;
+  EXPECT_NEAR(findShortestPath<SceneGraphLayer>(layer, NodeId(0), 1, workspace),
+              0.2,
+              1.0e-9);
+  EXPECT_EQ(workspace.path(1), std::vector<NodeId>({0, 2, 1}));
+
+  // the straight-line heuristic overestimates and settles the target too early
+  EXPECT_NEAR(findShortestPath<SceneGraphLayer>(layer, NodeId(0), 1, workspace, true),
+              10.0,
+              1.0e-9);
+}
+
+TEST(ShortestPathTests, DistanceMatrixCorrect) {
+  IsolatedSceneGraphLayer layer(1);
+  fillGrid(layer, 10, 11);
+  layer.emplaceNode(1000, std::make_unique<NodeAttributes>(Eigen::Vector3d::Zero()));
+
+  const std::vector<NodeId> sources{gridId(0, 0, 11), gridId(9, 10, 11), 1000};
+  const std::vector<NodeId> targets{gridId(3, 3, 11), gridId(0, 10, 11), 1000, 5000};
+
+  SearchWorkspace workspace;
+  const auto result =
+      getDistanceMatrix<SceneGraphLayer>(layer, sources, targets, workspace);
+  ASSERT_EQ(result.size(), sources.size());
+  for (size_t i = 0; i < sources.size(); ++i) {
+    ASSERT_EQ(result[i].size(), targets.size());
+    dijkstra<SceneGraphLayer>(layer, sources[i], workspace);
+    for (size_t j = 0; j < targets.size(); ++j) {
+      EXPECT_EQ(result[i][j], workspace.distance(targets[j])) << i << ", " << j;
+    }
+  }
+
+  EXPECT_DOUBLE_EQ(result[0][0], 6.0);
+  EXPECT_DOUBLE_EQ(result[2][2], 0.0);
+  EXPECT_TRUE(std::isinf(result[0][2]));
+  EXPECT_TRUE(std::isinf(result[0][3]));
+}
+
+}  // namespace spark_dsg
@@ -0,0 +1,324 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <spark_dsg/dynamic_scene_graph.h>
+#include <spark_dsg/node_attributes.h>
+#include <spark_dsg/scene_graph_layer.h>
+#include <spark_dsg/spatial_index.h>
+
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <thread>
+
+namespace spark_dsg {
+
+namespace {
+
+using Positions = std::map<NodeId, Eigen::Vector3d>;
+
+Positions randomPositions(size_t num_points, double extent, size_t seed) {
+  std::mt19937 gen(seed);
+  std::uniform_real_distribution<double> dist(-extent, extent);
+  Positions positions;
+  for (size_t i = 0; i < num_points; ++i) {
+    positions[i] = Eigen::Vector3d(dist(gen), dist(gen), dist(gen));
+  }
+  return positions;
+}
+
+std::vector<std::pair<double, NodeId>> sortedByDistance(const Positions& positions,
+                                                       const Eigen::Vector3d& center) {
+  std::vector<std::pair<double, NodeId>> sorted;
+  for (const auto& [node, pos] : positions) {
+    sorted.push_back({(pos - center).squaredNorm(), node});
+  }
+  std::sort(sorted.begin(), sorted.end());
+  return sorted;
+}
+
+std::vector<NodeId> bruteRadius(const Positions& positions,
+                                const Eigen::Vector3d& center,
+                                double radius) {
+  std::vector<NodeId> result;
+  for (const auto& [dist_sq, node] : sortedByDistance(positions, center)) {
+    if (dist_sq <= radius * radius) {
+      result.push_back(node);
+    }
+  }
+  return result;
+}
+
+std::vector<NodeId> bruteNearest(const Positions& positions,
+                                 const Eigen::Vector3d& center,
+                                 size_t k) {
+  std::vector<NodeId> result;
+  for (const auto& [dist_sq, node] : sortedByDistance(positions, center)) {
+    if (result.size() == k) {
+      break;
+    }
+    result.push_back(node);
+  }
+  return result;
+}
+
+}  // namespace
+
+TEST(SpatialIndexTests, InsertUpdateErase) {
+  SpatialIndex index(0.5);
+  EXPECT_EQ(index.size(), 0u);
+
+  index.insert(1, Eigen::Vector3d(0.1, 0.1, 0.1));
+  index.insert(2, Eigen::Vector3d(0.2, 0.1, 0.1));
+  index.insert(3, Eigen::Vector3d(5.0, 5.0, 5.0));
+  EXPECT_EQ(index.size(), 3u);
+  EXPECT_EQ(index.numCells(), 2u);
+  EXPECT_TRUE(index.contains(3));
+
+  // moving a node to a different cell drops the old (now empty) cell
+  index.insert(3, Eigen::Vector3d(0.3, 0.1, 0.1));
+  EXPECT_EQ(index.size(), 3u);
+  EXPECT_EQ(index.numCells(), 1u);
+  EXPECT_TRUE(index.position(3).isApprox(Eigen::Vector3d(0.3, 0.1, 0.1)));
+
+  EXPECT_TRUE(index.erase(2));
+  EXPECT_FALSE(index.erase(2));
+  EXPECT_FALSE(index.contains(2));
+  EXPECT_EQ(index.size(), 2u);
+  EXPECT_THROW(index.position(2), std::out_of_range);
+
+  index.clear();
+  EXPECT_EQ(index.size(), 0u);
+  EXPECT_EQ(index.numCells(), 0u);
+  EXPECT_THROW(SpatialIndex(0.0), std::invalid_argument);
+}
+
+TEST(SpatialIndexTests, NonFinitePositions) {
+  SpatialIndex index(0.5);
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  const double inf = std::numeric_limits<double>::infinity();
+  EXPECT_THROW(index.insert(1, Eigen::Vector3d(nan, 0.0, 0.0)), std::invalid_argument);
+  EXPECT_THROW(index.insert(1, Eigen::Vector3d(0.0, inf, 0.0)), std::invalid_argument);
+  EXPECT_EQ(index.size(), 0u);
+
+  index.insert(1, Eigen::Vector3d::Zero());
+  const Eigen::Vector3d bad(nan, 0.0, 0.0);
+  EXPECT_TRUE(index.radiusSearch(bad, 1.0).empty());
+  EXPECT_TRUE(index.radiusSearch(Eigen::Vector3d::Zero(), nan).empty());
+  EXPECT_TRUE(index.nearest(bad, 1).empty());
+  EXPECT_TRUE(index.boxSearch(bad, Eigen::Vector3d::Ones()).empty());
+
+  // unbounded boxes are still valid
+  EXPECT_EQ(index.boxSearch(Eigen::Vector3d::Constant(-inf), Eigen::Vector3d::Ones()),
+            std::vector<NodeId>({1}));
+
+  // the layer index leaves out nodes without a finite position
+  IsolatedSceneGraphLayer layer(1);
+  layer.emplaceNode(0, std::make_unique<NodeAttributes>(Eigen::Vector3d::Zero()));
+  layer.emplaceNode(1, std::make_unique<NodeAttributes>(bad));
+  EXPECT_EQ(layer.spatialIndex().size(), 1u);
+  layer.getNode(0).attributes().position = bad;
+  layer.refreshPosition(0);
+  EXPECT_EQ(layer.spatialIndex().size(), 0u);
+}
+
+TEST(SpatialIndexTests, QueriesMatchBruteForce) {
+  const auto positions = randomPositions(2000, 10.0, 42);
+  SpatialIndex index(1.0);
+  for (const auto& [node, pos] : positions) {
+    index.insert(node, pos);
+  }
+
+  std::mt19937 gen(7);
+  std::uniform_real_distribution<double> dist(-12.0, 12.0);
+  for (size_t i = 0; i < 50; ++i) {
+    const Eigen::Vector3d center(dist(gen), dist(gen), dist(gen));
+    EXPECT_EQ(index.radiusSearch(center, 2.5), bruteRadius(positions, center, 2.5));
+    EXPECT_EQ(index.nearest(center, 7), bruteNearest(positions, center, 7));
+  }
+
+  // queries covering much more space than the occupied cells
+  const Eigen::Vector3d origin = Eigen::Vector3d::Zero();
+  EXPECT_EQ(index.radiusSearch(origin, 100.0).size(), positions.size());
+  EXPECT_EQ(index.nearest(Eigen::Vector3d(500.0, 0.0, 0.0), 3),
+            bruteNearest(positions, Eigen::Vector3d(500.0, 0.0, 0.0), 3));
+  EXPECT_EQ(index.nearest(origin, 5000).size(), positions.size());
+}
+
+TEST(SpatialIndexTests, NearestWithMaxDistance) {
+  SpatialIndex index(1.0);
+  index.insert(1, Eigen::Vector3d(1.0, 0.0, 0.0));
+  index.insert(2, Eigen::Vector3d(2.0, 0.0, 0.0));
+  index.insert(3, Eigen::Vector3d(10.0, 0.0, 0.0));
+
+  const Eigen::Vector3d origin = Eigen::Vector3d::Zero();
+  EXPECT_EQ(index.nearest(origin, 3, 2.5), std::vector<NodeId>({1, 2}));
+  EXPECT_EQ(index.nearest(origin, 3, 0.5), std::vector<NodeId>());
+  EXPECT_EQ(index.nearest(origin, 3), std::vector<NodeId>({1, 2, 3}));
+  EXPECT_EQ(index.nearest(origin, 0), std::vector<NodeId>());
+}
+
+TEST(SpatialIndexTests, BoxSearch) {
+  const auto positions = randomPositions(500, 5.0, 3);
+  SpatialIndex index(0.75);
+  for (const auto& [node, pos] : positions) {
+    index.insert(node, pos);
+  }
+
+  const Eigen::Vector3d min(-1.0, -2.0, 0.0);
+  const Eigen::Vector3d max(3.0, 1.0, 4.5);
+  std::vector<NodeId> expected;
+  for (const auto& [node, pos] : positions) {
+    if ((pos.array() >= min.array()).all() && (pos.array() <= max.array()).all()) {
+      expected.push_back(node);
+    }
+  }
+
+  EXPECT_EQ(index.boxSearch(min, max), expected);
+  EXPECT_TRUE(index.boxSearch(max, min).empty());
+}
+
+TEST(SpatialIndexTests, BulkQueries) {
+  const auto positions = randomPositions(300, 4.0, 11);
+  SpatialIndex index;
+  for (const auto& [node, pos] : positions) {
+    index.insert(node, pos);
+  }
+
+  const std::vector<Eigen::Vector3d> centers{Eigen::Vector3d::Zero(),
+                                             Eigen::Vector3d(1.0, 2.0, -1.0),
+                                             Eigen::Vector3d(-3.0, 0.5, 2.0)};
+  const auto radius_results = index.radiusSearch(centers, 1.5);
+  const auto knn_results = index.nearest(centers, 4);
+  ASSERT_EQ(radius_results.size(), centers.size());
+  ASSERT_EQ(knn_results.size(), centers.size());
+  for (size_t i = 0; i < centers.size(); ++i) {
+    EXPECT_EQ(radius_results[i], index.radiusSearch(centers[i], 1.5));
+    EXPECT_EQ(knn_results[i], index.nearest(centers[i], 4));
+  }
+}
+
+TEST(SpatialIndexTests, LayerIndexTracksNodes) {
+  IsolatedSceneGraphLayer layer(1);
+  layer.emplaceNode(0, std::make_unique<NodeAttributes>(Eigen::Vector3d(0, 0, 0)));
+  layer.emplaceNode(1, std::make_unique<NodeAttributes>(Eigen::Vector3d(1, 0, 0)));
+
+  const auto& index = layer.spatialIndex();
+  EXPECT_EQ(index.size(), 2u);
+
+  // later changes are applied to the existing index
+  layer.emplaceNode(2, std::make_unique<NodeAttributes>(Eigen::Vector3d(2, 0, 0)));
+  layer.emplaceNode(3, std::make_unique<NodeAttributes>(Eigen::Vector3d(3, 0, 0)));
+  EXPECT_EQ(&layer.spatialIndex(), &index);
+  EXPECT_EQ(index.nearest(Eigen::Vector3d(2.9, 0.0, 0.0), 2),
+            std::vector<NodeId>({3, 2}));
+
+  layer.removeNode(3);
+  EXPECT_FALSE(index.contains(3));
+  layer.mergeNodes(2, 1);
+  EXPECT_FALSE(index.contains(2));
+  EXPECT_EQ(index.radiusSearch(Eigen::Vector3d::Zero(), 10.0),
+            std::vector<NodeId>({0, 1}));
+
+  // in-place modifications need to be reported
+  layer.getNode(1).attributes().position = Eigen::Vector3d(-5.0, 0.0, 0.0);
+  layer.refreshPosition(1);
+  EXPECT_EQ(index.nearest(Eigen::Vector3d(-4.0, 0.0, 0.0), 1),
+            std::vector<NodeId>({1}));
+
+  // a different resolution builds a second index without invalidating the first
+  const auto& fine_index = layer.spatialIndex(0.1);
+  EXPECT_EQ(fine_index.resolution(), 0.1);
+  EXPECT_EQ(fine_index.size(), 2u);
+  EXPECT_EQ(&layer.spatialIndex(), &index);
+  EXPECT_EQ(&layer.spatialIndex(0.1), &fine_index);
+
+  // both indices are kept up to date
+  layer.emplaceNode(4, std::make_unique<NodeAttributes>(Eigen::Vector3d(4, 0, 0)));
+  EXPECT_TRUE(index.contains(4));
+  EXPECT_TRUE(fine_index.contains(4));
+}
+
+TEST(SpatialIndexTests, LayerIndexBuiltOnceConcurrently) {
+  IsolatedSceneGraphLayer layer(1);
+  for (size_t i = 0; i < 1000; ++i) {
+    layer.emplaceNode(i, std::make_unique<NodeAttributes>(Eigen::Vector3d(i, 0, 0)));
+  }
+
+  std::vector<const SpatialIndex*> results(8, nullptr);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < results.size(); ++i) {
+    threads.emplace_back([&layer, &results, i]() {
+      const auto& index = layer.spatialIndex();
+      EXPECT_EQ(index.size(), 1000u);
+      results[i] = &index;
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (const auto result : results) {
+    EXPECT_EQ(result, results.front());
+  }
+}
+
+TEST(SpatialIndexTests, GraphUpdatesIndex) {
+  DynamicSceneGraph graph;
+  graph.emplaceNode(DsgLayers::PLACES,
+                    NodeSymbol('p', 0),
+                    std::make_unique<NodeAttributes>(Eigen::Vector3d::Zero()));
+  const auto& index = graph.getLayer(DsgLayers::PLACES).spatialIndex();
+
+  graph.emplaceNode(DsgLayers::PLACES,
+                    NodeSymbol('p', 1),
+                    std::make_unique<NodeAttributes>(Eigen::Vector3d(5.0, 0.0, 0.0)));
+  EXPECT_EQ(index.size(), 2u);
+
+  graph.setNodeAttributes(NodeSymbol('p', 1),
+                          std::make_unique<NodeAttributes>(Eigen::Vector3d(-1, 0, 0)));
+  EXPECT_TRUE(index.position(NodeSymbol('p', 1)).isApprox(Eigen::Vector3d(-1, 0, 0)));
+
+  graph.addOrUpdateNode(DsgLayers::PLACES,
+                        NodeSymbol('p', 0),
+                        std::make_unique<NodeAttributes>(Eigen::Vector3d(0, 3, 0)));
+  EXPECT_TRUE(index.position(NodeSymbol('p', 0)).isApprox(Eigen::Vector3d(0, 3, 0)));
+
+  graph.removeNode(NodeSymbol('p', 0));
+  EXPECT_EQ(index.size(), 1u);
+}
+
+}  // namespace spark_dsg
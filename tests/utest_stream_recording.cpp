@@ -0,0 +1,116 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <spark_dsg/stream_recording.h>
+
+#include <filesystem>
+
+#include "spark_dsg_tests/temp_file.h"
+
+namespace spark_dsg {
+
+namespace {
+
+StreamMessage makeMessage(uint64_t stamp_ns, const std::string& topic, size_t size) {
+  StreamMessage message;
+  message.stamp_ns = stamp_ns;
+  message.topic = topic;
+  for (size_t i = 0; i < size; ++i) {
+    message.payload.push_back(static_cast<uint8_t>(i + stamp_ns));
+  }
+  return message;
+}
+
+void expectMessagesEqual(const StreamMessage& expected, const StreamMessage& result) {
+  EXPECT_EQ(expected.stamp_ns, result.stamp_ns);
+  EXPECT_EQ(expected.topic, result.topic);
+  EXPECT_EQ(expected.payload, result.payload);
+}
+
+}  // namespace
+
+TEST(StreamRecording, RoundTripCorrect) {
+  TempFile tmp_file;
+  const std::vector<StreamMessage> expected{makeMessage(10, "", 5),
+                                            makeMessage(20, "layer/2/", 0),
+                                            makeMessage(35, "mesh/", 300)};
+  {
+    StreamWriter writer(tmp_file.path);
+    for (const auto& message : expected) {
+      writer.write(message);
+    }
+    EXPECT_EQ(writer.numMessages(), 3u);
+  }
+
+  StreamReader reader(tmp_file.path);
+  ASSERT_EQ(reader.size(), expected.size());
+  EXPECT_EQ(reader.stamp(2), 35u);
+
+  // random access
+  expectMessagesEqual(expected[2], reader.read(2));
+  expectMessagesEqual(expected[0], reader.read(0));
+  expectMessagesEqual(expected[1], reader.read(1));
+  EXPECT_THROW(reader.read(3), std::out_of_range);
+}
+
+TEST(StreamRecording, UnclosedRecordingReadable) {
+  TempFile tmp_file;
+  const std::vector<StreamMessage> expected{makeMessage(10, "", 5),
+                                            makeMessage(20, "layer/2/", 10)};
+  {
+    StreamWriter writer(tmp_file.path);
+    for (const auto& message : expected) {
+      writer.write(message);
+    }
+    writer.write(makeMessage(30, "", 100));
+    writer.close();
+  }
+
+  // drop the index and truncate the last message
+  const auto file_size = std::filesystem::file_size(tmp_file.path);
+  std::filesystem::resize_file(tmp_file.path, file_size - 24 - 3 * 16 - 50);
+
+  StreamReader reader(tmp_file.path);
+  ASSERT_EQ(reader.size(), expected.size());
+  expectMessagesEqual(expected[0], reader.read(0));
+  expectMessagesEqual(expected[1], reader.read(1));
+}
+
+TEST(StreamRecording, InvalidFileThrows) {
+  TempFile tmp_file;
+  EXPECT_THROW(StreamReader reader(tmp_file.path), std::runtime_error);
+}
+
+}  // namespace spark_dsg
@@ -0,0 +1,250 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <spark_dsg/dynamic_scene_graph.h>
+#include <spark_dsg/node_attributes.h>
+#include <spark_dsg/tiered_mesh.h>
+
+#include <filesystem>
+
+#include "spark_dsg_tests/temp_file.h"
+
+namespace spark_dsg {
+
+namespace {
+
+std::string archivePath(const TempFile& file) {
+  return std::string(file.path.c_str()) + ".archive";
+}
+
+Mesh createMesh(size_t num_vertices, Mesh::Timestamp stamp_offset = 0) {
+  Mesh mesh(true, true, true, true);
+  mesh.resizeVertices(num_vertices);
+  for (size_t i = 0; i < num_vertices; ++i) {
+    mesh.setPos(i, Eigen::Vector3f(i, 2.0f * i, -1.0f * i));
+    mesh.setColor(i, Color(i, 255 - i, 3 * i, 128));
+    mesh.setTimestamp(i, stamp_offset + 10 * i);
+    mesh.setFirstSeenTimestamp(i, stamp_offset + 10 * i - 1);
+    mesh.setLabel(i, i % 3);
+  }
+
+  for (size_t i = 0; i + 2 < num_vertices; ++i) {
+    mesh.faces.push_back({{i, i + 1, i + 2}});
+  }
+
+  return mesh;
+}
+
+void expectSameMesh(const TieredMesh& tiered, const Mesh& expected) {
+  ASSERT_EQ(tiered.numVertices(), expected.numVertices());
+  ASSERT_EQ(tiered.numFaces(), expected.numFaces());
+  for (size_t i = 0; i < expected.numVertices(); ++i) {
+    EXPECT_EQ(tiered.pos(i), expected.pos(i)) << "vertex " << i;
+    EXPECT_EQ(tiered.color(i), expected.color(i)) << "vertex " << i;
+    EXPECT_EQ(tiered.timestamp(i), expected.timestamp(i)) << "vertex " << i;
+    EXPECT_EQ(tiered.firstSeenTimestamp(i), expected.firstSeenTimestamp(i));
+    EXPECT_EQ(tiered.label(i), expected.label(i)) << "vertex " << i;
+  }
+
+  for (size_t i = 0; i < expected.numFaces(); ++i) {
+    EXPECT_EQ(tiered.face(i), expected.face(i)) << "face " << i;
+  }
+}
+
+}  // namespace
+
+TEST(TieredMeshTests, ArchiveIsTransparent) {
+  TempFile tmp_file;
+  TieredMesh::Config config;
+  config.archive_path = archivePath(tmp_file);
+  config.archive_age_ns = 25;
+  TieredMesh tiered(config, true, true, true, true);
+
+  Mesh expected = createMesh(10);
+  tiered.append(expected);
+  expectSameMesh(tiered, expected);
+
+  // vertices 0-4 have stamps before 50
+  EXPECT_EQ(tiered.archive(75), 5u);
+  EXPECT_EQ(tiered.numArchived(), 5u);
+  EXPECT_EQ(tiered.active().numVertices(), 5u);
+  EXPECT_TRUE(std::filesystem::exists(config.archive_path));
+  expectSameMesh(tiered, expected);
+
+  // only a prefix of the active vertices is archived
+  tiered.setTimestamp(5, 1000);
+  expected.setTimestamp(5, 1000);
+  EXPECT_EQ(tiered.archiveBefore(80), 0u);
+
+  // faces are offset by the existing vertices
+  const auto other = createMesh(4, 2000);
+  tiered.append(other);
+  expected.append(other);
+  expectSameMesh(tiered, expected);
+
+  // archived vertices can be modified
+  tiered.setPos(2, Eigen::Vector3f(1.0f, 2.0f, 3.0f));
+  expected.setPos(2, Eigen::Vector3f(1.0f, 2.0f, 3.0f));
+  tiered.setLabel(3, 7);
+  expected.setLabel(3, 7);
+  tiered.setColor(4, Color(1, 2, 3));
+  expected.setColor(4, Color(1, 2, 3));
+  expectSameMesh(tiered, expected);
+
+  EXPECT_EQ(tiered.archiveBefore(1500), 5u);
+  expectSameMesh(tiered, expected);
+
+  const auto mesh = tiered.toMesh();
+  EXPECT_EQ(mesh->points, expected.points);
+  EXPECT_EQ(mesh->colors, expected.colors);
+  EXPECT_EQ(mesh->stamps, expected.stamps);
+  EXPECT_EQ(mesh->first_seen_stamps, expected.first_seen_stamps);
+  EXPECT_EQ(mesh->labels, expected.labels);
+  EXPECT_EQ(mesh->faces, expected.faces);
+
+  EXPECT_THROW(tiered.pos(14), std::out_of_range);
+  EXPECT_THROW(tiered.face(12), std::out_of_range);
+}
+
+TEST(TieredMeshTests, Residency) {
+  TempFile tmp_file;
+  TieredMesh::Config config;
+  config.archive_path = archivePath(tmp_file);
+  {
+    TieredMesh tiered(config, true, true, true, true);
+    const auto mesh = createMesh(20000);
+    tiered.append(mesh);
+
+    auto residency = tiered.residency();
+    EXPECT_EQ(residency.num_active, 20000u);
+    EXPECT_EQ(residency.num_archived, 0u);
+    EXPECT_GT(residency.active_bytes, 0u);
+    EXPECT_EQ(residency.archive_bytes, 0u);
+
+    tiered.archiveBefore(100000);
+    residency = tiered.residency();
+    EXPECT_EQ(residency.num_active, 10000u);
+    EXPECT_EQ(residency.num_archived, 10000u);
+    EXPECT_GT(residency.archive_bytes, 0u);
+    EXPECT_LE(residency.resident_archive_bytes, residency.archive_bytes);
+
+    // evicted vertices are paged back in on access
+    tiered.evictArchive();
+    EXPECT_LE(tiered.residency().resident_archive_bytes, residency.archive_bytes);
+    EXPECT_EQ(tiered.pos(1234), mesh.pos(1234));
+    EXPECT_EQ(tiered.timestamp(9999), mesh.timestamp(9999));
+  }
+
+  EXPECT_FALSE(std::filesystem::exists(config.archive_path));
+}
+
+TEST(TieredMeshTests, SaveLoad) {
+  TempFile archive_file;
+  TempFile save_file;
+  TieredMesh::Config config;
+  config.archive_path = archivePath(archive_file);
+  TieredMesh tiered(config, true, true, false, true);
+
+  Mesh expected(true, true, false, true);
+  expected.append(createMesh(50));
+  tiered.append(expected);
+  tiered.archiveBefore(200);
+  ASSERT_EQ(tiered.numArchived(), 20u);
+
+  // saved in the regular mesh format
+  const auto save_path = std::string(save_file.path.c_str()) + ".sparkdsg";
+  tiered.save(save_path);
+  const auto loaded = Mesh::load(save_path);
+  std::filesystem::remove(save_path);
+  ASSERT_TRUE(loaded);
+  EXPECT_FALSE(loaded->has_labels);
+  EXPECT_EQ(loaded->points, expected.points);
+  EXPECT_EQ(loaded->colors, expected.colors);
+  EXPECT_EQ(loaded->stamps, expected.stamps);
+  EXPECT_EQ(loaded->first_seen_stamps, expected.first_seen_stamps);
+  EXPECT_TRUE(loaded->labels.empty());
+  EXPECT_EQ(loaded->faces, expected.faces);
+
+  EXPECT_THROW(tiered.label(3), std::out_of_range);
+}
+
+TEST(TieredMeshTests, SaveGraph) {
+  TempFile archive_file;
+  TempFile save_file;
+  TieredMesh::Config config;
+  config.archive_path = archivePath(archive_file);
+  TieredMesh tiered(config, true, true, true, true);
+
+  const auto expected = createMesh(100);
+  tiered.append(expected);
+  tiered.archiveBefore(500);
+  ASSERT_EQ(tiered.numArchived(), 50u);
+
+  DynamicSceneGraph graph;
+  graph.emplaceNode(DsgLayers::OBJECTS, 1, std::make_unique<ObjectNodeAttributes>());
+  graph.emplaceNode(DsgLayers::OBJECTS, 2, std::make_unique<ObjectNodeAttributes>());
+  graph.insertEdge(1, 2);
+
+  const auto save_path = std::string(save_file.path.c_str()) + ".sparkdsg";
+  io::saveDsgBinary(graph, save_path, tiered);
+  const auto loaded = DynamicSceneGraph::load(save_path);
+  std::filesystem::remove(save_path);
+  ASSERT_TRUE(loaded);
+  EXPECT_EQ(loaded->numNodes(false), 2u);
+  EXPECT_TRUE(loaded->hasEdge(1, 2));
+
+  const auto mesh = loaded->mesh();
+  ASSERT_TRUE(mesh);
+  EXPECT_EQ(mesh->points, expected.points);
+  EXPECT_EQ(mesh->colors, expected.colors);
+  EXPECT_EQ(mesh->stamps, expected.stamps);
+  EXPECT_EQ(mesh->labels, expected.labels);
+  EXPECT_EQ(mesh->first_seen_stamps, expected.first_seen_stamps);
+  EXPECT_EQ(mesh->faces, expected.faces);
+}
+
+TEST(TieredMeshTests, InvalidConfig) {
+  TieredMesh::Config config;
+  config.archive_path = "/nonexistent/directory/archive";
+  EXPECT_THROW(TieredMesh tiered(config), std::runtime_error);
+
+  TempFile tmp_file;
+  config.archive_path = archivePath(tmp_file);
+  TieredMesh tiered(config, true, false);
+  tiered.append(Mesh(true, false));
+  EXPECT_THROW(tiered.archiveBefore(10), std::runtime_error);
+}
+
+}  // namespace spark_dsg
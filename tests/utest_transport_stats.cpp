@@ -0,0 +1,108 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <spark_dsg/serialization/graph_binary_serialization.h>
+#include <spark_dsg/transport_stats.h>
+
+namespace spark_dsg {
+
+TEST(TransportStatsTests, HistogramBucketsCorrect) {
+  LogHistogram hist;
+  EXPECT_EQ(hist.mean(), 0.0);
+  EXPECT_EQ(hist.percentile(0.5), 0.0);
+
+  hist.add(0.5);
+  hist.add(1.0);
+  hist.add(3.0);
+  hist.add(3.5);
+  EXPECT_EQ(hist.count, 4u);
+  EXPECT_EQ(hist.buckets[0], 1u);
+  EXPECT_EQ(hist.buckets[1], 1u);
+  EXPECT_EQ(hist.buckets[2], 2u);
+  EXPECT_NEAR(hist.mean(), 2.0, 1.0e-9);
+  EXPECT_EQ(hist.min, 0.5);
+  EXPECT_EQ(hist.max, 3.5);
+
+  // percentiles are bucket upper bounds clamped to the maximum
+  EXPECT_EQ(hist.percentile(0.25), 1.0);
+  EXPECT_EQ(hist.percentile(0.5), 2.0);
+  EXPECT_EQ(hist.percentile(1.0), 3.5);
+
+  // huge values end up in the last bucket
+  hist.add(1.0e30);
+  EXPECT_EQ(hist.buckets[LogHistogram::NUM_BUCKETS - 1], 1u);
+
+  hist.reset();
+  EXPECT_EQ(hist.count, 0u);
+}
+
+TEST(TransportStatsTests, RecorderDisabledByDefault) {
+  TransportStatsRecorder recorder;
+  recorder.update([](TransportStats& stats) { ++stats.messages_sent; });
+  EXPECT_EQ(recorder.get().messages_sent, 0u);
+
+  recorder.enable(true);
+  recorder.update([](TransportStats& stats) { ++stats.messages_sent; });
+  EXPECT_EQ(recorder.get().messages_sent, 1u);
+
+  recorder.reset();
+  EXPECT_EQ(recorder.get().messages_sent, 0u);
+}
+
+TEST(TransportStatsTests, TrailerRoundTrip) {
+  DynamicSceneGraph graph;
+  graph.emplaceNode(2, 0, std::make_unique<NodeAttributes>());
+
+  std::vector<uint8_t> buffer;
+  io::binary::writeGraph(graph, buffer);
+
+  TransportTrailer trailer;
+  EXPECT_FALSE(TransportTrailer::parse(buffer.data(), buffer.size(), trailer));
+
+  TransportTrailer expected;
+  expected.sequence = 5;
+  expected.stamp_ns = 123456789;
+  expected.append(buffer);
+  ASSERT_TRUE(TransportTrailer::parse(buffer.data(), buffer.size(), trailer));
+  EXPECT_EQ(trailer.sequence, expected.sequence);
+  EXPECT_EQ(trailer.stamp_ns, expected.stamp_ns);
+
+  // graphs with a trailer are still readable
+  auto result = io::binary::readGraph(buffer);
+  ASSERT_TRUE(result != nullptr);
+  EXPECT_EQ(result->numNodes(), 1u);
+}
+
+}  // namespace spark_dsg
@@ -54,4 +54,146 @@ TEST(ZmqInterfaceTests, BasicSendReceiveCorrect) {
   EXPECT_TRUE(receiver.graph() != nullptr);
 }
 
+TEST(ZmqInterfaceTests, StatsCorrect) {
+  ZmqSender sender("tcp://127.0.0.1:8002", 1);
+  ZmqReceiver receiver("tcp://127.0.0.1:8002", 1, false);
+  sender.enableStats();
+  receiver.enableStats();
+
+  DynamicSceneGraph graph;
+  graph.emplaceNode(2, 0, std::make_unique<NodeAttributes>());
+
+  // wait for the subscription to connect
+  for (size_t i = 0; i < 15; ++i) {
+    sender.send(graph);
+    if (receiver.recv(100, true)) {
+      break;
+    }
+  }
+
+  ASSERT_TRUE(receiver.graph() != nullptr);
+  EXPECT_EQ(receiver.graph()->numNodes(), 1u);
+  receiver.resetStats();
+
+  for (size_t i = 0; i < 3; ++i) {
+    sender.send(graph);
+  }
+
+  EXPECT_TRUE(receiver.recv(100, true));
+  const auto sender_stats = sender.stats();
+  EXPECT_GE(sender_stats.messages_sent, 4u);
+  EXPECT_EQ(sender_stats.serialize_us.count, sender_stats.messages_sent);
+  EXPECT_EQ(sender_stats.send_us.count, sender_stats.messages_sent);
+  EXPECT_GT(sender_stats.bytes_sent, 0u);
+
+  const auto receiver_stats = receiver.stats();
+  EXPECT_EQ(receiver_stats.messages_received, 3u);
+  EXPECT_EQ(receiver_stats.messages_dropped, 0u);
+  EXPECT_EQ(receiver_stats.latency_us.count, 3u);
+  EXPECT_EQ(receiver_stats.parse_us.count, 3u);
+  const size_t message_size = sender_stats.bytes_sent / sender_stats.messages_sent;
+  EXPECT_EQ(receiver_stats.bytes_received, 3 * message_size);
+}
+
+TEST(ZmqInterfaceTests, LayerSubscriptionCorrect) {
+  ZmqSender sender("tcp://127.0.0.1:8003", 1, true);
+  ZmqReceiver receiver("tcp://127.0.0.1:8003", 1, {DsgLayers::PLACES}, false);
+
+  DynamicSceneGraph graph;
+  graph.emplaceNode(DsgLayers::OBJECTS, 0, std::make_unique<NodeAttributes>());
+  graph.emplaceNode(DsgLayers::PLACES, 1, std::make_unique<NodeAttributes>());
+  graph.emplaceNode(DsgLayers::PLACES, 2, std::make_unique<NodeAttributes>());
+  graph.emplaceNode(DsgLayers::ROOMS, 3, std::make_unique<NodeAttributes>());
+  graph.insertEdge(1, 2);
+  graph.insertEdge(1, 3);
+
+  for (size_t i = 0; i < 15; ++i) {
+    sender.send(graph);
+    if (receiver.recv(100, true)) {
+      break;
+    }
+  }
+
+  ASSERT_TRUE(receiver.graph() != nullptr);
+  const auto& result = *receiver.graph();
+  EXPECT_EQ(result.numNodes(), 2u);
+  EXPECT_TRUE(result.hasNode(1));
+  EXPECT_TRUE(result.hasNode(2));
+  EXPECT_TRUE(result.hasEdge(1, 2));
+  EXPECT_FALSE(result.hasNode(0));
+  EXPECT_FALSE(result.hasNode(3));
+}
+
+TEST(ZmqInterfaceTests, AsyncSendCorrect) {
+  ZmqSender sender("tcp://127.0.0.1:8004", 1);
+  ZmqReceiver receiver("tcp://127.0.0.1:8004", 1, false);
+  sender.enableStats();
+
+  auto graph = std::make_shared<DynamicSceneGraph>();
+  graph->emplaceNode(2, 0, std::make_unique<NodeAttributes>());
+
+  // wait for the subscription to connect
+  for (size_t i = 0; i < 15; ++i) {
+    sender.sendAsync(*graph);
+    sender.flush();
+    if (receiver.recv(100, true)) {
+      break;
+    }
+  }
+
+  ASSERT_TRUE(receiver.graph() != nullptr);
+  EXPECT_EQ(receiver.graph()->numNodes(), 1u);
+
+  // snapshots handed off within the window are coalesced into the latest one
+  sender.resetStats();
+  sender.setCoalesceWindow(200);
+  for (size_t i = 1; i < 5; ++i) {
+    auto snapshot = graph->clone();
+    snapshot->emplaceNode(2, i, std::make_unique<NodeAttributes>());
+    graph = snapshot;
+    sender.sendAsync(snapshot);
+  }
+
+  sender.flush();
+  EXPECT_TRUE(receiver.recv(100, true));
+  EXPECT_EQ(receiver.graph()->numNodes(), 5u);
+
+  const auto stats = sender.stats();
+  EXPECT_EQ(stats.messages_sent, 1u);
+  EXPECT_EQ(stats.messages_dropped, 3u);
+}
+
+TEST(ZmqInterfaceTests, RawRelayCorrect) {
+  ZmqSender sender("tcp://127.0.0.1:8005", 1);
+  ZmqReceiver recorder("tcp://127.0.0.1:8005", 1, false);
+
+  DynamicSceneGraph graph;
+  graph.emplaceNode(2, 0, std::make_unique<NodeAttributes>());
+  graph.emplaceNode(3, 1, std::make_unique<NodeAttributes>());
+
+  StreamMessage message;
+  bool have_message = false;
+  for (size_t i = 0; i < 15 && !have_message; ++i) {
+    sender.send(graph);
+    have_message = recorder.recvRaw(100, message);
+  }
+
+  ASSERT_TRUE(have_message);
+  EXPECT_TRUE(message.topic.empty());
+  EXPECT_GT(message.stamp_ns, 0u);
+  EXPECT_TRUE(recorder.graph() == nullptr);
+
+  ZmqSender player("tcp://127.0.0.1:8006", 1);
+  ZmqReceiver receiver("tcp://127.0.0.1:8006", 1);
+  for (size_t i = 0; i < 15; ++i) {
+    player.sendRaw(message);
+    if (receiver.recv(100)) {
+      break;
+    }
+  }
+
+  ASSERT_TRUE(receiver.graph() != nullptr);
+  EXPECT_EQ(receiver.graph()->numNodes(), 2u);
+}
+
 }  // namespace spark_dsg